@@ -0,0 +1,321 @@
+#include "array_kernels.hpp"
+#include "test_harness.hpp"
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// Every kernel table this CPU can run (AVX2, SSE2, plain loops) against the
+// plain loops below, at every length from 0 to 69 so each vector width sees
+// empty input, whole vectors and every tail, starting from an aligned and a
+// misaligned element.
+
+namespace {
+
+constexpr size_t kMaxLength = 69;
+
+// Reference kernels: one element at a time, integer arithmetic wrapping
+// through the unsigned type.
+template<typename T>
+T Wrap(uint64_t value) {
+    return static_cast<T>(value);
+}
+
+template<typename T>
+T ReferenceAdd(T left, T right) {
+    if constexpr (std::is_integral_v<T>) {
+        return Wrap<T>(static_cast<uint64_t>(left) + static_cast<uint64_t>(right));
+    } else {
+        return left + right;
+    }
+}
+
+template<typename T>
+T ReferenceMultiply(T left, T right) {
+    if constexpr (std::is_integral_v<T>) {
+        return Wrap<T>(static_cast<uint64_t>(left) * static_cast<uint64_t>(right));
+    } else {
+        return left * right;
+    }
+}
+
+template<typename T>
+ArrayAccumulator<T> ReferenceSum(const T* elements, size_t count) {
+    ArrayAccumulator<T> sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum = ReferenceAdd<ArrayAccumulator<T>>(sum, static_cast<ArrayAccumulator<T>>(elements[i]));
+    }
+    return sum;
+}
+
+template<typename T>
+ArrayAccumulator<T> ReferenceDot(const T* left, const T* right, size_t count) {
+    ArrayAccumulator<T> sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const auto product = ReferenceMultiply<ArrayAccumulator<T>>(left[i], right[i]);
+        sum = ReferenceAdd<ArrayAccumulator<T>>(sum, product);
+    }
+    return sum;
+}
+
+template<typename T>
+T ReferenceExtreme(const T* elements, size_t count, bool max) {
+    T best = elements[0];
+    for (size_t i = 0; i < count; ++i) {
+        if (elements[i] != elements[i]) {
+            return elements[i];
+        }
+        if (max ? elements[i] > best : elements[i] < best) {
+            best = elements[i];
+        }
+    }
+    return best;
+}
+
+template<typename T>
+bool Same(T left, T right) {
+    if constexpr (std::is_floating_point_v<T>) {
+        if (std::isnan(left) || std::isnan(right)) {
+            return std::isnan(left) && std::isnan(right);
+        }
+    }
+    return left == right;
+}
+
+// Deterministic values of each type: negatives and the extremes for the
+// integers, so sums and products wrap; halves for floating point, so every
+// sum and dot product below is exact whatever order the kernel adds in.
+struct Generator {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    uint64_t Next() {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return state >> 16;
+    }
+
+    template<typename T>
+    T Value() {
+        const uint64_t bits = Next();
+        if constexpr (std::is_floating_point_v<T>) {
+            return static_cast<T>(static_cast<int64_t>(bits % 2001) - 1000) / 2;
+        } else if constexpr (std::is_same_v<T, uint8_t>) {
+            return static_cast<uint8_t>(bits);
+        } else {
+            switch (bits % 8) {
+            case 0:
+                return std::numeric_limits<T>::min();
+            case 1:
+                return std::numeric_limits<T>::max();
+            default:
+                return static_cast<T>(static_cast<int64_t>(bits % 2001) - 1000) * static_cast<T>(bits % 3 == 0 ? 1 : -1);
+            }
+        }
+    }
+
+    template<typename T>
+    std::vector<T> Values(size_t count) {
+        std::vector<T> values(count);
+        for (T& value : values) {
+            value = Value<T>();
+        }
+        return values;
+    }
+};
+
+// Runs `check(elements, count)` at every length, from element 0 and from
+// element 1 of a buffer, and returns the first failure, or "".
+template<typename T>
+std::string AtEveryLength(Generator& generator, size_t minimum,
+                          const std::function<std::string(std::vector<T>&, size_t, size_t)>& check) {
+    for (size_t offset = 0; offset < 2; ++offset) {
+        for (size_t count = minimum; count <= kMaxLength; ++count) {
+            std::vector<T> buffer = generator.Values<T>(offset + count + 1);
+            const std::string failure = check(buffer, offset, count);
+            if (!failure.empty()) {
+                return failure + " at length " + std::to_string(count) + ", offset " + std::to_string(offset);
+            }
+        }
+    }
+    return "";
+}
+
+template<typename T>
+void CheckKernelSet(const std::string& table, const std::string& type, const ArrayKernelSet<T>& kernels) {
+    Generator generator;
+    const std::string name = table + " " + type + " ";
+    auto report = [&](const std::string& kernel, const std::string& failure) {
+        Check(failure.empty(), name + kernel + (failure.empty() ? "" : ": " + failure));
+    };
+
+    report("Fill", AtEveryLength<T>(generator, 0, [&](std::vector<T>& buffer, size_t offset, size_t count) {
+        const T guard = buffer[offset + count];
+        const T value = generator.Value<T>();
+        kernels.fill(buffer.data() + offset, count, value);
+        for (size_t i = 0; i < count; ++i) {
+            if (!Same(buffer[offset + i], value)) {
+                return std::string("element ") + std::to_string(i) + " not filled";
+            }
+        }
+        return Same(buffer[offset + count], guard) ? std::string() : std::string("wrote past the end");
+    }));
+
+    report("IndexOf", AtEveryLength<T>(generator, 0, [&](std::vector<T>& buffer, size_t offset, size_t count) {
+        const T* elements = buffer.data() + offset;
+        // Every element, an element repeated later, and the one past the end.
+        for (size_t target = 0; target <= count; ++target) {
+            const T value = buffer[offset + target];
+            int64_t expected = -1;
+            for (size_t i = 0; i < count; ++i) {
+                if (elements[i] == value) {
+                    expected = static_cast<int64_t>(i);
+                    break;
+                }
+            }
+            if (kernels.indexOf(elements, count, value) != expected) {
+                return std::string("wrong index for element ") + std::to_string(target);
+            }
+        }
+        if (count > 1) {
+            buffer[offset + count - 1] = buffer[offset];
+            if (kernels.indexOf(elements, count, buffer[offset]) != 0) {
+                return std::string("did not return the first match");
+            }
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            if (count > 0) {
+                buffer[offset + count / 2] = std::numeric_limits<T>::quiet_NaN();
+                if (kernels.indexOf(elements, count, std::numeric_limits<T>::quiet_NaN()) != -1) {
+                    return std::string("NaN matched");
+                }
+            }
+        }
+        return std::string();
+    }));
+
+    report("Sum", AtEveryLength<T>(generator, 0, [&](std::vector<T>& buffer, size_t offset, size_t count) {
+        const T* elements = buffer.data() + offset;
+        return Same(kernels.sum(elements, count), ReferenceSum(elements, count)) ? std::string()
+                                                                                   : std::string("wrong sum");
+    }));
+
+    for (bool max : {false, true}) {
+        auto kernel = max ? kernels.max : kernels.min;
+        report(max ? "Max" : "Min", AtEveryLength<T>(generator, 1, [&](std::vector<T>& buffer, size_t offset, size_t count) {
+            const T* elements = buffer.data() + offset;
+            if (!Same(kernel(elements, count), ReferenceExtreme(elements, count, max))) {
+                return std::string("wrong result");
+            }
+            if constexpr (std::is_floating_point_v<T>) {
+                // A NaN anywhere, in the vector body or the tail, wins.
+                for (size_t at : {size_t(0), count / 2, count - 1}) {
+                    const T saved = buffer[offset + at];
+                    buffer[offset + at] = std::numeric_limits<T>::quiet_NaN();
+                    const bool nan = std::isnan(kernel(elements, count));
+                    buffer[offset + at] = saved;
+                    if (!nan) {
+                        return std::string("NaN at element ") + std::to_string(at) + " ignored";
+                    }
+                }
+            }
+            return std::string();
+        }));
+    }
+
+    for (bool multiply : {false, true}) {
+        auto kernel = multiply ? kernels.multiply : kernels.add;
+        report(multiply ? "Multiply" : "Add", AtEveryLength<T>(generator, 0, [&](std::vector<T>& buffer, size_t offset, size_t count) {
+            const std::vector<T> right = generator.Values<T>(count);
+            std::vector<T> expected(count);
+            for (size_t i = 0; i < count; ++i) {
+                const T left = buffer[offset + i];
+                expected[i] = multiply ? ReferenceMultiply(left, right[i]) : ReferenceAdd(left, right[i]);
+            }
+            const T guard = buffer[offset + count];
+            // In place, as destination == left.
+            kernel(buffer.data() + offset, right.data(), buffer.data() + offset, count);
+            for (size_t i = 0; i < count; ++i) {
+                if (!Same(buffer[offset + i], expected[i])) {
+                    return std::string("wrong element ") + std::to_string(i);
+                }
+            }
+            return Same(buffer[offset + count], guard) ? std::string() : std::string("wrote past the end");
+        }));
+    }
+
+    report("Dot", AtEveryLength<T>(generator, 0, [&](std::vector<T>& buffer, size_t offset, size_t count) {
+        const std::vector<T> right = generator.Values<T>(count);
+        const T* left = buffer.data() + offset;
+        return Same(kernels.dot(left, right.data(), count), ReferenceDot(left, right.data(), count))
+                   ? std::string()
+                   : std::string("wrong dot product");
+    }));
+
+    report("Equal", AtEveryLength<T>(generator, 0, [&](std::vector<T>& buffer, size_t offset, size_t count) {
+        std::vector<T> copy(buffer.begin() + offset, buffer.begin() + offset + count);
+        const T* elements = buffer.data() + offset;
+        if (!kernels.equal(elements, copy.data(), count)) {
+            return std::string("equal arrays differ");
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const T saved = copy[i];
+            copy[i] = ReferenceAdd(copy[i], T(1));
+            const bool equal = kernels.equal(elements, copy.data(), count);
+            copy[i] = saved;
+            if (equal) {
+                return std::string("missed a difference at element ") + std::to_string(i);
+            }
+        }
+        return std::string();
+    }));
+}
+
+// Bool arrays run the uint8 kernels over 0 and 1.
+void CheckBoolKernels(const std::string& table, const ArrayKernelSet<uint8_t>& kernels) {
+    std::string failure;
+    for (size_t count = 1; count <= kMaxLength && failure.empty(); ++count) {
+        std::vector<uint8_t> flags(count, 0);
+        if (kernels.indexOf(flags.data(), count, 1) != -1 || kernels.sum(flags.data(), count) != 0
+            || kernels.max(flags.data(), count) != 0) {
+            failure = "all false";
+        }
+        flags[count - 1] = 1;
+        if (kernels.indexOf(flags.data(), count, 1) != static_cast<int64_t>(count - 1)
+            || kernels.max(flags.data(), count) != 1 || kernels.min(flags.data(), count) != (count == 1 ? 1 : 0)) {
+            failure = "last true";
+        }
+        kernels.fill(flags.data(), count, 1);
+        if (kernels.sum(flags.data(), count) != static_cast<int64_t>(count)) {
+            failure = "all true";
+        }
+        if (!failure.empty()) {
+            failure += " at length " + std::to_string(count);
+        }
+    }
+    Check(failure.empty(), table + " bool kernels" + (failure.empty() ? "" : ": " + failure));
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== Array Kernels Test ===" << std::endl;
+
+    const std::vector<const ArrayKernelTable*> tables = GetAllArrayKernels();
+    Check(!tables.empty() && tables.front() == &GetArrayKernels(), "GetArrayKernels picks the first table");
+    for (const ArrayKernelTable* table : tables) {
+        std::cout << "--- " << table->instructionSet << " ---" << std::endl;
+        CheckKernelSet<int32_t>(table->instructionSet, "int32", table->int32);
+        CheckKernelSet<int64_t>(table->instructionSet, "int64", table->int64);
+        CheckKernelSet<float>(table->instructionSet, "float32", table->float32);
+        CheckKernelSet<double>(table->instructionSet, "float64", table->float64);
+        CheckKernelSet<uint8_t>(table->instructionSet, "uint8", table->uint8);
+        CheckBoolKernels(table->instructionSet, table->uint8);
+    }
+
+    return TestHarness::Finish("Array Kernels");
+}
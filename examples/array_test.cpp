@@ -0,0 +1,170 @@
+#include "objectir_runtime.hpp"
+#include "ir_text_parser.hpp"
+#include "test_harness.hpp"
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// Unboxed arrays: how SetElement, stelem and System.Array.Fill convert a
+// value to the element type (floating-point values truncate and must fit,
+// integers wrap, bool arrays store nonzero as true), which values arrays of
+// primitives and arrays of objects accept, and Array.Copy between them.
+
+const std::string IR_CODE = R"(
+module ArrayTest version 1.0.0
+
+class Node {
+    field value: int32
+}
+
+class Main {
+    // Stores x into a new int32 array through stelem and loads it back.
+    static method StoreInt(x: float64) -> int32 {
+        ldc.i4 1
+        newarr int32
+        dup
+        ldc.i4 0
+        ldarg x
+        stelem
+        ldc.i4 0
+        ldelem
+        ret
+    }
+}
+)";
+
+namespace {
+
+bool Throws(const std::function<void()>& action, const std::string& fragment = "") {
+    try {
+        action();
+    } catch (const std::exception& e) {
+        return std::string(e.what()).find(fragment) != std::string::npos;
+    }
+    return false;
+}
+
+} // namespace
+
+int main() {
+    try {
+        std::cout << "=== Array Test ===" << std::endl;
+
+        auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+        auto main = vm->GetClass("Main");
+        auto arrayClass = vm->GetClass("System.Array");
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+
+        // Floating-point values truncate toward zero into integer arrays.
+        auto ints = vm->CreateArray(TypeReference::Int32(), 4);
+        ints->SetElement(0, Value(3.9));
+        ints->SetElement(1, Value(-3.9));
+        ints->SetElement(2, Value(2147483647.5));
+        ints->SetElement(3, Value(-2.5f));
+        const int32_t* intElements = ints->GetElements<int32_t>();
+        Check(intElements[0] == 3 && intElements[1] == -3 && intElements[2] == 2147483647 && intElements[3] == -2,
+              "float64 and float32 values truncate toward zero in an int32 array");
+        Check(Throws([&] { ints->SetElement(0, Value(2147483648.0)); }, "out of range")
+                  && Throws([&] { ints->SetElement(0, Value(-2147483649.0)); }, "out of range")
+                  && Throws([&] { ints->SetElement(0, Value(nan)); }, "out of range")
+                  && Throws([&] { ints->SetElement(0, Value(std::numeric_limits<float>::infinity())); }, "out of range"),
+              "values that do not fit an int32 element throw");
+        Check(intElements[0] == 3, "a rejected store leaves the element alone");
+
+        auto longs = vm->CreateArray(TypeReference::Int64(), 1);
+        longs->SetElement(0, Value(-9.2e18));
+        Check(longs->GetElement(0).AsInt64() == static_cast<int64_t>(-9.2e18)
+                  && Throws([&] { longs->SetElement(0, Value(9.3e18)); }, "out of range"),
+              "int64 elements take values up to 2^63, exclusive");
+
+        auto bytes = vm->CreateArray(TypeReference::UInt8(), 3);
+        bytes->SetElement(0, Value(255.9));
+        bytes->SetElement(1, Value(-0.5));
+        bytes->SetElement(2, Value(int32_t(300)));
+        const uint8_t* byteElements = bytes->GetElements<uint8_t>();
+        Check(byteElements[0] == 255 && byteElements[1] == 0 && byteElements[2] == 44,
+              "uint8 elements truncate floating-point values and wrap integers");
+        Check(Throws([&] { bytes->SetElement(0, Value(-1.0)); }) && Throws([&] { bytes->SetElement(0, Value(256.0)); }),
+              "values that do not fit a uint8 element throw");
+
+        // stelem and Array.Fill convert the same way.
+        Check(vm->InvokeStaticMethod(main, "StoreInt", {Value(7.75)}).AsInt32() == 7, "stelem truncates into an int32 array");
+        Check(Throws([&] { vm->InvokeStaticMethod(main, "StoreInt", {Value(nan)}); }, "out of range"),
+              "stelem of NaN into an int32 array throws");
+        Check(Throws([&] { vm->InvokeStaticMethod(arrayClass, "Fill", {Value(ints), Value(1e10)}); }, "out of range")
+                  && intElements[0] == 3 && intElements[1] == -3,
+              "Array.Fill with a value out of range throws and stores nothing");
+        vm->InvokeStaticMethod(arrayClass, "Fill", {Value(ints), Value(-6.5)});
+        Check(intElements[0] == -6 && intElements[3] == -6, "Array.Fill truncates its value once for every element");
+
+        // Bool arrays store any nonzero number as true.
+        auto flags = vm->CreateArray(TypeReference::Bool(), 4);
+        flags->SetElement(0, Value(int32_t(2)));
+        flags->SetElement(1, Value(0.0));
+        flags->SetElement(2, Value(true));
+        flags->SetElement(3, Value(int64_t(0)));
+        const bool* flagElements = flags->GetElements<bool>();
+        Check(flags->IsUnboxed() && flagElements[0] && !flagElements[1] && flagElements[2] && !flagElements[3],
+              "bool elements are true for nonzero values");
+        Check(flags->GetElement(0).IsBool() && flags->GetElement(0).AsBool(), "bool elements load as bool");
+        vm->InvokeStaticMethod(arrayClass, "Fill", {Value(flags), Value(false)});
+        Check(!flagElements[0] && !flagElements[2], "Array.Fill clears a bool array");
+
+        // Arrays of objects hold any Value; arrays of primitives only numbers.
+        auto node = vm->GetClass("Node")->CreateInstance();
+        auto objects = vm->CreateArray(TypeReference::Object(vm->GetClass("Node")), 3);
+        objects->SetElement(0, Value(node));
+        objects->SetElement(1, Value(int32_t(5)));
+        objects->SetElement(2, Value(std::string("text")));
+        Check(!objects->IsUnboxed() && objects->GetElement(0).AsObject() == node
+                  && objects->GetElement(1).AsInt32() == 5 && objects->GetElement(2).IsString(),
+              "an object array keeps objects, numbers and strings as they are");
+        Check(Throws([&] { ints->SetElement(0, Value(node)); }, "Cannot store an object")
+                  && Throws([&] { ints->SetElement(0, Value(std::string("7"))); }, "Cannot store a string")
+                  && Throws([&] { flags->SetElement(0, Value()); }, "Cannot store null"),
+              "primitive arrays reject objects, strings and null");
+        Check(Throws([&] { (void)ints->GetElements<Value>(); }) && Throws([&] { (void)objects->GetElements<int32_t>(); })
+                  && Throws([&] { (void)ints->GetElements<int64_t>(); }),
+              "GetElements only hands out the array's own storage type");
+
+        // Array.Copy converts between element types, but checks every
+        // element before it writes any.
+        auto doubles = vm->CreateArray(TypeReference::Float64(), 3);
+        doubles->SetElement(0, Value(1.5));
+        doubles->SetElement(1, Value(-2.5));
+        doubles->SetElement(2, Value(nan));
+        auto copied = vm->CreateArray(TypeReference::Int32(), 3);
+        vm->InvokeStaticMethod(arrayClass, "Copy", {Value(doubles), Value(copied), Value(int32_t(2))});
+        const int32_t* copiedElements = copied->GetElements<int32_t>();
+        Check(copiedElements[0] == 1 && copiedElements[1] == -2 && copiedElements[2] == 0,
+              "Array.Copy converts the first `length` elements to the destination's type");
+        copied->SetElement(0, Value(int32_t(9)));
+        Check(Throws([&] { vm->InvokeStaticMethod(arrayClass, "Copy", {Value(doubles), Value(copied), Value(int32_t(3))}); },
+                     "out of range")
+                  && copiedElements[0] == 9 && copiedElements[1] == -2,
+              "Array.Copy of an element the destination cannot hold writes nothing");
+        Check(Throws([&] { vm->InvokeStaticMethod(arrayClass, "Copy", {Value(objects), Value(copied), Value(int32_t(2))}); },
+                     "Cannot store an object")
+                  && copiedElements[0] == 9,
+              "Array.Copy from an object array checks the elements first too");
+        vm->InvokeStaticMethod(arrayClass, "Copy", {Value(copied), Value(objects), Value(int32_t(1))});
+        Check(objects->GetElement(0).IsInt32() && objects->GetElement(0).AsInt32() == 9
+                  && objects->GetElement(1).AsInt32() == 5,
+              "Array.Copy boxes primitive elements into an object array");
+        Check(Throws([&] { vm->InvokeStaticMethod(arrayClass, "Copy", {Value(copied), Value(bytes), Value(int32_t(4))}); },
+                     "out of range"),
+              "Array.Copy rejects a length past either array");
+        Check(Throws([&] { vm->InvokeStaticMethod(arrayClass, "Copy", {Value(copied), Value(copied)}); }, "argument 3"),
+              "Array.Copy needs its length argument");
+
+        return TestHarness::Finish("Array");
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,194 @@
+#include "objectir_runtime.hpp"
+#include "ir_text_parser.hpp"
+#include "test_harness.hpp"
+#include <iostream>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// Virtual and interface dispatch through the tables classes build at
+// finalization: overrides replace their base slot at every depth, inherited
+// methods keep it, interface calls go through each implementor's itable, and
+// interfaces are implemented through base classes and base interfaces.
+
+const std::string IR_CODE = R"(
+module DispatchTest version 1.0.0
+
+interface INamed {
+    method Name() -> int32
+}
+
+interface ITagged : INamed {
+    method Tag() -> int32
+}
+
+class Animal {
+    method Speak() -> int32 {
+        ldc.i4 1
+        ret
+    }
+
+    method Legs() -> int32 {
+        ldc.i4 4
+        ret
+    }
+
+    method Describe() -> int32 {
+        ldarg this
+        callvirt Animal.Speak() -> int32
+        ldc.i4 10
+        mul
+        ldarg this
+        callvirt Animal.Legs() -> int32
+        add
+        ret
+    }
+}
+
+class Dog : Animal {
+    method Speak() -> int32 {
+        ldc.i4 2
+        ret
+    }
+}
+
+class Puppy : Dog {
+    method Speak() -> int32 {
+        ldc.i4 3
+        ret
+    }
+}
+
+class Bird : Animal, ITagged {
+    method Legs() -> int32 {
+        ldc.i4 2
+        ret
+    }
+
+    method Name() -> int32 {
+        ldc.i4 100
+        ret
+    }
+
+    method Tag() -> int32 {
+        ldc.i4 101
+        ret
+    }
+}
+
+class Parrot : Bird {
+    method Name() -> int32 {
+        ldc.i4 200
+        ret
+    }
+}
+
+class Robot : INamed {
+    method Name() -> int32 {
+        ldc.i4 300
+        ret
+    }
+}
+
+class Printer {
+    method Show(x: int32) -> int32 {
+        ldc.i4 1
+        ret
+    }
+
+    method Show(x: string) -> int32 {
+        ldc.i4 2
+        ret
+    }
+}
+
+class Main {
+    static method Speak(a: Animal) -> int32 {
+        ldarg a
+        callvirt Animal.Speak() -> int32
+        ret
+    }
+
+    static method Describe(a: Animal) -> int32 {
+        ldarg a
+        callvirt Animal.Describe() -> int32
+        ret
+    }
+
+    static method Name(n: INamed) -> int32 {
+        ldarg n
+        callvirt INamed.Name() -> int32
+        ret
+    }
+
+    static method Tag(t: ITagged) -> int32 {
+        ldarg t
+        callvirt ITagged.Tag() -> int32
+        ret
+    }
+
+    static method ShowBoth(p: Printer) -> int32 {
+        ldarg p
+        ldc.i4 5
+        callvirt Printer.Show(int32) -> int32
+        ldc.i4 10
+        mul
+        ldarg p
+        ldstr "five"
+        callvirt Printer.Show(string) -> int32
+        add
+        ret
+    }
+}
+)";
+
+int main() {
+    try {
+        std::cout << "=== Dispatch Table Test ===" << std::endl;
+
+        auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+        auto main = vm->GetClass("Main");
+        auto make = [&](const std::string& name) { return Value(vm->GetClass(name)->CreateInstance()); };
+        auto call = [&](const std::string& method, const Value& receiver) {
+            return vm->InvokeStaticMethod(main, method, {receiver}).AsInt32();
+        };
+
+        const Value animal = make("Animal");
+        const Value dog = make("Dog");
+        const Value puppy = make("Puppy");
+        const Value bird = make("Bird");
+        const Value parrot = make("Parrot");
+        const Value robot = make("Robot");
+
+        bool dispatched = true;
+        for (int round = 0; round < 2; ++round) {
+            dispatched = dispatched && call("Speak", animal) == 1 && call("Speak", dog) == 2
+                         && call("Speak", puppy) == 3 && call("Speak", bird) == 1 && call("Speak", parrot) == 1;
+        }
+        Check(dispatched, "callvirt runs the override at every depth and inherits the base method");
+        Check(call("Describe", puppy) == 34 && call("Describe", parrot) == 12,
+              "a base method's own callvirts dispatch on the receiver");
+
+        Check(call("Name", bird) == 100 && call("Name", parrot) == 200 && call("Name", robot) == 300,
+              "an interface call dispatches through each implementor");
+        Check(call("Tag", bird) == 101 && call("Tag", parrot) == 101,
+              "an interface method is found on the implementor and inherited by its subclasses");
+
+        auto named = vm->GetClass("INamed");
+        auto tagged = vm->GetClass("ITagged");
+        Check(vm->GetClass("Parrot")->ImplementsInterface(tagged) && vm->GetClass("Parrot")->ImplementsInterface(named),
+              "interfaces are implemented through base classes and base interfaces");
+        Check(!vm->GetClass("Dog")->ImplementsInterface(named) && !vm->GetClass("Robot")->ImplementsInterface(tagged),
+              "classes that implement neither interface do not report them");
+        Check(puppy.AsObject()->IsInstanceOf(vm->GetClass("Animal")) && !dog.AsObject()->IsInstanceOf(vm->GetClass("Puppy")),
+              "subclass checks follow the hierarchy both ways");
+
+        Check(call("ShowBoth", make("Printer")) == 12, "overloads resolve by parameter types");
+
+        return TestHarness::Finish("Dispatch Table");
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,317 @@
+#include "objectir_runtime.hpp"
+#include "ir_text_parser.hpp"
+#include "test_harness.hpp"
+#include <iostream>
+#include <sstream>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// Exception handling through the handler tables: typed catch selection,
+// nested try/catch/finally, rethrow from a catch block, leave and ret out of
+// nested finally blocks, runtime errors caught as strings, and exceptions
+// reaching the host after the method's finally blocks ran.
+
+const std::string IR_CODE = R"(
+module ExceptionTest version 1.0.0
+
+class Boom {
+    field code: int32
+}
+
+class Other {
+}
+
+class Main {
+    // Throws a Boom from n frames down.
+    static method Thrower(n: int32) -> int32 {
+        local b: Boom
+        ldarg n
+        ldc.i4 0
+        bne go
+        newobj Boom
+        stloc b
+        ldloc b
+        ldc.i4 42
+        stfld Boom.code
+        ldloc b
+        throw
+    go:
+        ldarg n
+        ldc.i4 1
+        sub
+        call Main.Thrower(int32) -> int32
+        ldc.i4 1
+        add
+        ret
+    }
+
+    static method DivideByZero(a: int32) -> int32 {
+        ldarg a
+        ldc.i4 0
+        div
+        ret
+    }
+
+    static method SelectHandler() -> void {
+        local e: Boom
+        local o: Other
+        try {
+            ldc.i4 5
+            call Main.Thrower(int32) -> int32
+            call System.Console.WriteLine(int32) -> void
+        } catch (Other o) {
+            ldstr "wrong handler"
+            call System.Console.WriteLine(string) -> void
+        } catch (Boom e) {
+            ldloc e
+            ldfld Boom.code
+            call System.Console.WriteLine(int32) -> void
+        } finally {
+            ldstr "finally"
+            call System.Console.WriteLine(string) -> void
+        }
+        ret
+    }
+
+    static method Rethrow() -> void {
+        local e: Boom
+        local outer: Boom
+        try {
+            try {
+                ldc.i4 2
+                call Main.Thrower(int32) -> int32
+                pop
+            } catch (Boom e) {
+                ldstr "inner catch"
+                call System.Console.WriteLine(string) -> void
+                ldloc e
+                ldc.i4 7
+                stfld Boom.code
+                ldloc e
+                throw
+            } finally {
+                ldstr "inner finally"
+                call System.Console.WriteLine(string) -> void
+            }
+            ldstr "not reached"
+            call System.Console.WriteLine(string) -> void
+        } catch (Boom outer) {
+            ldstr "outer catch"
+            call System.Console.WriteLine(string) -> void
+            ldloc outer
+            ldfld Boom.code
+            call System.Console.WriteLine(int32) -> void
+        } finally {
+            ldstr "outer finally"
+            call System.Console.WriteLine(string) -> void
+        }
+        ret
+    }
+
+    // Leaves two nested try blocks from inside a loop; both finally blocks
+    // run, innermost first, on each of the three exits.
+    static method LeaveNested() -> int32 {
+        local i: int32
+        local total: int32
+        ldc.i4 0
+        stloc total
+        ldc.i4 0
+        stloc i
+    loop:
+        ldloc i
+        ldc.i4 3
+        bge done
+        try {
+            try {
+                ldloc total
+                ldc.i4 1
+                add
+                stloc total
+                leave next
+            } finally {
+                ldloc total
+                ldc.i4 10
+                mul
+                stloc total
+            }
+            ldstr "not reached"
+            call System.Console.WriteLine(string) -> void
+        } finally {
+            ldloc total
+            ldc.i4 2
+            add
+            stloc total
+        }
+    next:
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br loop
+    done:
+        ldloc total
+        ret
+    }
+
+    // Returns from inside two try blocks: both finally blocks run, innermost
+    // first, and the value returned is the one the ret found on the stack.
+    static method ReturnThroughFinally() -> int32 {
+        local x: int32
+        ldc.i4 5
+        stloc x
+        try {
+            try {
+                ldloc x
+                ret
+            } finally {
+                ldstr "inner finally"
+                call System.Console.WriteLine(string) -> void
+                ldc.i4 99
+                stloc x
+            }
+        } finally {
+            ldloc x
+            call System.Console.WriteLine(int32) -> void
+        }
+        ldc.i4 -1
+        ret
+    }
+
+    // Returns from a catch block inside a try block with a finally block.
+    static method ReturnFromCatch() -> int32 {
+        local e: Boom
+        try {
+            try {
+                ldc.i4 1
+                call Main.Thrower(int32) -> int32
+                ret
+            } catch (Boom e) {
+                ldloc e
+                ldfld Boom.code
+                ret
+            }
+        } finally {
+            ldstr "finally after catch"
+            call System.Console.WriteLine(string) -> void
+        }
+        ldc.i4 -1
+        ret
+    }
+
+    static method RuntimeError() -> void {
+        local s: string
+        try {
+            ldc.i4 1
+            call Main.DivideByZero(int32) -> int32
+            call System.Console.WriteLine(int32) -> void
+        } catch (string s) {
+            ldloc s
+            call System.Console.WriteLine(string) -> void
+        }
+        ret
+    }
+
+    // A thrown value caught in the same loop iteration, every 7th time.
+    static method ThrowInLoop() -> int32 {
+        local i: int32
+        local total: int32
+        local v: int32
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc total
+    loop:
+        ldloc i
+        ldc.i4 1000
+        bge done
+        try {
+            ldloc i
+            ldc.i4 7
+            rem
+            ldc.i4 0
+            bne skip
+            ldloc i
+            throw
+        skip:
+            ldloc total
+            ldc.i4 1
+            add
+            stloc total
+        } catch (int32 v) {
+            ldloc total
+            ldc.i4 100
+            add
+            stloc total
+        }
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br loop
+    done:
+        ldloc total
+        ret
+    }
+
+    static method Uncaught() -> void {
+        try {
+            ldc.i4 1
+            call Main.Thrower(int32) -> int32
+            pop
+        } finally {
+            ldstr "cleanup ran"
+            call System.Console.WriteLine(string) -> void
+        }
+        ret
+    }
+}
+)";
+
+int main() {
+    try {
+        std::cout << "=== Exception Handling Test ===" << std::endl;
+
+        auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+        std::ostringstream output;
+        vm->SetOutputFunction([&](const std::string& text) { output << text; });
+        auto main = vm->GetClass("Main");
+        auto run = [&](const std::string& method) {
+            output.str("");
+            vm->InvokeStaticMethod(main, method, {});
+            return output.str();
+        };
+
+        Check(run("SelectHandler") == "42\nfinally\n", "the matching catch handler runs, then finally");
+        Check(run("Rethrow") == "inner catch\ninner finally\nouter catch\n7\nouter finally\n",
+              "a rethrown exception runs the inner finally and reaches the outer catch unchanged");
+        Check(vm->InvokeStaticMethod(main, "LeaveNested", {}).AsInt32() == 1332,
+              "leave runs both finally blocks, innermost first");
+        output.str("");
+        const Value returned = vm->InvokeStaticMethod(main, "ReturnThroughFinally", {});
+        Check(returned.IsInt32() && returned.AsInt32() == 5 && output.str() == "inner finally\n99\n",
+              "ret in a try block runs the finally blocks and returns the value it found");
+        output.str("");
+        const Value caught = vm->InvokeStaticMethod(main, "ReturnFromCatch", {});
+        Check(caught.IsInt32() && caught.AsInt32() == 42 && output.str() == "finally after catch\n",
+              "ret in a catch block runs the enclosing finally block");
+        Check(run("RuntimeError").find("Division by zero") != std::string::npos, "a runtime error is caught as a string");
+        Check(vm->InvokeStaticMethod(main, "ThrowInLoop", {}).AsInt32() == 857 + 143 * 100,
+              "exceptions thrown and caught in a loop");
+
+        output.str("");
+        bool reachedHost = false;
+        try {
+            vm->InvokeStaticMethod(main, "Uncaught", {});
+        } catch (const std::exception&) {
+            reachedHost = true;
+        }
+        Check(reachedHost && output.str() == "cleanup ran\n", "an uncaught exception reaches the host after finally");
+
+        return TestHarness::Finish("Exception Handling");
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
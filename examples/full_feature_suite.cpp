@@ -1,7 +1,11 @@
 #include "../include/objectir_runtime.hpp"
 #include "../include/ir_text_parser.hpp"
+#include "../include/bytecode.hpp"
+#include "../include/jit_compiler.hpp"
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include <vector>
 
 using namespace ObjectIR;
 
@@ -13,6 +17,7 @@ using namespace ObjectIR;
 // - Field access and manipulation
 // - Type reflection and introspection
 // - Module serialization/deserialization
+// - Interpreter dispatch counts with and without superinstructions
 
 const std::string IR_CODE = R"(
 module FullFeatureSuite version 1.0.0
@@ -529,6 +534,36 @@ class MathTest {
 }
 )";
 
+// Dispatches of one run of each test on a fresh VM, prepared with or without
+// superinstructions. Only bodies that tiered up are fused, so each test first
+// runs often enough to tier up. The JIT is off so every instruction is
+// interpreted.
+std::vector<uint64_t> CountDispatches(const std::vector<std::string>& testNames, bool superinstructions)
+{
+    BytecodeCompiler::SetSuperinstructionsEnabled(superinstructions);
+    JitCompiler::SetEnabled(false);
+    auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+    auto testInstance = vm->CreateObject(vm->GetClass("MathTest"));
+    // What MathTest's constructor does; CreateObject does not run it.
+    testInstance->SetField("testsPassed", Value(int32_t(0)));
+    testInstance->SetField("testsFailed", Value(int32_t(0)));
+
+    std::vector<uint64_t> counts;
+    for (const auto& testName : testNames) {
+        for (uint32_t i = 0; i < TieredExecution::GetInvocationThreshold(); ++i) {
+            (void)vm->InvokeMethod(testInstance, testName, {});
+        }
+        DispatchProfile::Reset();
+        DispatchProfile::SetEnabled(true);
+        (void)vm->InvokeMethod(testInstance, testName, {});
+        DispatchProfile::SetEnabled(false);
+        counts.push_back(DispatchProfile::GetDispatchCount());
+    }
+    BytecodeCompiler::SetSuperinstructionsEnabled(true);
+    JitCompiler::SetEnabled(true);
+    return counts;
+}
+
 int main()
 {
     std::cout << "=== ObjectIR Full Feature Suite Test ===\n\n";
@@ -582,6 +617,26 @@ int main()
 
         std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n\n";
 
+        // Superinstructions fuse common opcode pairs; count what that saves
+        // on the tests above once they are hot.
+        std::cout << "Interpreter Dispatches:\n";
+        std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
+        const auto unfused = CountDispatches(testNames, false);
+        const auto fused = CountDispatches(testNames, true);
+        uint64_t unfusedTotal = 0;
+        uint64_t fusedTotal = 0;
+        for (size_t i = 0; i < testNames.size(); ++i) {
+            std::cout << "  " << std::left << std::setw(26) << testNames[i] << std::right
+                      << std::setw(5) << unfused[i] << " -> " << std::setw(5) << fused[i] << "\n";
+            unfusedTotal += unfused[i];
+            fusedTotal += fused[i];
+        }
+        const double reduction = unfusedTotal ? 100.0 * static_cast<double>(unfusedTotal - fusedTotal) / static_cast<double>(unfusedTotal) : 0.0;
+        std::cout << "  " << std::left << std::setw(26) << "total" << std::right
+                  << std::setw(5) << unfusedTotal << " -> " << std::setw(5) << fusedTotal
+                  << " (" << std::fixed << std::setprecision(1) << reduction << "% fewer)\n";
+        std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n\n";
+
         // Get test results
         auto passedCount = vm->InvokeMethod(testInstance, "GetPassedCount", {});
         auto failedCount = vm->InvokeMethod(testInstance, "GetFailedCount", {});
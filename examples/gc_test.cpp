@@ -0,0 +1,179 @@
+#include "objectir_runtime.hpp"
+#include "ir_text_parser.hpp"
+#include "test_harness.hpp"
+#include <future>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// GarbageCollector::Collect frees cycles nothing else references, while
+// objects held by the host (ObjectRef or Value) and everything they reach
+// keep their references. It waits for threads inside a MutatorScope.
+
+const std::string IR_CODE = R"(
+module GcTest version 1.0.0
+
+class Node {
+    field next: Node
+    field value: int32
+}
+
+class Main {
+    // Builds n two-node cycles and returns the last node of the last one.
+    static method Cycles(n: int32) -> Node {
+        local i: int32
+        local a: Node
+        local b: Node
+        ldc.i4 0
+        stloc i
+    loop:
+        ldloc i
+        ldarg n
+        bge done
+        newobj Node
+        stloc a
+        newobj Node
+        stloc b
+        ldloc a
+        ldloc b
+        stfld Node.next
+        ldloc b
+        ldloc a
+        stfld Node.next
+        ldloc b
+        ldloc i
+        stfld Node.value
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br loop
+    done:
+        ldloc b
+        ret
+    }
+}
+)";
+
+int main() {
+    try {
+        std::cout << "=== Garbage Collector Test ===" << std::endl;
+
+        GarbageCollector::SetEnabled(true);
+        auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+        auto node = vm->GetClass("Node");
+
+        // An unreachable two-node cycle and a cycle through an array.
+        std::weak_ptr<Object> cycleA, cycleB, arrayNode, array;
+        {
+            auto a = node->CreateInstance();
+            auto b = node->CreateInstance();
+            a->SetField("next", Value(b));
+            b->SetField("next", Value(a));
+            cycleA = a;
+            cycleB = b;
+
+            auto elements = vm->CreateArray(TypeReference::Object(), 1);
+            auto n = node->CreateInstance();
+            elements->SetElement(0, Value(n));
+            n->SetField("next", Value(std::static_pointer_cast<Object>(elements)));
+            arrayNode = n;
+            array = elements;
+        }
+
+        // A cycle the host holds through an ObjectRef, and one it holds only
+        // through a Value. Each has a child reachable only from the cycle.
+        ObjectRef hostRef = node->CreateInstance();
+        std::weak_ptr<Object> hostChild;
+        {
+            auto partner = node->CreateInstance();
+            auto child = node->CreateInstance();
+            child->SetField("value", Value(int32_t(11)));
+            hostRef->SetField("next", Value(partner));
+            partner->SetField("next", Value(hostRef));
+            partner->SetField("value", Value(child));
+            hostChild = child;
+        }
+        Value hostValue;
+        std::weak_ptr<Object> valueHeld, valueChild;
+        {
+            auto a = node->CreateInstance();
+            auto b = node->CreateInstance();
+            auto child = node->CreateInstance();
+            child->SetField("value", Value(int32_t(22)));
+            a->SetField("next", Value(b));
+            b->SetField("next", Value(a));
+            b->SetField("value", Value(child));
+            hostValue = Value(a);
+            valueHeld = b;
+            valueChild = child;
+        }
+
+        // The result of a call is held by the host too; the cycles the call
+        // built before it are garbage.
+        Value last = vm->InvokeStaticMethod(vm->GetClass("Main"), "Cycles", {Value(int32_t(1000))});
+        const uint64_t freedBefore = GarbageCollector::GetStatistics().objectsFreed;
+
+        const size_t cleared = GarbageCollector::Collect();
+        const uint64_t freed = GarbageCollector::GetStatistics().objectsFreed - freedBefore;
+
+        Check(cycleA.expired() && cycleB.expired(), "an unreachable cycle is freed");
+        Check(arrayNode.expired() && array.expired(), "a cycle through an array is freed");
+        Check(cleared >= 2 * 999 + 4 && freed == cleared, "the cycles the IR method built are freed");
+
+        Check(!hostChild.expired() && hostRef->GetField("next").AsObject()->GetField("next").AsObject() == hostRef,
+              "a cycle held through an ObjectRef keeps its references");
+        Check(!hostChild.expired() && hostChild.lock()->GetField("value").AsInt32() == 11,
+              "objects reachable from a host ObjectRef survive");
+        Check(!valueHeld.expired() && !valueChild.expired() && valueChild.lock()->GetField("value").AsInt32() == 22,
+              "objects reachable from a host Value survive");
+        auto lastNode = last.AsObject();
+        Check(lastNode && lastNode->GetField("value").AsInt32() == 999
+                  && lastNode->GetField("next").AsObject()->GetField("next").AsObject() == lastNode,
+              "a call's result keeps its cycle");
+
+        // Once the host lets go, the next collection frees them too.
+        hostRef.reset();
+        hostValue = Value();
+        last = Value();
+        lastNode.reset();
+        GarbageCollector::Collect();
+        Check(hostChild.expired() && valueHeld.expired() && valueChild.expired(),
+              "dropped host references leave the cycles to the next collection");
+
+        // No collection starts while another thread may be using objects;
+        // the first one after it is done frees what it skipped.
+        std::weak_ptr<Object> skipped;
+        {
+            auto a = node->CreateInstance();
+            auto b = node->CreateInstance();
+            a->SetField("next", Value(b));
+            b->SetField("next", Value(a));
+            skipped = a;
+        }
+        std::promise<void> entered;
+        std::promise<void> release;
+        std::thread worker([&] {
+            GarbageCollector::MutatorScope scope;
+            entered.set_value();
+            release.get_future().wait();
+        });
+        entered.get_future().wait();
+        const size_t clearedWhileBusy = GarbageCollector::Collect();
+        const bool keptWhileBusy = !skipped.expired();
+        release.set_value();
+        worker.join();
+        Check(clearedWhileBusy == 0 && keptWhileBusy, "no collection runs while another thread holds a MutatorScope");
+        GarbageCollector::Collect();
+        Check(skipped.expired(), "the next collection frees what the skipped one would have");
+
+        return TestHarness::Finish("Garbage Collector");
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,195 @@
+#include "objectir_runtime.hpp"
+#include "ir_text_parser.hpp"
+#include "objectir_plugin_api.h"
+#include "test_harness.hpp"
+#include <iostream>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// Call sites cache the method they resolved to, keyed on the receiver class
+// for callvirt, and field sites cache the receiver class and slot. Each site
+// here first warms its cache, then sees receivers or method bodies the cached
+// entry does not cover: more receiver classes than a polymorphic cache holds,
+// a class whose field sits at another slot, and bodies replaced through the
+// plugin API.
+
+const std::string IR_CODE = R"(
+module InlineCacheTest version 1.0.0
+
+class Shape {
+    field side: int32
+
+    method Area() -> int32 {
+        ldarg this
+        ldfld Shape.side
+        ldarg this
+        ldfld Shape.side
+        mul
+        ret
+    }
+}
+
+class Square {
+    method Area() -> int32 {
+        ldc.i4 2
+        ret
+    }
+}
+
+class Triangle {
+    method Area() -> int32 {
+        ldc.i4 3
+        ret
+    }
+}
+
+class Pentagon {
+    method Area() -> int32 {
+        ldc.i4 5
+        ret
+    }
+}
+
+class Hexagon {
+    method Area() -> int32 {
+        ldc.i4 6
+        ret
+    }
+}
+
+class Octagon {
+    method Area() -> int32 {
+        ldc.i4 8
+        ret
+    }
+}
+
+class Padded {
+    field pad: int32
+    field label: string
+    field side: int32
+}
+
+class Main {
+    static method Twice(x: int32) -> int32 {
+        ldarg x
+        ldc.i4 2
+        mul
+        ret
+    }
+
+    // Sums Twice(i) for i below n through one call site.
+    static method SumTwice(n: int32) -> int32 {
+        local i: int32
+        local sum: int32
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc sum
+    loop:
+        ldloc i
+        ldarg n
+        bge done
+        ldloc sum
+        ldloc i
+        call Main.Twice(int32) -> int32
+        add
+        stloc sum
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br loop
+    done:
+        ldloc sum
+        ret
+    }
+
+    static method AreaOf(s: Shape) -> int32 {
+        ldarg s
+        callvirt Shape.Area() -> int32
+        ret
+    }
+
+    static method SideOf(s: Shape) -> int32 {
+        ldarg s
+        ldfld Shape.side
+        ret
+    }
+
+    static method SetSide(s: Shape) -> void {
+        ldarg s
+        ldc.i4 9
+        stfld Shape.side
+        ret
+    }
+}
+)";
+
+int main() {
+    try {
+        std::cout << "=== Inline Cache Test ===" << std::endl;
+
+        auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+        auto* pluginVm = reinterpret_cast<ObjectIR_VirtualMachine*>(vm.get());
+        auto main = vm->GetClass("Main");
+        auto call = [&](const std::string& method, const std::vector<Value>& args) {
+            return vm->InvokeStaticMethod(main, method, args).AsInt32();
+        };
+
+        // A static call site, before and after its callee's body is replaced.
+        Check(call("SumTwice", {Value(int32_t(10))}) == 90, "a static call site calls its callee");
+        Check(call("SumTwice", {Value(int32_t(10))}) == 90, "a warm static call site calls the same callee");
+        const bool replaced = ObjectIR_PluginReplaceMethodInstructionsJson(pluginVm, "Main", "Twice", R"([
+            {"opCode": "ldarg", "operand": {"argumentName": "x"}},
+            {"opCode": "ldc.i4", "operand": {"value": 3}},
+            {"opCode": "mul"},
+            {"opCode": "ret"}
+        ])");
+        Check(replaced && call("SumTwice", {Value(int32_t(10))}) == 135,
+              "a static call site runs the body a plugin replaced");
+
+        // One callvirt site with six receiver classes, more than a
+        // polymorphic cache keeps.
+        const std::vector<std::pair<std::string, int32_t>> shapes = {
+            {"Shape", 16}, {"Square", 2}, {"Triangle", 3}, {"Pentagon", 5}, {"Hexagon", 6}, {"Octagon", 8},
+        };
+        std::vector<ObjectRef> receivers;
+        for (const auto& entry : shapes) {
+            receivers.push_back(vm->GetClass(entry.first)->CreateInstance());
+        }
+        receivers[0]->SetField("side", Value(int32_t(4)));
+        for (int round = 0; round < 2; ++round) {
+            bool dispatched = true;
+            for (size_t i = 0; i < receivers.size(); ++i) {
+                dispatched = dispatched && call("AreaOf", {Value(receivers[i])}) == shapes[i].second;
+            }
+            Check(dispatched, "a callvirt site dispatches on each receiver's class (round " + std::to_string(round + 1) + ")");
+        }
+        const bool overridden = ObjectIR_PluginReplaceMethodInstructionsJson(pluginVm, "Square", "Area", R"([
+            {"opCode": "ldc.i4", "operand": {"value": 4}},
+            {"opCode": "ret"}
+        ])");
+        Check(overridden && call("AreaOf", {Value(receivers[1])}) == 4 && call("AreaOf", {Value(receivers[2])}) == 3,
+              "a callvirt site runs the receiver method a plugin replaced");
+
+        // Field sites: Padded keeps `side` in another slot than Shape does.
+        auto padded = vm->GetClass("Padded")->CreateInstance();
+        padded->SetField("side", Value(int32_t(7)));
+        Check(call("SideOf", {Value(receivers[0])}) == 4 && call("SideOf", {Value(padded)}) == 7
+                  && call("SideOf", {Value(receivers[0])}) == 4,
+              "a field load site re-resolves for a class with another layout");
+        vm->InvokeStaticMethod(main, "SetSide", {Value(padded)});
+        vm->InvokeStaticMethod(main, "SetSide", {Value(receivers[0])});
+        Check(padded->GetField("side").AsInt32() == 9 && padded->GetField("pad").IsNull()
+                  && receivers[0]->GetField("side").AsInt32() == 9,
+              "a field store site writes the slot of each receiver's class");
+
+        return TestHarness::Finish("Inline Cache");
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
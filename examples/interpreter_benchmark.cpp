@@ -0,0 +1,504 @@
+#include "../include/objectir_runtime.hpp"
+#include "../include/bytecode.hpp"
+#include "../include/instruction_executor.hpp"
+#include "../include/ir_text_parser.hpp"
+#include "../include/jit_compiler.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ObjectIR;
+
+// Micro-benchmark for the interpreter: runs loop-, branch- and call-heavy
+// methods through the legacy tree walker (InstructionExecutor::ExecuteInstructions)
+// and through the prepared bytecode path used by VirtualMachine::Invoke*,
+// interpreted and with hot methods compiled by the baseline JIT.
+//
+// It also counts interpreter dispatches per workload with and without
+// superinstruction fusion. With --pairs it prints the most frequent opcode
+// pairs of the unfused code, which is what the fusion table in
+// bytecode_compiler.cpp is derived from.
+//
+// Usage: interpreter_benchmark [scale] [--pairs]   (default scale 1)
+
+const std::string IR_CODE = R"(
+module InterpreterBenchmark version 1.0.0
+
+class Bench {
+    // Tight counted loop: locals, arithmetic and a compare-and-branch.
+    static method SumLoop(n: int32) -> int32 {
+        local i: int32
+        local sum: int32
+
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc sum
+
+        loop_head:
+        ldloc i
+        ldarg n
+        bge loop_done
+
+        ldloc sum
+        ldloc i
+        add
+        ldc.i4 65521
+        rem
+        stloc sum
+
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br loop_head
+
+        loop_done:
+        ldloc sum
+        ret
+    }
+
+    // Loop with a data-dependent branch in its body (mirrors the
+    // comparison/branch tests of full_feature_suite, run many times).
+    static method CountEvens(n: int32) -> int32 {
+        local i: int32
+        local evens: int32
+
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc evens
+
+        count_head:
+        ldloc i
+        ldarg n
+        bge count_done
+
+        ldloc i
+        ldc.i4 2
+        rem
+        ldc.i4 0
+        bne count_next
+
+        ldloc evens
+        ldc.i4 1
+        add
+        stloc evens
+
+        count_next:
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br count_head
+
+        count_done:
+        ldloc evens
+        ret
+    }
+
+    // Recursive calls: dominated by call overhead.
+    static method Fib(n: int32) -> int32 {
+        ldarg n
+        ldc.i4 2
+        bge fib_recurse
+        ldarg n
+        ret
+
+        fib_recurse:
+        ldarg n
+        ldc.i4 1
+        sub
+        call Bench.Fib(int32) -> int32
+        ldarg n
+        ldc.i4 2
+        sub
+        call Bench.Fib(int32) -> int32
+        add
+        ret
+    }
+
+    // Virtual calls on an object from a loop: dominated by call dispatch.
+    static method CallLoop(n: int32) -> int32 {
+        local i: int32
+        local counter: Counter
+
+        newobj Counter
+        stloc counter
+        ldloc counter
+        ldc.i4 0
+        stfld Counter.value
+
+        ldc.i4 0
+        stloc i
+
+        call_head:
+        ldloc i
+        ldarg n
+        bge call_done
+
+        ldloc counter
+        ldloc i
+        callvirt Counter.Add(int32) -> void
+
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br call_head
+
+        call_done:
+        ldloc counter
+        callvirt Counter.Get() -> int32
+        ret
+    }
+
+    // Object allocation and field access from a loop.
+    static method AllocLoop(n: int32) -> int32 {
+        local i: int32
+        local sum: int32
+        local point: Point
+
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc sum
+
+        alloc_head:
+        ldloc i
+        ldarg n
+        bge alloc_done
+
+        newobj Point
+        stloc point
+        ldloc point
+        ldloc i
+        stfld Point.x
+        ldloc point
+        ldc.i4 3
+        stfld Point.y
+        ldloc point
+        ldloc point
+        ldfld Point.x
+        ldloc point
+        ldfld Point.y
+        add
+        stfld Point.z
+
+        ldloc sum
+        ldloc point
+        ldfld Point.z
+        add
+        ldc.i4 65521
+        rem
+        stloc sum
+
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br alloc_head
+
+        alloc_done:
+        ldloc sum
+        ret
+    }
+}
+
+class Point {
+    field x: int32
+    field y: int32
+    field z: int32
+}
+
+class Counter {
+    private field value: int32
+
+    method Add(amount: int32) -> void {
+        ldarg this
+        ldarg this
+        ldfld Counter.value
+        ldarg amount
+        add
+        ldc.i4 65521
+        rem
+        stfld Counter.value
+        ret
+    }
+
+    method Get() -> int32 {
+        ldarg this
+        ldfld Counter.value
+        ret
+    }
+}
+)";
+
+// The text IR has no structured loops, so this method is built from the JSON
+// instruction form: a While whose body runs an inner While that is left
+// through `break` on every outer iteration.
+//
+//   i = 0; sum = 0; running = true
+//   while (running) {
+//       i = i + 1; running = i < n; j = 0
+//       while (true) { j = j + 1; sum = (sum + j) % 65521; if (j >= 4) break; }
+//   }
+//   return sum
+const char* STRUCTURED_LOOP_JSON = R"([
+    {"opCode": "ldc.i4", "operand": 0}, {"opCode": "stloc", "operand": {"localName": "i"}},
+    {"opCode": "ldc.i4", "operand": 0}, {"opCode": "stloc", "operand": {"localName": "sum"}},
+    {"opCode": "ldtrue"}, {"opCode": "stloc", "operand": {"localName": "running"}},
+    {"opCode": "while", "operand": {
+        "condition": {"kind": "expression", "expression": {"opCode": "ldloc", "operand": {"localName": "running"}}},
+        "body": [
+            {"opCode": "ldloc", "operand": {"localName": "i"}}, {"opCode": "ldc.i4", "operand": 1}, {"opCode": "add"},
+            {"opCode": "stloc", "operand": {"localName": "i"}},
+            {"opCode": "ldloc", "operand": {"localName": "i"}}, {"opCode": "ldarg", "operand": {"argumentName": "n"}},
+            {"opCode": "clt"}, {"opCode": "stloc", "operand": {"localName": "running"}},
+            {"opCode": "ldc.i4", "operand": 0}, {"opCode": "stloc", "operand": {"localName": "j"}},
+            {"opCode": "while", "operand": {
+                "condition": {"kind": "expression", "expression": {"opCode": "ldtrue"}},
+                "body": [
+                    {"opCode": "ldloc", "operand": {"localName": "j"}}, {"opCode": "ldc.i4", "operand": 1}, {"opCode": "add"},
+                    {"opCode": "stloc", "operand": {"localName": "j"}},
+                    {"opCode": "ldloc", "operand": {"localName": "sum"}}, {"opCode": "ldloc", "operand": {"localName": "j"}},
+                    {"opCode": "add"}, {"opCode": "ldc.i4", "operand": 65521}, {"opCode": "rem"},
+                    {"opCode": "stloc", "operand": {"localName": "sum"}},
+                    {"opCode": "ldloc", "operand": {"localName": "j"}}, {"opCode": "ldc.i4", "operand": 4}, {"opCode": "cge"},
+                    {"opCode": "if", "operand": {"thenBlock": [{"opCode": "break"}]}}
+                ]
+            }}
+        ]
+    }},
+    {"opCode": "ldloc", "operand": {"localName": "sum"}},
+    {"opCode": "ret"}
+])";
+
+void AddStructuredLoop(const ClassRef& benchClass) {
+    const auto int32Type = TypeReference::Int32();
+    auto method = std::make_shared<Method>("StructuredLoop", int32Type, true);
+    method->AddParameter("n", int32Type);
+    method->AddLocal("i", int32Type);
+    method->AddLocal("j", int32Type);
+    method->AddLocal("sum", int32Type);
+    method->AddLocal("running", TypeReference::Bool());
+
+    std::vector<Instruction> instructions;
+    for (const auto& node : json::parse(STRUCTURED_LOOP_JSON)) {
+        instructions.push_back(InstructionExecutor::ParseJsonInstruction(node));
+    }
+    method->SetInstructions(std::move(instructions));
+    benchClass->AddMethod(method);
+}
+
+struct Workload {
+    std::string method;
+    int32_t argument;
+    int repetitions;
+};
+
+using Runner = std::function<Value(const MethodRef&, const std::vector<Value>&)>;
+
+double TimeRuns(const Runner& run, const MethodRef& method, const std::vector<Value>& args, int repetitions, Value& result) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i) {
+        result = run(method, args);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+const std::vector<Workload> kWorkloads = {
+    {"SumLoop", 100000, 10},
+    {"CountEvens", 100000, 10},
+    {"Fib", 20, 2},
+    {"CallLoop", 20000, 5},
+    {"AllocLoop", 20000, 5},
+    {"StructuredLoop", 20000, 5},
+};
+
+std::shared_ptr<VirtualMachine> LoadBenchmark() {
+    auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+    AddStructuredLoop(vm->GetClass("Bench"));
+    return vm;
+}
+
+// Dispatches of one run of every workload, prepared with or without fusion.
+std::vector<uint64_t> CountDispatches(bool superinstructions) {
+    BytecodeCompiler::SetSuperinstructionsEnabled(superinstructions);
+    JitCompiler::SetEnabled(false);
+    auto vm = LoadBenchmark();
+    auto benchClass = vm->GetClass("Bench");
+
+    std::vector<uint64_t> counts;
+    for (const auto& workload : kWorkloads) {
+        DispatchProfile::Reset();
+        DispatchProfile::SetEnabled(true);
+        (void)vm->InvokeStaticMethod(benchClass, workload.method, {Value(workload.argument)});
+        DispatchProfile::SetEnabled(false);
+        counts.push_back(DispatchProfile::GetDispatchCount());
+    }
+    BytecodeCompiler::SetSuperinstructionsEnabled(true);
+    JitCompiler::SetEnabled(true);
+    return counts;
+}
+
+void PrintDispatchCounts(bool printPairs) {
+    const auto unfused = CountDispatches(false);
+    // Pair counts of the unfused code, accumulated over all workloads.
+    std::vector<OpcodePairCount> pairs;
+    if (printPairs) {
+        BytecodeCompiler::SetSuperinstructionsEnabled(false);
+        JitCompiler::SetEnabled(false);
+        auto vm = LoadBenchmark();
+        auto benchClass = vm->GetClass("Bench");
+        DispatchProfile::Reset();
+        DispatchProfile::SetEnabled(true);
+        for (const auto& workload : kWorkloads) {
+            (void)vm->InvokeStaticMethod(benchClass, workload.method, {Value(workload.argument)});
+        }
+        DispatchProfile::SetEnabled(false);
+        BytecodeCompiler::SetSuperinstructionsEnabled(true);
+        JitCompiler::SetEnabled(true);
+        pairs = DispatchProfile::GetPairCounts();
+    }
+    const auto fused = CountDispatches(true);
+
+    std::cout << "\n" << std::left << std::setw(16) << "workload"
+              << std::right << std::setw(14) << "dispatches"
+              << std::setw(16) << "fused"
+              << std::setw(12) << "reduction" << "\n";
+    std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
+    uint64_t totalUnfused = 0;
+    uint64_t totalFused = 0;
+    for (size_t i = 0; i < kWorkloads.size(); ++i) {
+        totalUnfused += unfused[i];
+        totalFused += fused[i];
+        std::cout << std::left << std::setw(16) << kWorkloads[i].method
+                  << std::right << std::setw(14) << unfused[i]
+                  << std::setw(16) << fused[i]
+                  << std::setw(11) << std::fixed << std::setprecision(1)
+                  << (unfused[i] ? 100.0 * (1.0 - static_cast<double>(fused[i]) / unfused[i]) : 0.0) << "%\n";
+    }
+    std::cout << std::left << std::setw(16) << "total"
+              << std::right << std::setw(14) << totalUnfused
+              << std::setw(16) << totalFused
+              << std::setw(11)
+              << (totalUnfused ? 100.0 * (1.0 - static_cast<double>(totalFused) / totalUnfused) : 0.0) << "%\n";
+
+    if (printPairs) {
+        std::cout << "\nMost frequent opcode pairs (unfused):\n";
+        for (size_t i = 0; i < pairs.size() && i < 20; ++i) {
+            std::cout << "  " << std::left << std::setw(18) << GetBytecodeOpName(pairs[i].first)
+                      << " -> " << std::setw(18) << GetBytecodeOpName(pairs[i].second)
+                      << std::right << std::setw(12) << pairs[i].count << "\n";
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int scale = 1;
+    bool printPairs = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--pairs") {
+            printPairs = true;
+        } else {
+            scale = std::max(1, std::atoi(argv[i]));
+        }
+    }
+
+    std::cout << "=== ObjectIR Interpreter Benchmark ===\n\n";
+    std::cout << "Dispatch mode: " << InstructionExecutor::GetDispatchMode() << "\n";
+    std::cout << "JIT: " << (JitCompiler::IsSupported() ? "x86-64" : "unavailable") << "\n";
+    std::cout << "Scale: " << scale << "\n\n";
+
+    try {
+        auto vm = LoadBenchmark();
+        auto benchClass = vm->GetClass("Bench");
+
+        // Legacy path: walk the Instruction vector directly, as the VM did
+        // before methods were prepared. Nested calls still go through the VM.
+        Runner legacy = [&](const MethodRef& method, const std::vector<Value>& args) {
+            auto context = std::make_unique<ExecutionContext>(method);
+            auto* rawContext = context.get();
+            vm->PushContext(std::move(context));
+            auto result = InstructionExecutor::ExecuteInstructions(
+                method->GetInstructions(), nullptr, args, rawContext, vm.get(), method->GetLabelMap());
+            vm->PopContext();
+            return result;
+        };
+
+        Runner prepared = [&](const MethodRef& method, const std::vector<Value>& args) {
+            return vm->InvokeStaticMethod(benchClass, method->GetName(), args);
+        };
+
+        // Interpreted: the JIT is off; timed before the JIT run compiles anything.
+        auto timePrepared = [&](bool jit, const MethodRef& method, const std::vector<Value>& args,
+                                int repetitions, Value& result) {
+            JitCompiler::SetEnabled(jit);
+            (void)prepared(method, args); // warm up (prepares caches, tiers up)
+            const double ms = TimeRuns(prepared, method, args, repetitions, result);
+            JitCompiler::SetEnabled(true);
+            return ms;
+        };
+
+        std::cout << std::left << std::setw(16) << "workload"
+                  << std::right << std::setw(14) << "legacy (ms)"
+                  << std::setw(16) << "prepared (ms)"
+                  << std::setw(12) << "speedup"
+                  << std::setw(12) << "jit (ms)"
+                  << std::setw(12) << "speedup"
+                  << std::setw(10) << "verified"
+                  << std::setw(8) << "native" << "\n";
+        std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
+
+        bool allMatch = true;
+        for (const auto& workload : kWorkloads) {
+            auto method = benchClass->GetMethod(workload.method);
+            const std::vector<Value> args = {Value(workload.argument)};
+
+            Value legacyResult;
+            Value preparedResult;
+            Value jitResult;
+            (void)legacy(method, args);
+            const int repetitions = workload.repetitions * scale;
+            const double legacyMs = TimeRuns(legacy, method, args, repetitions, legacyResult);
+            const double preparedMs = timePrepared(false, method, args, repetitions, preparedResult);
+            const double jitMs = timePrepared(true, method, args, repetitions, jitResult);
+
+            const bool match = legacyResult == preparedResult && legacyResult == jitResult;
+            allMatch = allMatch && match;
+
+            std::cout << std::left << std::setw(16) << workload.method
+                      << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << legacyMs
+                      << std::setw(16) << preparedMs
+                      << std::setw(11) << (preparedMs > 0 ? legacyMs / preparedMs : 0.0) << "x"
+                      << std::setw(12) << jitMs
+                      << std::setw(11) << (jitMs > 0 ? legacyMs / jitMs : 0.0) << "x"
+                      << std::setw(10) << (method->GetPrepared()->verified ? "yes" : "no")
+                      << std::setw(8) << (method->GetPrepared()->nativeCode ? "yes" : "no")
+                      << (match ? "" : "  (result mismatch!)") << "\n";
+        }
+
+        std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
+        if (!allMatch) {
+            std::cerr << "\n✗ Legacy and prepared results differ\n";
+            return 1;
+        }
+
+        PrintDispatchCounts(printPairs);
+
+        std::cout << "\n✓ Benchmark completed\n";
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "\n✗ Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,469 @@
+#include "objectir_runtime.hpp"
+#include "ir_text_parser.hpp"
+#include "jit_compiler.hpp"
+#include "bytecode.hpp"
+#include "test_harness.hpp"
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// Runs the same methods interpreted and under the JIT (tiering up after two
+// calls or back edges) and checks they return, print and throw the same.
+// Call-heavy CallLoop also checks bail-outs: Weird returns a string where it
+// declares int32, and Thrower divides by zero on one iteration. Quotients
+// divides INT32_MIN by -1, which idiv traps on.
+
+const std::string IR_CODE = R"(
+module JitTest version 1.0.0
+class J {
+    static method FloatLoop(n: float64) -> float64 {
+        local f: float64
+        local x: float64
+        ldc.r8 0.0
+        stloc f
+        ldc.r8 1.0
+        stloc x
+        head:
+        ldloc f
+        ldarg n
+        bge done
+        ldloc x
+        ldc.r8 1.5
+        mul
+        ldc.r8 0.25
+        add
+        stloc x
+        ldloc x
+        ldc.r8 1000.0
+        ble skip
+        ldloc x
+        ldc.r8 999.0
+        sub
+        neg
+        neg
+        stloc x
+        skip:
+        ldloc x
+        ldc.r8 3.0
+        div
+        ldc.r8 3.0
+        mul
+        stloc x
+        ldloc f
+        ldc.r8 1.0
+        add
+        stloc f
+        br head
+        done:
+        ldloc x
+        ret
+    }
+    static method Cmp(a: float64, b: float64) -> int32 {
+        local i: int32
+        local c: int32
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc c
+        head:
+        ldloc i
+        ldc.i4 3000
+        bge done
+        ldarg a
+        ldarg b
+        clt
+        brfalse n1
+        ldloc c
+        ldc.i4 1
+        add
+        stloc c
+        n1:
+        ldarg a
+        ldarg b
+        cle
+        brfalse n2
+        ldloc c
+        ldc.i4 10
+        add
+        stloc c
+        n2:
+        ldarg a
+        ldarg b
+        cgt
+        brfalse n3
+        ldloc c
+        ldc.i4 100
+        add
+        stloc c
+        n3:
+        ldarg a
+        ldarg b
+        cge
+        brfalse n4
+        ldloc c
+        ldc.i4 1000
+        add
+        stloc c
+        n4:
+        ldarg a
+        ldarg b
+        ceq
+        brtrue n5
+        ldloc c
+        ldc.i4 10000
+        add
+        stloc c
+        n5:
+        ldarg a
+        ldarg b
+        cne
+        brfalse n6
+        ldloc c
+        ldc.i4 100000
+        add
+        stloc c
+        n6:
+        ldarg a
+        ldarg b
+        beq n7
+        ldloc c
+        ldc.i4 3
+        sub
+        stloc c
+        n7:
+        ldarg a
+        ldarg b
+        bne n8
+        ldloc c
+        ldc.i4 7
+        sub
+        stloc c
+        n8:
+        ldarg a
+        ldarg b
+        blt n9
+        ldloc c
+        ldc.i4 11
+        neg
+        sub
+        stloc c
+        n9:
+        ldarg a
+        ldarg b
+        bge n10
+        ldloc c
+        ldc.i4 13
+        sub
+        stloc c
+        n10:
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br head
+        done:
+        ldloc c
+        ret
+    }
+    static method DivLoop(n: int32, d: int32) -> int32 {
+        local i: int32
+        local s: int32
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc s
+        head:
+        ldloc i
+        ldarg n
+        bge done
+        ldloc s
+        ldloc i
+        ldarg d
+        div
+        add
+        ldloc i
+        ldarg d
+        rem
+        sub
+        stloc s
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br head
+        done:
+        ldloc s
+        ret
+    }
+    static method Quotients(n: int32, x: int32, d: int32) -> int32 {
+        local i: int32
+        local q: int32
+        local r: int32
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc q
+        ldc.i4 0
+        stloc r
+        head:
+        ldloc i
+        ldarg n
+        bge done
+        ldarg x
+        ldarg d
+        div
+        stloc q
+        ldarg x
+        ldarg d
+        rem
+        stloc r
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br head
+        done:
+        ldloc q
+        ldloc r
+        sub
+        ret
+    }
+    static method Twice(i: int32) -> int32 {
+        ldarg i
+        ldc.i4 2
+        mul
+        ret
+    }
+    static method Weird(i: int32) -> int32 {
+        ldarg i
+        ldc.i4 777
+        beq str
+        ldarg i
+        ret
+        str:
+        ldstr "seven"
+        ret
+    }
+    static method Thrower(i: int32) -> int32 {
+        ldarg i
+        ldc.i4 5000
+        bne ok
+        ldc.i4 1
+        ldc.i4 0
+        div
+        ret
+        ok:
+        ldarg i
+        ret
+    }
+    static method CallLoop(n: int32, which: int32) -> int32 {
+        local i: int32
+        local s: int32
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc s
+        head:
+        ldloc i
+        ldarg n
+        bge done
+        ldarg which
+        ldc.i4 0
+        bne w1
+        ldloc s
+        ldloc i
+        call J.Twice(int32) -> int32
+        add
+        stloc s
+        br next
+        w1:
+        ldarg which
+        ldc.i4 1
+        bne w2
+        ldloc s
+        ldloc i
+        call J.Weird(int32) -> int32
+        pop
+        ldc.i4 1
+        add
+        stloc s
+        br next
+        w2:
+        ldloc s
+        ldloc i
+        call J.Thrower(int32) -> int32
+        add
+        stloc s
+        next:
+        ldloc i
+        ldc.i4 1000
+        rem
+        ldc.i4 0
+        bne skip
+        ldloc i
+        call System.Console.WriteLine(int32) -> void
+        skip:
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br head
+        done:
+        ldloc s
+        ret
+    }
+    static method Flags(n: int32) -> int32 {
+        local i: int32
+        local on: bool
+        local c: int32
+        ldc.i4 0
+        stloc i
+        ldc.i4 0
+        stloc c
+        ldc.i4 0
+        ldc.i4 1
+        ceq
+        stloc on
+        head:
+        ldloc i
+        ldarg n
+        bge done
+        ldloc on
+        ldc.i4 0
+        ldc.i4 0
+        ceq
+        ceq
+        brfalse off
+        ldloc c
+        dup
+        add
+        ldc.i4 3
+        sub
+        stloc c
+        off:
+        ldloc on
+        brtrue wasOn
+        ldc.i4 1
+        ldc.i4 1
+        ceq
+        stloc on
+        br next
+        wasOn:
+        ldc.i4 1
+        ldc.i4 2
+        ceq
+        stloc on
+        next:
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br head
+        done:
+        ldloc c
+        ret
+    }
+}
+)";
+
+namespace {
+
+std::string Describe(const std::function<Value()>& call) {
+    try {
+        Value value = call();
+        std::ostringstream out;
+        if (value.IsInt32()) {
+            out << "int32 " << value.AsInt32();
+        } else if (value.IsFloat64()) {
+            out << "float64 " << value.AsFloat64();
+        } else {
+            out << "other";
+        }
+        return out.str();
+    } catch (const std::exception& e) {
+        return std::string("error ") + e.what();
+    }
+}
+
+struct Run {
+    std::vector<std::string> results;
+    std::string output;
+    std::vector<std::string> nativeMethods;
+};
+
+Run RunAll(bool jit) {
+    JitCompiler::SetEnabled(jit);
+    JitCompiler::SetThresholds(2, 2);
+    auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+    Run run;
+    std::ostringstream output;
+    vm->SetOutputFunction([&](const std::string& text) { output << text; });
+    auto j = vm->GetClass("J");
+    auto invoke = [&](const std::string& method, std::vector<Value> args) {
+        run.results.push_back(method + ": " + Describe([&] { return vm->InvokeStaticMethod(j, method, args); }));
+    };
+
+    // Three rounds, so later ones run the compiled code from entry.
+    for (int round = 0; round < 3; ++round) {
+        invoke("FloatLoop", {Value(5000.0)});
+        invoke("Cmp", {Value(1.0), Value(2.0)});
+        invoke("Cmp", {Value(2.0), Value(2.0)});
+        invoke("Cmp", {Value(std::nan("")), Value(2.0)});
+        invoke("DivLoop", {Value(int32_t(5000)), Value(int32_t(7))});
+        invoke("DivLoop", {Value(int32_t(5000)), Value(int32_t(-3))});
+        invoke("DivLoop", {Value(int32_t(5000)), Value(int32_t(0))});
+        invoke("CallLoop", {Value(int32_t(3000)), Value(int32_t(0))});
+        invoke("CallLoop", {Value(int32_t(3000)), Value(int32_t(1))});
+        invoke("CallLoop", {Value(int32_t(6000)), Value(int32_t(2))});
+        invoke("Flags", {Value(int32_t(5001))});
+        invoke("Quotients", {Value(int32_t(100)), Value(std::numeric_limits<int32_t>::min()), Value(int32_t(-1))});
+        invoke("Quotients", {Value(int32_t(100)), Value(std::numeric_limits<int32_t>::min()), Value(int32_t(7))});
+    }
+    run.output = output.str();
+    for (const char* name : {"FloatLoop", "Cmp", "DivLoop", "Flags", "Quotients"}) {
+        auto prepared = j->GetMethod(name)->GetPrepared();
+        if (prepared && prepared->nativeCode) {
+            run.nativeMethods.push_back(name);
+        }
+    }
+    return run;
+}
+
+} // namespace
+
+int main() {
+    try {
+        std::cout << "=== JIT Test ===" << std::endl;
+
+        const Run interpreted = RunAll(false);
+        const Run compiled = RunAll(true);
+
+        Check(interpreted.nativeMethods.empty(), "nothing is compiled with the JIT off");
+        for (size_t i = 0; i < interpreted.results.size(); ++i) {
+            const std::string& expected = interpreted.results[i];
+            const std::string actual = i < compiled.results.size() ? compiled.results[i] : "missing";
+            Check(actual == expected, expected + (actual == expected ? "" : " (JIT: " + actual + ")"));
+        }
+        Check(interpreted.results[6].rfind("DivLoop: error", 0) == 0, "division by zero throws");
+        Check(interpreted.results[9].rfind("CallLoop: error", 0) == 0, "an exception from a callee propagates");
+        Check(interpreted.results[11] == "Quotients: int32 -2147483648", "INT32_MIN / -1 wraps and INT32_MIN % -1 is 0");
+        Check(!interpreted.output.empty() && compiled.output == interpreted.output, "output matches");
+
+        if (JitCompiler::IsSupported()) {
+            Check(compiled.nativeMethods.size() == 5, "loop methods were compiled to native code");
+        } else {
+            std::cout << "(no JIT backend for this host)" << std::endl;
+        }
+
+        return TestHarness::Finish("JIT");
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
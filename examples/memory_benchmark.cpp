@@ -0,0 +1,387 @@
+#include "../include/objectir_runtime.hpp"
+#include "../include/ir_text_parser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#endif
+
+using namespace ObjectIR;
+
+// Memory benchmark for the allocator and the collectors: the Nursery against
+// operator new, the cost AllocationRegion adds to an allocation, and peak RSS
+// and time of cycle-heavy requests run plain, with the GarbageCollector on
+// (generational, or collecting the whole heap every time), and with an
+// AllocationRegion per request.
+//
+// Peak RSS only grows within a process, so each workload/mode pair runs in a
+// child process (this executable with the pair as arguments).
+//
+// Usage: memory_benchmark                      (everything)
+//        memory_benchmark <workload> <mode>    (one pair; modes plain, gc, gc-full, region)
+
+const std::string IR_CODE = R"(
+module MemoryBenchmark version 1.0.0
+
+class Node {
+    field next: Node
+    field value: int32
+    field items: System.Collections.Generic.List`1
+}
+
+class Bench {
+    // Allocates n pairs of nodes pointing at each other, which reference
+    // counting alone never frees. Every keepEvery-th iteration a node is
+    // appended to a chain that survives the request. Returns the sum of the
+    // values of the first 300 chained nodes.
+    static method Cycles(n: int32, keepEvery: int32) -> int32 {
+        local i: int32
+        local a: Node
+        local b: Node
+        local head: Node
+        local keep: Node
+        local sum: int32
+
+        newobj Node
+        stloc head
+        ldloc head
+        stloc keep
+        ldc.i4 0
+        stloc i
+
+        cycle_head:
+        ldloc i
+        ldarg n
+        bge cycle_done
+        newobj Node
+        stloc a
+        newobj Node
+        stloc b
+        ldloc a
+        ldloc b
+        stfld Node.next
+        ldloc b
+        ldloc a
+        stfld Node.next
+
+        ldloc i
+        ldarg keepEvery
+        rem
+        brtrue cycle_next
+        newobj Node
+        stloc a
+        ldloc a
+        ldloc i
+        stfld Node.value
+        ldloc keep
+        ldloc a
+        stfld Node.next
+        ldloc a
+        stloc keep
+
+        cycle_next:
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br cycle_head
+
+        cycle_done:
+        ldloc keep
+        ldloc head
+        stfld Node.next
+        ldloc head
+        call Bench.SumChain(Node) -> int32
+        ret
+    }
+
+    // Like Cycles, but each pair's cycle also runs through a List: node ->
+    // list -> node. The collector has to trace the list's native storage.
+    static method ListCycles(n: int32, keepEvery: int32) -> int32 {
+        local i: int32
+        local a: Node
+        local b: Node
+        local head: Node
+        local keep: Node
+        local list: System.Collections.Generic.List`1
+
+        newobj Node
+        stloc head
+        ldloc head
+        stloc keep
+        ldc.i4 0
+        stloc i
+
+        list_head:
+        ldloc i
+        ldarg n
+        bge list_done
+        newobj Node
+        stloc a
+        newobj Node
+        stloc b
+        ldloc a
+        ldloc b
+        stfld Node.next
+        ldloc b
+        ldloc a
+        stfld Node.next
+        newobj System.Collections.Generic.List`1
+        stloc list
+        ldloc list
+        ldloc a
+        callvirt System.Collections.Generic.List`1.Add(object) -> void
+        ldloc a
+        ldloc list
+        stfld Node.items
+
+        ldloc i
+        ldarg keepEvery
+        rem
+        brtrue list_next
+        newobj Node
+        stloc a
+        ldloc a
+        ldloc i
+        stfld Node.value
+        ldloc keep
+        ldloc a
+        stfld Node.next
+        ldloc a
+        stloc keep
+
+        list_next:
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br list_head
+
+        list_done:
+        ldloc keep
+        ldloc head
+        stfld Node.next
+        ldloc head
+        call Bench.SumChain(Node) -> int32
+        ret
+    }
+
+    static method SumChain(head: Node) -> int32 {
+        local i: int32
+        local node: Node
+        local sum: int32
+
+        ldc.i4 0
+        stloc sum
+        ldarg head
+        ldfld Node.next
+        stloc node
+        ldc.i4 0
+        stloc i
+
+        sum_head:
+        ldloc i
+        ldc.i4 300
+        bge sum_done
+        ldloc sum
+        ldloc node
+        ldfld Node.value
+        add
+        stloc sum
+        ldloc node
+        ldfld Node.next
+        stloc node
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br sum_head
+
+        sum_done:
+        ldloc sum
+        ret
+    }
+}
+)";
+
+struct Workload {
+    std::string name;
+    std::string method;
+    int32_t iterations;
+    int32_t keepEvery;
+};
+
+// A request's chain lives until the request returns. "survivors" adds a node
+// to it every iteration, so most of what that request allocates stays live.
+const std::vector<Workload> kWorkloads = {
+    {"cycles", "Cycles", 300000, 1000},
+    {"list-cycles", "ListCycles", 300000, 1000},
+    {"survivors", "Cycles", 300000, 1},
+};
+
+const std::vector<std::string> kModes = {"plain", "gc", "gc-full", "region"};
+
+constexpr int kRequests = 5;
+
+// Peak resident set size of this process so far, in KiB (0 if unknown).
+long PeakRssKiB() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    #if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+    #else
+    return usage.ru_maxrss;
+    #endif
+#else
+    return 0;
+#endif
+}
+
+double NanosecondsPer(std::chrono::steady_clock::time_point start, int count) {
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / count;
+}
+
+// Allocating and freeing one object-sized block, best of three rounds.
+void BenchmarkNursery() {
+    constexpr int kCount = 20000000;
+    constexpr size_t kBytes = 208;
+    double nursery = 1e9;
+    double heap = 1e9;
+    for (int round = 0; round < 3; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kCount; ++i) {
+            void* volatile block = Nursery::Allocate(kBytes);
+            Nursery::Release(block, kBytes);
+        }
+        nursery = std::min(nursery, NanosecondsPer(start, kCount));
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kCount; ++i) {
+            void* volatile block = ::operator new(kBytes);
+            ::operator delete(block);
+        }
+        heap = std::min(heap, NanosecondsPer(start, kCount));
+    }
+    std::cout << std::left << std::setw(34) << "allocate+free 208 bytes"
+              << std::right << std::fixed << std::setprecision(1)
+              << "nursery " << nursery << " ns, operator new " << heap << " ns\n";
+}
+
+// Creating and dropping an object, outside and inside a region.
+void BenchmarkRegion() {
+    constexpr int kCount = 5000000;
+    auto point = std::make_shared<Class>("Point");
+    point->AddField(std::make_shared<Field>("x", TypeReference::Int32()));
+    double plain = 1e9;
+    double recorded = 1e9;
+    for (int round = 0; round < 3; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kCount; ++i) {
+            (void)point->CreateInstance();
+        }
+        plain = std::min(plain, NanosecondsPer(start, kCount));
+
+        AllocationRegion region;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kCount; ++i) {
+            (void)point->CreateInstance();
+        }
+        recorded = std::min(recorded, NanosecondsPer(start, kCount));
+        region.Close();
+    }
+    std::cout << std::left << std::setw(34) << "create+drop object"
+              << std::right << std::fixed << std::setprecision(1)
+              << "plain " << plain << " ns, in a region " << recorded << " ns\n";
+}
+
+int RunWorkload(const std::string& workloadName, const std::string& mode) {
+    const Workload* workload = nullptr;
+    for (const auto& candidate : kWorkloads) {
+        if (candidate.name == workloadName) {
+            workload = &candidate;
+        }
+    }
+    if (!workload || std::find(kModes.begin(), kModes.end(), mode) == kModes.end()) {
+        std::cerr << "Unknown workload or mode: " << workloadName << " " << mode << "\n";
+        return 1;
+    }
+
+    const bool collecting = mode == "gc" || mode == "gc-full";
+    GarbageCollector::SetEnabled(collecting);
+    if (mode == "gc-full") {
+        GarbageCollector::SetYoungGenerationSize(0);
+    }
+    auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+    auto benchClass = vm->GetClass("Bench");
+    const std::vector<Value> args = {Value(workload->iterations), Value(workload->keepEvery)};
+
+    int32_t result = 0;
+    size_t cleared = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int request = 0; request < kRequests; ++request) {
+        if (mode == "region") {
+            AllocationRegion region;
+            result = vm->InvokeStaticMethod(benchClass, workload->method, args).AsInt32();
+            cleared += region.Close().cleared;
+        } else {
+            result = vm->InvokeStaticMethod(benchClass, workload->method, args).AsInt32();
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    if (collecting) {
+        cleared = GarbageCollector::GetStatistics().objectsFreed;
+    }
+
+    std::cout << std::left << std::setw(14) << workload->name << std::setw(9) << mode
+              << std::right << std::fixed << std::setprecision(0)
+              << std::setw(10) << std::chrono::duration<double, std::milli>(end - start).count()
+              << std::setw(14) << PeakRssKiB() / 1024
+              << std::setw(12) << cleared
+              << std::setw(10) << result << "\n";
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    try {
+        if (argc >= 3) {
+            return RunWorkload(argv[1], argv[2]);
+        }
+
+        std::cout << "=== ObjectIR Memory Benchmark ===\n\n";
+        BenchmarkNursery();
+        BenchmarkRegion();
+
+        std::cout << "\n" << kRequests << " requests per run\n";
+        std::cout << std::left << std::setw(14) << "workload" << std::setw(9) << "mode"
+                  << std::right << std::setw(10) << "time (ms)"
+                  << std::setw(14) << "peak RSS (MB)"
+                  << std::setw(12) << "cleared"
+                  << std::setw(10) << "result" << "\n";
+        std::cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
+        std::cout.flush();
+        for (const auto& workload : kWorkloads) {
+            for (const auto& mode : kModes) {
+                const std::string command = "\"" + std::string(argv[0]) + "\" " + workload.name + " " + mode;
+                if (std::system(command.c_str()) != 0) {
+                    std::cerr << "\n✗ " << workload.name << " " << mode << " failed\n";
+                    return 1;
+                }
+            }
+        }
+        std::cout << "\n✓ Benchmark completed\n";
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "\n✗ Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,172 @@
+#include "objectir_runtime.hpp"
+#include "ir_text_parser.hpp"
+#include "test_harness.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// The Nursery hands out aligned blocks that keep their contents, recycles a
+// freed block for the next allocation of its size, and passes the blocks of
+// an exiting thread on to the others. Objects it allocated on one thread live
+// on in another. With the collector on, minor collections free young cycles
+// while a young object referenced only from an old one survives.
+//
+// Checks of the recycling only apply when the nursery is built in
+// (OBJECTIR_NURSERY=ON); otherwise every block comes from operator new.
+
+namespace {
+
+bool Filled(const void* block, size_t bytes, unsigned char pattern) {
+    const auto* bytesOf = static_cast<const unsigned char*>(block);
+    for (size_t i = 0; i < bytes; ++i) {
+        if (bytesOf[i] != pattern) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    try {
+        std::cout << "=== Nursery Test ===" << std::endl;
+
+        Nursery::Release(Nursery::Allocate(64), 64);
+        const bool pooled = Nursery::GetStatistics().chunksCreated > 0;
+        std::cout << (pooled ? "nursery built in" : "nursery off: operator new") << std::endl;
+
+        // Blocks of every small size, and a few large ones, all live at once.
+        std::vector<std::pair<void*, size_t>> blocks;
+        bool aligned = true;
+        for (size_t bytes = 1; bytes <= Nursery::GetLargeAllocationSize() + 512; bytes += 7) {
+            void* block = Nursery::Allocate(bytes);
+            aligned = aligned && reinterpret_cast<uintptr_t>(block) % alignof(std::max_align_t) == 0;
+            std::memset(block, static_cast<int>(bytes & 0xff), bytes);
+            blocks.emplace_back(block, bytes);
+        }
+        bool intact = true;
+        for (const auto& entry : blocks) {
+            intact = intact && Filled(entry.first, entry.second, static_cast<unsigned char>(entry.second & 0xff));
+            Nursery::Release(entry.first, entry.second);
+        }
+        Check(aligned, "blocks are aligned for any scalar type");
+        Check(intact, "live blocks of every size keep their contents");
+
+        if (pooled) {
+            void* first = Nursery::Allocate(200);
+            Nursery::Release(first, 200);
+            void* second = Nursery::Allocate(200);
+            Check(second == first, "the next allocation of a size reuses the block freed last");
+            Nursery::Release(second, 200);
+
+            const uint64_t chunks = Nursery::GetStatistics().chunksCreated;
+            for (int i = 0; i < 1000; ++i) {
+                const size_t bytes = Nursery::GetLargeAllocationSize() * 4;
+                Nursery::Release(Nursery::Allocate(bytes), bytes);
+            }
+            Check(Nursery::GetStatistics().chunksCreated == chunks, "large blocks bypass the nursery's chunks");
+        }
+
+        // A thread frees its blocks and exits; another thread takes them over.
+        constexpr size_t kBytes = 48;
+        constexpr int kCount = 100;
+        std::set<void*> freedByWorker;
+        const size_t sharedBefore = Nursery::GetStatistics().sharedFreeBlocks;
+        std::thread([&] {
+            std::vector<void*> mine;
+            for (int i = 0; i < kCount; ++i) {
+                mine.push_back(Nursery::Allocate(kBytes));
+            }
+            for (void* block : mine) {
+                freedByWorker.insert(block);
+                Nursery::Release(block, kBytes);
+            }
+        }).join();
+        if (pooled) {
+            Check(Nursery::GetStatistics().sharedFreeBlocks >= sharedBefore + kCount,
+                  "an exiting thread hands its free blocks to the shared lists");
+            void* adopted = nullptr;
+            std::thread([&] {
+                adopted = Nursery::Allocate(kBytes);
+                Nursery::Release(adopted, kBytes);
+            }).join();
+            Check(freedByWorker.count(adopted) == 1, "another thread allocates from the blocks it handed over");
+        }
+
+        // Objects allocated on a thread that has exited.
+        auto vm = IRTextParser::ParseToVirtualMachine(R"(
+module NurseryTest version 1.0.0
+class Node {
+    field next: Node
+    field value: int32
+}
+)");
+        auto node = vm->GetClass("Node");
+        std::vector<ObjectRef> survivors;
+        std::thread([&] {
+            for (int i = 0; i < kCount; ++i) {
+                auto object = node->CreateInstance();
+                object->SetField("value", Value(int32_t(i)));
+                if (!survivors.empty()) {
+                    object->SetField("next", Value(survivors.back()));
+                }
+                survivors.push_back(object);
+            }
+        }).join();
+        bool chained = true;
+        for (int i = 1; i < kCount; ++i) {
+            chained = chained && survivors[i]->GetField("value").AsInt32() == i
+                      && survivors[i]->GetField("next").AsObject() == survivors[i - 1];
+        }
+        Check(chained, "objects outlive the thread that allocated them");
+        survivors.clear();
+
+        // Minor collections: only objects tracked since the last collection
+        // are traced, and references from older objects keep theirs alive.
+        GarbageCollector::SetEnabled(true);
+        GarbageCollector::SetYoungGenerationSize(16 * 1024);
+        ObjectRef old = node->CreateInstance();
+        GarbageCollector::Collect();
+        const auto before = GarbageCollector::GetStatistics();
+
+        std::weak_ptr<Object> kept;
+        std::weak_ptr<Object> firstCycle;
+        {
+            auto young = node->CreateInstance();
+            young->SetField("value", Value(int32_t(5)));
+            old->SetField("next", Value(young));
+            kept = young;
+        }
+        for (int i = 0; i < 2000; ++i) {
+            auto a = node->CreateInstance();
+            auto b = node->CreateInstance();
+            a->SetField("next", Value(b));
+            b->SetField("next", Value(a));
+            if (i == 0) {
+                firstCycle = a;
+            }
+        }
+        const auto after = GarbageCollector::GetStatistics();
+        Check(after.minorCollections > before.minorCollections
+                  && after.collections - before.collections == after.minorCollections - before.minorCollections,
+              "young allocations trigger minor collections only");
+        Check(firstCycle.expired() && after.objectsFreed > before.objectsFreed, "minor collections free young cycles");
+        Check(!kept.expired() && old->GetField("next").AsObject()->GetField("value").AsInt32() == 5,
+              "a young object referenced only from an old one survives");
+
+        GarbageCollector::SetEnabled(false);
+        return TestHarness::Finish("Nursery");
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,185 @@
+#include "objectir_runtime.hpp"
+#include "ir_text_parser.hpp"
+#include "test_harness.hpp"
+#include <iostream>
+#include <memory>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// AllocationRegion: closing a region clears the cycles among the objects
+// created in it, while objects that escaped - through a field of an older
+// object, an element of an older array, a host reference or an argument of
+// a request - survive with everything they reach.
+
+const std::string IR_CODE = R"(
+module RegionTest version 1.0.0
+
+class Node {
+    field next: Node
+    field value: int32
+}
+
+class Main {
+    // Builds n two-node cycles and stores the last one's first node in
+    // `holder`, which the caller created before the region.
+    static method Request(holder: Node, n: int32) -> int32 {
+        local i: int32
+        local a: Node
+        local b: Node
+        ldc.i4 0
+        stloc i
+    loop:
+        ldloc i
+        ldarg n
+        bge done
+        newobj Node
+        stloc a
+        newobj Node
+        stloc b
+        ldloc a
+        ldloc b
+        stfld Node.next
+        ldloc b
+        ldloc a
+        stfld Node.next
+        ldloc i
+        ldc.i4 1
+        add
+        stloc i
+        br loop
+    done:
+        ldloc a
+        ldarg n
+        stfld Node.value
+        ldarg holder
+        ldloc a
+        stfld Node.next
+        ldarg n
+        ret
+    }
+}
+)";
+
+int main() {
+    try {
+        std::cout << "=== Allocation Region Test ===" << std::endl;
+
+        auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+        auto node = vm->GetClass("Node");
+
+        // Long-lived objects the region's objects escape into.
+        ObjectRef cache = node->CreateInstance();
+        auto table = vm->CreateArray(TypeReference::Object(), 1);
+
+        ObjectRef hostRef;
+        std::weak_ptr<Object> cycleA, cycleB, viaField, viaFieldChild, viaArray, hostPartner, selfCycle, promoted;
+        AllocationRegion::Statistics inner;
+        AllocationRegion::Statistics outer;
+        {
+            AllocationRegion region;
+            Check(region.IsOpen(), "a new region is open");
+
+            auto a = node->CreateInstance();
+            auto b = node->CreateInstance();
+            a->SetField("next", Value(b));
+            b->SetField("next", Value(a));
+            cycleA = a;
+            cycleB = b;
+
+            auto field = node->CreateInstance();
+            auto fieldChild = node->CreateInstance();
+            fieldChild->SetField("value", Value(int32_t(7)));
+            field->SetField("next", Value(fieldChild));
+            fieldChild->SetField("next", Value(field));
+            cache->SetField("next", Value(field));
+            viaField = field;
+            viaFieldChild = fieldChild;
+
+            auto element = node->CreateInstance();
+            element->SetField("next", Value(element));
+            table->SetElement(0, Value(element));
+            viaArray = element;
+
+            hostRef = node->CreateInstance();
+            auto partner = node->CreateInstance();
+            hostRef->SetField("next", Value(partner));
+            partner->SetField("next", Value(hostRef));
+            hostPartner = partner;
+
+            {
+                AllocationRegion nested;
+                auto self = node->CreateInstance();
+                self->SetField("next", Value(self));
+                selfCycle = self;
+                auto kept = node->CreateInstance();
+                kept->SetField("next", Value(kept));
+                b->SetField("value", Value(kept));
+                promoted = kept;
+
+                bool rejected = false;
+                try {
+                    region.Close();
+                } catch (const std::runtime_error&) {
+                    rejected = true;
+                }
+                Check(rejected && region.IsOpen(), "closing a region that is not the innermost throws");
+
+                self.reset();
+                kept.reset();
+                inner = nested.Close();
+                Check(!nested.IsOpen(), "a closed region is no longer open");
+            }
+            Check(selfCycle.expired(), "a nested region clears its own cycles");
+            Check(!promoted.expired(), "an object reachable from the enclosing region's objects is promoted");
+            Check(inner.objects == 2 && inner.promoted == 1 && inner.cleared == 1, "nested region statistics");
+
+            a.reset();
+            b.reset();
+            field.reset();
+            fieldChild.reset();
+            element.reset();
+            partner.reset();
+            outer = region.Close();
+        }
+
+        Check(cycleA.expired() && cycleB.expired() && promoted.expired(),
+              "an unreachable cycle and what it reaches are cleared");
+        Check(!viaField.expired() && !viaFieldChild.expired()
+                  && cache->GetField("next").AsObject()->GetField("next").AsObject()->GetField("value").AsInt32() == 7,
+              "an object stored in an older object's field escapes with what it reaches");
+        Check(!viaArray.expired() && table->GetElement(0).AsObject()->GetField("next").AsObject() == viaArray.lock(),
+              "an object stored in an older array escapes with its references");
+        Check(!hostPartner.expired() && hostRef->GetField("next").AsObject()->GetField("next").AsObject() == hostRef,
+              "an object the host holds escapes with its cycle");
+        Check(outer.objects == 8 && outer.promoted == 5 && outer.cleared == 3, "region statistics");
+
+        // One region per request, as a server would use them: the cycles a
+        // request builds go when it ends, apart from the one it stores into
+        // `holder`.
+        ObjectRef holder = node->CreateInstance();
+        for (int request = 0; request < 3; ++request) {
+            AllocationRegion region;
+            Value result = vm->InvokeStaticMethod(vm->GetClass("Main"), "Request", {Value(holder), Value(int32_t(100))});
+            auto stats = region.Close();
+            Check(result.AsInt32() == 100 && stats.objects == 200 && stats.promoted == 2 && stats.cleared == 198,
+                  "request " + std::to_string(request) + " keeps only the cycle it stored");
+            auto stored = holder->GetField("next").AsObject();
+            Check(stored && stored->GetField("value").AsInt32() == 100
+                      && stored->GetField("next").AsObject()->GetField("next").AsObject() == stored,
+                  "the stored cycle keeps its references");
+            stored->SetField("next", Value());
+        }
+
+        // Escaped cycles live on like any other; break them so they go.
+        viaFieldChild.lock()->SetField("next", Value());
+        viaArray.lock()->SetField("next", Value());
+        hostRef->SetField("next", Value());
+
+        return TestHarness::Finish("Allocation Region");
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
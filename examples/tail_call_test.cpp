@@ -0,0 +1,169 @@
+#include "objectir_runtime.hpp"
+#include "ir_text_parser.hpp"
+#include "test_harness.hpp"
+#include <iostream>
+
+using namespace ObjectIR;
+using TestHarness::Check;
+
+// A call or callvirt right before ret reuses the caller's frame, so self and
+// mutual recursion 300000 calls deep run in constant native stack space.
+// Calls the frame cannot be reused for - into native methods, or where only
+// one of caller and callee returns a value - still run as ordinary calls.
+
+const std::string IR_CODE = R"(
+module TailCallTest version 1.0.0
+
+class Counter {
+    field count: int32
+
+    // Counts n down by calling itself on this.
+    method CountDown(n: int32) -> int32 {
+        ldarg n
+        brtrue more
+        ldarg this
+        ldfld Counter.count
+        ret
+    more:
+        ldarg this
+        ldarg this
+        ldfld Counter.count
+        ldc.i4 1
+        add
+        stfld Counter.count
+        ldarg this
+        ldarg n
+        ldc.i4 1
+        sub
+        callvirt Counter.CountDown(int32) -> int32
+        ret
+    }
+}
+
+class Main {
+    static method Down(n: int32) -> int32 {
+        ldarg n
+        brtrue more
+        ldc.i4 77
+        ret
+    more:
+        ldarg n
+        ldc.i4 1
+        sub
+        call Main.Down(int32) -> int32
+        ret
+    }
+
+    static method IsEven(n: int32) -> int32 {
+        ldarg n
+        brtrue more
+        ldc.i4 1
+        ret
+    more:
+        ldarg n
+        ldc.i4 1
+        sub
+        call Main.IsOdd(int32) -> int32
+        ret
+    }
+
+    static method IsOdd(n: int32) -> int32 {
+        local unused: int32
+        ldarg n
+        brtrue more
+        ldc.i4 0
+        ret
+    more:
+        ldarg n
+        ldc.i4 1
+        sub
+        call Main.IsEven(int32) -> int32
+        ret
+    }
+
+    // Not a tail call: the product needs the caller's frame.
+    static method Factorial(n: int32) -> int32 {
+        ldarg n
+        ldc.i4 1
+        bgt more
+        ldc.i4 1
+        ret
+    more:
+        ldarg n
+        ldarg n
+        ldc.i4 1
+        sub
+        call Main.Factorial(int32) -> int32
+        mul
+        ret
+    }
+
+    static method NativeTail(x: float64) -> float64 {
+        ldarg x
+        call System.Math.Abs(float64) -> float64
+        ret
+    }
+
+    // The callee returns a value the void caller drops.
+    static method Discard(n: int32) -> void {
+        ldarg n
+        call Main.Down(int32) -> int32
+        ret
+    }
+
+    static method ThrowAtZero(n: int32) -> int32 {
+        ldarg n
+        brtrue more
+        ldstr "reached zero"
+        throw
+    more:
+        ldarg n
+        ldc.i4 1
+        sub
+        call Main.ThrowAtZero(int32) -> int32
+        ret
+    }
+}
+)";
+
+int main() {
+    try {
+        std::cout << "=== Tail Call Test ===" << std::endl;
+
+        auto vm = IRTextParser::ParseToVirtualMachine(IR_CODE);
+        auto main = vm->GetClass("Main");
+        auto call = [&](const std::string& method, int32_t n) {
+            return vm->InvokeStaticMethod(main, method, {Value(n)});
+        };
+        constexpr int32_t kDepth = 300000;
+
+        Check(call("Down", kDepth).AsInt32() == 77, "self recursion 300000 calls deep");
+        Check(call("IsEven", kDepth + 1).AsInt32() == 0 && call("IsOdd", kDepth + 1).AsInt32() == 1,
+              "mutual recursion 300000 calls deep");
+
+        auto counter = vm->GetClass("Counter")->CreateInstance();
+        counter->SetField("count", Value(int32_t(0)));
+        Check(vm->InvokeMethod(counter, "CountDown", {Value(kDepth)}).AsInt32() == kDepth,
+              "virtual self recursion on the same receiver 300000 calls deep");
+
+        Check(call("Factorial", 10).AsInt32() == 3628800, "a call outside tail position keeps its caller");
+        Check(vm->InvokeStaticMethod(main, "NativeTail", {Value(-2.5)}).AsFloat64() == 2.5,
+              "a native callee in tail position runs as an ordinary call");
+        Check(vm->InvokeStaticMethod(main, "Discard", {Value(int32_t(1000))}).IsNull(),
+              "a void caller drops the value of a tail callee");
+
+        bool caught = false;
+        try {
+            call("ThrowAtZero", kDepth);
+        } catch (const std::exception& e) {
+            caught = std::string(e.what()).find("reached zero") != std::string::npos;
+        }
+        Check(caught, "an exception from the last of 300000 tail calls reaches the host");
+
+        return TestHarness::Finish("Tail Call");
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// Checks shared by the example test programs. Each check prints one line, and
+// a test exits non-zero when any of them failed, which is what CTest looks at.
+
+namespace TestHarness {
+
+inline int failures = 0;
+
+inline void Check(bool condition, const std::string& what) {
+    std::cout << (condition ? "✓ " : "✗ ") << what << std::endl;
+    if (!condition) {
+        ++failures;
+    }
+}
+
+/// Print the closing line of the test called `name`; returns the exit code.
+inline int Finish(const std::string& name) {
+    std::cout << "=== " << name << " Test " << (failures ? "Failed" : "Complete") << " ===" << std::endl;
+    return failures ? 1 : 0;
+}
+
+} // namespace TestHarness
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "objectir_runtime.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ObjectIR {
+
+// ============================================================================
+// AOT Compiler - C++ plugin source from the methods of a loaded module
+// ============================================================================
+
+/// Outcome for one method of a module passed to AotCompiler::GenerateSource.
+struct AotMethodReport {
+    std::string className;
+    std::string signature;
+    bool compiled = false;
+    std::string reason; // why the method stays interpreted
+};
+
+/// Translates the method bodies of a loaded module into C++, one function per
+/// method, wrapped into a plugin library (see VirtualMachine::LoadPlugin)
+/// whose ObjectIR_PluginInit installs them as native implementations.
+///
+/// Only verified bodies are translated, and only those the typed subset
+/// covers: moves, constants, int32/int64/float64 arithmetic, compares and
+/// branches, and static calls. Everything else stays interpreted, and so does
+/// a precompiled method at run time when
+///   - the loaded method is not the one the source was generated from (the
+///     plugin compares Fingerprint values before installing anything),
+///   - its body was replaced after the plugin was loaded, or
+///   - its arguments do not have the types its body was verified for.
+/// Precompiled methods call each other directly while the method tables they
+/// were resolved against are unchanged, and through the VM otherwise.
+class OBJECTIR_API AotCompiler {
+public:
+    /// C++ source of a plugin precompiling the methods of every class in `vm`.
+    /// `pluginName` is reported by ObjectIR_PluginGetInfo; `report`, if
+    /// given, receives one entry per method body considered. Bodies still at
+    /// the Interpreter tier are optimized first, as the plugin does before
+    /// comparing fingerprints (see TieredExecution).
+    static std::string GenerateSource(
+        VirtualMachine& vm,
+        const std::string& pluginName,
+        std::vector<AotMethodReport>* report = nullptr
+    );
+
+    /// Hash of everything a precompiled body depends on: the signature, the
+    /// local types and the prepared instruction stream with its constants and
+    /// call, field and type sites.
+    [[nodiscard]] static uint64_t Fingerprint(const Method& method);
+
+    /// `Name(type, ...) -> type` with canonical type names; identifies a
+    /// method within its class.
+    [[nodiscard]] static std::string Signature(const Method& method);
+
+private:
+    AotCompiler() = default;
+};
+
+} // namespace ObjectIR
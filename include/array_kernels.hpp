@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace ObjectIR {
+
+// ============================================================================
+// Array Kernels - Bulk operations over unboxed array storage
+// ============================================================================
+
+/// What Sum and Dot return for elements of type T: int64 for integers,
+/// double for floating point.
+template<typename T>
+using ArrayAccumulator = std::conditional_t<std::is_floating_point_v<T>, double, int64_t>;
+
+/// Bulk operations over `count` contiguous elements of type T (see
+/// Array::GetElements). Integer arithmetic wraps. Floating-point elements
+/// compare with ==, so NaN never matches; Min and Max return NaN when any
+/// element is NaN, and Sum and Dot add in an unspecified order.
+template<typename T>
+struct ArrayKernelSet
+{
+    void (*fill)(T *destination, size_t count, T value);
+    /// Index of the first element equal to `value`, or -1.
+    int64_t (*indexOf)(const T *elements, size_t count, T value);
+    ArrayAccumulator<T> (*sum)(const T *elements, size_t count);
+    /// `count` must be at least 1.
+    T (*min)(const T *elements, size_t count);
+    T (*max)(const T *elements, size_t count);
+    /// `destination` may be `left` or `right`.
+    void (*add)(const T *left, const T *right, T *destination, size_t count);
+    void (*multiply)(const T *left, const T *right, T *destination, size_t count);
+    ArrayAccumulator<T> (*dot)(const T *left, const T *right, size_t count);
+    bool (*equal)(const T *left, const T *right, size_t count);
+};
+
+/// One implementation of every kernel. Bool arrays use the uint8 kernels.
+struct ArrayKernelTable
+{
+    /// "avx2", "sse2" or "scalar".
+    const char *instructionSet;
+    ArrayKernelSet<int32_t> int32;
+    ArrayKernelSet<int64_t> int64;
+    ArrayKernelSet<float> float32;
+    ArrayKernelSet<double> float64;
+    ArrayKernelSet<uint8_t> uint8;
+};
+
+/// The kernels for this CPU, chosen on first use: AVX2 when CPUID reports
+/// it, SSE2 on other x86-64 CPUs, plain loops elsewhere or when the runtime
+/// is built with -DOBJECTIR_SIMD=OFF.
+const ArrayKernelTable &GetArrayKernels();
+
+/// Every table this CPU can run, GetArrayKernels's choice first and the
+/// plain loops last, so tests and benchmarks can compare them.
+std::vector<const ArrayKernelTable *> GetAllArrayKernels();
+
+/// The AVX2 kernels, or nullptr when the runtime was built without them.
+/// Only call on a CPU that supports AVX2.
+const ArrayKernelTable *GetAvx2ArrayKernels();
+
+} // namespace ObjectIR
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "objectir_runtime.hpp"
+#include <memory>
+
+namespace ObjectIR {
+
+// ============================================================================
+// System.Array - Bulk operations over arrays
+// ============================================================================
+
+// Any element type
+Value Array_Fill(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value Array_Copy(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value Array_IndexOf(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value Array_SequenceEqual(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+
+// Arrays of int32, int64, float32, float64 or uint8
+Value Array_Sum(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value Array_Min(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value Array_Max(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value Array_Add(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value Array_Multiply(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value Array_Dot(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+
+} // namespace ObjectIR
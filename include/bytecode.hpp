@@ -0,0 +1,627 @@
+#pragma once
+
+#include "objectir_runtime.hpp"
+#include "ir_instruction.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ObjectIR {
+
+// ============================================================================
+// Prepared Bytecode - Linear, pre-resolved form of a Method's instructions
+// ============================================================================
+
+/// Opcodes of the prepared (linked) instruction stream.
+///
+/// Unlike `OpCode`, every operand of a `BytecodeOp` is an integer: a local or
+/// argument slot, a branch target in the same stream, or an index into one of
+/// the side tables of `PreparedMethod` (constants, call sites, ...).
+///
+/// The list is kept as an X-macro so the threaded interpreter can build its
+/// label table in enum order.
+#define OBJECTIR_BYTECODE_OPS(X) \
+    X(Nop)                                                                           \
+    X(Dup)                                                                           \
+    X(Pop)                                                                           \
+    X(LdArg)        /* a = argument slot */                                          \
+    X(LdThis)                                                                        \
+    X(StArg)        /* a = argument slot */                                          \
+    X(LdLoc)        /* a = local slot */                                             \
+    X(StLoc)        /* a = local slot */                                             \
+    X(LdFld)        /* a = field site */                                             \
+    X(StFld)        /* a = field site */                                             \
+    X(LdConst)      /* a = constant index */                                         \
+    X(LdNull)                                                                        \
+    X(Add)                                                                           \
+    X(Sub)                                                                           \
+    X(Mul)                                                                           \
+    X(Div)                                                                           \
+    X(Rem)                                                                           \
+    X(Neg)                                                                           \
+    X(Ceq)                                                                           \
+    X(Cne)                                                                           \
+    X(Clt)                                                                           \
+    X(Cle)                                                                           \
+    X(Cgt)                                                                           \
+    X(Cge)                                                                           \
+    X(Ret)                                                                           \
+    X(Br)           /* a = target */                                                 \
+    X(BrTrue)       /* a = target */                                                 \
+    X(BrFalse)      /* a = target */                                                 \
+    X(Beq)          /* a = target */                                                 \
+    X(Bne)          /* a = target */                                                 \
+    X(Bgt)          /* a = target */                                                 \
+    X(Blt)          /* a = target */                                                 \
+    X(Bge)          /* a = target */                                                 \
+    X(Ble)          /* a = target */                                                 \
+    X(NewObj)       /* a = type site */                                              \
+    X(NewArr)       /* a = type site */                                              \
+    X(LdLen)                                                                         \
+    X(LdElem)                                                                        \
+    X(StElem)                                                                        \
+    X(CastClass)    /* a = type site */                                              \
+    X(IsInst)       /* a = type site */                                              \
+    X(Call)         /* a = call site */                                              \
+    X(CallVirt)     /* a = call site */                                              \
+    X(Fail)         /* a = message index; throws std::runtime_error(message) */      \
+    X(InlineGuard)  /* a = target if the call changed, b = inlined call index */     \
+    X(Throw)        /* throws the value on top of the stack as an IRException */     \
+    X(Leave)        /* a = leave site */                                             \
+    X(EndFinally)                                                                    \
+    /* Calls directly followed by Ret, marked once the body is prepared: the */      \
+    /* callee reuses the caller's frame where it can (see MarkTailCalls) */          \
+    X(TailCall)     /* a = call site */                                              \
+    X(TailCallVirt) /* a = call site */                                              \
+    /* Quickened forms: rewritten in place from the generic op the first time */     \
+    /* it sees matching operand tags, and back when the tag guard fails */           \
+    X(AddI32)                                                                        \
+    X(SubI32)                                                                        \
+    X(MulI32)                                                                        \
+    X(AddF64)                                                                        \
+    X(SubF64)                                                                        \
+    X(MulF64)                                                                        \
+    X(DivF64)                                                                        \
+    X(CeqI32)                                                                        \
+    X(CneI32)                                                                        \
+    X(CltI32)                                                                        \
+    X(CleI32)                                                                        \
+    X(CgtI32)                                                                        \
+    X(CgeI32)                                                                        \
+    X(BeqI32)       /* a = target */                                                 \
+    X(BneI32)       /* a = target */                                                 \
+    X(BgtI32)       /* a = target */                                                 \
+    X(BltI32)       /* a = target */                                                 \
+    X(BgeI32)       /* a = target */                                                 \
+    X(BleI32)       /* a = target */                                                 \
+    X(BrTrueBool)   /* a = target */                                                 \
+    X(BrFalseBool)  /* a = target */                                                 \
+    /* Unchecked int32 forms, only emitted into PreparedMethod::verifiedCode */      \
+    X(AddI32Unchecked)                                                               \
+    X(SubI32Unchecked)                                                               \
+    X(MulI32Unchecked)                                                               \
+    X(CeqI32Unchecked)                                                               \
+    X(CneI32Unchecked)                                                               \
+    X(CltI32Unchecked)                                                               \
+    X(CleI32Unchecked)                                                               \
+    X(CgtI32Unchecked)                                                               \
+    X(CgeI32Unchecked)                                                               \
+    X(BeqI32Unchecked) /* a = target */                                              \
+    X(BneI32Unchecked) /* a = target */                                              \
+    X(BgtI32Unchecked) /* a = target */                                              \
+    X(BltI32Unchecked) /* a = target */                                              \
+    X(BgeI32Unchecked) /* a = target */                                              \
+    X(BleI32Unchecked) /* a = target */                                              \
+    /* Superinstructions: a/b of the first instruction, further operands are */      \
+    /* read from the instructions that follow (see FuseSuperinstructions) */         \
+    X(LdLocLdConstArithStLoc)   /* b = arithmetic op */                              \
+    X(LdLocLdLocArithStLoc)     /* b = arithmetic op */                              \
+    X(LdLocLdArgBranch)         /* b = compare-branch op */                          \
+    X(LdLocLdConstBranch)       /* b = compare-branch op */                          \
+    X(LdLocLdLocBranch)         /* b = compare-branch op */                          \
+    X(LdLocLdConstArith)        /* b = arithmetic op */                              \
+    X(LdLocLdLocArith)          /* b = arithmetic op */                              \
+    X(LdThisLdFld)                                                                   \
+    X(LdLocLdFld)                                                                    \
+    X(LdConstStLoc)
+
+enum class BytecodeOp : uint16_t {
+#define OBJECTIR_BYTECODE_ENUM_ENTRY(name) name,
+    OBJECTIR_BYTECODE_OPS(OBJECTIR_BYTECODE_ENUM_ENTRY)
+#undef OBJECTIR_BYTECODE_ENUM_ENTRY
+};
+
+#define OBJECTIR_BYTECODE_COUNT_ENTRY(name) +1
+constexpr size_t kBytecodeOpCount = 0 OBJECTIR_BYTECODE_OPS(OBJECTIR_BYTECODE_COUNT_ENTRY);
+#undef OBJECTIR_BYTECODE_COUNT_ENTRY
+
+/// Name of `op` as spelled in OBJECTIR_BYTECODE_OPS.
+OBJECTIR_API const char* GetBytecodeOpName(BytecodeOp op);
+
+/// The generic op a quickened, unchecked or fused instruction stands for at
+/// its position in the stream (for a superinstruction, its first component).
+/// Generic ops map to themselves.
+OBJECTIR_API BytecodeOp GetGenericBytecodeOp(BytecodeOp op);
+
+/// A single prepared instruction.
+///
+/// For the generic arithmetic, compare and branch ops `b` is the quickening
+/// state: kQuickeningDisabled once a quickened form of the instruction failed
+/// its guard, after which it stays generic.
+struct BytecodeInstruction {
+    BytecodeOp op = BytecodeOp::Nop;
+    int32_t a = 0;
+    int32_t b = 0;
+};
+
+constexpr int32_t kQuickeningDisabled = 1;
+
+/// Number of receiver classes a CallVirt site remembers before it stops
+/// caching and always dispatches through the receiver's tables (megamorphic).
+constexpr size_t kCallSiteCacheSize = 4;
+
+/// One inline cache entry: calls on `receiver` dispatch to `method`.
+struct CallCacheEntry {
+    ClassRef receiver;
+    MethodRef method;
+};
+
+/// Call target of a Call/CallVirt instruction, with its per-site flags and
+/// inline cache.
+struct CallSite {
+    CallTarget target;
+    // target.declaringType and target.name, interned when the site is lowered.
+    SymbolId declaringType = kNoSymbol;
+    SymbolId name = kNoSymbol;
+    size_t argumentCount = 0;
+    bool isVoidReturn = false;
+    bool isConsoleWriteLine = false;
+
+    // Inline cache. Static calls use entry 0 (receiver = declaring class),
+    // virtual calls key entries on the receiver's class. Entries are valid
+    // while both the dispatch epoch and the class registry version match.
+    mutable CallCacheEntry cache[kCallSiteCacheSize];
+    mutable size_t cacheCount = 0;
+    mutable bool megamorphic = false;
+    mutable uint64_t cacheEpoch = 0;
+    mutable uint64_t cachedRegistryVersion = 0;
+
+    // Virtual dispatch on a cache miss: the vtable slot of the method the
+    // target resolves to in its declaring class (an interface table slot when
+    // that class is an interface), resolved once under the same validity
+    // rules. Receivers outside that class resolve by name through the VM.
+    mutable ClassRef slotClass;
+    mutable size_t slot = Method::kNoVTableSlot;
+    mutable bool slotResolved = false;
+};
+
+/// Field referenced by a LdFld/StFld instruction.
+struct FieldSite {
+    std::string name;
+    SymbolId symbol = kNoSymbol;
+
+    // Monomorphic cache: instances of `cachedClass` keep this field in
+    // `cachedSlot`. Class layouts never change once finalized, so the entry
+    // stays valid for as long as the class does.
+    mutable ClassRef cachedClass;
+    mutable size_t cachedSlot = 0;
+};
+
+/// Type operand of NewObj/NewArr/CastClass/IsInst.
+struct TypeSite {
+    std::string name;
+    std::string normalizedName;
+    SymbolId symbol = kNoSymbol;
+    SymbolId normalizedSymbol = kNoSymbol;
+
+    // Lazily resolved handles, valid while the VM's class registry version
+    // equals `cachedRegistryVersion`. A resolved class may be null (IsInst on
+    // an unknown type), hence the separate flags.
+    mutable ClassRef cachedClass;
+    mutable bool hasCachedClass = false;
+    mutable TypeReference cachedType;
+    mutable bool hasCachedType = false;
+    mutable uint64_t cachedRegistryVersion = 0;
+};
+
+/// Static type of an operand stack entry, local or argument as inferred by
+/// BytecodeVerifier. `Unknown` covers values whose type is only known at run
+/// time (fields, call results, merged paths with different types).
+enum class VerifiedType : uint8_t {
+    Unknown,
+    Null,
+    Int32,
+    Int64,
+    Float32,
+    Float64,
+    Bool,
+    String,
+    Object
+};
+
+/// Types of the operand stack, locals and arguments on entry to one
+/// instruction. `reached` is false for instructions no path leads to.
+struct VerifiedFrameState {
+    bool reached = false;
+    std::vector<VerifiedType> stack;
+    std::vector<VerifiedType> locals;
+    std::vector<VerifiedType> arguments;
+};
+
+/// A call BytecodeInliner replaced with the body of the method it resolved
+/// to. The InlineGuard in front of the body falls back to the original call
+/// (kept after the end of the caller's code) once that resolution changed.
+struct InlinedCall {
+    MethodRef method;
+    // The body that was inlined; the guard fails once the method has another.
+    std::shared_ptr<const std::vector<Instruction>> source;
+    // For a CallVirt, the sealed class the receiver must have.
+    ClassRef receiver;
+    uint32_t callSite = 0; // index of the original call site in callSites
+    uint32_t sourceIp = 0; // of the call in the caller's body
+    size_t argumentCount = 0;
+    int32_t thisSlot = -1; // local holding the receiver while the body runs
+
+    // Outcome of the last resolution check, valid while both the dispatch
+    // epoch and the class registry version match.
+    mutable uint64_t checkedEpoch = ~uint64_t{0};
+    mutable uint64_t checkedRegistryVersion = ~uint64_t{0};
+    mutable bool holds = false;
+};
+
+/// Catch type of a PreparedHandler that catches every thrown value.
+constexpr int32_t kCatchAnyType = -1;
+
+/// An exception handler of a prepared body (see ExceptionHandler), with its
+/// ranges in code indices.
+struct PreparedHandler {
+    ExceptionHandlerKind kind = ExceptionHandlerKind::Catch;
+    uint32_t tryStart = 0;
+    uint32_t tryEnd = 0;
+    uint32_t handlerStart = 0;
+    uint32_t handlerEnd = 0;
+    int32_t catchType = kCatchAnyType; // type site
+};
+
+/// Target of a Leave instruction, and the finally handlers (indices into
+/// PreparedMethod::handlers, innermost first) that run before control gets
+/// there: those whose protected range holds the Leave but not the target.
+/// A `ret` in a range a finally handler protects is lowered to a Leave that
+/// `returns`: it keeps the value on top of the stack while the handlers run
+/// and pushes it back at `target`, a Ret after the body.
+struct LeaveSite {
+    uint32_t target = 0;
+    std::vector<uint32_t> finallyHandlers;
+    bool returns = false;
+};
+
+class JitCode;
+
+/// The prepared form of a Method body.
+struct PreparedMethod {
+    // Quickening rewrites opcodes of `code` and `verifiedCode` in place while
+    // the body runs; operands and the stream length never change.
+    mutable std::vector<BytecodeInstruction> code;
+    // Index of the method body instruction every entry of `code` was lowered
+    // from (diagnostics). While/If bodies map to the While/If instruction.
+    std::vector<uint32_t> sourceIps;
+
+    std::vector<Value> constants;
+    std::vector<CallSite> callSites;
+    std::vector<FieldSite> fieldSites;
+    std::vector<TypeSite> typeSites;
+    std::vector<std::string> messages;
+
+    // Inlining (see BytecodeInliner). Code spliced in for inlinedCalls[i] has
+    // inlineFrames[pc] == i + 1 and the callee's source ips; the method's own
+    // code has 0. Both are empty when nothing was inlined.
+    std::vector<InlinedCall> inlinedCalls;
+    std::vector<uint32_t> inlineFrames;
+
+    // Exception handling. Protected ranges are code indices, which the
+    // inliner and the optimizer do not track: bodies with handlers or Leave
+    // instructions skip both, and are never compiled to native code.
+    std::vector<PreparedHandler> handlers;
+    std::vector<LeaveSite> leaveSites;
+    [[nodiscard]] bool HasExceptionHandling() const { return !handlers.empty() || !leaveSites.empty(); }
+
+    size_t argumentCount = 0;
+    // Locals of the frame: the method's own, then scratch slots inlined
+    // bodies keep their arguments and locals in.
+    size_t localCount = 0;
+
+    // Verification results (see BytecodeVerifier). A verified body has a fixed
+    // stack depth at every instruction, never underflows and never reaches a
+    // Fail. `verifiedCode` is `code` with the operations whose operand types
+    // were proven rewritten into unchecked typed forms; it is only valid for
+    // frames whose arguments match `argumentTypes` (Unknown matches anything).
+    bool verified = false;
+    std::string verificationError;
+    size_t maxStackDepth = 0;
+    std::vector<VerifiedType> argumentTypes;
+    mutable std::vector<BytecodeInstruction> verifiedCode;
+
+    // Tier the body was prepared for (see TieredExecution). Interpreter-tier
+    // code is lowered and verified only, and never quickens.
+    ExecutionTier tier = ExecutionTier::Optimized;
+
+    // Native tier (see JitCompiler). Once the method's profile reaches a
+    // threshold, verified frames compile the body to `nativeCode`; bodies the
+    // JIT cannot handle, or whose native code kept bailing out, are marked
+    // `nativeCodeRejected` and stay in the interpreter (rejected code is kept:
+    // outer frames may still run it).
+    mutable uint32_t nativeBailouts = 0;
+    mutable std::shared_ptr<JitCode> nativeCode;
+    mutable bool nativeCodeRejected = false;
+
+    // The instructions this stream was prepared from.
+    std::shared_ptr<const std::vector<Instruction>> source;
+};
+
+// ============================================================================
+// Bytecode Compiler - Lowers Method instructions into a PreparedMethod
+// ============================================================================
+
+class OBJECTIR_API BytecodeCompiler {
+public:
+    /// Prepare the instructions of `method`. Names that cannot be resolved are
+    /// compiled into instructions that fail with the same error the tree walker
+    /// would report, so preparing never throws for malformed bodies. With a
+    /// `vm`, the calls BytecodeInliner can resolve in it are inlined. The
+    /// Interpreter tier skips everything but lowering and verification.
+    static std::shared_ptr<PreparedMethod> Compile(
+        const Method& method,
+        VirtualMachine* vm = nullptr,
+        ExecutionTier tier = ExecutionTier::Optimized
+    );
+
+    /// Fuse common instruction sequences into superinstructions (default on).
+    /// Affects methods prepared after the call.
+    static void SetSuperinstructionsEnabled(bool enabled);
+    [[nodiscard]] static bool AreSuperinstructionsEnabled();
+
+    /// Run calls in tail position in the caller's frame (default on), so
+    /// tail-recursive methods need no stack per call. The caller then no
+    /// longer shows up in call stacks and error messages of the callee.
+    /// Affects methods prepared after the call.
+    static void SetTailCallsEnabled(bool enabled);
+    [[nodiscard]] static bool AreTailCallsEnabled();
+
+private:
+    BytecodeCompiler() = default;
+};
+
+// ============================================================================
+// Dispatch Profile - Opcode counts of the prepared interpreter
+// ============================================================================
+
+/// How often `second` was dispatched right after `first` in the same frame.
+struct OpcodePairCount {
+    BytecodeOp first;
+    BytecodeOp second;
+    uint64_t count;
+};
+
+/// Counts every dispatch of InstructionExecutor::ExecutePrepared, and every
+/// pair of consecutive opcodes, while enabled. The pair counts are what the
+/// superinstruction table of BytecodeCompiler is derived from. Profiling is
+/// process-wide, not synchronized, and off by default.
+class OBJECTIR_API DispatchProfile {
+public:
+    static void SetEnabled(bool enabled);
+    [[nodiscard]] static bool IsEnabled();
+    static void Reset();
+
+    [[nodiscard]] static uint64_t GetDispatchCount();
+    /// Pairs seen since the last Reset, most frequent first.
+    [[nodiscard]] static std::vector<OpcodePairCount> GetPairCounts();
+
+private:
+    DispatchProfile() = default;
+};
+
+// ============================================================================
+// Bytecode Verifier - Stack depth and type inference over prepared code
+// ============================================================================
+
+class OBJECTIR_API BytecodeVerifier {
+public:
+    /// Verify `prepared` (compiled from `method`) and record the result in its
+    /// verification fields. Never throws: a body that fails verification keeps
+    /// `verified == false` and the reason in `verificationError`, and runs on
+    /// the checked interpreter path.
+    static void Verify(const Method& method, PreparedMethod& prepared);
+
+    /// Run the analysis of Verify over `code` (a stream of generic ops with the
+    /// layout of `prepared.code`) and return the frame state at every
+    /// instruction. With `trustCallResults` the result of a call is typed by
+    /// the return type its call site declares instead of Unknown; callers must
+    /// check that assumption at run time. Returns false, with the reason in
+    /// `error`, when the stream does not verify.
+    static bool InferFrameStates(
+        const Method& method,
+        const PreparedMethod& prepared,
+        const std::vector<BytecodeInstruction>& code,
+        bool trustCallResults,
+        std::vector<VerifiedFrameState>& states,
+        std::string& error
+    );
+
+private:
+    BytecodeVerifier() = default;
+};
+
+// ============================================================================
+// Bytecode Optimizer - Pass pipeline over freshly lowered code
+// ============================================================================
+
+/// Passes of BytecodeOptimizer in the order they run, with the names
+/// BytecodeOptimizer::Configure accepts.
+#define OBJECTIR_OPTIMIZER_PASSES(X)                                                     \
+    X(ConstantFolding, "const-fold")     /* ldc sequences, constant locals */            \
+    X(DeadStores, "dead-store")          /* stloc of a local no path reads again */      \
+    X(DeadCode, "dead-code")             /* loads whose value is popped right away */    \
+    X(DupPop, "dup-pop")                 /* dup immediately consumed by pop */           \
+    X(BranchThreading, "branch-thread")  /* jumps to jumps, to ret, to the next op */    \
+    X(UnreachableBlocks, "unreachable")  /* code no path from the entry reaches */
+
+enum class OptimizerPass : uint8_t {
+#define OBJECTIR_OPTIMIZER_ENUM_ENTRY(name, text) name,
+    OBJECTIR_OPTIMIZER_PASSES(OBJECTIR_OPTIMIZER_ENUM_ENTRY)
+#undef OBJECTIR_OPTIMIZER_ENUM_ENTRY
+};
+
+#define OBJECTIR_OPTIMIZER_COUNT_ENTRY(name, text) +1
+constexpr size_t kOptimizerPassCount = 0 OBJECTIR_OPTIMIZER_PASSES(OBJECTIR_OPTIMIZER_COUNT_ENTRY);
+#undef OBJECTIR_OPTIMIZER_COUNT_ENTRY
+
+/// What one pass did since the last BytecodeOptimizer::ResetStatistics.
+/// `changes` counts rewritten instructions (a folded sequence counts once).
+struct OptimizerPassStats {
+    OptimizerPass pass;
+    const char* name;
+    bool enabled;
+    uint64_t changes;
+};
+
+struct OptimizerStatistics {
+    uint64_t methods = 0;            // bodies the pipeline ran on
+    uint64_t instructionsBefore = 0; // their length after lowering
+    uint64_t instructionsAfter = 0;  // and after optimization
+    std::vector<OptimizerPassStats> passes;
+};
+
+/// Runs the enabled passes over the code of a method as BytecodeCompiler
+/// lowered it, before verification and superinstruction fusion, and drops
+/// the instructions they made redundant (branch targets and source ips are
+/// remapped). Only bodies whose stack depth is consistent on every path, and
+/// that have no exception handling, are touched; every transformation keeps the values, errors and stack depths
+/// the body produces, so any other body runs exactly as written.
+///
+/// Pass switches and statistics are process-wide; all passes are on by
+/// default, and changes affect methods prepared after the call.
+class OBJECTIR_API BytecodeOptimizer {
+public:
+    static void Optimize(const Method& method, PreparedMethod& prepared);
+
+    static void SetPassEnabled(OptimizerPass pass, bool enabled);
+    [[nodiscard]] static bool IsPassEnabled(OptimizerPass pass);
+    /// Name of `pass` as spelled in OBJECTIR_OPTIMIZER_PASSES.
+    [[nodiscard]] static const char* GetPassName(OptimizerPass pass);
+
+    /// Apply a comma-separated list of switches, left to right: `all` or
+    /// `none` (also `on`/`off`), a pass name to enable it, or `-name` to
+    /// disable it. Throws std::runtime_error for an unknown entry.
+    static void Configure(const std::string& spec);
+
+    [[nodiscard]] static OptimizerStatistics GetStatistics();
+    static void ResetStatistics();
+
+private:
+    BytecodeOptimizer() = default;
+};
+
+// ============================================================================
+// Bytecode Inliner - Splices small callees into their callers at load time
+// ============================================================================
+
+/// Replaces calls of small methods with their bodies: Call sites of static
+/// methods, and CallVirt sites whose declaring class is sealed (see
+/// Class::IsSealed). Only verified callees that fit the size budget are
+/// inlined, one level deep, and only if they use 'this' in ways the caller's
+/// frame can reproduce (fields are read and written through `ldarg this`).
+///
+/// Each inlined body keeps its arguments and locals in scratch locals of the
+/// caller and is entered through an InlineGuard, which runs the original call
+/// instead when the receiver has another class or the call would no longer
+/// resolve to the inlined body (methods replaced, native implementations
+/// installed). Errors raised by inlined code report the callee and its ip,
+/// wrapped by the caller's call, as a real call would.
+///
+/// Switches are process-wide; inlining is on by default.
+class OBJECTIR_API BytecodeInliner {
+public:
+    /// Re-prepare the method bodies of `vm` that have calls to inline. The
+    /// module loaders call this once all classes are registered; code that
+    /// builds classes by hand can call it when it is done. Bodies at the
+    /// Interpreter tier are left alone (TieredExecution inlines into them as
+    /// it optimizes them). Returns the number of calls inlined.
+    static size_t InlineCalls(VirtualMachine& vm);
+
+    /// Splice the calls of `method` that can be inlined into `prepared`, its
+    /// freshly lowered code (see BytecodeCompiler::Compile). Bodies with
+    /// exception handling are neither inlined into nor inlined. Returns the
+    /// number of calls inlined.
+    static size_t Inline(VirtualMachine& vm, const Method& method, PreparedMethod& prepared);
+
+    static void SetEnabled(bool enabled);
+    [[nodiscard]] static bool IsEnabled();
+
+    /// Largest callee inlined, in prepared instructions (default 16), and the
+    /// most instructions inlining may add to one caller (default 256).
+    static void SetBudget(size_t calleeInstructions, size_t callerGrowth);
+    [[nodiscard]] static size_t GetCalleeBudget();
+    [[nodiscard]] static size_t GetCallerGrowthBudget();
+
+    /// Apply a switch: `on`, `off`, or a number to enable inlining with that
+    /// callee budget. Throws std::runtime_error for anything else.
+    static void Configure(const std::string& spec);
+
+private:
+    BytecodeInliner() = default;
+};
+
+// ============================================================================
+// Tiered Execution - Promotes hot methods from the interpreter to native code
+// ============================================================================
+
+/// Methods start at ExecutionTier::Interpreter: their bodies are lowered and
+/// verified, nothing more, so code that runs once costs no optimization. A
+/// method whose profile (see Method::GetProfile) reaches the optimize
+/// thresholds is re-prepared at ExecutionTier::Optimized, and its following
+/// calls run that body. Reaching the JitCompiler thresholds compiles the body
+/// a verified frame runs to native code, entered at the next call or loop
+/// header, which also moves loops of long-running frames off the interpreter.
+///
+/// Switches are process-wide. With tiering off, every body is prepared at the
+/// Optimized tier right away; the JIT thresholds still apply.
+class OBJECTIR_API TieredExecution {
+public:
+    /// Affects methods prepared after the call (default on).
+    static void SetEnabled(bool enabled);
+    [[nodiscard]] static bool IsEnabled();
+
+    /// Invocations of a method, or back edges taken in its loops, after
+    /// which it is optimized (defaults 16 and 1000). Native code follows at
+    /// JitCompiler::SetThresholds.
+    static void SetThresholds(uint32_t invocations, uint32_t backEdges);
+    [[nodiscard]] static uint32_t GetInvocationThreshold();
+    [[nodiscard]] static uint32_t GetBackEdgeThreshold();
+
+    /// Tier new method bodies are prepared at.
+    [[nodiscard]] static ExecutionTier GetInitialTier();
+
+    /// Body a new frame of `method` runs: counts the invocation, and
+    /// optimizes the method once that makes it hot.
+    static std::shared_ptr<PreparedMethod> Enter(Method& method, VirtualMachine* vm);
+
+    /// Re-prepare `method` at the Optimized tier unless it already is past
+    /// the Interpreter tier, inlining calls resolved in `vm` if given.
+    /// Returns the current body.
+    static std::shared_ptr<PreparedMethod> Optimize(Method& method, VirtualMachine* vm);
+    /// Optimize every method of `vm` that has a body.
+    static void OptimizeAll(VirtualMachine& vm);
+
+    /// Apply a comma-separated list of switches: `on`, `off`,
+    /// `optimize=<calls>`, `optimize-loops=<back edges>`, `native=<calls>`,
+    /// `native-loops=<back edges>`. Throws std::runtime_error for anything
+    /// else.
+    static void Configure(const std::string& spec);
+
+private:
+    TieredExecution() = default;
+};
+
+} // namespace ObjectIR
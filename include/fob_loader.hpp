@@ -67,6 +67,15 @@ namespace ObjectIR
         uint32_t typeIndex;
     };
 
+    struct FOBExceptionHandler {
+        uint8_t kind;               // 0x01 = Catch, 0x02 = Finally
+        uint32_t tryStart;
+        uint32_t tryEnd;
+        uint32_t handlerStart;
+        uint32_t handlerEnd;
+        uint32_t catchTypeIndex;    // 0xFFFFFFFF = any
+    };
+
     struct FOBMethodDefinition {
         uint32_t nameIndex;
         uint32_t returnTypeIndex;
@@ -75,6 +84,7 @@ namespace ObjectIR
         std::vector<FOBParameterDefinition> parameters;
         std::vector<FOBLocalDefinition> locals;
         std::vector<uint32_t> instructionOffsets;
+        std::vector<FOBExceptionHandler> exceptionHandlers;
     };
 
     struct FOBTypeDefinition {
@@ -112,6 +122,8 @@ namespace ObjectIR
         static std::vector<FOBTypeDefinition> ParseTypesSection(std::istream &stream, const SectionHeader &section);
         static std::vector<FOBInstruction> ParseCodeSection(std::istream &stream, const SectionHeader &section);
         static std::vector<FOBConstant> ParseConstantsSection(std::istream &stream, const SectionHeader &section);
+        /// Attaches the handler tables of the .exceptions section to `types`.
+        static void ParseExceptionsSection(std::istream &stream, const SectionHeader &section, std::vector<FOBTypeDefinition> &types);
 
         // Helper methods
         static uint32_t ReadU32(std::istream &stream);
@@ -8,6 +8,39 @@ namespace ObjectIR {
 
 using json = nlohmann::json;
 
+// ============================================================================
+// IR Exceptions - Values thrown by IR code and errors unwinding through it
+// ============================================================================
+
+/// An exception raised while IR code runs: a value thrown by `throw`, or a
+/// runtime error, which IR handlers see as its message string. Each IR frame
+/// the exception leaves records where it was; the "VM error in method ..."
+/// context what() reports is only formatted from those records when asked
+/// for. Copies share one state, so passing the exception on copies nothing.
+class OBJECTIR_API IRException : public std::runtime_error {
+public:
+    /// A runtime error.
+    explicit IRException(const std::string& message);
+    /// The value of an IR `throw`.
+    static IRException FromValue(Value value);
+
+    [[nodiscard]] const Value& GetValue() const;
+    /// The message without the frames the exception went through.
+    [[nodiscard]] const std::string& GetMessage() const;
+    /// Record that the exception left a frame of `method` at instruction `ip`
+    /// of `source` (innermost frame first).
+    void AddFrame(const MethodRef& method, size_t ip, std::shared_ptr<const std::vector<Instruction>> source);
+    [[nodiscard]] size_t GetFrameCount() const;
+
+    [[nodiscard]] const char* what() const noexcept override;
+
+private:
+    struct State;
+    IRException(const std::string& message, Value value);
+
+    std::shared_ptr<State> _state;
+};
+
 // ============================================================================
 // Instruction Executor - Executes IR instructions at runtime
 // ============================================================================
@@ -37,6 +70,63 @@ public:
         VirtualMachine* vm,
         const std::unordered_map<std::string, size_t>& labelMap = {}
     );
+
+    /// Execute a method body prepared by BytecodeCompiler
+    static Value ExecutePrepared(
+        const PreparedMethod& prepared,
+        ObjectRef thisPtr,
+        const std::vector<Value>& args,
+        ExecutionContext* context,
+        VirtualMachine* vm
+    );
+
+    /// Execute a prepared body in a context that already holds its arguments
+    static Value ExecutePrepared(
+        const PreparedMethod& prepared,
+        ObjectRef thisPtr,
+        ExecutionContext* context,
+        VirtualMachine* vm
+    );
+
+    /// Perform the call of a prepared call site whose arguments (below them,
+    /// for a virtual call, the instance) are on top of the operand stack, and
+    /// push its result. Shared by the interpreter and native code.
+    static void ExecuteCallSite(
+        const CallSite& site,
+        bool isVirtual,
+        ExecutionContext* context,
+        VirtualMachine* vm
+    );
+
+    /// Perform a static call of a prepared call site with explicit arguments
+    /// and return its result (null for a void call). Used by precompiled
+    /// method bodies (see AotCompiler).
+    static Value InvokeStaticCallSite(
+        const CallSite& site,
+        const std::vector<Value>& args,
+        VirtualMachine* vm
+    );
+
+    /// Stackless calls (default on): a call from one IR method to another
+    /// pushes the callee's frame on the VM's frame stack and ExecutePrepared
+    /// continues with it in the same dispatch loop, so IR recursion depth is
+    /// not bounded by the native stack. Native methods and native code
+    /// (see JitCompiler) still call on the native stack.
+    static void SetStacklessCallsEnabled(bool enabled);
+    static bool AreStacklessCallsEnabled();
+
+    /// Dispatch strategy ExecutePrepared was built with ("threaded" or "switch")
+    static const char* GetDispatchMode();
+
+    /// Build the value pushed by a LdCon/LdStr instruction
+    static Value CreateConstantValue(const Instruction& instr);
+
+    /// Apply the arithmetic or compare `op` (Add..Neg, Ceq..Cge) to constant
+    /// operands with the interpreter's own handlers; for a branch (BrTrue,
+    /// BrFalse, Beq..Ble) the result is whether it is taken. Returns false,
+    /// leaving `result` alone, when the operation would fail at run time or
+    /// its outcome depends on the target (integer division by zero or -1).
+    static bool EvaluateConstantOp(OpCode op, const Value* operands, size_t count, Value& result);
     
 private:
     InstructionExecutor() = default;
@@ -60,12 +150,36 @@ private:
     // Helper to convert values to double for arithmetic
     static double ValueToDouble(const Value& v);
     static int64_t ValueToInt64(const Value& v);
-    static bool EvaluateCondition(
+    static bool ValueToBool(const Value& value);
+    static bool CompareBranch(OpCode cmp, const Value& left, const Value& right);
+
+    // Structured control flow of the tree walker. Break/Continue are reported
+    // to the enclosing While through the returned BlockExit.
+    enum class BlockExit { Normal, Break, Continue };
+
+    static BlockExit ExecuteBlock(
+        const std::vector<Instruction>& block,
+        ExecutionContext* context,
+        VirtualMachine* vm
+    );
+    static BlockExit ExecuteStructured(
+        const Instruction& instr,
+        ExecutionContext* context,
+        VirtualMachine* vm
+    );
+    static BlockExit EvaluateCondition(
         const Instruction::ConditionData& condition,
         ExecutionContext* context,
+        VirtualMachine* vm,
+        bool& result
+    );
+    static void ExecuteBinaryWhile(
+        const Instruction::WhileData& whileData,
+        const Instruction* setupInstructions,
+        size_t setupCount,
+        ExecutionContext* context,
         VirtualMachine* vm
     );
-    static bool ValueToBool(const Value& value);
 };
 
 } // namespace ObjectIR
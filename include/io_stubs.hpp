@@ -70,6 +70,8 @@ Value File_ReadAllText(ObjectRef thisPtr, const std::vector<Value>& args, Virtua
 Value File_WriteAllText(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
 Value File_ReadAllLines(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
 Value File_WriteAllLines(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value File_ReadAllBytes(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
+Value File_WriteAllBytes(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
 Value File_Delete(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm);
 
 } // namespace ObjectIR
\ No newline at end of file
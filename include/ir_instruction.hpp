@@ -80,6 +80,10 @@ enum class OpCode {
     Continue,
     Throw,
     While,
+
+    // Exception handling (see ExceptionHandler)
+    Leave,
+    EndFinally,
 };
 
 /// Represents the kind of structured condition used by high-level control flow
@@ -49,6 +49,13 @@ namespace ObjectIR
             std::shared_ptr<VirtualMachine> vm,
             const json &typeJson);
 
+        /// Link the base class and interfaces named by a loaded class or
+        /// interface definition
+        static void LinkTypeDefinition(std::shared_ptr<VirtualMachine> vm, const json &typeJson);
+
+        /// The registered class called `name`, or null when there is none
+        static ClassRef FindLoadedClass(std::shared_ptr<VirtualMachine> vm, const std::string &name);
+
         /// Load a class definition
         static ClassRef LoadClass(
             std::shared_ptr<VirtualMachine> vm,
@@ -70,6 +77,14 @@ namespace ObjectIR
             const json &methodsArray,
             std::shared_ptr<VirtualMachine> vm);
 
+        /// Load the "exceptionHandlers" table of a method whose body has
+        /// `instructionCount` instructions. Offsets are instruction indices
+        /// or labels of `labelMap`.
+        static std::vector<ExceptionHandler> LoadExceptionHandlers(
+            const json &handlersArray,
+            const std::unordered_map<std::string, size_t> &labelMap,
+            size_t instructionCount);
+
         /// Load fields for a class
         static void LoadFields(
             ClassRef classRef,
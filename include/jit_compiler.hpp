@@ -0,0 +1,118 @@
+#pragma once
+
+#include "bytecode.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ObjectIR {
+
+// ============================================================================
+// JIT Compiler - Baseline native code for hot prepared methods
+// ============================================================================
+
+/// Native code of one prepared method, produced by JitCompiler.
+///
+/// The code works on the interpreter's frame in place: arguments, locals and
+/// the operand stack stay Values in the ExecutionContext's storage, and every
+/// instruction leaves them exactly as the interpreter would. Native code can
+/// therefore hand the frame back to the interpreter at any instruction: at a
+/// Ret, and wherever an assumption it was compiled under does not hold (a
+/// division by zero, a call returning another type than it declares).
+class OBJECTIR_API JitCode {
+public:
+    ~JitCode();
+    JitCode(const JitCode&) = delete;
+    JitCode& operator=(const JitCode&) = delete;
+
+    /// True when a frame about to execute instruction `pc` can continue in
+    /// native code: `pc` is the method entry or a loop header, and every slot
+    /// of the frame holds the type the code was compiled for.
+    [[nodiscard]] bool CanEnter(size_t pc, ExecutionContext& context) const;
+
+    /// Run the frame from `pc` (see CanEnter) until the code hands it back.
+    /// `pc` is then the instruction the interpreter continues with; the
+    /// frame's operand stack has the depth the interpreter expects there.
+    /// Exceptions thrown by a call propagate with `pc` at the call.
+    void Run(size_t& pc, ExecutionContext& context, VirtualMachine* vm) const;
+
+    /// True when leaving at `pc` is a return or a tail call (which the
+    /// interpreter makes) rather than a bail-out.
+    [[nodiscard]] bool IsReturn(size_t pc) const { return _returns[pc]; }
+
+    /// Bytes of machine code.
+    [[nodiscard]] size_t GetCodeSize() const { return _codeSize; }
+
+private:
+    friend class JitCompiler;
+
+    struct Frame;
+    struct EntryPoint {
+        size_t pc;
+        VerifiedFrameState state;
+    };
+
+    explicit JitCode(const PreparedMethod& prepared) : _prepared(prepared) {}
+
+    static int64_t CallFromNative(Frame* frame, int64_t pc) noexcept;
+
+    const PreparedMethod& _prepared;
+    void* _memory = nullptr;
+    size_t _mappedSize = 0;
+    size_t _codeSize = 0;
+
+    size_t _maxStackDepth = 0;
+    std::vector<uint32_t> _stackDepths;        // operand stack depth on entry, per instruction
+    std::vector<bool> _returns;                // instructions that are a Ret or TailCall
+    std::vector<VerifiedType> _callResultTypes; // declared result type, per call instruction
+    std::vector<EntryPoint> _entryPoints;
+};
+
+/// Baseline template JIT for x86-64.
+///
+/// Hot methods (see the thresholds below) whose body verified are compiled
+/// one instruction at a time into fixed machine code sequences, selected by
+/// the operand types the verifier inferred: int32 and float64 arithmetic,
+/// compares and branches, moves of primitive values, and static calls, which
+/// go back through InstructionExecutor::ExecuteCallSite and so reach IR and
+/// native stdlib methods alike. A body using anything else stays in the
+/// interpreter. So does a body whose hot path - its loops, or all of it
+/// without loops - is at least one eighth calls: each call leaves native code
+/// and enters the callee through the interpreter, which costs more than
+/// native code saves around it. The frame keeps its ExecutionContext, so
+/// diagnostics and stack traces see native frames like interpreted ones.
+///
+/// Only available on x86-64 Linux/FreeBSD builds with OBJECTIR_JIT; other
+/// builds always interpret.
+class OBJECTIR_API JitCompiler {
+public:
+    /// True when this build can generate native code for the host.
+    [[nodiscard]] static bool IsSupported();
+
+    /// Tier-up of hot methods (default on where supported). Affects frames
+    /// entered after the call.
+    static void SetEnabled(bool enabled);
+    [[nodiscard]] static bool IsEnabled();
+
+    /// Invocations of a method, or back edges taken in one of its loops,
+    /// after which it is compiled.
+    static void SetThresholds(uint32_t invocations, uint32_t backEdges);
+    [[nodiscard]] static uint32_t GetInvocationThreshold();
+    [[nodiscard]] static uint32_t GetBackEdgeThreshold();
+
+    /// Compile `prepared` (prepared from `method`). Returns nullptr, with the
+    /// reason in `error` if given, for bodies the JIT does not handle.
+    static std::shared_ptr<JitCode> Compile(
+        const Method& method,
+        const PreparedMethod& prepared,
+        std::string* error = nullptr
+    );
+
+private:
+    JitCompiler() = default;
+};
+
+} // namespace ObjectIR
@@ -0,0 +1,294 @@
+#pragma once
+
+// Support code for plugin sources generated by objectir_aot (see
+// AotCompiler). Not meant to be included by hand-written code.
+
+#include "aot_compiler.hpp"
+#include "bytecode.hpp"
+#include "instruction_executor.hpp"
+#include "objectir_plugin_api.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+    #define OBJECTIR_AOT_EXPORT extern "C" __declspec(dllexport)
+#else
+    #define OBJECTIR_AOT_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+namespace ObjectIR::Aot {
+
+struct Module;
+
+/// Checks the arguments of a call and runs the typed function generated for
+/// the method body, or the interpreter if they do not match.
+using EntryFn = Value (*)(Module&, ObjectRef, const std::vector<Value>&, VirtualMachine*);
+
+/// One precompiled method of a generated plugin.
+struct MethodInfo {
+    const char* className;
+    const char* signature;   // AotCompiler::Signature
+    uint64_t fingerprint;    // AotCompiler::Fingerprint
+    EntryFn entry;
+};
+
+/// Call site `site` of method `caller` that the generated code performs by
+/// calling the function of method `callee` directly.
+struct DirectCall {
+    size_t caller;
+    size_t site;
+    size_t callee;
+};
+
+/// The precompiled methods of a plugin, installed into one VM.
+struct Module {
+    VirtualMachine* vm = nullptr;
+    const std::vector<MethodInfo>* methods = nullptr;
+    const std::vector<DirectCall>* directCalls = nullptr;
+
+    // Per method: the installed method (null if it was not found or did not
+    // match), the body it was compiled from, and that body's prepared form,
+    // whose constants and call sites the generated code uses.
+    std::vector<std::weak_ptr<Method>> installed;
+    std::vector<const Method*> installedMethods;
+    std::vector<std::shared_ptr<const std::vector<Instruction>>> sources;
+    std::vector<std::shared_ptr<PreparedMethod>> prepared;
+
+    uint64_t checkedEpoch = ~uint64_t{0};
+    bool direct = false;
+
+    /// True while direct calls between precompiled methods are equivalent to
+    /// calls through the VM. Rechecked whenever the dispatch epoch changed.
+    bool Direct() {
+        const uint64_t epoch = VirtualMachine::GetDispatchEpoch();
+        if (epoch != checkedEpoch) {
+            checkedEpoch = epoch;
+            direct = CheckDirectCalls();
+        }
+        return direct;
+    }
+
+    const Value& Constant(size_t method, int32_t index) const { return prepared[method]->constants[index]; }
+    const CallSite& Site(size_t method, int32_t index) const { return prepared[method]->callSites[index]; }
+
+    Value Interpret(size_t method, ObjectRef self, const std::vector<Value>& args, VirtualMachine* callVm) const {
+        auto target = installed[method].lock();
+        if (!target) {
+            throw std::runtime_error(std::string("Precompiled method is gone: ") + (*methods)[method].signature);
+        }
+        return callVm->InvokeBytecode(target, std::move(self), args);
+    }
+
+    bool Owns(size_t method) const;
+
+private:
+    bool CheckDirectCalls() const {
+        for (size_t i = 0; i < installedMethods.size(); ++i) {
+            if (installedMethods[i] && !Owns(i)) {
+                return false;
+            }
+        }
+        for (const DirectCall& call : *directCalls) {
+            if (!installedMethods[call.caller]) {
+                continue;
+            }
+            if (!installedMethods[call.callee]) {
+                return false;
+            }
+            const CallTarget& target = Site(call.caller, static_cast<int32_t>(call.site)).target;
+            try {
+                if (vm->ResolveMethod(vm->GetClass(target.declaringType), target, true).get() !=
+                    installedMethods[call.callee]) {
+                    return false;
+                }
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/// The native implementation installed for a precompiled method.
+struct Entry {
+    std::shared_ptr<Module> module;
+    size_t index = 0;
+
+    Value operator()(ObjectRef self, const std::vector<Value>& args, VirtualMachine* vm) const {
+        auto method = module->installed[index].lock();
+        if (method && method->GetSharedInstructions() != module->sources[index]) {
+            // The body was replaced after the plugin was loaded.
+            return vm->InvokeBytecode(method, std::move(self), args);
+        }
+        return (*module->methods)[index].entry(*module, std::move(self), args, vm);
+    }
+};
+
+inline bool Module::Owns(size_t method) const {
+    auto target = installed[method].lock();
+    if (!target || target->GetSharedInstructions() != sources[method]) {
+        return false;
+    }
+    const Entry* entry = target->GetNativeImpl().target<Entry>();
+    return entry && entry->module.get() == this && entry->index == method;
+}
+
+/// Install the methods of a generated plugin whose fingerprint matches the
+/// loaded module; the others stay interpreted. Returns the installed module.
+inline std::shared_ptr<Module> Install(
+    VirtualMachine* vm,
+    const std::vector<MethodInfo>& methods,
+    const std::vector<DirectCall>& directCalls,
+    const char* pluginName
+) {
+    auto module = std::make_shared<Module>();
+    module->vm = vm;
+    module->methods = &methods;
+    module->directCalls = &directCalls;
+    module->installed.resize(methods.size());
+    module->installedMethods.resize(methods.size(), nullptr);
+    module->sources.resize(methods.size());
+    module->prepared.resize(methods.size());
+
+    size_t mismatched = 0;
+    for (size_t i = 0; i < methods.size(); ++i) {
+        const MethodInfo& info = methods[i];
+        MethodRef match;
+        if (vm->HasClass(info.className)) {
+            for (const auto& method : vm->GetClass(info.className)->GetAllMethods()) {
+                if (method && method->HasInstructions() && AotCompiler::Signature(*method) == info.signature) {
+                    match = method;
+                    break;
+                }
+            }
+        }
+        if (match) {
+            // Precompiled bodies were generated from the Optimized tier.
+            TieredExecution::Optimize(*match, vm);
+        }
+        if (!match || AotCompiler::Fingerprint(*match) != info.fingerprint) {
+            ++mismatched;
+            continue;
+        }
+        module->installed[i] = match;
+        module->installedMethods[i] = match.get();
+        module->sources[i] = match->GetSharedInstructions();
+        module->prepared[i] = match->GetPrepared();
+    }
+
+    for (size_t i = 0; i < methods.size(); ++i) {
+        if (auto method = module->installed[i].lock()) {
+            method->SetNativeImpl(Entry{module, i});
+        }
+    }
+
+    if (mismatched != 0) {
+        std::fprintf(stderr, "[%s] %zu of %zu precompiled methods do not match the loaded module and stay interpreted\n",
+                     pluginName, mismatched, methods.size());
+    }
+    return module;
+}
+
+/// Give the methods of `module` back to the interpreter.
+inline void Uninstall(Module& module) {
+    for (size_t i = 0; i < module.installed.size(); ++i) {
+        if (module.Owns(i)) {
+            module.installed[i].lock()->SetNativeImpl(nullptr);
+        }
+    }
+}
+
+// Operations of the generated code. int32/int64 arithmetic wraps around, as
+// it does in the interpreter's handlers on every supported target.
+
+inline int32_t AddI32(int32_t a, int32_t b) { return static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b)); }
+inline int32_t SubI32(int32_t a, int32_t b) { return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b)); }
+inline int32_t MulI32(int32_t a, int32_t b) { return static_cast<int32_t>(static_cast<uint32_t>(a) * static_cast<uint32_t>(b)); }
+inline int32_t NegI32(int32_t a) { return static_cast<int32_t>(0u - static_cast<uint32_t>(a)); }
+inline int64_t AddI64(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }
+inline int64_t SubI64(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }
+inline int64_t MulI64(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b)); }
+inline int64_t NegI64(int64_t a) { return static_cast<int64_t>(0u - static_cast<uint64_t>(a)); }
+
+inline int32_t DivI32(int32_t a, int32_t b) {
+    if (b == 0) throw std::runtime_error("Division by zero");
+    return b == -1 ? NegI32(a) : a / b;
+}
+
+inline int32_t RemI32(int32_t a, int32_t b) {
+    if (b == 0) throw std::runtime_error("Division by zero");
+    return b == -1 ? 0 : a % b;
+}
+
+inline int64_t DivI64(int64_t a, int64_t b) {
+    if (b == 0) throw std::runtime_error("Division by zero");
+    return b == -1 ? NegI64(a) : a / b;
+}
+
+inline int64_t RemI64(int64_t a, int64_t b) {
+    if (b == 0) throw std::runtime_error("Division by zero");
+    return b == -1 ? 0 : a % b;
+}
+
+inline double F64(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline bool StringEquals(const Value& a, const Value& b) { return a.AsStringRef() == b.AsStringRef(); }
+inline bool StringTruthy(const Value& value) { return !value.AsStringRef().empty(); }
+
+inline Value Box(int32_t value) { return Value(value); }
+inline Value Box(int64_t value) { return Value(value); }
+inline Value Box(double value) { return Value(value); }
+inline Value Box(bool value) { return Value(value); }
+inline const Value& Box(const Value& value) { return value; }
+
+[[noreturn]] inline void ThrowResultMismatch(const CallSite& site) {
+    throw std::runtime_error("Call to " + site.target.declaringType + "." + site.target.name +
+                             " did not return its declared " + site.target.returnType);
+}
+
+/// Result of a call made through the VM, which must have the declared type
+/// the caller's code was compiled for.
+template <typename T> T Expect(const Value& value, const CallSite& site);
+
+template <> inline int32_t Expect<int32_t>(const Value& value, const CallSite& site) {
+    if (!value.IsInt32()) ThrowResultMismatch(site);
+    return value.UncheckedInt32();
+}
+
+template <> inline int64_t Expect<int64_t>(const Value& value, const CallSite& site) {
+    if (!value.IsInt64()) ThrowResultMismatch(site);
+    return value.AsInt64();
+}
+
+template <> inline double Expect<double>(const Value& value, const CallSite& site) {
+    if (!value.IsFloat64()) ThrowResultMismatch(site);
+    return value.UncheckedFloat64();
+}
+
+template <> inline bool Expect<bool>(const Value& value, const CallSite& site) {
+    if (!value.IsBool()) ThrowResultMismatch(site);
+    return value.UncheckedBool();
+}
+
+/// ObjectIR_PluginGetInfo of a generated plugin: any v1 runtime.
+inline int32_t GetPluginInfo(ObjectIR_PluginInfoV1* outInfo, const char* pluginName) {
+    if (!outInfo) return 0;
+    outInfo->structSize = sizeof(ObjectIR_PluginInfoV1);
+    outInfo->abiMinPacked = OBJECTIR_PLUGIN_ABI_PACKED(1u, 0u);
+    outInfo->abiMaxPacked = OBJECTIR_PLUGIN_ABI_PACKED(1u, 0xFFFFu);
+    outInfo->pluginName = pluginName;
+    outInfo->pluginVersion = "1.0.0";
+    return 1;
+}
+
+} // namespace ObjectIR::Aot
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "ir_instruction.hpp"
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <unordered_map>
@@ -11,6 +13,7 @@
 #include <variant>
 #include <type_traits>
 #include <cstdint>
+#include <atomic>
 // Windows headers sometimes leak macros that collide with common identifiers.
 // Keep the runtime headers resilient even if included after <windows.h>.
 #if defined(interface)
@@ -55,12 +58,44 @@ namespace ObjectIR
     class Field;
     class VirtualMachine;
     class ExecutionContext;
+    struct PreparedMethod;
+    struct CallSite;
 
     using ObjectRef = std::shared_ptr<Object>;
     using ClassRef = std::shared_ptr<Class>;
     using MethodRef = std::shared_ptr<Method>;
     using FieldRef = std::shared_ptr<Field>;
 
+    // ============================================================================
+    // Symbols - Interned names
+    // ============================================================================
+
+    /// Compact id of an interned class, method, field, local or argument name.
+    using SymbolId = uint32_t;
+    constexpr SymbolId kNoSymbol = static_cast<SymbolId>(-1);
+
+    /// Process-wide table of interned names, shared by every VM. Classes,
+    /// methods, fields, parameters and locals intern their names when they are
+    /// created and prepared code interns the names it refers to, so registries
+    /// are keyed on SymbolId and lookups at run time compare integers; names
+    /// are only hashed where they enter through the load or embedding APIs.
+    /// Ids are never reused. Thread-safe.
+    class OBJECTIR_API SymbolTable
+    {
+    public:
+        /// Id of `name`, interning it on first use.
+        static SymbolId Intern(std::string_view name);
+        /// Id of `name` if it was interned, otherwise kNoSymbol. Never grows the
+        /// table, so lookups of unknown names cost nothing later.
+        [[nodiscard]] static SymbolId Find(std::string_view name);
+        /// Name of `symbol`; throws std::out_of_range for an unknown id.
+        [[nodiscard]] static const std::string &GetName(SymbolId symbol);
+        [[nodiscard]] static size_t GetCount();
+
+    private:
+        SymbolTable() = default;
+    };
+
     // ============================================================================
     // Type System
     // ============================================================================
@@ -85,6 +120,7 @@ namespace ObjectIR
     public:
         TypeReference() = default;
         TypeReference(const TypeReference& other);
+        TypeReference& operator=(const TypeReference& other) = default;
         explicit TypeReference(PrimitiveType primitive);
         explicit TypeReference(ClassRef classType);
 
@@ -119,42 +155,152 @@ namespace ObjectIR
     // ============================================================================
 
     /// Represents a runtime value that can be stored on the stack
+    ///
+    /// A Value is 16 bytes: a type tag and an 8-byte payload. Primitives are
+    /// copied bit for bit. Strings are immutable, reference-counted buffers
+    /// shared between copies, and objects are held through an intrusive count
+    /// on the Object (see Object::RetainValueReference), so copying a Value
+    /// never allocates.
     class OBJECTIR_API Value
     {
     public:
-        Value();
-        explicit Value(int32_t i32);
-        explicit Value(int64_t i64);
-        explicit Value(float f);
-        explicit Value(double d);
-        explicit Value(bool b);
+        Value() noexcept : _tag(Tag::Null) { _payload.i64 = 0; }
+        explicit Value(int32_t i32) noexcept : _tag(Tag::Int32) { _payload.i64 = 0; _payload.i32 = i32; }
+        explicit Value(int64_t i64) noexcept : _tag(Tag::Int64) { _payload.i64 = i64; }
+        explicit Value(float f) noexcept : _tag(Tag::Float32) { _payload.i64 = 0; _payload.f32 = f; }
+        explicit Value(double d) noexcept : _tag(Tag::Float64) { _payload.f64 = d; }
+        explicit Value(bool b) noexcept : _tag(Tag::Bool) { _payload.i64 = 0; _payload.b = b; }
         explicit Value(const std::string &str);
         explicit Value(ObjectRef obj);
 
-        [[nodiscard]] bool IsInt32() const;
-        [[nodiscard]] bool IsInt64() const;
-        [[nodiscard]] bool IsFloat32() const;
-        [[nodiscard]] bool IsFloat64() const;
-        [[nodiscard]] bool IsBool() const;
-        [[nodiscard]] bool IsString() const;
-        [[nodiscard]] bool IsObject() const;
-        [[nodiscard]] bool IsNull() const { return _value.index() == 0; }
-
-        [[nodiscard]] int32_t AsInt32() const;
-        [[nodiscard]] int64_t AsInt64() const;
-        [[nodiscard]] float AsFloat32() const;
-        [[nodiscard]] double AsFloat64() const;
-        [[nodiscard]] bool AsBool() const;
-        [[nodiscard]] std::string AsString() const;
+        Value(const Value &other) noexcept : _tag(other._tag), _payload(other._payload)
+        {
+            if (IsHeapTag(_tag))
+                Retain();
+        }
+
+        Value(Value &&other) noexcept : _tag(other._tag), _payload(other._payload)
+        {
+            other._tag = Tag::Null;
+        }
+
+        Value &operator=(const Value &other) noexcept
+        {
+            if (this != &other)
+            {
+                Value copy(other);
+                Swap(copy);
+            }
+            return *this;
+        }
+
+        Value &operator=(Value &&other) noexcept
+        {
+            if (this != &other)
+            {
+                Value moved(std::move(other));
+                Swap(moved);
+            }
+            return *this;
+        }
+
+        ~Value()
+        {
+            if (IsHeapTag(_tag))
+                Release();
+        }
+
+        [[nodiscard]] bool IsInt32() const { return _tag == Tag::Int32; }
+        [[nodiscard]] bool IsInt64() const { return _tag == Tag::Int64; }
+        [[nodiscard]] bool IsFloat32() const { return _tag == Tag::Float32; }
+        [[nodiscard]] bool IsFloat64() const { return _tag == Tag::Float64; }
+        [[nodiscard]] bool IsBool() const { return _tag == Tag::Bool; }
+        [[nodiscard]] bool IsString() const { return _tag == Tag::String; }
+        [[nodiscard]] bool IsObject() const { return _tag == Tag::Object; }
+        [[nodiscard]] bool IsNull() const { return _tag == Tag::Null; }
+
+        [[nodiscard]] int32_t AsInt32() const
+        {
+            if (!IsInt32()) ThrowTypeMismatch("int32");
+            return _payload.i32;
+        }
+
+        [[nodiscard]] int64_t AsInt64() const
+        {
+            if (!IsInt64()) ThrowTypeMismatch("int64");
+            return _payload.i64;
+        }
+
+        [[nodiscard]] float AsFloat32() const
+        {
+            if (!IsFloat32()) ThrowTypeMismatch("float32");
+            return _payload.f32;
+        }
+
+        [[nodiscard]] double AsFloat64() const
+        {
+            if (!IsFloat64()) ThrowTypeMismatch("float64");
+            return _payload.f64;
+        }
+
+        [[nodiscard]] bool AsBool() const
+        {
+            if (!IsBool()) ThrowTypeMismatch("bool");
+            return _payload.b;
+        }
+
+        /// Payloads without the tag check, for operands whose tag the caller
+        /// already knows (verified or tag-guarded bytecode).
+        [[nodiscard]] int32_t UncheckedInt32() const { return _payload.i32; }
+        [[nodiscard]] double UncheckedFloat64() const { return _payload.f64; }
+        [[nodiscard]] bool UncheckedBool() const { return _payload.b; }
+        [[nodiscard]] Object *UncheckedObject() const { return _payload.obj; }
+
+        /// Layout contract for native code (see JitCompiler): the tag is the
+        /// byte at offset 0 and the payload starts at kPayloadOffset. An int32,
+        /// bool or float32 payload has its unused upper bytes zeroed.
+        enum class Tag : uint8_t { Null, Int32, Int64, Float32, Float64, Bool, String, Object };
+        static constexpr size_t kPayloadOffset = 8;
+        [[nodiscard]] Tag GetTag() const { return _tag; }
+
+        [[nodiscard]] std::string AsString() const { return AsStringRef(); }
+        /// The string payload without copying it; valid while this Value lives.
+        [[nodiscard]] const std::string &AsStringRef() const;
         [[nodiscard]] ObjectRef AsObject() const;
 
         bool operator==(const Value& other) const;
         bool operator!=(const Value& other) const { return !(*this == other); }
 
     private:
-        std::variant<std::nullptr_t, int32_t, int64_t, float, double, bool, std::string, ObjectRef> _value;
+        struct StringData;
+
+        static bool IsHeapTag(Tag tag) { return tag >= Tag::String; }
+        [[noreturn]] static void ThrowTypeMismatch(const char *typeName);
+
+        void Retain() const noexcept;
+        void Release() noexcept;
+
+        void Swap(Value &other) noexcept
+        {
+            std::swap(_tag, other._tag);
+            std::swap(_payload, other._payload);
+        }
+
+        Tag _tag;
+        union Payload
+        {
+            int32_t i32;
+            int64_t i64;
+            float f32;
+            double f64;
+            bool b;
+            StringData *str;
+            Object *obj;
+        } _payload;
     };
 
+    static_assert(sizeof(Value) == 16, "Value is expected to be a 16-byte tagged union");
+
 } // namespace ObjectIR
 
 // Hash function for Value to enable use in unordered_map/unordered_set
@@ -192,38 +338,121 @@ namespace std {
 
 namespace ObjectIR {
 
+    // ============================================================================
+    // Nursery - Object allocation
+    // ============================================================================
+
+    /// Per-thread allocator for objects and their slot storage. Each thread
+    /// bump-allocates fresh blocks out of its current chunk and keeps the
+    /// blocks it frees on per-size free lists, so the next allocation of that
+    /// size reuses the most recently freed block without locking. Threads hand
+    /// surplus free blocks, and all of them on exit, to shared lists. Chunks
+    /// are never returned to the system. Blocks above
+    /// GetLargeAllocationSize() come from operator new. Building with
+    /// OBJECTIR_NURSERY=OFF routes every block to operator new.
+    class OBJECTIR_API Nursery
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t chunksCreated = 0;
+            size_t reservedBytes = 0;
+            /// Free blocks on the shared lists.
+            size_t sharedFreeBlocks = 0;
+        };
+
+        /// Block of at least `bytes` bytes, aligned for any scalar type.
+        [[nodiscard]] static void *Allocate(size_t bytes);
+        /// Return a block; `bytes` must match the Allocate call. Any thread may
+        /// release a block, and keeps it for its own allocations.
+        static void Release(void *block, size_t bytes) noexcept;
+
+        [[nodiscard]] static size_t GetChunkSize();
+        [[nodiscard]] static size_t GetLargeAllocationSize();
+        [[nodiscard]] static Statistics GetStatistics();
+
+    private:
+        Nursery() = default;
+    };
+
+    /// Standard allocator over the Nursery, for std::allocate_shared and
+    /// containers.
+    template<typename T>
+    class NurseryAllocator
+    {
+    public:
+        using value_type = T;
+
+        NurseryAllocator() noexcept = default;
+        template<typename U>
+        NurseryAllocator(const NurseryAllocator<U> &) noexcept {}
+
+        [[nodiscard]] T *allocate(size_t count) {
+            return static_cast<T *>(Nursery::Allocate(count * sizeof(T)));
+        }
+        void deallocate(T *block, size_t count) noexcept { Nursery::Release(block, count * sizeof(T)); }
+
+        template<typename U>
+        bool operator==(const NurseryAllocator<U> &) const noexcept { return true; }
+        template<typename U>
+        bool operator!=(const NurseryAllocator<U> &) const noexcept { return false; }
+    };
+
     // ============================================================================
     // Object Model - Core OOP support
     // ============================================================================
 
+    /// Receives the references an object or a root set holds (see
+    /// GarbageCollector).
+    class OBJECTIR_API ReferenceVisitor
+    {
+    public:
+        virtual ~ReferenceVisitor() = default;
+        /// A Value; only object values matter to the collector.
+        virtual void VisitValue(const Value &value) = 0;
+        /// An object held through an ObjectRef rather than a Value.
+        virtual void VisitObject(const Object *object) = 0;
+    };
+
+    /// Reports the references held by native data attached with Object::SetData.
+    using DataTracer = void (*)(const void *data, ReferenceVisitor &visitor);
+
     /// Base class for all runtime objects
     class OBJECTIR_API Object : public std::enable_shared_from_this<Object>
     {
     public:
         Object() = default;
+        /// Create an object with `slotCount` field slots (see Class::GetFieldSlotCount).
+        explicit Object(size_t slotCount) : _slots(slotCount) {}
         virtual ~Object() = default;
 
         void SetField(const std::string &fieldName, const Value &value);
         [[nodiscard]] Value GetField(const std::string &fieldName) const;
+        void SetField(SymbolId fieldName, const Value &value);
+        [[nodiscard]] Value GetField(SymbolId fieldName) const;
 
-        [[nodiscard]] ClassRef GetClass() const { return _class; }
+        [[nodiscard]] const ClassRef &GetClass() const { return _class; }
         void SetClass(ClassRef classType) { _class = classType; }
 
         [[nodiscard]] bool IsInstanceOf(ClassRef classType) const;
         [[nodiscard]] ObjectRef GetBaseInstance() const { return _baseInstance; }
         void SetBaseInstance(ObjectRef base) { _baseInstance = base; }
 
+        // Field slots laid out by the object's class. Slot indices come from
+        // Class::GetFieldSlot and are not bounds-checked here.
+        [[nodiscard]] size_t GetSlotCount() const { return _slots.size(); }
+        [[nodiscard]] const Value &GetSlot(size_t slot) const { return _slots[slot]; }
+        void SetSlot(size_t slot, const Value &value) { _slots[slot] = value; }
+
         // Initialize field slots (used during object creation)
-        void InitializeFieldSlot(const std::string& fieldName) {
-            if (_fieldValues.find(fieldName) == _fieldValues.end()) {
-                _fieldValues[fieldName] = Value(); // Initialize to null/default
-            }
-        }
+        void InitializeFieldSlot(const std::string& fieldName);
 
-        // Generic data storage for native implementations
+        // Generic data storage for native implementations. Data holding
+        // Values or objects passes a tracer so the collector sees through it.
         template<typename T>
-        void SetData(std::shared_ptr<T> data) {
+        void SetData(std::shared_ptr<T> data, DataTracer tracer = nullptr) {
             _data = std::static_pointer_cast<void>(data);
+            _dataTracer = tracer;
         }
 
         template<typename T>
@@ -231,40 +460,109 @@ namespace ObjectIR {
             return std::static_pointer_cast<T>(_data);
         }
 
+        // References held by Values. While at least one Value refers to this
+        // object, `_valueAnchor` keeps it alive; the anchor is taken from the
+        // ObjectRef the first Value was created from and dropped with the last.
+        void RetainValueReference(const ObjectRef &self) const;
+        void RetainValueReference() const noexcept { _valueRefCount.fetch_add(1, std::memory_order_relaxed); }
+        void ReleaseValueReference() const noexcept;
+        [[nodiscard]] const ObjectRef &GetValueAnchor() const { return _valueAnchor; }
+        [[nodiscard]] uint32_t GetValueReferenceCount() const { return _valueRefCount.load(std::memory_order_acquire); }
+
+        /// Report every reference the object holds: field slots, fields set by
+        /// native code, the base instance and traced native data.
+        virtual void VisitReferences(ReferenceVisitor &visitor) const;
+        /// Drop everything VisitReferences reports, and native data; the
+        /// collector uses it to break unreachable cycles.
+        virtual void ClearReferences();
+
     protected:
-        std::unordered_map<std::string, Value> _fieldValues;
+        // Declared fields, indexed by slot.
+        std::vector<Value, NurseryAllocator<Value>> _slots;
+        // Fields that are not part of the class layout (set by native code).
+        std::unordered_map<SymbolId, Value> _fieldValues;
         ClassRef _class;
         ObjectRef _baseInstance;
         std::shared_ptr<void> _data;
+        DataTracer _dataTracer = nullptr;
+
+    private:
+        mutable std::atomic<uint32_t> _valueRefCount{0};
+        mutable std::atomic_flag _valueAnchorLock = ATOMIC_FLAG_INIT;
+        mutable ObjectRef _valueAnchor;
     };
 
     /// Array class for runtime arrays
+    ///
+    /// Arrays of int32, int64, float32, float64, bool and uint8 keep their
+    /// elements unboxed in one contiguous buffer that native code reaches
+    /// through GetElements<T>(); GetElement boxes an element into a Value and
+    /// SetElement converts a numeric Value to the element type. Arrays of
+    /// strings and objects hold Values.
     class OBJECTIR_API Array : public Object
     {
     public:
-        Array(TypeReference elementType, int32_t length)
-            : _elementType(elementType), _length(length), _elements(length) {}
+        Array(TypeReference elementType, int32_t length);
 
-        void SetElement(int32_t index, const Value& value) {
-            if (index >= 0 && index < _length) {
-                _elements[index] = value;
-            }
-        }
+        /// Store `value` at `index`; out-of-range indices are ignored. Throws
+        /// std::runtime_error when an unboxed array is given a non-numeric
+        /// value.
+        void SetElement(int32_t index, const Value& value);
+        /// The element at `index`, or null when out of range.
+        Value GetElement(int32_t index) const;
+
+        [[nodiscard]] int32_t GetArrayLength() const { return _length; }
+        [[nodiscard]] TypeReference GetElementType() const { return _elementType; }
 
-        Value GetElement(int32_t index) const {
-            if (index >= 0 && index < _length) {
-                return _elements[index];
+        /// True when the elements are stored unboxed.
+        [[nodiscard]] bool IsUnboxed() const { return _elementKind != PrimitiveType::Object; }
+        /// Bytes per element in the array's storage.
+        [[nodiscard]] size_t GetElementSize() const;
+
+        /// The element storage, GetArrayLength() elements of T. T is the native
+        /// type of an unboxed array (int32_t, int64_t, float, double, bool or
+        /// uint8_t) or Value for any other array; a different T throws
+        /// std::runtime_error.
+        template<typename T>
+        [[nodiscard]] T *GetElements() {
+            return const_cast<T *>(static_cast<const Array *>(this)->GetElements<T>());
+        }
+        template<typename T>
+        [[nodiscard]] const T *GetElements() const {
+            if (!Holds<T>()) {
+                ThrowElementTypeMismatch();
+            }
+            if constexpr (std::is_same_v<T, Value>) {
+                return _elements.data();
+            } else {
+                return reinterpret_cast<const T *>(_buffer.data());
             }
-            return Value(); // null
         }
 
-        [[nodiscard]] int32_t GetArrayLength() const { return _length; }
-        [[nodiscard]] TypeReference GetElementType() const { return _elementType; }
+        void VisitReferences(ReferenceVisitor &visitor) const override;
+        void ClearReferences() override;
 
     private:
+        template<typename T>
+        [[nodiscard]] bool Holds() const {
+            if constexpr (std::is_same_v<T, int32_t>) return _elementKind == PrimitiveType::Int32;
+            else if constexpr (std::is_same_v<T, int64_t>) return _elementKind == PrimitiveType::Int64;
+            else if constexpr (std::is_same_v<T, float>) return _elementKind == PrimitiveType::Float32;
+            else if constexpr (std::is_same_v<T, double>) return _elementKind == PrimitiveType::Float64;
+            else if constexpr (std::is_same_v<T, bool>) return _elementKind == PrimitiveType::Bool;
+            else if constexpr (std::is_same_v<T, uint8_t>) return _elementKind == PrimitiveType::UInt8;
+            else if constexpr (std::is_same_v<T, Value>) return _elementKind == PrimitiveType::Object;
+            else return false;
+        }
+        [[noreturn]] void ThrowElementTypeMismatch() const;
+
         TypeReference _elementType;
         int32_t _length;
-        std::vector<Value> _elements;
+        // Int32, Int64, Float32, Float64, Bool or UInt8 for unboxed arrays
+        // (elements in _buffer); Object otherwise (elements in _elements).
+        PrimitiveType _elementKind;
+        std::vector<Value, NurseryAllocator<Value>> _elements;
+        std::vector<unsigned char, NurseryAllocator<unsigned char>> _buffer;
     };
 
     /// Represents a field definition within a class
@@ -272,14 +570,22 @@ namespace ObjectIR {
     {
     public:
         Field(std::string name, TypeReference type)
-            : _name(std::move(name)), _type(type) {}
+            : _name(std::move(name)), _nameSymbol(SymbolTable::Intern(_name)), _type(type) {}
 
         [[nodiscard]] const std::string &GetName() const { return _name; }
+        [[nodiscard]] SymbolId GetNameSymbol() const { return _nameSymbol; }
         [[nodiscard]] const TypeReference &GetType() const { return _type; }
 
+        /// Slot of this field in instances of its class, or Class::kNoFieldSlot
+        /// until the class layout has been finalized.
+        [[nodiscard]] size_t GetSlot() const { return _slot; }
+        void SetSlot(size_t slot) { _slot = slot; }
+
     private:
         std::string _name;
+        SymbolId _nameSymbol;
         TypeReference _type;
+        size_t _slot = static_cast<size_t>(-1);
     };
 
     // ============================================================================
@@ -289,43 +595,125 @@ namespace ObjectIR {
     /// Signature for native method implementations
     using NativeMethodImpl = std::function<Value(ObjectRef thisPtr, const std::vector<Value> &, VirtualMachine *)>;
 
+    /// How a method body currently runs (see TieredExecution).
+    enum class ExecutionTier : uint8_t
+    {
+        Interpreter, // lowered bytecode, generic handlers only
+        Optimized,   // optimizer passes, inlining, quickening, superinstructions
+        Native       // machine code (JIT, precompiled plugin or native implementation)
+    };
+
+    /// Name of `tier` as reported by VirtualMachine::ExportMetadata.
+    OBJECTIR_API const char *GetExecutionTierName(ExecutionTier tier);
+
+    /// Execution counters of a method: frames entered and loop back edges
+    /// taken by its bytecode, whatever tier ran them. Not synchronized.
+    struct MethodProfile
+    {
+        uint64_t invocations = 0;
+        uint64_t backEdges = 0;
+    };
+
+    enum class ExceptionHandlerKind : uint8_t
+    {
+        Catch,
+        Finally
+    };
+
+    /// A protected range of a method body and its handler, in instruction
+    /// indices of the body (ends exclusive). A catch handler is entered with
+    /// the thrown value as the only operand stack entry when the value is a
+    /// `catchType` (anything when empty); runtime errors are thrown as their
+    /// message string. A finally handler runs whenever control leaves the
+    /// range, through `leave` or an exception, and ends with `endfinally`.
+    /// Handlers are listed innermost first: the first one that applies wins.
+    struct ExceptionHandler
+    {
+        ExceptionHandlerKind kind = ExceptionHandlerKind::Catch;
+        size_t tryStart = 0;
+        size_t tryEnd = 0;
+        size_t handlerStart = 0;
+        size_t handlerEnd = 0;
+        std::string catchType;
+    };
+
     /// Represents a method definition
     class OBJECTIR_API Method
     {
     public:
         Method(std::string name, TypeReference returnType, bool isStatic = false, bool isVirtual = false)
-            : _name(std::move(name)), _returnType(returnType), _isStatic(isStatic), _isVirtual(isVirtual) {}
+            : _name(std::move(name)), _nameSymbol(SymbolTable::Intern(_name)), _returnType(returnType),
+              _isStatic(isStatic), _isVirtual(isVirtual) {}
 
         [[nodiscard]] const std::string &GetName() const { return _name; }
+        [[nodiscard]] SymbolId GetNameSymbol() const { return _nameSymbol; }
         [[nodiscard]] const TypeReference &GetReturnType() const { return _returnType; }
         [[nodiscard]] bool IsStatic() const { return _isStatic; }
         [[nodiscard]] bool IsVirtual() const { return _isVirtual; }
+
+        /// Slot of this instance method in the vtable of its class and the
+        /// classes derived from it (see Class::FinalizeDispatch), or
+        /// kNoVTableSlot for static methods and until the class is finalized.
+        static constexpr size_t kNoVTableSlot = static_cast<size_t>(-1);
+        [[nodiscard]] size_t GetVTableSlot() const { return _vtableSlot; }
+        void SetVTableSlot(size_t slot) { _vtableSlot = slot; }
+        /// Same parameter count and parameter types as `other`.
+        [[nodiscard]] bool HasSameSignature(const Method &other) const;
         [[nodiscard]] const std::vector<std::pair<std::string, TypeReference>> &GetParameters() const { return _parameters; }
         [[nodiscard]] const std::vector<std::pair<std::string, TypeReference>> &GetLocals() const { return _locals; }
+        // Name -> index maps, kept in step with AddParameter/AddLocal
+        [[nodiscard]] const std::unordered_map<SymbolId, size_t> &GetParameterIndices() const { return _parameterIndices; }
+        [[nodiscard]] const std::unordered_map<SymbolId, size_t> &GetLocalIndices() const { return _localIndices; }
 
-        [[nodiscard]] bool HasInstructions() const { return !_instructions.empty(); }
-        [[nodiscard]] const std::vector<Instruction> &GetInstructions() const { return _instructions; }
+        [[nodiscard]] bool HasInstructions() const { return !_instructions->empty(); }
+        [[nodiscard]] const std::vector<Instruction> &GetInstructions() const { return *_instructions; }
+        [[nodiscard]] std::shared_ptr<const std::vector<Instruction>> GetSharedInstructions() const { return _instructions; }
 
         void AddParameter(const std::string &name, const TypeReference &type);
         void AddLocal(const std::string &name, const TypeReference &type);
-        void SetNativeImpl(NativeMethodImpl impl) { _nativeImpl = impl; }
-        [[nodiscard]] NativeMethodImpl GetNativeImpl() const { return _nativeImpl; }
+        void SetNativeImpl(NativeMethodImpl impl);
+        [[nodiscard]] const NativeMethodImpl &GetNativeImpl() const { return _nativeImpl; }
         void SetInstructions(std::vector<Instruction> instructions);
         
         // Label map for branch resolution
-        void SetLabelMap(const std::unordered_map<std::string, size_t>& labelMap) { _labelMap = labelMap; }
+        void SetLabelMap(const std::unordered_map<std::string, size_t>& labelMap) { _labelMap = labelMap; _prepared.reset(); }
         [[nodiscard]] const std::unordered_map<std::string, size_t>& GetLabelMap() const { return _labelMap; }
 
+        // Exception handler table (see ExceptionHandler)
+        void SetExceptionHandlers(std::vector<ExceptionHandler> handlers) { _exceptionHandlers = std::move(handlers); _prepared.reset(); }
+        [[nodiscard]] const std::vector<ExceptionHandler>& GetExceptionHandlers() const { return _exceptionHandlers; }
+
+        // Prepared bytecode (built by SetInstructions, rebuilt lazily after the
+        // locals, parameters, label map or exception handlers change).
+        void Prepare();
+        [[nodiscard]] std::shared_ptr<PreparedMethod> GetPrepared() const;
+        /// Replace the prepared body, e.g. with one compiled from the same
+        /// instructions (BytecodeInliner, TieredExecution), or drop it with
+        /// nullptr (it is rebuilt on the next call).
+        void SetPrepared(std::shared_ptr<PreparedMethod> prepared) { _prepared = std::move(prepared); }
+
+        // Tiered execution
+        [[nodiscard]] MethodProfile &GetProfile() const { return _profile; }
+        /// Tier of the current body; never prepares it.
+        [[nodiscard]] ExecutionTier GetTier() const;
+
     private:
         std::string _name;
+        SymbolId _nameSymbol;
         TypeReference _returnType;
         bool _isStatic;
         bool _isVirtual;
+        size_t _vtableSlot = kNoVTableSlot;
         std::vector<std::pair<std::string, TypeReference>> _parameters;
         std::vector<std::pair<std::string, TypeReference>> _locals;
-        std::vector<Instruction> _instructions;
+        std::unordered_map<SymbolId, size_t> _parameterIndices;
+        std::unordered_map<SymbolId, size_t> _localIndices;
+        std::shared_ptr<const std::vector<Instruction>> _instructions = std::make_shared<const std::vector<Instruction>>();
         NativeMethodImpl _nativeImpl;
         std::unordered_map<std::string, size_t> _labelMap; // Maps label names to instruction indices
+        std::vector<ExceptionHandler> _exceptionHandlers;
+        mutable std::shared_ptr<PreparedMethod> _prepared;
+        mutable MethodProfile _profile;
     };
 
     // ============================================================================
@@ -338,8 +726,9 @@ namespace ObjectIR {
         explicit Class(std::string name);
 
         [[nodiscard]] const std::string &GetName() const { return _name; }
+        [[nodiscard]] SymbolId GetNameSymbol() const { return _nameSymbol; }
         [[nodiscard]] ClassRef GetBaseClass() const { return _baseClass; }
-        void SetBaseClass(ClassRef base) { _baseClass = base; }
+        void SetBaseClass(ClassRef base);
 
         [[nodiscard]] const std::string &GetNamespace() const { return _namespace; }
         void SetNamespace(const std::string &ns) { _namespace = ns; }
@@ -350,27 +739,70 @@ namespace ObjectIR {
         [[nodiscard]] bool IsSealed() const { return _isSealed; }
         void SetSealed(bool sealed) { _isSealed = sealed; }
 
+        /// Interfaces are classes whose instance methods are only signatures;
+        /// calls through them dispatch via the receiver's interface tables.
+        [[nodiscard]] bool IsInterface() const { return _isInterface; }
+        void SetInterface(bool isInterface) { _isInterface = isInterface; }
+
         // Field management
         void AddField(FieldRef field);
         [[nodiscard]] FieldRef GetField(const std::string &name) const;
+        [[nodiscard]] FieldRef GetField(SymbolId name) const;
         [[nodiscard]] const std::vector<FieldRef> &GetAllFields() const { return _fields; }
 
+        // Field layout. Instance fields are flattened into one slot array, base
+        // class fields first; a field that redeclares an inherited name shares
+        // the inherited slot. The layout is finalized on first use (for example
+        // by CreateInstance), after which fields and the base class are fixed.
+        static constexpr size_t kNoFieldSlot = static_cast<size_t>(-1);
+        void FinalizeLayout() const;
+        [[nodiscard]] bool IsLayoutFinalized() const { return _layoutFinalized; }
+        [[nodiscard]] size_t GetFieldSlotCount() const;
+        /// Slot of the field `name` (declared here or inherited), or kNoFieldSlot.
+        [[nodiscard]] size_t GetFieldSlot(const std::string &name) const;
+        [[nodiscard]] size_t GetFieldSlot(SymbolId name) const;
+
         // Method management
         void AddMethod(MethodRef method);
         [[nodiscard]] MethodRef GetMethod(const std::string &name) const;
+        [[nodiscard]] MethodRef GetMethod(SymbolId name) const;
         [[nodiscard]] std::vector<MethodRef> GetMethods() const;
+        /// First method called `name` here or in a base class, most derived first.
         [[nodiscard]] MethodRef LookupMethod(const std::string &name) const;
+        [[nodiscard]] MethodRef LookupMethod(SymbolId name) const;
         [[nodiscard]] const std::vector<MethodRef> &GetAllMethods() const { return _methods; }
 
+        // Dispatch tables, built from the class, its base classes and its
+        // interfaces on first use and rebuilt once the dispatch epoch moves on
+        // (see VirtualMachine::GetDispatchEpoch):
+        // - the vtable holds every instance method by slot: a base class's
+        //   slots come first, and a method with the name and signature of an
+        //   inherited one takes over its slot;
+        // - the interface tables map each slot of an interface implemented
+        //   here or by a base class (or by those interfaces) to the method
+        //   implementing it, null when there is none;
+        // - the overload index lists the methods visible under each name, most
+        //   derived first, without the ones overridden here.
+        void FinalizeDispatch() const;
+        [[nodiscard]] const std::vector<MethodRef> &GetVTable() const;
+        /// Table of `interfaceType` in this class, or null if it is not implemented.
+        [[nodiscard]] const std::vector<MethodRef> *GetInterfaceTable(const Class &interfaceType) const;
+        [[nodiscard]] const std::vector<MethodRef> &GetMethodsByName(SymbolId name) const;
+        /// True for this class and the classes derived from it (constant time).
+        [[nodiscard]] bool IsSubclassOf(const Class &classType) const;
+
         // Object construction
         [[nodiscard]] ObjectRef CreateInstance() const;
 
-        // Interface/contract support
+        // Interface/contract support. Interfaces of base classes and base
+        // interfaces count as implemented.
         void AddInterface(ClassRef interfaceType);
         [[nodiscard]] bool ImplementsInterface(ClassRef interfaceType) const;
+        [[nodiscard]] const std::vector<ClassRef> &GetInterfaces() const { return _interfaces; }
 
     private:
         std::string _name;
+        SymbolId _nameSymbol;
         std::string _namespace;
         ClassRef _baseClass;
         std::vector<FieldRef> _fields;
@@ -378,6 +810,18 @@ namespace ObjectIR {
         std::vector<ClassRef> _interfaces;
         bool _isAbstract = false;
         bool _isSealed = false;
+        bool _isInterface = false;
+
+        mutable std::unordered_map<SymbolId, size_t> _fieldSlots;
+        mutable size_t _fieldSlotCount = 0;
+        mutable bool _layoutFinalized = false;
+
+        mutable uint64_t _dispatchEpoch = 0;
+        mutable std::vector<MethodRef> _vtable;
+        mutable std::vector<std::pair<const Class *, std::vector<MethodRef>>> _interfaceTables;
+        mutable std::unordered_map<SymbolId, std::vector<MethodRef>> _methodsByName;
+        // This class and its base classes, root first, for IsSubclassOf.
+        mutable std::vector<const Class *> _ancestors;
     };
 
     // ============================================================================
@@ -465,29 +909,106 @@ namespace ObjectIR {
     // Execution Context - Runtime state for method execution
     // ============================================================================
 
+    /// A call frame. Its arguments, locals and operand stack are consecutive
+    /// windows of one Value array: the VM's frame stack for frames created by
+    /// the VM (arguments are taken in place from the caller's operand stack),
+    /// or storage owned by the context for standalone contexts.
+    ///
+    /// Only the most recent frame on a frame stack may grow its operand stack.
     class OBJECTIR_API ExecutionContext
     {
     public:
+        /// Standalone context with its own storage.
         explicit ExecutionContext(MethodRef method);
-
-        void PushStack(const Value &value);
+        /// Frame on `frameValues` whose arguments are the top `argumentCount`
+        /// values of `frameValues`.
+        ExecutionContext(MethodRef method, std::vector<Value> &frameValues, size_t argumentCount);
+
+        ExecutionContext(const ExecutionContext &) = delete;
+        ExecutionContext &operator=(const ExecutionContext &) = delete;
+
+        /// Re-initialize this context as a frame on `frameValues` (see above),
+        /// so the VM can reuse contexts across calls.
+        void Bind(MethodRef method, std::vector<Value> &frameValues, size_t argumentCount);
+        /// Re-initialize this frame in place as a frame of `method` whose
+        /// arguments are the top `argumentCount` operand stack values, which
+        /// replace its own arguments (tail calls).
+        void Rebind(MethodRef method, size_t argumentCount);
+        /// Drop the method, 'this' and owned values (before the context is pooled).
+        void Unbind();
+        [[nodiscard]] bool UsesStorage(const std::vector<Value> &values) const { return _values == &values; }
+        /// Position of the frame's first argument in its storage.
+        [[nodiscard]] size_t GetFrameBase() const { return _argumentBase; }
+        /// Copy the frame into storage owned by the context and drop it from
+        /// the shared frame stack. Used when a frame stays observable after it
+        /// stopped executing (diagnostics after an error).
+        void Detach();
+
+        void PushStack(const Value &value) { _values->push_back(value); }
+        void PushStack(Value &&value) { _values->push_back(std::move(value)); }
         [[nodiscard]] Value PopStack();
         [[nodiscard]] Value PeekStack() const;
+        /// Value `depth` entries below the top of the operand stack (0 = top).
+        [[nodiscard]] Value PeekStack(size_t depth) const;
+        [[nodiscard]] size_t GetStackDepth() const { return _values->size() - _stackBase; }
+        /// Operand stack access for verified code, which is known not to
+        /// underflow: one past the top entry, and dropping the top `count`.
+        [[nodiscard]] Value *UncheckedStackEnd() { return _values->data() + _values->size(); }
+        void UncheckedDrop(size_t count) { _values->resize(_values->size() - count); }
+        /// Make room for `depth` more operand stack entries up front. Grows
+        /// the storage geometrically: it is shared by every frame of a deep
+        /// call chain.
+        void ReserveStack(size_t depth)
+        {
+            const size_t size = _values->size() + depth;
+            if (size > _values->capacity())
+                _values->reserve(std::max(size, _values->capacity() * 2));
+        }
+        /// Grow (with nulls) or shrink the operand stack to `depth` entries.
+        /// Meant for small adjustments, which it keeps inline.
+        void ResizeStack(size_t depth)
+        {
+            const size_t size = _stackBase + depth;
+            while (_values->size() < size)
+                _values->emplace_back();
+            if (_values->size() > size)
+                _values->resize(size);
+        }
+
+        /// First argument, local and operand stack slot of the frame, for native
+        /// code that works on the frame in place. Invalidated whenever the frame
+        /// storage grows (pushes, calls).
+        [[nodiscard]] Value *FrameArguments() { return _values->data() + _argumentBase; }
+        [[nodiscard]] Value *FrameLocals() { return _values->data() + _localBase; }
+        [[nodiscard]] Value *FrameStack() { return _values->data() + _stackBase; }
 
         void SetLocal(size_t index, const Value &value);
         [[nodiscard]] Value GetLocal(size_t index) const;
         void SetLocal(const std::string &name, const Value &value);
         [[nodiscard]] Value GetLocal(const std::string &name) const;
+        /// Local/argument slots without the range check; `index` must be below
+        /// the method's local count or GetArgumentCount() respectively.
+        [[nodiscard]] Value &UncheckedLocal(size_t index) { return (*_values)[_localBase + index]; }
+        [[nodiscard]] const Value &UncheckedArgument(size_t index) const { return (*_values)[_argumentBase + index]; }
+        /// Make the frame hold at least `count` locals (the extra ones null),
+        /// for prepared bodies with more locals than the method declares.
+        void EnsureLocals(size_t count)
+        {
+            if (count > _localCount)
+                GrowLocals(count);
+        }
 
-        [[nodiscard]] ObjectRef GetThis() const { return _this; }
+        [[nodiscard]] const ObjectRef &GetThis() const { return _this; }
         void SetThis(ObjectRef obj) { _this = obj; }
 
         void SetArguments(const std::vector<Value> &args);
+        [[nodiscard]] size_t GetArgumentCount() const { return _argumentCount; }
         [[nodiscard]] Value GetArgument(size_t index) const;
         [[nodiscard]] Value GetArgument(const std::string &name) const;
+        void SetArgument(size_t index, const Value &value);
         void SetArgument(const std::string &name, const Value &value);
 
-        [[nodiscard]] MethodRef GetMethod() const { return _method; }
+        [[nodiscard]] const MethodRef &GetMethod() const { return _method; }
 
         // Instruction location tracking (for diagnostics)
         void SetLastInstruction(size_t ip, OpCode opCode) {
@@ -502,20 +1023,176 @@ namespace ObjectIR {
         // Diagnostics helpers
         [[nodiscard]] std::vector<Value> GetStackSnapshot(size_t maxDepth = 16) const;
 
+        /// Report 'this' and the values held in storage owned by the context;
+        /// frames on the VM frame stack are reported by VirtualMachine::VisitRoots.
+        void VisitReferences(ReferenceVisitor &visitor) const;
+
     private:
+        // Insert `count` null values at `position` of this frame's storage.
+        void GrowRegion(size_t position, size_t count);
+        // Grow the local region to `count` slots.
+        void GrowLocals(size_t count);
+
         MethodRef _method;
-        std::vector<Value> _stack;
-        std::vector<Value> _locals;
-        std::vector<Value> _arguments;
+        std::vector<Value> *_values;
+        std::vector<Value> _ownValues;
+        size_t _argumentBase = 0;
+        size_t _argumentCount = 0;
+        size_t _localBase = 0;
+        size_t _localCount = 0;
+        size_t _stackBase = 0;
         ObjectRef _this;
-        std::unordered_map<std::string, size_t> _localIndices;
-        std::unordered_map<std::string, size_t> _parameterIndices;
 
         bool _hasLastInstruction = false;
         size_t _lastIp = 0;
         OpCode _lastOpCode = OpCode::Nop;
     };
 
+    // ============================================================================
+    // Garbage Collection
+    // ============================================================================
+
+    /// Optional tracing collector for object graphs reference counting cannot
+    /// free. Objects stay owned by ObjectRef/Value counts; once enabled, every
+    /// object the VMs create is tracked, and a collection marks from the root
+    /// set - the frame stacks, contexts and handles reported by root scanners,
+    /// plus any object referenced from somewhere the tracer cannot see (host
+    /// code, untraced native data) - and clears the references of the tracked
+    /// objects left unmarked, so the cycles among them fall apart.
+    ///
+    /// Collections run when the tracked heap grows past its trigger (twice
+    /// the size that survived the last collection, at least 4 MiB, at most
+    /// the heap limit) and on Collect. In between, minor collections look at
+    /// the young generation - the objects tracked since the last collection -
+    /// whenever it reaches its size (1 MiB by default); references from old
+    /// objects pin the young objects they lead to, so mutators need no write
+    /// barrier. Allocating past the heap limit after a full collection throws
+    /// std::runtime_error. Sizes are estimates: object
+    /// headers plus field and element slots.
+    ///
+    /// A collection reads every VM's roots and objects without stopping the
+    /// other threads, so it only starts while no thread but the collecting
+    /// one holds a MutatorScope. Otherwise Track leaves it to a later
+    /// allocation and Collect returns 0.
+    class OBJECTIR_API GarbageCollector
+    {
+    public:
+        struct Statistics
+        {
+            /// All collections, minor ones included.
+            uint64_t collections = 0;
+            uint64_t minorCollections = 0;
+            uint64_t objectsFreed = 0;
+            uint64_t bytesFreed = 0;
+            size_t trackedObjects = 0;
+            size_t trackedBytes = 0;
+            /// Objects of the last collection kept alive only by references
+            /// from outside the traced heap and the root scanners.
+            size_t pinnedObjects = 0;
+        };
+
+        /// Affects objects created after the call (default off).
+        static void SetEnabled(bool enabled);
+        [[nodiscard]] static bool IsEnabled();
+
+        /// Tracked heap size past which allocation fails, in bytes; 0 (the
+        /// default) for none.
+        static void SetHeapLimit(size_t bytes);
+        [[nodiscard]] static size_t GetHeapLimit();
+
+        /// Young generation size that triggers a minor collection, in bytes;
+        /// 0 collects the whole heap every time.
+        static void SetYoungGenerationSize(size_t bytes);
+        [[nodiscard]] static size_t GetYoungGenerationSize();
+
+        /// Track a new object of about `bytes` bytes, collecting first if the
+        /// heap reached its trigger, and record it in the calling thread's
+        /// AllocationRegion. Apart from the region, a no-op while disabled.
+        static void Track(const ObjectRef &object, size_t bytes);
+
+        /// Collect now. Returns the number of objects whose references were
+        /// cleared.
+        static size_t Collect();
+
+        using RootScanner = std::function<void(ReferenceVisitor &)>;
+        /// Register a source of roots; returns the id to remove it with.
+        static size_t AddRootScanner(RootScanner scanner);
+        static void RemoveRootScanner(size_t id);
+
+        [[nodiscard]] static Statistics GetStatistics();
+
+        /// Marks the calling thread as using objects for its lifetime, which
+        /// keeps other threads from collecting. VirtualMachine holds one for
+        /// every call it runs; host threads that work on objects while
+        /// another thread may collect hold one too. Entering the outermost
+        /// scope of a thread waits for a collection in progress.
+        class OBJECTIR_API MutatorScope
+        {
+        public:
+            MutatorScope();
+            ~MutatorScope();
+            MutatorScope(const MutatorScope &) = delete;
+            MutatorScope &operator=(const MutatorScope &) = delete;
+        };
+
+        /// Apply a comma-separated list of switches: `on`, `off`,
+        /// `limit=<bytes>[k|m|g]`, `young=<bytes>[k|m|g]`. Throws
+        /// std::runtime_error for anything else.
+        static void Configure(const std::string &spec);
+
+    private:
+        GarbageCollector() = default;
+    };
+
+    /// Scope for the objects one unit of work - typically one request served
+    /// by an InvokeStaticMethod call - allocates on the calling thread. The
+    /// region records every object created while it is open. Closing it
+    /// traces just those objects: the ones still referenced from outside the
+    /// region (static fields, long-lived collections, host handles, the
+    /// call's result) escaped and are promoted, with everything they reach,
+    /// to the enclosing region or the ordinary heap. The rest were left
+    /// unreachable; reference counting already freed most of them, and the
+    /// close clears the references of the cycles among them so they go too.
+    /// Regions nest and work whether or not the GarbageCollector is enabled.
+    class OBJECTIR_API AllocationRegion
+    {
+    public:
+        struct Statistics
+        {
+            /// Objects created while the region was open, the ones promoted
+            /// from regions nested in it included.
+            size_t objects = 0;
+            /// Objects that escaped.
+            size_t promoted = 0;
+            /// Unreachable objects whose references the close cleared.
+            size_t cleared = 0;
+        };
+
+        /// Open a region on the calling thread, inside the innermost one
+        /// open there.
+        AllocationRegion();
+        /// Closes the region if it is still open.
+        ~AllocationRegion();
+        AllocationRegion(const AllocationRegion &) = delete;
+        AllocationRegion &operator=(const AllocationRegion &) = delete;
+
+        /// Close the region. Throws std::runtime_error if it is closed
+        /// already, or is not the innermost region open on the calling
+        /// thread.
+        Statistics Close();
+        [[nodiscard]] bool IsOpen() const { return _impl != nullptr; }
+
+    private:
+        friend class GarbageCollector;
+        struct Impl;
+
+        /// Record a new object in the calling thread's innermost region.
+        static void Record(const ObjectRef &object, size_t bytes);
+        static Impl *&Current();
+
+        std::unique_ptr<Impl> _impl;
+    };
+
     // ============================================================================
     // Virtual Machine - Runtime engine
     // ============================================================================
@@ -543,11 +1220,25 @@ namespace ObjectIR {
             }
         }
 
-        // Class registry
+        // Class registry. A class is registered under its simple, raw and
+        // namespace-qualified names; a qualified name that is not registered
+        // falls back to its simple name.
         void RegisterClass(ClassRef classType);
         [[nodiscard]] ClassRef GetClass(const std::string &name) const;
+        [[nodiscard]] ClassRef GetClass(SymbolId name) const;
         [[nodiscard]] bool HasClass(const std::string &name) const;
+        [[nodiscard]] bool HasClass(SymbolId name) const;
         [[nodiscard]] std::vector<std::string> GetAllClassNames() const;
+        // Changes on every RegisterClass and is never shared between two VMs, so
+        // prepared code can cache class lookups keyed on it.
+        [[nodiscard]] uint64_t GetClassRegistryVersion() const { return _classRegistryVersion; }
+
+        // Bytecode verification. Every method body is verified when it is
+        // prepared, and bodies that fail run on the checked interpreter path.
+        // For untrusted modules these turn the first failure into an error
+        // (std::runtime_error naming the method and the reason) at load time.
+        void VerifyClass(const ClassRef &classType) const;
+        void VerifyAllClasses() const;
         // Object creation
         [[nodiscard]] ObjectRef CreateObject(ClassRef classType);
         [[nodiscard]] ObjectRef CreateObject(const std::string &className);
@@ -556,12 +1247,51 @@ namespace ObjectIR {
         // Method invocation
         Value InvokeMethod(ObjectRef object, const std::string &methodName, const std::vector<Value> &args);
         Value InvokeStaticMethod(ClassRef classType, const std::string &methodName, const std::vector<Value> &args);
+        Value InvokeMethod(ObjectRef object, SymbolId methodName, const std::vector<Value> &args);
+        Value InvokeStaticMethod(ClassRef classType, SymbolId methodName, const std::vector<Value> &args);
 
         // Signature-aware invocation (recommended for overloaded methods).
         Value InvokeMethod(ObjectRef object, const CallTarget& target, const std::vector<Value>& args);
         Value InvokeStaticMethod(ClassRef classType, const CallTarget& target, const std::vector<Value>& args);
 
-        // Reflection/export
+        // Overload resolution on its own, and invocation of an already resolved
+        // method. Call-site inline caches use these to skip repeated lookups.
+        [[nodiscard]] MethodRef ResolveMethod(ClassRef classType, const CallTarget& target, bool requireStatic) const;
+        /// Same, for a target whose name is already interned as `name`.
+        [[nodiscard]] MethodRef ResolveMethod(ClassRef classType, SymbolId name, const CallTarget& target, bool requireStatic) const;
+        Value InvokeResolved(const MethodRef& method, ObjectRef object, const std::vector<Value>& args);
+        /// Invoke `method` with the top `argumentCount` values of `caller`'s
+        /// operand stack as its arguments; they are consumed. When `caller`
+        /// lives on this VM's frame stack, the callee frame takes them in place.
+        Value InvokeWithStackArguments(const MethodRef& method, ObjectRef object, ExecutionContext* caller, size_t argumentCount);
+        /// Tail call: turn `frame`, a frame on this VM's frame stack, into a
+        /// frame of `method` whose arguments are the top `argumentCount` values
+        /// of its operand stack. Returns the body the frame continues with, or
+        /// null, leaving the frame alone, when the call needs a frame of its
+        /// own (native implementations, frames off the frame stack).
+        std::shared_ptr<PreparedMethod> ReuseFrame(const MethodRef& method, ObjectRef object, ExecutionContext* frame, size_t argumentCount);
+        /// Stackless call: push a frame of `method` whose arguments are the top
+        /// `argumentCount` values of `caller`'s operand stack, and return the
+        /// body the caller's dispatch loop continues with in it. Returns null,
+        /// pushing nothing, when the call needs a native frame of its own (see
+        /// InvokeWithStackArguments). PopFrame ends the frame once it returned.
+        std::shared_ptr<PreparedMethod> PushFrame(const MethodRef& method, ObjectRef object, ExecutionContext* caller, size_t argumentCount);
+        /// Pop the current frame, and its values off the frame stack.
+        void PopFrame();
+        /// Run the IR body of `method` even if a native implementation is
+        /// installed: precompiled methods (see AotCompiler) fall back to it
+        /// for arguments their code was not compiled for.
+        Value InvokeBytecode(const MethodRef& method, ObjectRef object, const std::vector<Value>& args);
+
+        // Process-wide counter bumped whenever a method table or body changes
+        // (AddMethod, SetInstructions, SetNativeImpl, SetBaseClass, RegisterClass,
+        // plugin method replacement). Cached call targets are only trusted while
+        // the epoch they were resolved in is current.
+        [[nodiscard]] static uint64_t GetDispatchEpoch();
+        static void InvalidateDispatchCaches();
+
+        // Reflection/export. Methods with a body report their tier and
+        // profile under "execution".
         [[nodiscard]] json ExportMetadata(bool includeInstructions = false) const;
         [[nodiscard]] json ExportClassMetadata(const std::string& name, bool includeInstructions = false) const;
 
@@ -581,15 +1311,40 @@ namespace ObjectIR {
         [[nodiscard]] std::vector<const ExecutionContext*> GetCallStackSnapshot() const;
         void PushContext(std::unique_ptr<ExecutionContext> context);
         void PopContext();
+        /// Pop the frames above `frame`, which failed and stayed on the call
+        /// stack, once `frame` handles their error (see ExceptionHandler).
+        /// Does nothing when `frame` is not on the call stack.
+        void UnwindTo(const ExecutionContext* frame);
+
+        /// Report the VM's roots: the frame stack and every context's 'this'
+        /// and owned values. Registered with the GarbageCollector for the
+        /// VM's lifetime.
+        void VisitRoots(ReferenceVisitor &visitor) const;
 
     private:
-        std::unordered_map<std::string, ClassRef> _classes;
+        // Run the prepared body of `method` in a new frame whose arguments are
+        // the top `argumentCount` values of the frame stack.
+        Value RunFrame(const MethodRef& method, ObjectRef object, size_t argumentCount);
+        // Push a frame of `method` on the top `argumentCount` values of the
+        // frame stack and make it the current context.
+        ExecutionContext* BindFrame(const MethodRef& method, size_t argumentCount);
+
+        // Class for `name`, or null (see GetClass).
+        ClassRef FindClass(SymbolId name, std::string_view text) const;
+
+        std::unordered_map<SymbolId, ClassRef> _classes;
+        uint64_t _classRegistryVersion = 0;
         std::vector<std::unique_ptr<ExecutionContext>> _contextStack;
         std::unique_ptr<ExecutionContext> _currentContext;
+        // Arguments, locals and operand stacks of the frames created by the VM,
+        // and contexts kept for reuse once their call returned.
+        std::vector<Value> _frameValues;
+        std::vector<std::unique_ptr<ExecutionContext>> _contextPool;
         OutputFunction _outputFunction;
 
         struct LoadedPlugin;
         std::vector<std::unique_ptr<LoadedPlugin>> _plugins;
+        size_t _rootScanner;
     };
 
     // ============================================================================
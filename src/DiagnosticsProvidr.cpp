@@ -191,6 +191,8 @@ std::string OpCodeToString(OpCode op) {
         case OpCode::LdLen: return "ldlen";
         case OpCode::Throw: return "throw";
         case OpCode::While: return "while";
+        case OpCode::Leave: return "leave";
+        case OpCode::EndFinally: return "endfinally";
         case OpCode::If: return "if";
         default: return std::to_string(static_cast<int>(op));
     }
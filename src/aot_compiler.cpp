@@ -0,0 +1,1014 @@
+#include "aot_compiler.hpp"
+#include "bytecode.hpp"
+#include "objectir_type_names.hpp"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ObjectIR {
+
+namespace {
+
+using Type = VerifiedType;
+
+// C++ representation of a slot of a given verified type. Strings, objects,
+// null and values of unknown type stay Values.
+enum class Rep { Int32, Int64, Float64, Bool, Boxed };
+
+class Unsupported : public std::exception {
+public:
+    explicit Unsupported(std::string message) : _message(std::move(message)) {}
+    const char* what() const noexcept override { return _message.c_str(); }
+
+private:
+    std::string _message;
+};
+
+const char* TypeName(Type type) {
+    switch (type) {
+        case Type::Null: return "null";
+        case Type::Int32: return "int32";
+        case Type::Int64: return "int64";
+        case Type::Float32: return "float32";
+        case Type::Float64: return "float64";
+        case Type::Bool: return "bool";
+        case Type::String: return "string";
+        case Type::Object: return "object";
+        default: return "unknown";
+    }
+}
+
+Rep RepOf(Type type) {
+    switch (type) {
+        case Type::Int32: return Rep::Int32;
+        case Type::Int64: return Rep::Int64;
+        case Type::Float64: return Rep::Float64;
+        case Type::Bool: return Rep::Bool;
+        case Type::Float32: throw Unsupported("float32 values");
+        default: return Rep::Boxed;
+    }
+}
+
+const char* CppType(Rep rep) {
+    switch (rep) {
+        case Rep::Int32: return "int32_t";
+        case Rep::Int64: return "int64_t";
+        case Rep::Float64: return "double";
+        case Rep::Bool: return "bool";
+        default: return "ObjectIR::Value";
+    }
+}
+
+const char* Suffix(Rep rep) {
+    switch (rep) {
+        case Rep::Int32: return "i32";
+        case Rep::Int64: return "i64";
+        case Rep::Float64: return "f64";
+        case Rep::Bool: return "b";
+        default: return "v";
+    }
+}
+
+bool IsInteger(Type type) { return type == Type::Int32 || type == Type::Int64; }
+bool IsNumber(Type type) { return IsInteger(type) || type == Type::Float64; }
+
+// Declared result type of a call site, as BytecodeVerifier::InferFrameStates
+// types it when trusting call results.
+Type DeclaredResultType(const std::string& name) {
+    const std::string normalized = TypeNames::NormalizeTypeName(name);
+    if (normalized == "int32") return Type::Int32;
+    if (normalized == "int64") return Type::Int64;
+    if (normalized == "float32") return Type::Float32;
+    if (normalized == "float64") return Type::Float64;
+    if (normalized == "bool") return Type::Bool;
+    return Type::Unknown;
+}
+
+// Tag check of the generated entry for an argument the body was verified for.
+std::string ArgumentCheck(Type type, const std::string& value) {
+    switch (type) {
+        case Type::Int32: return value + ".IsInt32()";
+        case Type::Int64: return value + ".IsInt64()";
+        case Type::Float64: return value + ".IsFloat64()";
+        case Type::Bool: return value + ".IsBool()";
+        case Type::String: return value + ".IsString()";
+        case Type::Object: return value + ".IsObject()";
+        default: return {};
+    }
+}
+
+std::string Unbox(Type type, const std::string& value) {
+    switch (type) {
+        case Type::Int32: return value + ".AsInt32()";
+        case Type::Int64: return value + ".AsInt64()";
+        case Type::Float64: return value + ".AsFloat64()";
+        case Type::Bool: return value + ".AsBool()";
+        default: return value;
+    }
+}
+
+std::string Int32Literal(int32_t value) {
+    return value == INT32_MIN ? "(-2147483647 - 1)" : std::to_string(value);
+}
+
+std::string Int64Literal(int64_t value) {
+    return value == INT64_MIN ? "(-9223372036854775807LL - 1)"
+                              : "static_cast<int64_t>(" + std::to_string(value) + "LL)";
+}
+
+// A decimal literal where it reads back exactly, the bit pattern otherwise
+// (NaN, infinities, negative zero).
+std::string Float64Literal(double value) {
+    if (std::isfinite(value) && !(value == 0.0 && std::signbit(value))) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        if (std::strtod(buffer, nullptr) == value) {
+            std::string literal = buffer;
+            if (literal.find_first_of(".en") == std::string::npos) {
+                literal += ".0";
+            }
+            return literal;
+        }
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "ObjectIR::Aot::F64(0x%016" PRIx64 "ull)", bits);
+    return buffer;
+}
+
+std::string CString(const std::string& text) {
+    std::string literal = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            literal += '\\';
+            literal += static_cast<char>(c);
+        } else if (c < 0x20 || c >= 0x7F) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\%03o", c);
+            literal += escape;
+        } else {
+            literal += static_cast<char>(c);
+        }
+    }
+    return literal + "\"";
+}
+
+// FNV-1a, 64 bit.
+class Hasher {
+public:
+    void Bytes(const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            _hash = (_hash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+    void Number(uint64_t value) { Bytes(&value, sizeof(value)); }
+    void Text(const std::string& text) {
+        Number(text.size());
+        Bytes(text.data(), text.size());
+    }
+    [[nodiscard]] uint64_t Get() const { return _hash; }
+
+private:
+    uint64_t _hash = 14695981039346656037ull;
+};
+
+/// A method body considered for translation.
+struct Candidate {
+    MethodRef method;
+    std::string className;
+    std::string signature;
+    std::shared_ptr<PreparedMethod> prepared;
+    std::vector<BytecodeInstruction> code; // generic ops
+    std::vector<VerifiedFrameState> states;
+    std::vector<Type> parameterTypes;
+    bool returnsVoid = false;
+    Type returnType = Type::Unknown; // of the values its Ret instructions return
+    bool rejected = false;
+    std::string reason;
+};
+
+struct DirectCallInfo {
+    size_t caller;
+    size_t site;
+    size_t callee;
+};
+
+std::string ReturnCppType(const Candidate& candidate) {
+    return candidate.returnsVoid ? "void" : CppType(RepOf(candidate.returnType));
+}
+
+/// Writes the typed function of one method. Slot `i` of kind k (stack `s`,
+/// locals `l`, arguments `a`) holding a value of type T lives in the C++
+/// variable `<k><i>_<rep of T>`; the verifier proves that every path into an
+/// instruction leaves a slot with the same type, or Unknown, and values are
+/// boxed on the edges into an Unknown slot.
+class MethodEmitter {
+public:
+    MethodEmitter(VirtualMachine& vm, const std::vector<Candidate>& candidates,
+                  const std::unordered_map<const Method*, size_t>& indices, size_t self,
+                  std::vector<DirectCallInfo>& directCalls)
+        : _vm(vm), _candidates(candidates), _indices(indices), _c(candidates[self]),
+          _index(indices.at(_c.method.get())), _directCalls(directCalls) {}
+
+    std::string Emit() {
+        const size_t n = _c.code.size();
+        std::vector<bool> labels(n, false);
+        for (size_t pc = 0; pc < n; ++pc) {
+            if (_c.states[pc].reached && IsBranch(_c.code[pc].op)) {
+                labels[static_cast<size_t>(_c.code[pc].a)] = true;
+            }
+        }
+
+        for (size_t i = 0; i < _c.parameterTypes.size(); ++i) {
+            _parameters.insert(Name('a', i, _c.parameterTypes[i]));
+        }
+
+        std::ostringstream body;
+        for (size_t pc = 0; pc < n; ++pc) {
+            const VerifiedFrameState& in = _c.states[pc];
+            if (!in.reached) {
+                continue;
+            }
+            if (labels[pc]) {
+                body << "L" << pc << ":\n";
+            }
+            _line.str({});
+            EmitInstruction(pc, in);
+            body << _line.str();
+        }
+
+        std::ostringstream function;
+        function << Prototype() << " {\n";
+        for (const auto& variable : _variables) {
+            const Rep rep = variable.second;
+            function << "    " << CppType(rep) << " " << variable.first
+                     << (rep == Rep::Boxed ? "" : rep == Rep::Bool ? " = false" : " = 0") << ";\n";
+        }
+        function << body.str();
+        if (!_c.returnsVoid) {
+            function << "    return {};\n";
+        }
+        function << "}\n";
+        return function.str();
+    }
+
+    std::string Prototype() const {
+        std::ostringstream prototype;
+        prototype << ReturnCppType(_c) << " M" << _index
+                  << "([[maybe_unused]] ObjectIR::Aot::Module& m, [[maybe_unused]] ObjectIR::VirtualMachine* vm";
+        for (size_t i = 0; i < _c.parameterTypes.size(); ++i) {
+            prototype << ", " << CppType(RepOf(_c.parameterTypes[i])) << " " << Name('a', i, _c.parameterTypes[i]);
+        }
+        prototype << ")";
+        return prototype.str();
+    }
+
+private:
+    static bool IsBranch(BytecodeOp op) {
+        switch (op) {
+            case BytecodeOp::Br:
+            case BytecodeOp::BrTrue:
+            case BytecodeOp::BrFalse:
+            case BytecodeOp::Beq:
+            case BytecodeOp::Bne:
+            case BytecodeOp::Bgt:
+            case BytecodeOp::Blt:
+            case BytecodeOp::Bge:
+            case BytecodeOp::Ble:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static std::string Name(char kind, size_t index, Type type) {
+        return std::string(1, kind) + std::to_string(index) + "_" + Suffix(RepOf(type));
+    }
+
+    // Variable of a slot, declared on first use.
+    std::string Slot(char kind, size_t index, Type type) {
+        std::string name = Name(kind, index, type);
+        if (!_parameters.count(name)) {
+            _variables.emplace(name, RepOf(type));
+        }
+        return name;
+    }
+
+    std::string Stack(size_t index, Type type) { return Slot('s', index, type); }
+
+    void Statement(const std::string& text) { _line << "    " << text << "\n"; }
+
+    // Statements that carry the slots from `out` (the state an instruction
+    // leaves) into `in` (the state its successor expects).
+    std::string Transfer(const VerifiedFrameState& out, const VerifiedFrameState& in) {
+        std::string moves;
+        auto slots = [&](char kind, const std::vector<Type>& from, const std::vector<Type>& to) {
+            for (size_t i = 0; i < from.size() && i < to.size(); ++i) {
+                if (from[i] == to[i]) {
+                    continue;
+                }
+                if (RepOf(to[i]) != Rep::Boxed) {
+                    throw Unsupported("slot types disagree at a merge");
+                }
+                if (RepOf(from[i]) != Rep::Boxed) {
+                    moves += Slot(kind, i, to[i]) + " = ObjectIR::Aot::Box(" + Slot(kind, i, from[i]) + "); ";
+                }
+            }
+        };
+        if (out.stack.size() != in.stack.size()) {
+            throw Unsupported("stack depths disagree at a merge");
+        }
+        slots('s', out.stack, in.stack);
+        slots('l', out.locals, in.locals);
+        slots('a', out.arguments, in.arguments);
+        return moves;
+    }
+
+    void FallThrough(size_t pc, const VerifiedFrameState& out) {
+        if (pc + 1 >= _c.code.size()) {
+            throw Unsupported("falls off the end of the body");
+        }
+        const std::string moves = Transfer(out, _c.states[pc + 1]);
+        if (!moves.empty()) {
+            Statement(moves.substr(0, moves.size() - 1));
+        }
+    }
+
+    void Jump(const std::string& condition, size_t target, const VerifiedFrameState& out) {
+        const std::string moves = Transfer(out, _c.states[target]);
+        const std::string jump = moves + "goto L" + std::to_string(target) + ";";
+        if (condition.empty()) {
+            Statement(jump);
+        } else if (moves.empty()) {
+            Statement("if (" + condition + ") " + jump);
+        } else {
+            Statement("if (" + condition + ") { " + jump + " }");
+        }
+    }
+
+    static std::string ToInt64(const std::string& value, Type type) {
+        return type == Type::Int64 ? value : "static_cast<int64_t>(" + value + ")";
+    }
+
+    static std::string ToDouble(const std::string& value, Type type) {
+        return type == Type::Float64 ? value : "static_cast<double>(" + value + ")";
+    }
+
+    // `left op right` with the conversions of the interpreter's compare
+    // handlers (ExecuteCeq, CompareBranch, ...).
+    std::string Compare(BytecodeOp op, Type a, const std::string& x, Type b, const std::string& y) const {
+        const char* symbol = nullptr;
+        bool equality = false;
+        switch (op) {
+            case BytecodeOp::Ceq: case BytecodeOp::Beq: symbol = "=="; equality = true; break;
+            case BytecodeOp::Cne: case BytecodeOp::Bne: symbol = "!="; equality = true; break;
+            case BytecodeOp::Clt: case BytecodeOp::Blt: symbol = "<"; break;
+            case BytecodeOp::Cle: case BytecodeOp::Ble: symbol = "<="; break;
+            case BytecodeOp::Cgt: case BytecodeOp::Bgt: symbol = ">"; break;
+            default: symbol = ">="; break;
+        }
+        const std::string infix = std::string(" ") + symbol + " ";
+        if (a == Type::Int32 && b == Type::Int32) {
+            return x + infix + y;
+        }
+        if (IsInteger(a) && IsInteger(b)) {
+            return ToInt64(x, a) + infix + ToInt64(y, b);
+        }
+        if (equality && a == Type::String && b == Type::String) {
+            return std::string(op == BytecodeOp::Ceq || op == BytecodeOp::Beq ? "" : "!") +
+                   "ObjectIR::Aot::StringEquals(" + x + ", " + y + ")";
+        }
+        if (equality && a == Type::Bool && b == Type::Bool) {
+            return x + infix + y;
+        }
+        if (IsNumber(a) && IsNumber(b)) {
+            return ToDouble(x, a) + infix + ToDouble(y, b);
+        }
+        throw Unsupported(std::string(GetBytecodeOpName(op)) + " on " + TypeName(a) + " and " + TypeName(b));
+    }
+
+    // Condition BrTrue tests, with the truth of ValueToBool.
+    std::string Truth(Type type, const std::string& value) const {
+        switch (type) {
+            case Type::Bool: return value;
+            case Type::Int32:
+            case Type::Int64: return value + " != 0";
+            case Type::Float64: return value + " != 0.0";
+            case Type::String: return "ObjectIR::Aot::StringTruthy(" + value + ")";
+            case Type::Null: return "false";
+            default: throw Unsupported(std::string("branch on ") + TypeName(type));
+        }
+    }
+
+    // Result type and expression of a generic arithmetic instruction, with
+    // the conversions of ExecuteAdd and friends.
+    std::pair<Type, std::string> Arithmetic(BytecodeOp op, Type a, const std::string& x, Type b,
+                                            const std::string& y) const {
+        if (!IsNumber(a) || !IsNumber(b)) {
+            throw Unsupported(std::string(GetBytecodeOpName(op)) + " on " + TypeName(a) + " and " + TypeName(b));
+        }
+        const char* name = GetBytecodeOpName(op);
+        if (a == Type::Int32 && b == Type::Int32) {
+            return {Type::Int32, std::string("ObjectIR::Aot::") + name + "I32(" + x + ", " + y + ")"};
+        }
+        if (a == Type::Int64 || b == Type::Int64) {
+            return {Type::Int64, std::string("ObjectIR::Aot::") + name + "I64(" + ToInt64(x, a) + ", " + ToInt64(y, b) + ")"};
+        }
+        const char* symbol = nullptr;
+        switch (op) {
+            case BytecodeOp::Add: symbol = " + "; break;
+            case BytecodeOp::Sub: symbol = " - "; break;
+            case BytecodeOp::Mul: symbol = " * "; break;
+            case BytecodeOp::Div: symbol = " / "; break;
+            default: throw Unsupported("floating point remainder");
+        }
+        return {Type::Float64, ToDouble(x, a) + symbol + ToDouble(y, b)};
+    }
+
+    void EmitCall(size_t pc, VerifiedFrameState& out) {
+        const int32_t siteIndex = _c.code[pc].a;
+        const CallSite& site = _c.prepared->callSites[static_cast<size_t>(siteIndex)];
+        const size_t depth = out.stack.size();
+        const size_t count = site.argumentCount;
+        const size_t first = depth - count;
+        const Type resultType = site.isVoidReturn ? Type::Unknown : DeclaredResultType(site.target.returnType);
+        const std::string siteRef = "m.Site(" + std::to_string(_index) + ", " + std::to_string(siteIndex) + ")";
+
+        std::string boxed;
+        for (size_t i = first; i < depth; ++i) {
+            boxed += (i == first ? "" : ", ") + std::string("ObjectIR::Aot::Box(") + Stack(i, out.stack[i]) + ")";
+        }
+        std::string viaVm = "ObjectIR::InstructionExecutor::InvokeStaticCallSite(" + siteRef + ", {" + boxed + "}, vm)";
+
+        std::string target;
+        if (!site.isVoidReturn) {
+            target = Stack(first, resultType) + " = ";
+            if (RepOf(resultType) != Rep::Boxed) {
+                viaVm = std::string("ObjectIR::Aot::Expect<") + CppType(RepOf(resultType)) + ">(" + viaVm + ", " + siteRef + ")";
+            }
+        }
+
+        const std::string direct = DirectCall(site, out, first, resultType);
+        if (direct.empty()) {
+            Statement(target + viaVm + ";");
+        } else {
+            _directCalls.push_back(DirectCallInfo{_index, static_cast<size_t>(siteIndex),
+                                                  _indices.at(_candidates[_callee].method.get())});
+            Statement("if (m.Direct()) {");
+            Statement("    " + target + direct + ";");
+            Statement("} else {");
+            Statement("    " + target + viaVm + ";");
+            Statement("}");
+        }
+
+        out.stack.resize(first);
+        if (!site.isVoidReturn) {
+            out.stack.push_back(resultType);
+        }
+    }
+
+    // Expression calling the function of the precompiled method a static call
+    // site resolves to, or empty if the call has to go through the VM.
+    std::string DirectCall(const CallSite& site, const VerifiedFrameState& state, size_t first, Type resultType) {
+        if (site.isConsoleWriteLine) {
+            return {};
+        }
+        MethodRef callee;
+        try {
+            callee = _vm.ResolveMethod(_vm.GetClass(site.declaringType), site.name, site.target, true);
+        } catch (const std::exception&) {
+            return {};
+        }
+        const auto found = _indices.find(callee.get());
+        if (found == _indices.end()) {
+            return {};
+        }
+        size_t calleeCandidate = 0;
+        while (_candidates[calleeCandidate].method != callee) {
+            ++calleeCandidate;
+        }
+        const Candidate& target = _candidates[calleeCandidate];
+
+        // The callee must run its verified body for these arguments, and
+        // return what the caller was compiled to expect.
+        if (target.parameterTypes.size() != site.argumentCount) {
+            return {};
+        }
+        std::string arguments;
+        for (size_t i = 0; i < site.argumentCount; ++i) {
+            const Type parameter = target.parameterTypes[i];
+            const Type argument = state.stack[first + i];
+            if (parameter != Type::Unknown && parameter != argument) {
+                return {};
+            }
+            const std::string value = Stack(first + i, argument);
+            arguments += ", " + (RepOf(parameter) == Rep::Boxed ? "ObjectIR::Aot::Box(" + value + ")" : value);
+        }
+        std::string call = "M" + std::to_string(found->second) + "(m, vm" + arguments + ")";
+        if (!site.isVoidReturn) {
+            if (target.returnsVoid) {
+                return {};
+            }
+            if (RepOf(resultType) == Rep::Boxed) {
+                call = "ObjectIR::Aot::Box(" + call + ")";
+            } else if (target.returnType != resultType) {
+                return {};
+            }
+        }
+        _callee = calleeCandidate;
+        return call;
+    }
+
+    void EmitInstruction(size_t pc, const VerifiedFrameState& in) {
+        const BytecodeInstruction& instr = _c.code[pc];
+        VerifiedFrameState out = in;
+        auto& stack = out.stack;
+        const size_t depth = stack.size();
+        const auto a = static_cast<size_t>(instr.a);
+
+        switch (instr.op) {
+            case BytecodeOp::Nop:
+                break;
+
+            case BytecodeOp::Dup:
+                Statement(Stack(depth, stack.back()) + " = " + Stack(depth - 1, stack.back()) + ";");
+                stack.push_back(stack.back());
+                break;
+
+            case BytecodeOp::Pop:
+                if (RepOf(stack.back()) == Rep::Boxed) {
+                    Statement(Stack(depth - 1, stack.back()) + " = ObjectIR::Value();");
+                }
+                stack.pop_back();
+                break;
+
+            case BytecodeOp::LdArg:
+                Statement(Stack(depth, out.arguments[a]) + " = " + Slot('a', a, out.arguments[a]) + ";");
+                stack.push_back(out.arguments[a]);
+                break;
+
+            case BytecodeOp::StArg:
+                Statement(Slot('a', a, stack.back()) + " = " + Stack(depth - 1, stack.back()) + ";");
+                out.arguments[a] = stack.back();
+                stack.pop_back();
+                break;
+
+            case BytecodeOp::LdLoc:
+                Statement(Stack(depth, out.locals[a]) + " = " + Slot('l', a, out.locals[a]) + ";");
+                stack.push_back(out.locals[a]);
+                break;
+
+            case BytecodeOp::StLoc:
+                Statement(Slot('l', a, stack.back()) + " = " + Stack(depth - 1, stack.back()) + ";");
+                out.locals[a] = stack.back();
+                stack.pop_back();
+                break;
+
+            case BytecodeOp::LdConst: {
+                const Value& constant = _c.prepared->constants[a];
+                Type type;
+                std::string value;
+                if (constant.IsInt32()) {
+                    type = Type::Int32;
+                    value = Int32Literal(constant.AsInt32());
+                } else if (constant.IsInt64()) {
+                    type = Type::Int64;
+                    value = Int64Literal(constant.AsInt64());
+                } else if (constant.IsFloat64()) {
+                    type = Type::Float64;
+                    value = Float64Literal(constant.AsFloat64());
+                } else if (constant.IsBool()) {
+                    type = Type::Bool;
+                    value = constant.AsBool() ? "true" : "false";
+                } else if (constant.IsString()) {
+                    type = Type::String;
+                    value = "m.Constant(" + std::to_string(_index) + ", " + std::to_string(a) + ")";
+                } else if (constant.IsNull()) {
+                    type = Type::Null;
+                    value = "ObjectIR::Value()";
+                } else {
+                    throw Unsupported(constant.IsFloat32() ? "float32 values" : "object constants");
+                }
+                Statement(Stack(depth, type) + " = " + value + ";");
+                stack.push_back(type);
+                break;
+            }
+
+            case BytecodeOp::LdNull:
+                Statement(Stack(depth, Type::Null) + " = ObjectIR::Value();");
+                stack.push_back(Type::Null);
+                break;
+
+            case BytecodeOp::Add:
+            case BytecodeOp::Sub:
+            case BytecodeOp::Mul:
+            case BytecodeOp::Div:
+            case BytecodeOp::Rem: {
+                const Type left = stack[depth - 2];
+                const Type right = stack[depth - 1];
+                const auto result = Arithmetic(instr.op, left, Stack(depth - 2, left), right, Stack(depth - 1, right));
+                Statement(Stack(depth - 2, result.first) + " = " + result.second + ";");
+                stack.pop_back();
+                stack.back() = result.first;
+                break;
+            }
+
+            case BytecodeOp::Neg: {
+                const Type type = stack.back();
+                const std::string value = Stack(depth - 1, type);
+                std::string negated;
+                switch (type) {
+                    case Type::Int32: negated = "ObjectIR::Aot::NegI32(" + value + ")"; break;
+                    case Type::Int64: negated = "ObjectIR::Aot::NegI64(" + value + ")"; break;
+                    case Type::Float64: negated = "-" + value; break;
+                    default: throw Unsupported(std::string("Neg on ") + TypeName(type));
+                }
+                Statement(value + " = " + negated + ";");
+                break;
+            }
+
+            case BytecodeOp::Ceq:
+            case BytecodeOp::Cne:
+            case BytecodeOp::Clt:
+            case BytecodeOp::Cle:
+            case BytecodeOp::Cgt:
+            case BytecodeOp::Cge: {
+                const Type left = stack[depth - 2];
+                const Type right = stack[depth - 1];
+                const std::string condition =
+                    Compare(instr.op, left, Stack(depth - 2, left), right, Stack(depth - 1, right));
+                Statement(Stack(depth - 2, Type::Bool) + " = " + condition + ";");
+                stack.pop_back();
+                stack.back() = Type::Bool;
+                break;
+            }
+
+            case BytecodeOp::Ret:
+                if (_c.returnsVoid) {
+                    Statement("return;");
+                } else if (stack.empty()) {
+                    Statement("return ObjectIR::Value();");
+                } else if (RepOf(_c.returnType) == Rep::Boxed) {
+                    Statement("return ObjectIR::Aot::Box(" + Stack(depth - 1, stack.back()) + ");");
+                } else {
+                    Statement("return " + Stack(depth - 1, stack.back()) + ";");
+                }
+                return;
+
+            case BytecodeOp::Br:
+                Jump({}, a, out);
+                return;
+
+            case BytecodeOp::BrTrue:
+            case BytecodeOp::BrFalse: {
+                const Type type = stack.back();
+                std::string condition = Truth(type, Stack(depth - 1, type));
+                if (instr.op == BytecodeOp::BrFalse) {
+                    condition = "!(" + condition + ")";
+                }
+                stack.pop_back();
+                Jump(condition, a, out);
+                break;
+            }
+
+            case BytecodeOp::Beq:
+            case BytecodeOp::Bne:
+            case BytecodeOp::Bgt:
+            case BytecodeOp::Blt:
+            case BytecodeOp::Bge:
+            case BytecodeOp::Ble: {
+                const Type left = stack[depth - 2];
+                const Type right = stack[depth - 1];
+                const std::string condition =
+                    Compare(instr.op, left, Stack(depth - 2, left), right, Stack(depth - 1, right));
+                stack.resize(depth - 2);
+                Jump(condition, a, out);
+                break;
+            }
+
+            case BytecodeOp::Call:
+                EmitCall(pc, out);
+                break;
+
+            default:
+                throw Unsupported(std::string("instruction ") + GetBytecodeOpName(instr.op));
+        }
+        FallThrough(pc, out);
+    }
+
+    VirtualMachine& _vm;
+    const std::vector<Candidate>& _candidates;
+    const std::unordered_map<const Method*, size_t>& _indices;
+    const Candidate& _c;
+    const size_t _index; // of the method in the generated plugin
+    std::vector<DirectCallInfo>& _directCalls;
+    size_t _callee = 0;
+
+    std::unordered_set<std::string> _parameters;
+    std::map<std::string, Rep> _variables;
+    std::ostringstream _line;
+};
+
+// Entry of a precompiled method: the argument check of CanRunVerified, then
+// the typed function.
+std::string EmitEntry(const Candidate& candidate, size_t index) {
+    const std::string id = std::to_string(index);
+    std::ostringstream entry;
+    entry << "ObjectIR::Value E" << id
+          << "(ObjectIR::Aot::Module& m, ObjectIR::ObjectRef self, const std::vector<ObjectIR::Value>& args, "
+             "ObjectIR::VirtualMachine* vm) {\n";
+
+    std::string check = "args.size() != " + std::to_string(candidate.parameterTypes.size());
+    std::string arguments;
+    for (size_t i = 0; i < candidate.parameterTypes.size(); ++i) {
+        const std::string value = "args[" + std::to_string(i) + "]";
+        const std::string test = ArgumentCheck(candidate.parameterTypes[i], value);
+        if (!test.empty()) {
+            check += " || !" + test;
+        }
+        arguments += ", " + Unbox(candidate.parameterTypes[i], value);
+    }
+    entry << "    if (" << check << ") {\n"
+          << "        return m.Interpret(" << id << ", std::move(self), args, vm);\n"
+          << "    }\n";
+    const std::string call = "M" + id + "(m, vm" + arguments + ")";
+    if (candidate.returnsVoid) {
+        entry << "    " << call << ";\n"
+              << "    return ObjectIR::Value();\n";
+    } else {
+        entry << "    return ObjectIR::Aot::Box(" << call << ");\n";
+    }
+    entry << "}\n";
+    return entry.str();
+}
+
+} // namespace
+
+std::string AotCompiler::Signature(const Method& method) {
+    std::string signature = method.GetName() + "(";
+    const auto& parameters = method.GetParameters();
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        if (i) signature += ", ";
+        signature += TypeNames::CanonicalTypeName(parameters[i].second);
+    }
+    return signature + ") -> " + TypeNames::CanonicalTypeName(method.GetReturnType());
+}
+
+uint64_t AotCompiler::Fingerprint(const Method& method) {
+    Hasher hash;
+    hash.Text(Signature(method));
+    hash.Number(method.IsStatic() ? 1 : 0);
+    for (const auto& local : method.GetLocals()) {
+        hash.Text(TypeNames::CanonicalTypeName(local.second));
+    }
+
+    const auto prepared = method.GetPrepared();
+    hash.Number(prepared->argumentCount);
+    hash.Number(prepared->localCount);
+    hash.Number(prepared->code.size());
+    // Quickening and superinstructions rewrite opcodes, never operands.
+    for (const auto& instr : prepared->code) {
+        hash.Number(static_cast<uint64_t>(GetGenericBytecodeOp(instr.op)));
+        hash.Number(static_cast<uint32_t>(instr.a));
+    }
+    for (const auto& constant : prepared->constants) {
+        hash.Number(static_cast<uint64_t>(constant.GetTag()));
+        if (constant.IsInt32()) {
+            hash.Number(static_cast<uint32_t>(constant.AsInt32()));
+        } else if (constant.IsInt64()) {
+            hash.Number(static_cast<uint64_t>(constant.AsInt64()));
+        } else if (constant.IsFloat32()) {
+            const float value = constant.AsFloat32();
+            hash.Bytes(&value, sizeof(value));
+        } else if (constant.IsFloat64()) {
+            const double value = constant.AsFloat64();
+            hash.Bytes(&value, sizeof(value));
+        } else if (constant.IsBool()) {
+            hash.Number(constant.AsBool() ? 1 : 0);
+        } else if (constant.IsString()) {
+            hash.Text(constant.AsStringRef());
+        }
+    }
+    for (const auto& site : prepared->callSites) {
+        hash.Text(site.target.declaringType);
+        hash.Text(site.target.name);
+        hash.Text(site.target.returnType);
+        for (const auto& parameter : site.target.parameterTypes) {
+            hash.Text(parameter);
+        }
+        hash.Number(site.argumentCount);
+    }
+    for (const auto& site : prepared->fieldSites) {
+        hash.Text(site.name);
+    }
+    for (const auto& site : prepared->typeSites) {
+        hash.Text(site.name);
+    }
+    for (const auto& message : prepared->messages) {
+        hash.Text(message);
+    }
+    return hash.Get();
+}
+
+std::string AotCompiler::GenerateSource(
+    VirtualMachine& vm,
+    const std::string& pluginName,
+    std::vector<AotMethodReport>* report
+) {
+    std::vector<Candidate> candidates;
+    TieredExecution::OptimizeAll(vm);
+
+    // Classes are registered under several names; translate each one once.
+    std::unordered_set<const Class*> seen;
+    for (const auto& name : vm.GetAllClassNames()) {
+        const ClassRef cls = vm.GetClass(name);
+        if (!cls || !seen.insert(cls.get()).second) {
+            continue;
+        }
+        std::string className = TypeNames::GetQualifiedClassName(cls);
+        if (!vm.HasClass(className) || vm.GetClass(className) != cls) {
+            className = name;
+        }
+
+        for (const auto& method : cls->GetAllMethods()) {
+            if (!method || method->GetNativeImpl() || !method->HasInstructions()) {
+                continue;
+            }
+            Candidate candidate;
+            candidate.method = method;
+            candidate.className = className;
+            candidate.signature = Signature(*method);
+            candidate.prepared = method->GetPrepared();
+
+            const PreparedMethod& prepared = *candidate.prepared;
+            const TypeReference& returnType = method->GetReturnType();
+            candidate.returnsVoid = returnType.IsPrimitive() && !returnType.IsArray() &&
+                                    returnType.GetPrimitiveType() == PrimitiveType::Void;
+            std::string error;
+            if (!prepared.verified) {
+                candidate.rejected = true;
+                candidate.reason = "not verified: " + prepared.verificationError;
+            } else if (prepared.HasExceptionHandling()) {
+                candidate.rejected = true;
+                candidate.reason = "has exception handlers";
+            } else {
+                candidate.parameterTypes = prepared.argumentTypes;
+                candidate.code = prepared.code;
+                for (auto& instr : candidate.code) {
+                    instr.op = GetGenericBytecodeOp(instr.op);
+                    if (instr.op == BytecodeOp::InlineGuard) {
+                        // Generated code always makes the original call.
+                        instr.op = BytecodeOp::Br;
+                    }
+                }
+                if (!BytecodeVerifier::InferFrameStates(*method, prepared, candidate.code, true,
+                                                        candidate.states, error)) {
+                    candidate.rejected = true;
+                    candidate.reason = error;
+                }
+            }
+
+            if (!candidate.rejected && !candidate.returnsVoid) {
+                bool first = true;
+                for (size_t pc = 0; pc < candidate.code.size(); ++pc) {
+                    const auto& state = candidate.states[pc];
+                    if (!state.reached || candidate.code[pc].op != BytecodeOp::Ret) {
+                        continue;
+                    }
+                    const Type type = state.stack.empty() ? Type::Null : state.stack.back();
+                    candidate.returnType = first || candidate.returnType == type ? type : Type::Unknown;
+                    first = false;
+                }
+            }
+            candidates.push_back(std::move(candidate));
+        }
+    }
+
+    // Translate until no method drops out: callers of a method that cannot be
+    // translated have to call it through the VM.
+    std::unordered_map<const Method*, size_t> indices;
+    std::vector<std::string> functions;
+    std::vector<std::string> prototypes;
+    std::vector<DirectCallInfo> directCalls;
+    for (bool retry = true; retry;) {
+        retry = false;
+        indices.clear();
+        functions.clear();
+        prototypes.clear();
+        directCalls.clear();
+        for (const auto& candidate : candidates) {
+            if (!candidate.rejected) {
+                const size_t index = indices.size();
+                indices.emplace(candidate.method.get(), index);
+            }
+        }
+        for (size_t i = 0; i < candidates.size() && !retry; ++i) {
+            Candidate& candidate = candidates[i];
+            if (candidate.rejected) {
+                continue;
+            }
+            try {
+                MethodEmitter emitter(vm, candidates, indices, i, directCalls);
+                for (const Type type : candidate.parameterTypes) {
+                    (void)RepOf(type);
+                }
+                if (!candidate.returnsVoid) {
+                    (void)RepOf(candidate.returnType);
+                }
+                prototypes.push_back(emitter.Prototype());
+                functions.push_back("// " + candidate.className + "." + candidate.signature + "\n" + emitter.Emit());
+            } catch (const Unsupported& unsupported) {
+                candidate.rejected = true;
+                candidate.reason = unsupported.what();
+                retry = true;
+            }
+        }
+    }
+
+    std::ostringstream source;
+    source << "// Generated by objectir_aot. Do not edit.\n"
+           << "//\n"
+           << "// Plugin " << pluginName << ": " << indices.size() << " precompiled method"
+           << (indices.size() == 1 ? "" : "s")
+           << ", installed by ObjectIR_PluginInit (see ObjectIR::AotCompiler).\n\n"
+           << "#include \"objectir_aot_support.hpp\"\n\n"
+           << "namespace {\n\n";
+    for (const auto& prototype : prototypes) {
+        source << prototype << ";\n";
+    }
+    source << "\n";
+    for (const auto& function : functions) {
+        source << function << "\n";
+    }
+
+    size_t index = 0;
+    for (const auto& candidate : candidates) {
+        if (!candidate.rejected) {
+            source << EmitEntry(candidate, index++) << "\n";
+        }
+    }
+
+    source << "const std::vector<ObjectIR::Aot::MethodInfo> kMethods = {\n";
+    index = 0;
+    for (const auto& candidate : candidates) {
+        if (candidate.rejected) {
+            continue;
+        }
+        char fingerprint[32];
+        std::snprintf(fingerprint, sizeof(fingerprint), "0x%016" PRIx64 "ull", Fingerprint(*candidate.method));
+        source << "    {" << CString(candidate.className) << ", " << CString(candidate.signature) << ", "
+               << fingerprint << ", E" << index++ << "},\n";
+    }
+    source << "};\n\n"
+           << "const std::vector<ObjectIR::Aot::DirectCall> kDirectCalls = {\n";
+    for (const auto& call : directCalls) {
+        source << "    {" << call.caller << ", " << call.site << ", "
+               << call.callee << "},\n";
+    }
+    source << "};\n\n"
+           << "const char* const kPluginName = " << CString(pluginName) << ";\n"
+           << "std::vector<std::shared_ptr<ObjectIR::Aot::Module>> g_modules;\n\n"
+           << "} // namespace\n\n"
+           << "OBJECTIR_AOT_EXPORT int32_t ObjectIR_PluginGetInfo(ObjectIR_PluginInfoV1* outInfo) {\n"
+           << "    return ObjectIR::Aot::GetPluginInfo(outInfo, kPluginName);\n"
+           << "}\n\n"
+           << "OBJECTIR_AOT_EXPORT bool ObjectIR_PluginInit(ObjectIR::VirtualMachine* vm) {\n"
+           << "    try {\n"
+           << "        g_modules.push_back(ObjectIR::Aot::Install(vm, kMethods, kDirectCalls, kPluginName));\n"
+           << "        return true;\n"
+           << "    } catch (const std::exception& ex) {\n"
+           << "        std::fprintf(stderr, \"[%s] init failed: %s\\n\", kPluginName, ex.what());\n"
+           << "        return false;\n"
+           << "    }\n"
+           << "}\n\n"
+           << "OBJECTIR_AOT_EXPORT void ObjectIR_PluginShutdown(ObjectIR::VirtualMachine* vm) {\n"
+           << "    for (auto it = g_modules.begin(); it != g_modules.end();) {\n"
+           << "        if ((*it)->vm == vm) {\n"
+           << "            ObjectIR::Aot::Uninstall(**it);\n"
+           << "            it = g_modules.erase(it);\n"
+           << "        } else {\n"
+           << "            ++it;\n"
+           << "        }\n"
+           << "    }\n"
+           << "}\n";
+
+    if (report) {
+        for (const auto& candidate : candidates) {
+            report->push_back(AotMethodReport{candidate.className, candidate.signature, !candidate.rejected,
+                                              candidate.reason});
+        }
+    }
+    return source.str();
+}
+
+} // namespace ObjectIR
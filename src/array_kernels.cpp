@@ -0,0 +1,36 @@
+#include "array_kernels.hpp"
+#include "array_kernels_simd.hpp"
+
+namespace ObjectIR {
+
+namespace {
+
+const ArrayKernelTable& ScalarArrayKernels() {
+    static const ArrayKernelTable kernels = ArrayKernels<0>::MakeTable("scalar");
+    return kernels;
+}
+
+} // namespace
+
+std::vector<const ArrayKernelTable*> GetAllArrayKernels() {
+    std::vector<const ArrayKernelTable*> tables;
+#if defined(OBJECTIR_SIMD) && defined(__x86_64__) && defined(__GNUC__)
+    if (__builtin_cpu_supports("avx2")) {
+        if (const ArrayKernelTable* avx2 = GetAvx2ArrayKernels()) {
+            tables.push_back(avx2);
+        }
+    }
+    // SSE2 is part of x86-64.
+    static const ArrayKernelTable sse2 = ArrayKernels<16>::MakeTable("sse2");
+    tables.push_back(&sse2);
+#endif
+    tables.push_back(&ScalarArrayKernels());
+    return tables;
+}
+
+const ArrayKernelTable& GetArrayKernels() {
+    static const ArrayKernelTable& kernels = *GetAllArrayKernels().front();
+    return kernels;
+}
+
+} // namespace ObjectIR
@@ -0,0 +1,22 @@
+// Built with -mavx2 (see CMakeLists.txt). Nothing here runs unless
+// GetArrayKernels has checked that the CPU supports AVX2, so nothing here may
+// be shared with other files either: see array_kernels_simd.hpp.
+
+#include "array_kernels.hpp"
+
+#if defined(OBJECTIR_SIMD) && defined(__AVX2__)
+    #include "array_kernels_simd.hpp"
+#endif
+
+namespace ObjectIR {
+
+const ArrayKernelTable* GetAvx2ArrayKernels() {
+#if defined(OBJECTIR_SIMD) && defined(__AVX2__)
+    static const ArrayKernelTable kernels = ArrayKernels<32>::MakeTable("avx2");
+    return &kernels;
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace ObjectIR
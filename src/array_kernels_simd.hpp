@@ -0,0 +1,337 @@
+#pragma once
+
+// Kernel bodies shared by array_kernels.cpp and array_kernels_avx2.cpp. Each
+// includes this once and instantiates ArrayKernels<N> for the vector width
+// it is compiled for; N = 0 gives plain loops. Everything here is in an
+// anonymous namespace so each file keeps its own copy. That does not cover
+// inline functions from other headers, which the linker may take from the
+// AVX2 file for the whole program: call only builtins and constexpr library
+// code from these kernels.
+
+#include "array_kernels.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+
+namespace ObjectIR {
+
+namespace {
+
+// GCC/Clang vector extensions; other compilers only get ArrayKernels<0>.
+// Conversions are a macro so no vector wider than a register crosses a call.
+#if defined(__GNUC__)
+template<typename T, size_t kBytes>
+struct VectorOf {
+    typedef T Type __attribute__((vector_size(kBytes)));
+};
+
+    #define OBJECTIR_CONVERT_VECTOR(vector, Type) __builtin_convertvector(vector, Type)
+#else
+template<typename T, size_t kBytes>
+struct VectorOf;
+
+    #define OBJECTIR_CONVERT_VECTOR(vector, Type) static_cast<Type>(vector)
+#endif
+
+// Integer arithmetic is done on the unsigned type so overflow wraps.
+template<typename T>
+using WrappingType = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>,
+                                                 std::enable_if<true, T>>::type;
+
+template<size_t kVectorBytes>
+struct ArrayKernels {
+    template<typename T>
+    using Vec = typename VectorOf<T, kVectorBytes>::Type;
+
+    template<typename T>
+    static constexpr size_t kLanes = kVectorBytes / sizeof(T);
+
+    template<typename V, typename T>
+    static V Load(const T* source) {
+        V vector;
+        std::memcpy(&vector, source, sizeof(vector));
+        return vector;
+    }
+
+    template<typename T, typename V>
+    static void Store(T* destination, const V& vector) {
+        std::memcpy(destination, &vector, sizeof(vector));
+    }
+
+    // Combines the lanes of `vector` with `combine`. The lanes are read with
+    // constant indices, which lets the vector stay in a register in the loop
+    // that produced it.
+    template<typename V, typename Combine, size_t... kLane>
+    static auto FoldLanes(V vector, Combine combine, std::index_sequence<kLane...>) {
+        auto result = vector[0];
+        ((result = combine(vector[kLane + 1], result)), ...);
+        return result;
+    }
+
+    template<typename T, typename Combine>
+    static T FoldLanes(Vec<T> vector, Combine combine) {
+        return FoldLanes(vector, combine, std::make_index_sequence<kLanes<T> - 1>());
+    }
+
+    template<typename Mask>
+    static bool Any(Mask mask) {
+#if defined(__AVX2__)
+        if constexpr (sizeof(Mask) == 32) {
+            return !_mm256_testz_si256((__m256i)mask, (__m256i)mask);
+        }
+#endif
+#if defined(__SSE2__)
+        if constexpr (sizeof(Mask) == 16) {
+            return _mm_movemask_epi8((__m128i)mask) != 0;
+        }
+#endif
+        uint64_t words[sizeof(Mask) / sizeof(uint64_t)];
+        std::memcpy(words, &mask, sizeof(words));
+        uint64_t any = 0;
+        for (uint64_t word : words) {
+            any |= word;
+        }
+        return any != 0;
+    }
+
+    template<typename T>
+    static void Fill(T* destination, size_t count, T value) {
+        size_t i = 0;
+        if constexpr (kVectorBytes != 0) {
+            const Vec<T> broadcast = Vec<T>{} + value;
+            for (; i + kLanes<T> <= count; i += kLanes<T>) {
+                Store(destination + i, broadcast);
+            }
+        }
+        for (; i < count; ++i) {
+            destination[i] = value;
+        }
+    }
+
+    template<typename T>
+    static int64_t IndexOf(const T* elements, size_t count, T value) {
+        size_t i = 0;
+        if constexpr (kVectorBytes != 0) {
+            const Vec<T> broadcast = Vec<T>{} + value;
+            for (; i + kLanes<T> <= count; i += kLanes<T>) {
+                if (Any(Load<Vec<T>>(elements + i) == broadcast)) {
+                    break; // the loop below finds the lane
+                }
+            }
+        }
+        for (; i < count; ++i) {
+            if (elements[i] == value) {
+                return static_cast<int64_t>(i);
+            }
+        }
+        return -1;
+    }
+
+#if defined(__SSE2__)
+    // Sums each group of 8 bytes into a 64-bit lane (psadbw).
+    template<typename Bytes>
+    static auto SumBytes(Bytes bytes) {
+    #if defined(__AVX2__)
+        if constexpr (kVectorBytes == 32) {
+            return (Vec<uint64_t>)_mm256_sad_epu8((__m256i)bytes, _mm256_setzero_si256());
+        }
+    #endif
+        static_assert(kVectorBytes == 16 || kVectorBytes == 32, "no psadbw for this width");
+        if constexpr (kVectorBytes == 16) {
+            return (Vec<uint64_t>)_mm_sad_epu8((__m128i)bytes, _mm_setzero_si128());
+        }
+    }
+#endif
+
+    // Sum and Dot widen each element to the accumulator type first.
+    template<typename T, bool kDot>
+    static ArrayAccumulator<T> Accumulate(const T* left, const T* right, size_t count) {
+        using Wide = WrappingType<ArrayAccumulator<T>>;
+        Wide total = 0;
+        size_t i = 0;
+#if defined(__SSE2__)
+        if constexpr (kVectorBytes != 0 && !kDot && std::is_same_v<T, uint8_t>) {
+            Vec<uint64_t> partial = {};
+            for (; i + kLanes<T> <= count; i += kLanes<T>) {
+                partial += SumBytes(Load<Vec<T>>(left + i));
+            }
+            total = FoldLanes<uint64_t>(partial, [](uint64_t lane, uint64_t sum) { return sum + lane; });
+        } else
+#endif
+        if constexpr (kVectorBytes != 0 && !kDot && std::is_same_v<T, int32_t>) {
+            // Sign extension is slow before SSE4.1, so add the zero-extended
+            // halves of each 64-bit word and take 2^32 back for every negative
+            // element.
+            Vec<uint64_t> low = {};
+            Vec<uint64_t> high = {};
+            Vec<T> negatives = {};
+            for (; i + kLanes<T> <= count; i += kLanes<T>) {
+                const Vec<T> elements = Load<Vec<T>>(left + i);
+                const auto words = (Vec<uint64_t>)elements;
+                low += words & uint64_t{0xffffffff};
+                high += words >> 32;
+                negatives -= elements < 0;
+            }
+            // Arrays hold fewer than 2^31 elements, so the counts fit.
+            const auto negativeCount = static_cast<uint32_t>(FoldLanes<T>(negatives, [](T lane, T sum) { return sum + lane; }));
+            total = FoldLanes<uint64_t>(low + high, [](uint64_t lane, uint64_t sum) { return sum + lane; }) -
+                    (uint64_t{negativeCount} << 32);
+        } else if constexpr (kVectorBytes != 0) {
+            // Each step widens one accumulator's worth of elements; four
+            // accumulators keep the additions independent.
+            constexpr size_t kStep = kLanes<Wide>;
+            using Narrow = typename VectorOf<T, kStep * sizeof(T)>::Type;
+            Vec<Wide> partial[4] = {};
+            for (; i + 4 * kStep <= count; i += 4 * kStep) {
+                for (size_t k = 0; k < 4; ++k) {
+                    const Vec<Wide> x = OBJECTIR_CONVERT_VECTOR(Load<Narrow>(left + i + k * kStep), Vec<Wide>);
+                    if constexpr (kDot) {
+                        partial[k] += x * OBJECTIR_CONVERT_VECTOR(Load<Narrow>(right + i + k * kStep), Vec<Wide>);
+                    } else {
+                        partial[k] += x;
+                    }
+                }
+            }
+            total = FoldLanes<Wide>(partial[0] + partial[1] + partial[2] + partial[3],
+                                    [](Wide lane, Wide sum) { return sum + lane; });
+        }
+        for (; i < count; ++i) {
+            if constexpr (kDot) {
+                total += static_cast<Wide>(left[i]) * static_cast<Wide>(right[i]);
+            } else {
+                total += static_cast<Wide>(left[i]);
+            }
+        }
+        return static_cast<ArrayAccumulator<T>>(total);
+    }
+
+    template<typename T>
+    static ArrayAccumulator<T> Sum(const T* elements, size_t count) {
+        return Accumulate<T, false>(elements, nullptr, count);
+    }
+
+    template<typename T>
+    static ArrayAccumulator<T> Dot(const T* left, const T* right, size_t count) {
+        return Accumulate<T, true>(left, right, count);
+    }
+
+    template<typename T, bool kMax>
+    static T Better(T candidate, T best) {
+        if constexpr (kMax) {
+            return candidate > best ? candidate : best;
+        } else {
+            return candidate < best ? candidate : best;
+        }
+    }
+
+    template<typename T, bool kMax>
+    static T Extreme(const T* elements, size_t count) {
+        T best = elements[0];
+        bool nan = elements[0] != elements[0];
+        size_t i = 1;
+        if constexpr (kVectorBytes != 0) {
+            if (count >= kLanes<T>) {
+                Vec<T> extreme = Load<Vec<T>>(elements);
+                auto nanLanes = extreme != extreme;
+                for (i = kLanes<T>; i + kLanes<T> <= count; i += kLanes<T>) {
+                    const Vec<T> vector = Load<Vec<T>>(elements + i);
+                    if constexpr (kMax) {
+                        extreme = vector > extreme ? vector : extreme;
+                    } else {
+                        extreme = vector < extreme ? vector : extreme;
+                    }
+                    if constexpr (std::is_floating_point_v<T>) {
+                        nanLanes |= vector != vector;
+                    }
+                }
+                best = FoldLanes<T>(extreme, Better<T, kMax>);
+                nan = Any(nanLanes);
+            }
+        }
+        for (; i < count; ++i) {
+            best = Better<T, kMax>(elements[i], best);
+            nan |= elements[i] != elements[i];
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            if (nan) {
+                return static_cast<T>(NAN); // __builtin_nanf, not a library call
+            }
+        }
+        return best;
+    }
+
+    template<typename T>
+    static T Min(const T* elements, size_t count) {
+        return Extreme<T, false>(elements, count);
+    }
+
+    template<typename T>
+    static T Max(const T* elements, size_t count) {
+        return Extreme<T, true>(elements, count);
+    }
+
+    template<typename T, bool kMultiply>
+    static void Combine(const T* left, const T* right, T* destination, size_t count) {
+        using Wrapping = WrappingType<T>;
+        size_t i = 0;
+        if constexpr (kVectorBytes != 0) {
+            for (; i + kLanes<T> <= count; i += kLanes<T>) {
+                const auto x = Load<Vec<Wrapping>>(left + i);
+                const auto y = Load<Vec<Wrapping>>(right + i);
+                Store(destination + i, kMultiply ? x * y : x + y);
+            }
+        }
+        for (; i < count; ++i) {
+            const auto x = static_cast<Wrapping>(left[i]);
+            const auto y = static_cast<Wrapping>(right[i]);
+            destination[i] = static_cast<T>(kMultiply ? x * y : x + y);
+        }
+    }
+
+    template<typename T>
+    static void Add(const T* left, const T* right, T* destination, size_t count) {
+        Combine<T, false>(left, right, destination, count);
+    }
+
+    template<typename T>
+    static void Multiply(const T* left, const T* right, T* destination, size_t count) {
+        Combine<T, true>(left, right, destination, count);
+    }
+
+    template<typename T>
+    static bool Equal(const T* left, const T* right, size_t count) {
+        size_t i = 0;
+        if constexpr (kVectorBytes != 0) {
+            for (; i + kLanes<T> <= count; i += kLanes<T>) {
+                if (Any(Load<Vec<T>>(left + i) != Load<Vec<T>>(right + i))) {
+                    return false;
+                }
+            }
+        }
+        for (; i < count; ++i) {
+            if (!(left[i] == right[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename T>
+    static ArrayKernelSet<T> MakeSet() {
+        return {&Fill<T>, &IndexOf<T>, &Sum<T>, &Min<T>, &Max<T>, &Add<T>, &Multiply<T>, &Dot<T>, &Equal<T>};
+    }
+
+    static ArrayKernelTable MakeTable(const char* instructionSet) {
+        return {instructionSet, MakeSet<int32_t>(), MakeSet<int64_t>(), MakeSet<float>(), MakeSet<double>(),
+                MakeSet<uint8_t>()};
+    }
+};
+
+} // namespace
+
+} // namespace ObjectIR
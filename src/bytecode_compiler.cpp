@@ -0,0 +1,788 @@
+#include "bytecode.hpp"
+#include "instruction_executor.hpp"
+#include "objectir_type_names.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace ObjectIR {
+
+namespace {
+
+bool IsConditionSetupLoad(OpCode op) {
+    switch (op) {
+        case OpCode::LdLoc:
+        case OpCode::LdCon:
+        case OpCode::LdI4:
+        case OpCode::LdI8:
+        case OpCode::LdR4:
+        case OpCode::LdR8:
+        case OpCode::LdTrue:
+        case OpCode::LdFalse:
+        case OpCode::LdNull:
+            return true;
+        default:
+            return false;
+    }
+}
+
+class Lowering {
+public:
+    Lowering(const Method& method, PreparedMethod& out)
+        : _method(method), _out(out), _instructions(*out.source) {
+        const auto& params = method.GetParameters();
+        for (size_t i = 0; i < params.size(); ++i) {
+            _argumentSlots[params[i].first] = static_cast<int32_t>(i);
+        }
+        const auto& locals = method.GetLocals();
+        for (size_t i = 0; i < locals.size(); ++i) {
+            _localSlots[locals[i].first] = static_cast<int32_t>(i);
+        }
+        _out.argumentCount = params.size();
+        _out.localCount = locals.size();
+    }
+
+    void Run() {
+        const size_t count = _instructions.size();
+        _out.code.reserve(count + 1);
+        _out.sourceIps.reserve(count + 1);
+
+        _codeStart.resize(count + 1);
+        for (size_t ip = 0; ip < count; ++ip) {
+            _codeStart[ip] = _out.code.size();
+            Lower(ip, _instructions[ip], false);
+        }
+
+        // Running off the end of the body behaves like a trailing `ret`.
+        _codeStart[count] = _out.code.size();
+        Emit(BytecodeOp::Ret, 0, count);
+
+        // Branch operands name source instructions; structured instructions
+        // expand to several entries, so map them to code indices now.
+        for (const auto& branch : _branches) {
+            _out.code[branch.codeIndex].a = static_cast<int32_t>(_codeStart[branch.sourceTarget]);
+        }
+
+        // Branches whose target could not be resolved jump to a stub that reports
+        // the error only when the branch is actually taken, as the tree walker does.
+        for (const auto& pending : _badBranches) {
+            _out.code[pending.codeIndex].a = static_cast<int32_t>(_out.code.size());
+            Emit(BytecodeOp::Fail, AddMessage(pending.message), pending.sourceIp);
+        }
+
+        LowerExceptionHandlers();
+    }
+
+private:
+    struct PendingBranch {
+        size_t codeIndex;
+        size_t sourceIp;
+        std::string message;
+    };
+
+    struct ResolvedBranch {
+        size_t codeIndex;
+        size_t sourceTarget;
+    };
+
+    // Jump targets of the innermost enclosing While.
+    struct LoopLabels {
+        size_t continueTarget;
+        std::vector<size_t> breakBranches;
+    };
+
+    void Emit(BytecodeOp op, int32_t a, size_t sourceIp, int32_t b = 0) {
+        _out.code.push_back(BytecodeInstruction{op, a, b});
+        _out.sourceIps.push_back(static_cast<uint32_t>(sourceIp));
+    }
+
+    void EmitFail(const std::string& message, size_t sourceIp) {
+        Emit(BytecodeOp::Fail, AddMessage(message), sourceIp);
+    }
+
+    int32_t AddMessage(const std::string& message) {
+        _out.messages.push_back(message);
+        return static_cast<int32_t>(_out.messages.size() - 1);
+    }
+
+    int32_t AddConstant(Value value) {
+        _out.constants.push_back(std::move(value));
+        return static_cast<int32_t>(_out.constants.size() - 1);
+    }
+
+    int32_t AddTypeSite(const std::string& name) {
+        TypeSite site;
+        site.name = name;
+        site.normalizedName = TypeNames::NormalizeTypeName(name);
+        site.symbol = SymbolTable::Intern(site.name);
+        site.normalizedSymbol = SymbolTable::Intern(site.normalizedName);
+        _out.typeSites.push_back(std::move(site));
+        return static_cast<int32_t>(_out.typeSites.size() - 1);
+    }
+
+    void EmitBranch(BytecodeOp op, const Instruction& instr, size_t ip) {
+        int target = -1;
+        if (instr.hasOperandInt) {
+            target = instr.operandInt;
+        } else if (!instr.operandString.empty()) {
+            auto labelIt = _method.GetLabelMap().find(instr.operandString);
+            if (labelIt != _method.GetLabelMap().end()) {
+                target = static_cast<int>(labelIt->second);
+            } else {
+                try {
+                    target = std::stoi(instr.operandString);
+                } catch (...) {
+                    _badBranches.push_back({_out.code.size(), ip, "Branch target not found: " + instr.operandString});
+                    Emit(op, 0, ip);
+                    return;
+                }
+            }
+        }
+
+        if (target < 0 || static_cast<size_t>(target) >= _instructions.size()) {
+            _badBranches.push_back({_out.code.size(), ip, "Branch target out of range"});
+            Emit(op, 0, ip);
+            return;
+        }
+
+        _branches.push_back({_out.code.size(), static_cast<size_t>(target)});
+        Emit(op, 0, ip);
+    }
+
+    void EmitSlot(BytecodeOp op, const std::unordered_map<std::string, int32_t>& slots,
+                  const std::string& name, const char* missingPrefix, size_t ip) {
+        auto it = slots.find(name);
+        if (it == slots.end()) {
+            EmitFail(missingPrefix + name, ip);
+            return;
+        }
+        Emit(op, it->second, ip);
+    }
+
+    void EmitField(BytecodeOp op, const Instruction& instr, const char* missingMessage, size_t ip) {
+        const std::string fieldName = instr.fieldTarget.has_value() ? instr.fieldTarget->name : instr.operandString;
+        if (fieldName.empty()) {
+            EmitFail(missingMessage, ip);
+            return;
+        }
+        FieldSite site;
+        site.name = fieldName;
+        site.symbol = SymbolTable::Intern(fieldName);
+        _out.fieldSites.push_back(std::move(site));
+        Emit(op, static_cast<int32_t>(_out.fieldSites.size() - 1), ip);
+    }
+
+    void LowerBlock(const std::vector<Instruction>& block, size_t ip) {
+        for (const auto& instr : block) {
+            Lower(ip, instr, true);
+        }
+    }
+
+    // Emits the test of a While condition. The BrFalse that leaves the loop
+    // is added to `exitBranches` for the caller to patch.
+    void LowerCondition(const Instruction::ConditionData& condition, size_t ip, std::vector<size_t>& exitBranches) {
+        LowerBlock(condition.setupInstructions, ip);
+
+        switch (condition.kind) {
+            case ConditionKind::Stack:
+                break;
+            case ConditionKind::Binary:
+                EmitComparison(condition.comparisonOp, ip);
+                break;
+            case ConditionKind::Expression:
+                LowerBlock(condition.expressionInstructions, ip);
+                break;
+            case ConditionKind::None:
+            default:
+                EmitFail("Condition kind not supported", ip);
+                return;
+        }
+        exitBranches.push_back(_out.code.size());
+        Emit(BytecodeOp::BrFalse, 0, ip);
+    }
+
+    void EmitComparison(OpCode comparisonOp, size_t ip) {
+        switch (comparisonOp) {
+            case OpCode::Ceq: Emit(BytecodeOp::Ceq, 0, ip); break;
+            case OpCode::Cne: Emit(BytecodeOp::Cne, 0, ip); break;
+            case OpCode::Clt: Emit(BytecodeOp::Clt, 0, ip); break;
+            case OpCode::Cle: Emit(BytecodeOp::Cle, 0, ip); break;
+            case OpCode::Cgt: Emit(BytecodeOp::Cgt, 0, ip); break;
+            case OpCode::Cge: Emit(BytecodeOp::Cge, 0, ip); break;
+            case OpCode::Nop: EmitFail("Binary condition missing comparison operation", ip); break;
+            default: EmitFail("Unsupported comparison opcode in binary condition", ip); break;
+        }
+    }
+
+    // While lowers to
+    //     head:  <condition>  brfalse exit
+    //            <body>       br head
+    //     exit:
+    // with `break` as `br exit` and `continue` as `br head`.
+    void LowerWhile(const Instruction& instr, size_t ip, bool nested) {
+        if (!instr.whileData.has_value()) {
+            EmitFail("While instruction missing metadata", ip);
+            return;
+        }
+        const auto& whileData = instr.whileData.value();
+
+        // Binary conditions of While instructions in the method body re-run the
+        // loads that precede the loop before every test (instead of the
+        // condition's own setup), as the tree walker's dispatcher does.
+        const bool useSourceSetup = !nested && whileData.condition.kind == ConditionKind::Binary;
+
+        // The condition is lowered before this loop's labels are pushed: a
+        // break/continue inside it belongs to the enclosing loop.
+        const size_t head = _out.code.size();
+        std::vector<size_t> exitBranches;
+        if (useSourceSetup) {
+            size_t setupStart = ip;
+            while (setupStart > 0 && IsConditionSetupLoad(_instructions[setupStart - 1].opCode)) {
+                --setupStart;
+            }
+            for (size_t i = setupStart; i < ip; ++i) {
+                Lower(ip, _instructions[i], true);
+            }
+            EmitComparison(whileData.condition.comparisonOp, ip);
+            exitBranches.push_back(_out.code.size());
+            Emit(BytecodeOp::BrFalse, 0, ip);
+        } else {
+            LowerCondition(whileData.condition, ip, exitBranches);
+        }
+
+        _loops.push_back(LoopLabels{head, std::move(exitBranches)});
+        LowerBlock(whileData.body, ip);
+        Emit(BytecodeOp::Br, static_cast<int32_t>(head), ip);
+
+        const size_t exit = _out.code.size();
+        for (size_t branch : _loops.back().breakBranches) {
+            _out.code[branch].a = static_cast<int32_t>(exit);
+        }
+        _loops.pop_back();
+    }
+
+    // If lowers to
+    //            brfalse else
+    //            <then>       br end
+    //     else:  <else>
+    //     end:
+    void LowerIf(const Instruction& instr, size_t ip) {
+        if (!instr.ifData.has_value()) {
+            EmitFail("If instruction missing metadata", ip);
+            return;
+        }
+        const auto& ifData = instr.ifData.value();
+
+        const size_t toElse = _out.code.size();
+        Emit(BytecodeOp::BrFalse, 0, ip);
+        LowerBlock(ifData.thenBlock, ip);
+
+        if (ifData.elseBlock.empty()) {
+            _out.code[toElse].a = static_cast<int32_t>(_out.code.size());
+            return;
+        }
+
+        const size_t toEnd = _out.code.size();
+        Emit(BytecodeOp::Br, 0, ip);
+        _out.code[toElse].a = static_cast<int32_t>(_out.code.size());
+        LowerBlock(ifData.elseBlock, ip);
+        _out.code[toEnd].a = static_cast<int32_t>(_out.code.size());
+    }
+
+    void LowerLoopExit(OpCode opCode, size_t ip) {
+        if (_loops.empty()) {
+            // Outside of a loop these escape the method as errors.
+            EmitFail(opCode == OpCode::Break ? "break" : "continue", ip);
+            return;
+        }
+        if (opCode == OpCode::Break) {
+            _loops.back().breakBranches.push_back(_out.code.size());
+            Emit(BytecodeOp::Br, 0, ip);
+        } else {
+            Emit(BytecodeOp::Br, static_cast<int32_t>(_loops.back().continueTarget), ip);
+        }
+    }
+
+    // Protected ranges and handlers name source instructions like branches
+    // do. Entries that do not fit the body are dropped. Leave instructions,
+    // lowered as branches, then get the site of their target; a ret that
+    // would skip a finally handler becomes one too (see LeaveSite::returns).
+    void LowerExceptionHandlers() {
+        const size_t count = _instructions.size();
+        for (const auto& handler : _method.GetExceptionHandlers()) {
+            if (handler.tryStart > handler.tryEnd || handler.tryEnd > count ||
+                handler.handlerStart > handler.handlerEnd || handler.handlerEnd > count) {
+                continue;
+            }
+            PreparedHandler prepared;
+            prepared.kind = handler.kind;
+            prepared.tryStart = static_cast<uint32_t>(_codeStart[handler.tryStart]);
+            prepared.tryEnd = static_cast<uint32_t>(_codeStart[handler.tryEnd]);
+            prepared.handlerStart = static_cast<uint32_t>(_codeStart[handler.handlerStart]);
+            prepared.handlerEnd = static_cast<uint32_t>(_codeStart[handler.handlerEnd]);
+            if (handler.kind == ExceptionHandlerKind::Catch && !handler.catchType.empty()) {
+                prepared.catchType = AddTypeSite(handler.catchType);
+            }
+            _out.handlers.push_back(prepared);
+        }
+
+        std::vector<bool> returns(_out.code.size(), false);
+        size_t epilogue = 0;
+        for (size_t pc = 0; pc < returns.size(); ++pc) {
+            if (_out.code[pc].op != BytecodeOp::Ret || !InFinallyRange(pc)) {
+                continue;
+            }
+            if (epilogue == 0) {
+                epilogue = _out.code.size();
+                Emit(BytecodeOp::Ret, 0, _instructions.size());
+            }
+            _out.code[pc] = BytecodeInstruction{BytecodeOp::Leave, static_cast<int32_t>(epilogue), 0};
+            returns[pc] = true;
+        }
+
+        for (size_t pc = 0; pc < _out.code.size(); ++pc) {
+            if (_out.code[pc].op != BytecodeOp::Leave) {
+                continue;
+            }
+            LeaveSite site;
+            site.target = static_cast<uint32_t>(_out.code[pc].a);
+            site.returns = pc < returns.size() && returns[pc];
+            for (size_t i = 0; i < _out.handlers.size(); ++i) {
+                const PreparedHandler& handler = _out.handlers[i];
+                const bool holdsLeave = handler.tryStart <= pc && pc < handler.tryEnd;
+                const bool holdsTarget = handler.tryStart <= site.target && site.target < handler.tryEnd;
+                if (handler.kind == ExceptionHandlerKind::Finally && holdsLeave && !holdsTarget) {
+                    site.finallyHandlers.push_back(static_cast<uint32_t>(i));
+                }
+            }
+            _out.leaveSites.push_back(std::move(site));
+            _out.code[pc].a = static_cast<int32_t>(_out.leaveSites.size() - 1);
+        }
+    }
+
+    [[nodiscard]] bool InFinallyRange(size_t pc) const {
+        for (const auto& handler : _out.handlers) {
+            if (handler.kind == ExceptionHandlerKind::Finally && handler.tryStart <= pc && pc < handler.tryEnd) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Lowers one instruction. `ip` is the index of the method body instruction
+    // it belongs to (for diagnostics); `nested` is set inside While/If blocks,
+    // where `ret` does nothing and labelled branches are rejected, matching
+    // InstructionExecutor::Execute.
+    void Lower(size_t ip, const Instruction& instr, bool nested) {
+        if (nested) {
+            switch (instr.opCode) {
+                case OpCode::Ret:
+                    Emit(BytecodeOp::Nop, 0, ip);
+                    return;
+                case OpCode::Br:
+                case OpCode::BrTrue:
+                case OpCode::BrFalse:
+                case OpCode::Beq:
+                case OpCode::Bne:
+                case OpCode::Bgt:
+                case OpCode::Blt:
+                case OpCode::Bge:
+                case OpCode::Ble:
+                    EmitFail("Branch opcodes must be handled by the instruction dispatcher", ip);
+                    return;
+                default:
+                    break;
+            }
+        }
+
+        switch (instr.opCode) {
+            case OpCode::Nop: Emit(BytecodeOp::Nop, 0, ip); break;
+            case OpCode::Dup: Emit(BytecodeOp::Dup, 0, ip); break;
+            case OpCode::Pop: Emit(BytecodeOp::Pop, 0, ip); break;
+
+            case OpCode::LdArg:
+                if (instr.identifier == "this") {
+                    Emit(BytecodeOp::LdThis, 0, ip);
+                } else {
+                    EmitSlot(BytecodeOp::LdArg, _argumentSlots, instr.identifier, "Argument not found: ", ip);
+                }
+                break;
+            case OpCode::StArg:
+                EmitSlot(BytecodeOp::StArg, _argumentSlots, instr.identifier, "Argument not found: ", ip);
+                break;
+            case OpCode::LdLoc:
+                EmitSlot(BytecodeOp::LdLoc, _localSlots, instr.identifier, "Local variable not found: ", ip);
+                break;
+            case OpCode::StLoc:
+                EmitSlot(BytecodeOp::StLoc, _localSlots, instr.identifier, "Local variable not found: ", ip);
+                break;
+
+            case OpCode::LdFld:
+                EmitField(BytecodeOp::LdFld, instr, "LdFld instruction missing field operand", ip);
+                break;
+            case OpCode::StFld:
+                EmitField(BytecodeOp::StFld, instr, "StFld instruction missing field operand", ip);
+                break;
+
+            case OpCode::LdCon:
+            case OpCode::LdStr:
+                try {
+                    Emit(BytecodeOp::LdConst, AddConstant(InstructionExecutor::CreateConstantValue(instr)), ip);
+                } catch (const std::exception& ex) {
+                    EmitFail(ex.what(), ip);
+                }
+                break;
+            case OpCode::LdI4: Emit(BytecodeOp::LdConst, AddConstant(Value(instr.operandInt)), ip); break;
+            case OpCode::LdI8: Emit(BytecodeOp::LdConst, AddConstant(Value(static_cast<int64_t>(instr.operandInt))), ip); break;
+            case OpCode::LdR4: Emit(BytecodeOp::LdConst, AddConstant(Value(static_cast<float>(instr.operandDouble))), ip); break;
+            case OpCode::LdR8: Emit(BytecodeOp::LdConst, AddConstant(Value(instr.operandDouble)), ip); break;
+            case OpCode::LdTrue: Emit(BytecodeOp::LdConst, AddConstant(Value(true)), ip); break;
+            case OpCode::LdFalse: Emit(BytecodeOp::LdConst, AddConstant(Value(false)), ip); break;
+            case OpCode::LdNull: Emit(BytecodeOp::LdNull, 0, ip); break;
+
+            case OpCode::Add: Emit(BytecodeOp::Add, 0, ip); break;
+            case OpCode::Sub: Emit(BytecodeOp::Sub, 0, ip); break;
+            case OpCode::Mul: Emit(BytecodeOp::Mul, 0, ip); break;
+            case OpCode::Div: Emit(BytecodeOp::Div, 0, ip); break;
+            case OpCode::Rem: Emit(BytecodeOp::Rem, 0, ip); break;
+            case OpCode::Neg: Emit(BytecodeOp::Neg, 0, ip); break;
+
+            case OpCode::Ceq: Emit(BytecodeOp::Ceq, 0, ip); break;
+            case OpCode::Cne: Emit(BytecodeOp::Cne, 0, ip); break;
+            case OpCode::Clt: Emit(BytecodeOp::Clt, 0, ip); break;
+            case OpCode::Cle: Emit(BytecodeOp::Cle, 0, ip); break;
+            case OpCode::Cgt: Emit(BytecodeOp::Cgt, 0, ip); break;
+            case OpCode::Cge: Emit(BytecodeOp::Cge, 0, ip); break;
+
+            case OpCode::Ret: Emit(BytecodeOp::Ret, 0, ip); break;
+            case OpCode::Br: EmitBranch(BytecodeOp::Br, instr, ip); break;
+            case OpCode::BrTrue: EmitBranch(BytecodeOp::BrTrue, instr, ip); break;
+            case OpCode::BrFalse: EmitBranch(BytecodeOp::BrFalse, instr, ip); break;
+            case OpCode::Beq: EmitBranch(BytecodeOp::Beq, instr, ip); break;
+            case OpCode::Bne: EmitBranch(BytecodeOp::Bne, instr, ip); break;
+            case OpCode::Bgt: EmitBranch(BytecodeOp::Bgt, instr, ip); break;
+            case OpCode::Blt: EmitBranch(BytecodeOp::Blt, instr, ip); break;
+            case OpCode::Bge: EmitBranch(BytecodeOp::Bge, instr, ip); break;
+            case OpCode::Ble: EmitBranch(BytecodeOp::Ble, instr, ip); break;
+
+            case OpCode::NewObj:
+                if (instr.operandString.empty()) {
+                    EmitFail("NewObj instruction missing type operand", ip);
+                } else {
+                    Emit(BytecodeOp::NewObj, AddTypeSite(instr.operandString), ip);
+                }
+                break;
+
+            case OpCode::NewArr: {
+                const std::string typeName = !instr.operandString.empty() ? instr.operandString : instr.identifier;
+                if (typeName.empty()) {
+                    EmitFail("NewArr instruction missing element type operand", ip);
+                } else {
+                    Emit(BytecodeOp::NewArr, AddTypeSite(typeName), ip);
+                }
+                break;
+            }
+
+            case OpCode::CastClass:
+            case OpCode::IsInst: {
+                const std::string typeName = !instr.operandString.empty() ? instr.operandString : instr.identifier;
+                if (typeName.empty()) {
+                    EmitFail("CastClass/IsInst instruction missing type operand", ip);
+                } else {
+                    Emit(instr.opCode == OpCode::CastClass ? BytecodeOp::CastClass : BytecodeOp::IsInst,
+                         AddTypeSite(typeName), ip);
+                }
+                break;
+            }
+
+            case OpCode::LdLen: Emit(BytecodeOp::LdLen, 0, ip); break;
+            case OpCode::LdElem: Emit(BytecodeOp::LdElem, 0, ip); break;
+            case OpCode::StElem: Emit(BytecodeOp::StElem, 0, ip); break;
+
+            case OpCode::Call:
+            case OpCode::CallVirt: {
+                if (!instr.callTarget.has_value()) {
+                    EmitFail("Call instruction missing target metadata", ip);
+                    break;
+                }
+                CallSite site;
+                site.target = instr.callTarget.value();
+                site.declaringType = SymbolTable::Intern(site.target.declaringType);
+                site.name = SymbolTable::Intern(site.target.name);
+                site.argumentCount = site.target.parameterTypes.size();
+                site.isVoidReturn = site.target.returnType.empty() || site.target.returnType == "void" ||
+                                    site.target.returnType == "System.Void";
+                site.isConsoleWriteLine = site.target.declaringType == "System.Console" && site.target.name == "WriteLine";
+                _out.callSites.push_back(std::move(site));
+                Emit(instr.opCode == OpCode::Call ? BytecodeOp::Call : BytecodeOp::CallVirt,
+                     static_cast<int32_t>(_out.callSites.size() - 1), ip);
+                break;
+            }
+
+            case OpCode::While: LowerWhile(instr, ip, nested); break;
+            case OpCode::If: LowerIf(instr, ip); break;
+
+            case OpCode::Break:
+            case OpCode::Continue:
+                LowerLoopExit(instr.opCode, ip);
+                break;
+            case OpCode::Throw: Emit(BytecodeOp::Throw, 0, ip); break;
+            case OpCode::Leave: EmitBranch(BytecodeOp::Leave, instr, ip); break;
+            case OpCode::EndFinally: Emit(BytecodeOp::EndFinally, 0, ip); break;
+
+            default:
+                EmitFail("Unknown instruction opcode", ip);
+                break;
+        }
+    }
+
+    const Method& _method;
+    PreparedMethod& _out;
+    const std::vector<Instruction>& _instructions;
+    std::unordered_map<std::string, int32_t> _argumentSlots;
+    std::unordered_map<std::string, int32_t> _localSlots;
+    std::vector<PendingBranch> _badBranches;
+    std::vector<ResolvedBranch> _branches;
+    std::vector<size_t> _codeStart;
+    std::vector<LoopLabels> _loops;
+};
+
+// ----------------------------------------------------------------------------
+// Superinstructions
+//
+// A rule replaces the opcode of the first instruction of a matching sequence
+// with a superinstruction. The rest of the sequence stays in place, so branch
+// targets and source ips are unaffected, and a superinstruction whose fast
+// path does not apply executes its first instruction and falls through to the
+// second. The operator of a wildcard element is kept in `b` of the fused
+// instruction. Rules are tried in order, so longer sequences come first; the
+// table was derived from DispatchProfile pair counts (see
+// examples/interpreter_benchmark.cpp --pairs).
+// ----------------------------------------------------------------------------
+
+enum class FusionElementKind { Exact, Arithmetic, CompareBranch };
+
+struct FusionElement {
+    FusionElementKind kind;
+    BytecodeOp op;
+};
+
+struct FusionRule {
+    BytecodeOp fused;
+    size_t length;
+    FusionElement pattern[4];
+};
+
+constexpr FusionElement Op(BytecodeOp op) { return {FusionElementKind::Exact, op}; }
+constexpr FusionElement kAnyArithmetic{FusionElementKind::Arithmetic, BytecodeOp::Nop};
+constexpr FusionElement kAnyCompareBranch{FusionElementKind::CompareBranch, BytecodeOp::Nop};
+
+const FusionRule kFusionRules[] = {
+    {BytecodeOp::LdLocLdConstArithStLoc, 4,
+     {Op(BytecodeOp::LdLoc), Op(BytecodeOp::LdConst), kAnyArithmetic, Op(BytecodeOp::StLoc)}},
+    {BytecodeOp::LdLocLdLocArithStLoc, 4,
+     {Op(BytecodeOp::LdLoc), Op(BytecodeOp::LdLoc), kAnyArithmetic, Op(BytecodeOp::StLoc)}},
+    {BytecodeOp::LdLocLdArgBranch, 3,
+     {Op(BytecodeOp::LdLoc), Op(BytecodeOp::LdArg), kAnyCompareBranch}},
+    {BytecodeOp::LdLocLdConstBranch, 3,
+     {Op(BytecodeOp::LdLoc), Op(BytecodeOp::LdConst), kAnyCompareBranch}},
+    {BytecodeOp::LdLocLdLocBranch, 3,
+     {Op(BytecodeOp::LdLoc), Op(BytecodeOp::LdLoc), kAnyCompareBranch}},
+    {BytecodeOp::LdLocLdConstArith, 3,
+     {Op(BytecodeOp::LdLoc), Op(BytecodeOp::LdConst), kAnyArithmetic}},
+    {BytecodeOp::LdLocLdLocArith, 3,
+     {Op(BytecodeOp::LdLoc), Op(BytecodeOp::LdLoc), kAnyArithmetic}},
+    {BytecodeOp::LdThisLdFld, 2, {Op(BytecodeOp::LdThis), Op(BytecodeOp::LdFld)}},
+    {BytecodeOp::LdLocLdFld, 2, {Op(BytecodeOp::LdLoc), Op(BytecodeOp::LdFld)}},
+    {BytecodeOp::LdConstStLoc, 2, {Op(BytecodeOp::LdConst), Op(BytecodeOp::StLoc)}},
+};
+
+bool MatchesElement(const FusionElement& element, BytecodeOp op) {
+    switch (element.kind) {
+        case FusionElementKind::Exact:
+            return op == element.op;
+        case FusionElementKind::Arithmetic:
+            return op == BytecodeOp::Add || op == BytecodeOp::Sub || op == BytecodeOp::Mul || op == BytecodeOp::Rem;
+        case FusionElementKind::CompareBranch:
+            return op == BytecodeOp::Beq || op == BytecodeOp::Bne || op == BytecodeOp::Bgt ||
+                   op == BytecodeOp::Blt || op == BytecodeOp::Bge || op == BytecodeOp::Ble;
+    }
+    return false;
+}
+
+// Code indices a superinstruction may not extend over: the edges of
+// protected ranges and handlers. A fused instruction fails at the pc of its
+// first component, which has to be covered by the same handlers as the rest.
+std::vector<bool> FindRegionEdges(const PreparedMethod& prepared) {
+    std::vector<bool> edges(prepared.code.size() + 1, false);
+    for (const auto& handler : prepared.handlers) {
+        edges[handler.tryStart] = edges[handler.tryEnd] = true;
+        edges[handler.handlerStart] = edges[handler.handlerEnd] = true;
+    }
+    return edges;
+}
+
+void FuseSuperinstructions(std::vector<BytecodeInstruction>& code, const std::vector<bool>& regionEdges) {
+    size_t pc = 0;
+    while (pc < code.size()) {
+        size_t matched = 1;
+        for (const auto& rule : kFusionRules) {
+            if (pc + rule.length > code.size()) {
+                continue;
+            }
+            int32_t wildcard = 0;
+            bool matches = true;
+            for (size_t i = 0; i < rule.length && matches; ++i) {
+                const BytecodeOp op = GetGenericBytecodeOp(code[pc + i].op);
+                matches = (i == 0 || !regionEdges[pc + i]) && MatchesElement(rule.pattern[i], op);
+                if (matches && rule.pattern[i].kind != FusionElementKind::Exact) {
+                    wildcard = static_cast<int32_t>(op);
+                }
+            }
+            if (matches) {
+                code[pc].op = rule.fused;
+                code[pc].b = wildcard;
+                matched = rule.length;
+                break;
+            }
+        }
+        pc += matched;
+    }
+}
+
+std::atomic<bool> g_superinstructionsEnabled{true};
+
+// Tail calls: a call directly followed by Ret becomes TailCall/TailCallVirt.
+// The executor decides per call whether the frame can be reused. Calls left
+// by the inliner in its stubs and inlined bodies branch to the code after
+// them, so they are never marked, and neither are calls in a protected range
+// or a handler: the frame has to stay to handle what the callee throws.
+void MarkTailCalls(std::vector<BytecodeInstruction>& code, const std::vector<PreparedHandler>& handlers) {
+    auto inRegion = [&handlers](size_t pc) {
+        for (const auto& handler : handlers) {
+            if ((handler.tryStart <= pc && pc < handler.tryEnd) ||
+                (handler.handlerStart <= pc && pc < handler.handlerEnd)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (size_t pc = 0; pc + 1 < code.size(); ++pc) {
+        if (code[pc + 1].op != BytecodeOp::Ret || inRegion(pc)) {
+            continue;
+        }
+        if (code[pc].op == BytecodeOp::Call) {
+            code[pc].op = BytecodeOp::TailCall;
+        } else if (code[pc].op == BytecodeOp::CallVirt) {
+            code[pc].op = BytecodeOp::TailCallVirt;
+        }
+    }
+}
+
+std::atomic<bool> g_tailCallsEnabled{true};
+
+} // namespace
+
+std::shared_ptr<PreparedMethod> BytecodeCompiler::Compile(const Method& method, VirtualMachine* vm, ExecutionTier tier) {
+    auto prepared = std::make_shared<PreparedMethod>();
+    prepared->source = method.GetSharedInstructions();
+    prepared->tier = tier == ExecutionTier::Interpreter ? tier : ExecutionTier::Optimized;
+
+    Lowering lowering(method, *prepared);
+    lowering.Run();
+    if (prepared->tier == ExecutionTier::Interpreter) {
+        // Verified all the same: strict mode, the JIT and the inliner must
+        // reach the same verdict whichever tier prepared the body.
+        BytecodeVerifier::Verify(method, *prepared);
+    } else {
+        if (vm) {
+            BytecodeInliner::Inline(*vm, method, *prepared);
+        }
+        BytecodeOptimizer::Optimize(method, *prepared);
+        BytecodeVerifier::Verify(method, *prepared);
+    }
+
+    if (g_tailCallsEnabled.load(std::memory_order_relaxed)) {
+        MarkTailCalls(prepared->code, prepared->handlers);
+        MarkTailCalls(prepared->verifiedCode, prepared->handlers);
+    }
+    if (prepared->tier != ExecutionTier::Interpreter && g_superinstructionsEnabled.load(std::memory_order_relaxed)) {
+        const std::vector<bool> regionEdges = FindRegionEdges(*prepared);
+        FuseSuperinstructions(prepared->code, regionEdges);
+        FuseSuperinstructions(prepared->verifiedCode, regionEdges);
+    }
+    return prepared;
+}
+
+void BytecodeCompiler::SetSuperinstructionsEnabled(bool enabled) {
+    g_superinstructionsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool BytecodeCompiler::AreSuperinstructionsEnabled() {
+    return g_superinstructionsEnabled.load(std::memory_order_relaxed);
+}
+
+void BytecodeCompiler::SetTailCallsEnabled(bool enabled) {
+    g_tailCallsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool BytecodeCompiler::AreTailCallsEnabled() {
+    return g_tailCallsEnabled.load(std::memory_order_relaxed);
+}
+
+BytecodeOp GetGenericBytecodeOp(BytecodeOp op) {
+    switch (op) {
+        case BytecodeOp::AddI32:
+        case BytecodeOp::AddF64:
+        case BytecodeOp::AddI32Unchecked: return BytecodeOp::Add;
+        case BytecodeOp::SubI32:
+        case BytecodeOp::SubF64:
+        case BytecodeOp::SubI32Unchecked: return BytecodeOp::Sub;
+        case BytecodeOp::MulI32:
+        case BytecodeOp::MulF64:
+        case BytecodeOp::MulI32Unchecked: return BytecodeOp::Mul;
+        case BytecodeOp::DivF64: return BytecodeOp::Div;
+        case BytecodeOp::CeqI32:
+        case BytecodeOp::CeqI32Unchecked: return BytecodeOp::Ceq;
+        case BytecodeOp::CneI32:
+        case BytecodeOp::CneI32Unchecked: return BytecodeOp::Cne;
+        case BytecodeOp::CltI32:
+        case BytecodeOp::CltI32Unchecked: return BytecodeOp::Clt;
+        case BytecodeOp::CleI32:
+        case BytecodeOp::CleI32Unchecked: return BytecodeOp::Cle;
+        case BytecodeOp::CgtI32:
+        case BytecodeOp::CgtI32Unchecked: return BytecodeOp::Cgt;
+        case BytecodeOp::CgeI32:
+        case BytecodeOp::CgeI32Unchecked: return BytecodeOp::Cge;
+        case BytecodeOp::BeqI32:
+        case BytecodeOp::BeqI32Unchecked: return BytecodeOp::Beq;
+        case BytecodeOp::BneI32:
+        case BytecodeOp::BneI32Unchecked: return BytecodeOp::Bne;
+        case BytecodeOp::BgtI32:
+        case BytecodeOp::BgtI32Unchecked: return BytecodeOp::Bgt;
+        case BytecodeOp::BltI32:
+        case BytecodeOp::BltI32Unchecked: return BytecodeOp::Blt;
+        case BytecodeOp::BgeI32:
+        case BytecodeOp::BgeI32Unchecked: return BytecodeOp::Bge;
+        case BytecodeOp::BleI32:
+        case BytecodeOp::BleI32Unchecked: return BytecodeOp::Ble;
+        case BytecodeOp::BrTrueBool: return BytecodeOp::BrTrue;
+        case BytecodeOp::BrFalseBool: return BytecodeOp::BrFalse;
+        case BytecodeOp::LdLocLdConstArithStLoc:
+        case BytecodeOp::LdLocLdLocArithStLoc:
+        case BytecodeOp::LdLocLdArgBranch:
+        case BytecodeOp::LdLocLdConstBranch:
+        case BytecodeOp::LdLocLdLocBranch:
+        case BytecodeOp::LdLocLdConstArith:
+        case BytecodeOp::LdLocLdLocArith:
+        case BytecodeOp::LdLocLdFld: return BytecodeOp::LdLoc;
+        case BytecodeOp::LdThisLdFld: return BytecodeOp::LdThis;
+        case BytecodeOp::LdConstStLoc: return BytecodeOp::LdConst;
+        case BytecodeOp::TailCall: return BytecodeOp::Call;
+        case BytecodeOp::TailCallVirt: return BytecodeOp::CallVirt;
+        default: return op;
+    }
+}
+
+} // namespace ObjectIR
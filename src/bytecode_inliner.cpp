@@ -0,0 +1,562 @@
+#include "bytecode.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ObjectIR {
+
+namespace {
+
+std::atomic<bool> g_inliningEnabled{true};
+std::atomic<size_t> g_calleeBudget{16};
+std::atomic<size_t> g_callerGrowthBudget{256};
+
+bool IsBranch(BytecodeOp op) {
+    switch (op) {
+        case BytecodeOp::Br:
+        case BytecodeOp::BrTrue:
+        case BytecodeOp::BrFalse:
+        case BytecodeOp::Beq:
+        case BytecodeOp::Bne:
+        case BytecodeOp::Bgt:
+        case BytecodeOp::Blt:
+        case BytecodeOp::Bge:
+        case BytecodeOp::Ble:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Loads that cannot fail and leave 'this' where it is (see CheckFieldAccess).
+bool IsSimpleLoad(BytecodeOp op) {
+    switch (op) {
+        case BytecodeOp::LdArg:
+        case BytecodeOp::LdLoc:
+        case BytecodeOp::LdConst:
+        case BytecodeOp::LdNull:
+        case BytecodeOp::LdThis:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool ReturnsVoid(const Method& method) {
+    const TypeReference& type = method.GetReturnType();
+    return type.IsPrimitive() && type.GetPrimitiveType() == PrimitiveType::Void;
+}
+
+// The method a call site resolves to if its body may be inlined: static
+// calls, and virtual calls whose declaring class is sealed (`receiver` is set
+// to that class). Null otherwise.
+MethodRef ResolveCallee(VirtualMachine& vm, const Method& caller, const CallSite& site, bool isVirtual,
+                        ClassRef& receiver) {
+    if (site.isConsoleWriteLine) {
+        return nullptr;
+    }
+    MethodRef callee;
+    try {
+        ClassRef classRef = vm.GetClass(site.declaringType);
+        if (!classRef) {
+            return nullptr;
+        }
+        if (isVirtual) {
+            if (!classRef->IsSealed()) {
+                return nullptr;
+            }
+            callee = vm.ResolveMethod(classRef, site.name, site.target, /*requireStatic*/false);
+            receiver = classRef;
+        } else {
+            callee = vm.ResolveMethod(classRef, site.name, site.target, /*requireStatic*/true);
+        }
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+    if (!callee || callee.get() == &caller || callee->GetNativeImpl() || !callee->HasInstructions() ||
+        (isVirtual && callee->IsStatic()) || callee->GetParameters().size() != site.argumentCount) {
+        return nullptr;
+    }
+    return callee;
+}
+
+/// A callee body that passed the checks of Analyze, in generic ops.
+struct CalleeBody {
+    MethodRef method;
+    std::shared_ptr<PreparedMethod> prepared;
+    std::vector<BytecodeInstruction> code;
+    std::vector<VerifiedFrameState> states;
+    bool returnsVoid = false;
+
+    // Offsets of the callee's tables once appended to the caller's.
+    bool copied = false;
+    int32_t constantBase = 0;
+    int32_t callSiteBase = 0;
+    int32_t fieldSiteBase = 0;
+    int32_t typeSiteBase = 0;
+};
+
+// Field access reads the instance from the stack, or from 'this' when the
+// popped value is not an object; in an inlined body 'this' is the caller's.
+// Only accesses whose instance is certainly the callee's own 'this' keep
+// their meaning: `ldarg this; ldfld` and `ldarg this; <load>; stfld`, with
+// no branch entering in between.
+bool CheckFieldAccess(const CalleeBody& body, const std::vector<bool>& isTarget, size_t pc) {
+    const auto& code = body.code;
+    if (code[pc].op == BytecodeOp::LdFld) {
+        return pc >= 1 && code[pc - 1].op == BytecodeOp::LdThis && !isTarget[pc];
+    }
+    return pc >= 2 && code[pc - 2].op == BytecodeOp::LdThis && IsSimpleLoad(code[pc - 1].op) &&
+           !isTarget[pc - 1] && !isTarget[pc];
+}
+
+bool Analyze(const MethodRef& callee, bool isVirtual, CalleeBody& out) {
+    auto prepared = callee->GetPrepared();
+    if (!prepared->inlinedCalls.empty() || prepared->tier != ExecutionTier::Optimized) {
+        // Inlining is one level deep: take the callee's own optimized body.
+        prepared = BytecodeCompiler::Compile(*callee);
+    }
+    if (!prepared->verified || prepared->HasExceptionHandling() ||
+        prepared->code.size() > g_calleeBudget.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    // Quickening and fusion rewrite `code` in place; inline the generic ops
+    // the instructions stand for.
+    out.code = prepared->code;
+    for (auto& instr : out.code) {
+        instr.op = GetGenericBytecodeOp(instr.op);
+        instr.b = 0;
+    }
+    std::string error;
+    if (!BytecodeVerifier::InferFrameStates(*callee, *prepared, out.code, false, out.states, error)) {
+        return false;
+    }
+
+    std::vector<bool> isTarget(out.code.size(), false);
+    for (const auto& instr : out.code) {
+        if (IsBranch(instr.op)) {
+            isTarget[static_cast<size_t>(instr.a)] = true;
+        }
+    }
+    for (size_t pc = 0; pc < out.code.size(); ++pc) {
+        if (!out.states[pc].reached) {
+            continue;
+        }
+        switch (out.code[pc].op) {
+            case BytecodeOp::Fail:
+            case BytecodeOp::InlineGuard:
+                return false;
+            case BytecodeOp::Ret:
+                if (out.states[pc].stack.size() > 1) {
+                    return false;
+                }
+                break;
+            case BytecodeOp::LdFld:
+            case BytecodeOp::StFld:
+                if (!isVirtual || !CheckFieldAccess(out, isTarget, pc)) {
+                    return false;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    out.method = callee;
+    out.prepared = std::move(prepared);
+    out.returnsVoid = ReturnsVoid(*callee);
+    return true;
+}
+
+/// One call of the caller chosen for inlining.
+struct InlineSite {
+    size_t pc;
+    size_t body; // index into the bodies
+    ClassRef receiver;
+};
+
+class Splicer {
+public:
+    Splicer(PreparedMethod& prepared, std::vector<CalleeBody>& bodies)
+        : _prepared(prepared), _bodies(bodies), _scratchBase(static_cast<int32_t>(prepared.localCount)) {}
+
+    // Rebuild the caller's code with the bodies of `sites` (in pc order)
+    // spliced in place of their calls.
+    void Run(const std::vector<InlineSite>& sites) {
+        const auto& code = _prepared.code;
+        const size_t count = code.size();
+        std::vector<size_t> newIndex(count + 1, 0);
+        std::vector<size_t> callerBranches;
+        struct Stub {
+            size_t guard;
+            size_t exit;
+            BytecodeInstruction call;
+            uint32_t sourceIp;
+        };
+        std::vector<Stub> stubs;
+
+        size_t next = 0;
+        for (size_t pc = 0; pc < count; ++pc) {
+            newIndex[pc] = _code.size();
+            if (next < sites.size() && sites[next].pc == pc) {
+                const InlineSite& site = sites[next++];
+                const uint32_t sourceIp = _prepared.sourceIps[pc];
+                const size_t guard = SpliceCall(site, code[pc], sourceIp);
+                stubs.push_back({guard, _code.size(), code[pc], sourceIp});
+                continue;
+            }
+            if (IsBranch(code[pc].op)) {
+                callerBranches.push_back(_code.size());
+            }
+            Emit(code[pc].op, code[pc].a, _prepared.sourceIps[pc], 0);
+        }
+        newIndex[count] = _code.size();
+
+        for (size_t at : callerBranches) {
+            _code[at].a = static_cast<int32_t>(newIndex[static_cast<size_t>(_code[at].a)]);
+        }
+        // The original calls, taken when an InlineGuard fails.
+        for (const Stub& stub : stubs) {
+            _code[stub.guard].a = static_cast<int32_t>(_code.size());
+            Emit(stub.call.op, stub.call.a, stub.sourceIp, 0);
+            Emit(BytecodeOp::Br, static_cast<int32_t>(stub.exit), stub.sourceIp, 0);
+        }
+
+        _prepared.code = std::move(_code);
+        _prepared.sourceIps = std::move(_sourceIps);
+        _prepared.inlineFrames = std::move(_frames);
+        _prepared.localCount = static_cast<size_t>(_scratchBase) + _scratchCount;
+    }
+
+private:
+    // Emits the guard, the argument stores and the remapped body of one
+    // call; returns the index of the guard.
+    size_t SpliceCall(const InlineSite& site, const BytecodeInstruction& call, uint32_t sourceIp) {
+        CalleeBody& body = _bodies[site.body];
+        CopyTables(body);
+
+        const CallSite& callSite = _prepared.callSites[static_cast<size_t>(call.a)];
+        InlinedCall inlined;
+        inlined.method = body.method;
+        inlined.source = body.prepared->source;
+        inlined.receiver = site.receiver;
+        inlined.callSite = static_cast<uint32_t>(call.a);
+        inlined.sourceIp = sourceIp;
+        inlined.argumentCount = callSite.argumentCount;
+
+        // Scratch layout: [this] arguments locals, shared by every site.
+        const bool isVirtual = call.op == BytecodeOp::CallVirt;
+        const int32_t thisSlot = _scratchBase;
+        inlined.thisSlot = isVirtual ? thisSlot : -1;
+        _prepared.inlinedCalls.push_back(std::move(inlined));
+        const uint32_t frame = static_cast<uint32_t>(_prepared.inlinedCalls.size());
+
+        const int32_t argumentBase = _scratchBase + (isVirtual ? 1 : 0);
+        const int32_t localBase = argumentBase + static_cast<int32_t>(callSite.argumentCount);
+        const size_t localCount = body.prepared->localCount;
+        _scratchCount = std::max(_scratchCount, static_cast<size_t>(localBase - _scratchBase) + localCount);
+
+        const size_t guard = _code.size();
+        Emit(BytecodeOp::InlineGuard, 0, sourceIp, 0, static_cast<int32_t>(frame - 1));
+        for (size_t i = callSite.argumentCount; i-- > 0;) {
+            Emit(BytecodeOp::StLoc, argumentBase + static_cast<int32_t>(i), sourceIp, 0);
+        }
+        if (isVirtual) {
+            Emit(BytecodeOp::StLoc, thisSlot, sourceIp, 0);
+        }
+        // A fresh frame starts with null locals; so does every inlined call.
+        for (size_t i = 0; i < localCount; ++i) {
+            Emit(BytecodeOp::LdNull, 0, sourceIp, 0);
+            Emit(BytecodeOp::StLoc, localBase + static_cast<int32_t>(i), sourceIp, 0);
+        }
+
+        const auto& code = body.code;
+        const auto& sourceIps = body.prepared->sourceIps;
+        std::vector<size_t> start(code.size());
+        std::vector<size_t> branches;
+        std::vector<size_t> exits;
+        for (size_t pc = 0; pc < code.size(); ++pc) {
+            start[pc] = _code.size();
+            const BytecodeInstruction& instr = code[pc];
+            const uint32_t ip = sourceIps[pc];
+            if (!body.states[pc].reached) {
+                Emit(BytecodeOp::Nop, 0, ip, frame);
+                continue;
+            }
+            switch (instr.op) {
+                case BytecodeOp::LdArg: Emit(BytecodeOp::LdLoc, argumentBase + instr.a, ip, frame); break;
+                case BytecodeOp::StArg: Emit(BytecodeOp::StLoc, argumentBase + instr.a, ip, frame); break;
+                case BytecodeOp::LdLoc:
+                case BytecodeOp::StLoc: Emit(instr.op, localBase + instr.a, ip, frame); break;
+                case BytecodeOp::LdThis:
+                    // Static methods run with a null 'this'.
+                    if (isVirtual) {
+                        Emit(BytecodeOp::LdLoc, thisSlot, ip, frame);
+                    } else {
+                        Emit(BytecodeOp::LdNull, 0, ip, frame);
+                    }
+                    break;
+                case BytecodeOp::LdConst: Emit(instr.op, body.constantBase + instr.a, ip, frame); break;
+                case BytecodeOp::LdFld:
+                case BytecodeOp::StFld: Emit(instr.op, body.fieldSiteBase + instr.a, ip, frame); break;
+                case BytecodeOp::NewObj:
+                case BytecodeOp::NewArr:
+                case BytecodeOp::CastClass:
+                case BytecodeOp::IsInst: Emit(instr.op, body.typeSiteBase + instr.a, ip, frame); break;
+                case BytecodeOp::Call:
+                case BytecodeOp::CallVirt: Emit(instr.op, body.callSiteBase + instr.a, ip, frame); break;
+                case BytecodeOp::Ret: {
+                    // Leave exactly what the call would have pushed: the
+                    // result unless the site discards it (the result of a
+                    // void method is null whatever its stack holds).
+                    const bool hasValue = !body.states[pc].stack.empty();
+                    if (body.returnsVoid) {
+                        if (hasValue) {
+                            Emit(BytecodeOp::Pop, 0, ip, frame);
+                        }
+                        if (!callSite.isVoidReturn) {
+                            Emit(BytecodeOp::LdNull, 0, ip, frame);
+                        }
+                    } else if (!hasValue && !callSite.isVoidReturn) {
+                        Emit(BytecodeOp::LdNull, 0, ip, frame);
+                    } else if (hasValue && callSite.isVoidReturn) {
+                        Emit(BytecodeOp::Pop, 0, ip, frame);
+                    }
+                    exits.push_back(_code.size());
+                    Emit(BytecodeOp::Br, 0, ip, frame);
+                    break;
+                }
+                default:
+                    if (IsBranch(instr.op)) {
+                        branches.push_back(_code.size());
+                    }
+                    Emit(instr.op, instr.a, ip, frame);
+                    break;
+            }
+        }
+
+        for (size_t at : branches) {
+            _code[at].a = static_cast<int32_t>(start[static_cast<size_t>(_code[at].a)]);
+        }
+        const int32_t exit = static_cast<int32_t>(_code.size());
+        for (size_t at : exits) {
+            _code[at].a = exit;
+        }
+        return guard;
+    }
+
+    // Append the constants and sites of `body` to the caller's tables, once
+    // per callee. Only the resolution inputs are copied, not the caches.
+    void CopyTables(CalleeBody& body) {
+        if (body.copied) {
+            return;
+        }
+        body.copied = true;
+        const PreparedMethod& source = *body.prepared;
+        body.constantBase = static_cast<int32_t>(_prepared.constants.size());
+        body.callSiteBase = static_cast<int32_t>(_prepared.callSites.size());
+        body.fieldSiteBase = static_cast<int32_t>(_prepared.fieldSites.size());
+        body.typeSiteBase = static_cast<int32_t>(_prepared.typeSites.size());
+
+        _prepared.constants.insert(_prepared.constants.end(), source.constants.begin(), source.constants.end());
+        for (const CallSite& site : source.callSites) {
+            CallSite copy;
+            copy.target = site.target;
+            copy.declaringType = site.declaringType;
+            copy.name = site.name;
+            copy.argumentCount = site.argumentCount;
+            copy.isVoidReturn = site.isVoidReturn;
+            copy.isConsoleWriteLine = site.isConsoleWriteLine;
+            _prepared.callSites.push_back(std::move(copy));
+        }
+        for (const FieldSite& site : source.fieldSites) {
+            FieldSite copy;
+            copy.name = site.name;
+            copy.symbol = site.symbol;
+            _prepared.fieldSites.push_back(std::move(copy));
+        }
+        for (const TypeSite& site : source.typeSites) {
+            TypeSite copy;
+            copy.name = site.name;
+            copy.normalizedName = site.normalizedName;
+            copy.symbol = site.symbol;
+            copy.normalizedSymbol = site.normalizedSymbol;
+            _prepared.typeSites.push_back(std::move(copy));
+        }
+    }
+
+    void Emit(BytecodeOp op, int32_t a, uint32_t sourceIp, uint32_t frame, int32_t b = 0) {
+        _code.push_back(BytecodeInstruction{op, a, b});
+        _sourceIps.push_back(sourceIp);
+        _frames.push_back(frame);
+    }
+
+    PreparedMethod& _prepared;
+    std::vector<CalleeBody>& _bodies;
+    const int32_t _scratchBase;
+    size_t _scratchCount = 0;
+    std::vector<BytecodeInstruction> _code;
+    std::vector<uint32_t> _sourceIps;
+    std::vector<uint32_t> _frames;
+};
+
+// Instructions SpliceCall emits for one call, counted against the caller's
+// growth budget.
+size_t SpliceSize(const CalleeBody& body, const CallSite& site, bool isVirtual) {
+    size_t size = 1 + site.argumentCount + (isVirtual ? 1 : 0) + 2 * body.prepared->localCount + 2;
+    for (size_t pc = 0; pc < body.code.size(); ++pc) {
+        size += body.code[pc].op == BytecodeOp::Ret ? 3 : 1;
+    }
+    return size;
+}
+
+// Whether `method` has a call ResolveCallee accepts, before paying for a
+// new compilation.
+bool HasCandidateCall(VirtualMachine& vm, const Method& method) {
+    const auto prepared = method.GetPrepared();
+    for (const auto& instr : prepared->code) {
+        const BytecodeOp op = GetGenericBytecodeOp(instr.op);
+        if (op != BytecodeOp::Call && op != BytecodeOp::CallVirt) {
+            continue;
+        }
+        ClassRef receiver;
+        if (ResolveCallee(vm, method, prepared->callSites[static_cast<size_t>(instr.a)], op == BytecodeOp::CallVirt,
+                          receiver)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+size_t BytecodeInliner::Inline(VirtualMachine& vm, const Method& method, PreparedMethod& prepared) {
+    if (!IsEnabled() || !prepared.inlinedCalls.empty() || prepared.code.empty() || prepared.HasExceptionHandling()) {
+        return 0;
+    }
+
+    // Only calls every path reaches with a fixed stack are inlined, so the
+    // spliced body sees exactly the arguments the call would have taken.
+    std::vector<VerifiedFrameState> states;
+    std::string error;
+    if (!BytecodeVerifier::InferFrameStates(method, prepared, prepared.code, false, states, error)) {
+        return 0;
+    }
+
+    std::vector<CalleeBody> bodies;
+    std::unordered_map<const Method*, size_t> bodyIndex;
+    std::unordered_set<const Method*> rejected;
+    std::vector<InlineSite> sites;
+    const size_t growthBudget = g_callerGrowthBudget.load(std::memory_order_relaxed);
+    size_t growth = 0;
+
+    for (size_t pc = 0; pc < prepared.code.size(); ++pc) {
+        const BytecodeOp op = prepared.code[pc].op;
+        if ((op != BytecodeOp::Call && op != BytecodeOp::CallVirt) || !states[pc].reached) {
+            continue;
+        }
+        const bool isVirtual = op == BytecodeOp::CallVirt;
+        const CallSite& site = prepared.callSites[static_cast<size_t>(prepared.code[pc].a)];
+        ClassRef receiver;
+        MethodRef callee = ResolveCallee(vm, method, site, isVirtual, receiver);
+        if (!callee || rejected.count(callee.get()) != 0) {
+            continue;
+        }
+
+        auto found = bodyIndex.find(callee.get());
+        if (found == bodyIndex.end()) {
+            CalleeBody body;
+            if (!Analyze(callee, isVirtual, body)) {
+                rejected.insert(callee.get());
+                continue;
+            }
+            found = bodyIndex.emplace(callee.get(), bodies.size()).first;
+            bodies.push_back(std::move(body));
+        }
+        // Static sites resolve to static methods and virtual ones to
+        // instance methods, so a body is always analyzed for its kind of site.
+        const CalleeBody& body = bodies[found->second];
+        const size_t size = SpliceSize(body, site, isVirtual);
+        if (growth + size > growthBudget) {
+            continue;
+        }
+        growth += size;
+        sites.push_back({pc, found->second, isVirtual ? receiver : nullptr});
+    }
+
+    if (sites.empty()) {
+        return 0;
+    }
+    Splicer(prepared, bodies).Run(sites);
+    return sites.size();
+}
+
+size_t BytecodeInliner::InlineCalls(VirtualMachine& vm) {
+    if (!IsEnabled()) {
+        return 0;
+    }
+    size_t inlined = 0;
+    // Classes are registered under several names; visit each one once.
+    std::unordered_set<const Class*> seen;
+    for (const auto& name : vm.GetAllClassNames()) {
+        ClassRef classRef = vm.GetClass(name);
+        if (!classRef || !seen.insert(classRef.get()).second) {
+            continue;
+        }
+        for (const auto& method : classRef->GetAllMethods()) {
+            // Bodies still at the Interpreter tier are inlined into once
+            // TieredExecution optimizes them.
+            if (!method || method->GetNativeImpl() || !method->HasInstructions() ||
+                method->GetPrepared()->tier != ExecutionTier::Optimized || !HasCandidateCall(vm, *method)) {
+                continue;
+            }
+            auto prepared = BytecodeCompiler::Compile(*method, &vm);
+            if (!prepared->inlinedCalls.empty()) {
+                inlined += prepared->inlinedCalls.size();
+                method->SetPrepared(std::move(prepared));
+            }
+        }
+    }
+    return inlined;
+}
+
+void BytecodeInliner::SetEnabled(bool enabled) {
+    g_inliningEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool BytecodeInliner::IsEnabled() {
+    return g_inliningEnabled.load(std::memory_order_relaxed);
+}
+
+void BytecodeInliner::SetBudget(size_t calleeInstructions, size_t callerGrowth) {
+    g_calleeBudget.store(calleeInstructions, std::memory_order_relaxed);
+    g_callerGrowthBudget.store(callerGrowth, std::memory_order_relaxed);
+}
+
+size_t BytecodeInliner::GetCalleeBudget() {
+    return g_calleeBudget.load(std::memory_order_relaxed);
+}
+
+size_t BytecodeInliner::GetCallerGrowthBudget() {
+    return g_callerGrowthBudget.load(std::memory_order_relaxed);
+}
+
+void BytecodeInliner::Configure(const std::string& spec) {
+    if (spec == "on" || spec == "off") {
+        SetEnabled(spec == "on");
+        return;
+    }
+    if (spec.empty() || spec.find_first_not_of("0123456789") != std::string::npos || spec.size() > 9) {
+        throw std::runtime_error("Unknown inliner setting: " + spec);
+    }
+    g_calleeBudget.store(std::stoul(spec), std::memory_order_relaxed);
+    SetEnabled(true);
+}
+
+} // namespace ObjectIR
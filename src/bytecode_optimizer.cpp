@@ -0,0 +1,704 @@
+#include "bytecode.hpp"
+#include "instruction_executor.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ObjectIR {
+
+namespace {
+
+constexpr size_t kNone = static_cast<size_t>(-1);
+
+// Rounds of the whole pipeline per method; passes expose work for each other
+// (folding a branch makes code unreachable, dead stores leave loads to pop),
+// but real code settles after two or three.
+constexpr size_t kMaxRounds = 4;
+
+constexpr uint32_t kAllPasses = (1u << kOptimizerPassCount) - 1;
+
+std::atomic<uint32_t> g_enabledPasses{kAllPasses};
+std::atomic<uint64_t> g_passChanges[kOptimizerPassCount] = {};
+std::atomic<uint64_t> g_optimizedMethods{0};
+std::atomic<uint64_t> g_instructionsBefore{0};
+std::atomic<uint64_t> g_instructionsAfter{0};
+
+#define OBJECTIR_OPTIMIZER_NAME_ENTRY(name, text) text,
+const char* const kPassNames[] = { OBJECTIR_OPTIMIZER_PASSES(OBJECTIR_OPTIMIZER_NAME_ENTRY) };
+#undef OBJECTIR_OPTIMIZER_NAME_ENTRY
+
+uint32_t PassBit(OptimizerPass pass) {
+    return 1u << static_cast<uint32_t>(pass);
+}
+
+bool IsCompareBranch(BytecodeOp op) {
+    switch (op) {
+        case BytecodeOp::Beq:
+        case BytecodeOp::Bne:
+        case BytecodeOp::Bgt:
+        case BytecodeOp::Blt:
+        case BytecodeOp::Bge:
+        case BytecodeOp::Ble:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool IsBranch(BytecodeOp op) {
+    return op == BytecodeOp::Br || op == BytecodeOp::BrTrue || op == BytecodeOp::BrFalse || IsCompareBranch(op) ||
+           op == BytecodeOp::InlineGuard;
+}
+
+// The operation InstructionExecutor::EvaluateConstantOp computes for `op`,
+// or Nop if it has no constant form.
+OpCode FoldableOpCode(BytecodeOp op) {
+    switch (op) {
+        case BytecodeOp::Add: return OpCode::Add;
+        case BytecodeOp::Sub: return OpCode::Sub;
+        case BytecodeOp::Mul: return OpCode::Mul;
+        case BytecodeOp::Div: return OpCode::Div;
+        case BytecodeOp::Rem: return OpCode::Rem;
+        case BytecodeOp::Neg: return OpCode::Neg;
+        case BytecodeOp::Ceq: return OpCode::Ceq;
+        case BytecodeOp::Cne: return OpCode::Cne;
+        case BytecodeOp::Clt: return OpCode::Clt;
+        case BytecodeOp::Cle: return OpCode::Cle;
+        case BytecodeOp::Cgt: return OpCode::Cgt;
+        case BytecodeOp::Cge: return OpCode::Cge;
+        case BytecodeOp::BrTrue: return OpCode::BrTrue;
+        case BytecodeOp::BrFalse: return OpCode::BrFalse;
+        case BytecodeOp::Beq: return OpCode::Beq;
+        case BytecodeOp::Bne: return OpCode::Bne;
+        case BytecodeOp::Bgt: return OpCode::Bgt;
+        case BytecodeOp::Blt: return OpCode::Blt;
+        case BytecodeOp::Bge: return OpCode::Bge;
+        case BytecodeOp::Ble: return OpCode::Ble;
+        default: return OpCode::Nop;
+    }
+}
+
+// Pushes a value without side effects or failure modes, so a push that is
+// popped right away can go. LdArg is not among them: it fails when the
+// frame was given fewer arguments than the method declares.
+bool IsPureLoad(BytecodeOp op) {
+    return op == BytecodeOp::LdConst || op == BytecodeOp::LdNull || op == BytecodeOp::LdLoc ||
+           op == BytecodeOp::LdThis;
+}
+
+// The passes work on the generic ops BytecodeCompiler's lowering emits, and
+// never move instructions: a removed instruction becomes a Nop, and Compact
+// drops those once a round is over.
+class Pipeline {
+public:
+    explicit Pipeline(PreparedMethod& prepared)
+        : _prepared(prepared), _code(prepared.code) {}
+
+    size_t Run(OptimizerPass pass) {
+        FindTargets();
+        switch (pass) {
+            case OptimizerPass::ConstantFolding: return PropagateConstants() + FoldConstants();
+            case OptimizerPass::DeadStores: return RemoveDeadStores();
+            case OptimizerPass::DeadCode: return RemoveDeadLoads();
+            case OptimizerPass::DupPop: return RemoveDupPops();
+            case OptimizerPass::BranchThreading: return ThreadBranches();
+            case OptimizerPass::UnreachableBlocks: return RemoveUnreachable();
+        }
+        return 0;
+    }
+
+    // Drop the Nops, remapping branch targets to the next instruction kept.
+    // A trailing Nop something branches to stays so the target exists.
+    void Compact() {
+        const size_t count = _code.size();
+        std::vector<size_t> newIndex(count + 1);
+        auto layout = [&](bool keepLast) {
+            size_t kept = 0;
+            for (size_t pc = 0; pc < count; ++pc) {
+                newIndex[pc] = kept;
+                if (_code[pc].op != BytecodeOp::Nop || (keepLast && pc + 1 == count)) {
+                    ++kept;
+                }
+            }
+            newIndex[count] = kept;
+            return kept;
+        };
+
+        size_t kept = layout(false);
+        bool keepLast = false;
+        for (const auto& instr : _code) {
+            if (IsBranch(instr.op) && newIndex[static_cast<size_t>(instr.a)] == kept) {
+                keepLast = true;
+                kept = layout(true);
+                break;
+            }
+        }
+        if (kept == count) {
+            return;
+        }
+
+        std::vector<BytecodeInstruction> code;
+        std::vector<uint32_t> sourceIps;
+        std::vector<uint32_t> inlineFrames;
+        const bool inlined = !_prepared.inlineFrames.empty();
+        code.reserve(kept);
+        sourceIps.reserve(kept);
+        for (size_t pc = 0; pc < count; ++pc) {
+            if (_code[pc].op == BytecodeOp::Nop && !(keepLast && pc + 1 == count)) {
+                continue;
+            }
+            BytecodeInstruction instr = _code[pc];
+            if (IsBranch(instr.op)) {
+                instr.a = static_cast<int32_t>(newIndex[static_cast<size_t>(instr.a)]);
+            }
+            code.push_back(instr);
+            sourceIps.push_back(_prepared.sourceIps[pc]);
+            if (inlined) {
+                inlineFrames.push_back(_prepared.inlineFrames[pc]);
+            }
+        }
+        _code = std::move(code);
+        _prepared.sourceIps = std::move(sourceIps);
+        if (inlined) {
+            _prepared.inlineFrames = std::move(inlineFrames);
+        }
+    }
+
+private:
+    void FindTargets() {
+        _isTarget.assign(_code.size(), false);
+        for (const auto& instr : _code) {
+            if (IsBranch(instr.op)) {
+                _isTarget[static_cast<size_t>(instr.a)] = true;
+            }
+        }
+    }
+
+    // The instruction before `pc` that always falls through to it (skipping
+    // Nops), or kNone if a branch may enter in between.
+    size_t Previous(size_t pc) const {
+        if (_isTarget[pc]) {
+            return kNone;
+        }
+        for (size_t i = pc; i-- > 0;) {
+            if (_code[i].op != BytecodeOp::Nop) {
+                return i;
+            }
+            if (_isTarget[i]) {
+                return kNone;
+            }
+        }
+        return kNone;
+    }
+
+    // The instruction `pc` always falls through to, or kNone.
+    size_t Next(size_t pc) const {
+        for (size_t i = pc + 1; i < _code.size(); ++i) {
+            if (_isTarget[i]) {
+                return kNone;
+            }
+            if (_code[i].op != BytecodeOp::Nop) {
+                return i;
+            }
+        }
+        return kNone;
+    }
+
+    // First non-Nop instruction at or after `pc` (ignoring targets).
+    size_t SkipNops(size_t pc) const {
+        while (pc < _code.size() && _code[pc].op == BytecodeOp::Nop) {
+            ++pc;
+        }
+        return pc;
+    }
+
+    void Successors(size_t pc, std::vector<size_t>& out) const {
+        out.clear();
+        const BytecodeInstruction& instr = _code[pc];
+        switch (instr.op) {
+            case BytecodeOp::Ret:
+            case BytecodeOp::Fail:
+            case BytecodeOp::Throw:
+                return;
+            case BytecodeOp::Br:
+                out.push_back(static_cast<size_t>(instr.a));
+                return;
+            default:
+                if (IsBranch(instr.op)) {
+                    out.push_back(static_cast<size_t>(instr.a));
+                }
+                if (pc + 1 < _code.size()) {
+                    out.push_back(pc + 1);
+                }
+                return;
+        }
+    }
+
+    bool IsConstantLoad(size_t pc) const {
+        return pc != kNone && (_code[pc].op == BytecodeOp::LdConst || _code[pc].op == BytecodeOp::LdNull);
+    }
+
+    Value ConstantOf(size_t pc) const {
+        return _code[pc].op == BytecodeOp::LdNull ? Value() : _prepared.constants[static_cast<size_t>(_code[pc].a)];
+    }
+
+    int32_t AddConstant(Value value) {
+        _prepared.constants.push_back(std::move(value));
+        return static_cast<int32_t>(_prepared.constants.size() - 1);
+    }
+
+    void Remove(size_t pc) {
+        _code[pc] = BytecodeInstruction{BytecodeOp::Nop, 0, 0};
+    }
+
+    // Replace arithmetic, compares and branches whose operands are constant
+    // loads by their result (or by an unconditional branch / nothing).
+    size_t FoldConstants() {
+        size_t changes = 0;
+        for (size_t pc = 0; pc < _code.size(); ++pc) {
+            const OpCode op = FoldableOpCode(_code[pc].op);
+            if (op == OpCode::Nop) {
+                continue;
+            }
+            const size_t arity = (op == OpCode::Neg || op == OpCode::BrTrue || op == OpCode::BrFalse) ? 1 : 2;
+            const size_t right = Previous(pc);
+            const size_t left = arity == 2 && right != kNone ? Previous(right) : kNone;
+            if (!IsConstantLoad(right) || (arity == 2 && !IsConstantLoad(left))) {
+                continue;
+            }
+
+            Value operands[2];
+            if (arity == 2) {
+                operands[0] = ConstantOf(left);
+                operands[1] = ConstantOf(right);
+            } else {
+                operands[0] = ConstantOf(right);
+            }
+            Value result;
+            if (!InstructionExecutor::EvaluateConstantOp(op, operands, arity, result)) {
+                continue;
+            }
+
+            Remove(right);
+            if (arity == 2) {
+                Remove(left);
+            }
+            if (IsBranch(_code[pc].op)) {
+                if (result.AsBool()) {
+                    _code[pc].op = BytecodeOp::Br;
+                } else {
+                    Remove(pc);
+                }
+            } else {
+                _code[pc] = BytecodeInstruction{BytecodeOp::LdConst, AddConstant(std::move(result)), 0};
+            }
+            ++changes;
+        }
+        return changes;
+    }
+
+    // Forward dataflow over the locals: a local holds a known constant at an
+    // instruction when every path to it last stored that same constant
+    // (identified by its constant index). Loads of such locals become
+    // constant loads, which FoldConstants can then fold further.
+    size_t PropagateConstants() {
+        const size_t localCount = _prepared.localCount;
+        if (localCount == 0) {
+            return 0;
+        }
+        constexpr int32_t kVarying = -1;
+        constexpr int32_t kNull = -2;
+
+        const size_t count = _code.size();
+        std::vector<std::vector<int32_t>> entry(count);
+        std::vector<size_t> worklist{0};
+        entry[0].assign(localCount, kVarying);
+        std::vector<int32_t> state;
+        std::vector<size_t> successors;
+
+        while (!worklist.empty()) {
+            const size_t pc = worklist.back();
+            worklist.pop_back();
+
+            state = entry[pc];
+            if (_code[pc].op == BytecodeOp::StLoc) {
+                const size_t value = Previous(pc);
+                int32_t& local = state[static_cast<size_t>(_code[pc].a)];
+                if (value != kNone && _code[value].op == BytecodeOp::LdConst) {
+                    local = _code[value].a;
+                } else if (value != kNone && _code[value].op == BytecodeOp::LdNull) {
+                    local = kNull;
+                } else {
+                    local = kVarying;
+                }
+            }
+
+            Successors(pc, successors);
+            for (size_t next : successors) {
+                std::vector<int32_t>& target = entry[next];
+                if (target.empty()) {
+                    target = state;
+                    worklist.push_back(next);
+                    continue;
+                }
+                bool changed = false;
+                for (size_t i = 0; i < localCount; ++i) {
+                    if (target[i] != state[i] && target[i] != kVarying) {
+                        target[i] = kVarying;
+                        changed = true;
+                    }
+                }
+                if (changed) {
+                    worklist.push_back(next);
+                }
+            }
+        }
+
+        size_t changes = 0;
+        for (size_t pc = 0; pc < count; ++pc) {
+            if (_code[pc].op != BytecodeOp::LdLoc || entry[pc].empty()) {
+                continue;
+            }
+            const int32_t value = entry[pc][static_cast<size_t>(_code[pc].a)];
+            if (value == kNull) {
+                _code[pc] = BytecodeInstruction{BytecodeOp::LdNull, 0, 0};
+                ++changes;
+            } else if (value >= 0) {
+                _code[pc] = BytecodeInstruction{BytecodeOp::LdConst, value, 0};
+                ++changes;
+            }
+        }
+        return changes;
+    }
+
+    // Backward liveness over the locals; a store no path reads before the
+    // next store (or the end of the method) becomes a pop, and a store whose
+    // only read follows right after it goes away with that read.
+    size_t RemoveDeadStores() {
+        const size_t localCount = _prepared.localCount;
+        if (localCount == 0) {
+            return 0;
+        }
+        const size_t count = _code.size();
+        std::vector<std::vector<bool>> liveIn(count, std::vector<bool>(localCount, false));
+        std::vector<bool> live;
+        std::vector<size_t> successors;
+
+        auto liveOut = [&](size_t pc) {
+            live.assign(localCount, false);
+            Successors(pc, successors);
+            for (size_t next : successors) {
+                for (size_t i = 0; i < localCount; ++i) {
+                    if (liveIn[next][i]) {
+                        live[i] = true;
+                    }
+                }
+            }
+        };
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t pc = count; pc-- > 0;) {
+                liveOut(pc);
+                const BytecodeInstruction& instr = _code[pc];
+                if (instr.op == BytecodeOp::StLoc) {
+                    live[static_cast<size_t>(instr.a)] = false;
+                } else if (instr.op == BytecodeOp::LdLoc) {
+                    live[static_cast<size_t>(instr.a)] = true;
+                }
+                if (live != liveIn[pc]) {
+                    liveIn[pc] = live;
+                    changed = true;
+                }
+            }
+        }
+
+        size_t changes = 0;
+        for (size_t pc = 0; pc < count; ++pc) {
+            if (_code[pc].op != BytecodeOp::StLoc) {
+                continue;
+            }
+            const size_t slot = static_cast<size_t>(_code[pc].a);
+            liveOut(pc);
+            if (!live[slot]) {
+                _code[pc] = BytecodeInstruction{BytecodeOp::Pop, 0, 0};
+                ++changes;
+                continue;
+            }
+            const size_t load = Next(pc);
+            if (load != kNone && _code[load].op == BytecodeOp::LdLoc && static_cast<size_t>(_code[load].a) == slot) {
+                liveOut(load);
+                if (!live[slot]) {
+                    Remove(pc);
+                    Remove(load);
+                    ++changes;
+                }
+            }
+        }
+        return changes;
+    }
+
+    // `load; pop` for a load without side effects.
+    size_t RemoveDeadLoads() {
+        size_t changes = 0;
+        for (size_t pc = 0; pc < _code.size(); ++pc) {
+            if (_code[pc].op != BytecodeOp::Pop) {
+                continue;
+            }
+            const size_t load = Previous(pc);
+            if (load != kNone && IsPureLoad(_code[load].op)) {
+                Remove(load);
+                Remove(pc);
+                ++changes;
+            }
+        }
+        return changes;
+    }
+
+    // `dup; pop` and `dup; stloc/starg; pop`.
+    size_t RemoveDupPops() {
+        size_t changes = 0;
+        for (size_t pc = 0; pc < _code.size(); ++pc) {
+            if (_code[pc].op != BytecodeOp::Dup) {
+                continue;
+            }
+            size_t pop = Next(pc);
+            if (pop != kNone && (_code[pop].op == BytecodeOp::StLoc || _code[pop].op == BytecodeOp::StArg)) {
+                pop = Next(pop);
+            }
+            if (pop != kNone && _code[pop].op == BytecodeOp::Pop) {
+                Remove(pc);
+                Remove(pop);
+                ++changes;
+            }
+        }
+        return changes;
+    }
+
+    // Where control ends up when it reaches `pc`: past Nops and through
+    // unconditional branches (bounded, for `br` cycles).
+    size_t FinalTarget(size_t pc) const {
+        for (size_t steps = 0; steps < _code.size(); ++steps) {
+            pc = SkipNops(pc);
+            if (pc >= _code.size() || _code[pc].op != BytecodeOp::Br) {
+                break;
+            }
+            pc = static_cast<size_t>(_code[pc].a);
+        }
+        return pc;
+    }
+
+    size_t ThreadBranches() {
+        size_t changes = 0;
+        for (size_t pc = 0; pc < _code.size(); ++pc) {
+            BytecodeInstruction& instr = _code[pc];
+            if (!IsBranch(instr.op)) {
+                continue;
+            }
+
+            const size_t target = FinalTarget(static_cast<size_t>(instr.a));
+            if (target < _code.size() && target != SkipNops(static_cast<size_t>(instr.a)) &&
+                _code[target].op != BytecodeOp::Br) {
+                instr.a = static_cast<int32_t>(target);
+                ++changes;
+            }
+
+            if (instr.op == BytecodeOp::Br && target < _code.size() && _code[target].op == BytecodeOp::Ret) {
+                // The stack is the same on both sides of the jump.
+                instr = BytecodeInstruction{BytecodeOp::Ret, 0, 0};
+                ++changes;
+                continue;
+            }
+
+            const size_t next = SkipNops(pc + 1);
+            if (static_cast<size_t>(instr.a) == next) {
+                if (instr.op == BytecodeOp::Br) {
+                    Remove(pc);
+                    ++changes;
+                } else if (instr.op == BytecodeOp::BrTrue || instr.op == BytecodeOp::BrFalse) {
+                    // Converting the condition to bool cannot fail.
+                    instr = BytecodeInstruction{BytecodeOp::Pop, 0, 0};
+                    ++changes;
+                }
+                continue;
+            }
+
+            //     brtrue L1          brfalse L2
+            //     br L2        ->
+            // L1:                L1:
+            if ((instr.op == BytecodeOp::BrTrue || instr.op == BytecodeOp::BrFalse) && next < _code.size() &&
+                _code[next].op == BytecodeOp::Br && !_isTarget[next] &&
+                static_cast<size_t>(instr.a) == SkipNops(next + 1)) {
+                instr.op = instr.op == BytecodeOp::BrTrue ? BytecodeOp::BrFalse : BytecodeOp::BrTrue;
+                instr.a = _code[next].a;
+                Remove(next);
+                ++changes;
+            }
+        }
+        return changes;
+    }
+
+    size_t RemoveUnreachable() {
+        const size_t count = _code.size();
+        std::vector<bool> reached(count, false);
+        std::vector<size_t> worklist{0};
+        std::vector<size_t> successors;
+        reached[0] = true;
+        while (!worklist.empty()) {
+            const size_t pc = worklist.back();
+            worklist.pop_back();
+            Successors(pc, successors);
+            for (size_t next : successors) {
+                if (!reached[next]) {
+                    reached[next] = true;
+                    worklist.push_back(next);
+                }
+            }
+        }
+
+        size_t changes = 0;
+        for (size_t pc = 0; pc < count; ++pc) {
+            if (!reached[pc] && _code[pc].op != BytecodeOp::Nop) {
+                Remove(pc);
+                ++changes;
+            }
+        }
+        return changes;
+    }
+
+    PreparedMethod& _prepared;
+    std::vector<BytecodeInstruction>& _code;
+    std::vector<bool> _isTarget;
+};
+
+} // namespace
+
+void BytecodeOptimizer::Optimize(const Method& method, PreparedMethod& prepared) {
+    const uint32_t enabled = g_enabledPasses.load(std::memory_order_relaxed);
+    if (enabled == 0 || prepared.code.empty() || prepared.HasExceptionHandling()) {
+        return;
+    }
+
+    // Bodies whose stack depth is not fixed at every instruction (or that
+    // reach a Fail) keep every instruction, so they fail where and how they
+    // always did.
+    std::vector<VerifiedFrameState> states;
+    std::string error;
+    if (!BytecodeVerifier::InferFrameStates(method, prepared, prepared.code, false, states, error)) {
+        return;
+    }
+
+    Pipeline pipeline(prepared);
+    const size_t before = prepared.code.size();
+    size_t changes[kOptimizerPassCount] = {};
+    for (size_t round = 0; round < kMaxRounds; ++round) {
+        size_t roundChanges = 0;
+        for (size_t i = 0; i < kOptimizerPassCount; ++i) {
+            if (enabled & (1u << i)) {
+                const size_t passChanges = pipeline.Run(static_cast<OptimizerPass>(i));
+                changes[i] += passChanges;
+                roundChanges += passChanges;
+            }
+        }
+        pipeline.Compact();
+        if (roundChanges == 0) {
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < kOptimizerPassCount; ++i) {
+        if (changes[i] != 0) {
+            g_passChanges[i].fetch_add(changes[i], std::memory_order_relaxed);
+        }
+    }
+    g_optimizedMethods.fetch_add(1, std::memory_order_relaxed);
+    g_instructionsBefore.fetch_add(before, std::memory_order_relaxed);
+    g_instructionsAfter.fetch_add(prepared.code.size(), std::memory_order_relaxed);
+}
+
+void BytecodeOptimizer::SetPassEnabled(OptimizerPass pass, bool enabled) {
+    if (enabled) {
+        g_enabledPasses.fetch_or(PassBit(pass), std::memory_order_relaxed);
+    } else {
+        g_enabledPasses.fetch_and(~PassBit(pass), std::memory_order_relaxed);
+    }
+}
+
+bool BytecodeOptimizer::IsPassEnabled(OptimizerPass pass) {
+    return (g_enabledPasses.load(std::memory_order_relaxed) & PassBit(pass)) != 0;
+}
+
+const char* BytecodeOptimizer::GetPassName(OptimizerPass pass) {
+    return kPassNames[static_cast<size_t>(pass)];
+}
+
+void BytecodeOptimizer::Configure(const std::string& spec) {
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        std::string entry = spec.substr(start, end - start);
+        start = end + 1;
+
+        const size_t first = entry.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            continue;
+        }
+        entry = entry.substr(first, entry.find_last_not_of(" \t") - first + 1);
+
+        if (entry == "all" || entry == "on") {
+            g_enabledPasses.store(kAllPasses, std::memory_order_relaxed);
+            continue;
+        }
+        if (entry == "none" || entry == "off") {
+            g_enabledPasses.store(0, std::memory_order_relaxed);
+            continue;
+        }
+
+        bool enable = true;
+        if (entry[0] == '-' || entry[0] == '+') {
+            enable = entry[0] == '+';
+            entry.erase(0, 1);
+        }
+        bool found = false;
+        for (size_t i = 0; i < kOptimizerPassCount; ++i) {
+            if (entry == kPassNames[i]) {
+                SetPassEnabled(static_cast<OptimizerPass>(i), enable);
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            throw std::runtime_error("Unknown optimizer pass: " + entry);
+        }
+    }
+}
+
+OptimizerStatistics BytecodeOptimizer::GetStatistics() {
+    OptimizerStatistics stats;
+    stats.methods = g_optimizedMethods.load(std::memory_order_relaxed);
+    stats.instructionsBefore = g_instructionsBefore.load(std::memory_order_relaxed);
+    stats.instructionsAfter = g_instructionsAfter.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kOptimizerPassCount; ++i) {
+        const auto pass = static_cast<OptimizerPass>(i);
+        stats.passes.push_back(OptimizerPassStats{
+            pass, kPassNames[i], IsPassEnabled(pass), g_passChanges[i].load(std::memory_order_relaxed)});
+    }
+    return stats;
+}
+
+void BytecodeOptimizer::ResetStatistics() {
+    for (auto& changes : g_passChanges) {
+        changes.store(0, std::memory_order_relaxed);
+    }
+    g_optimizedMethods.store(0, std::memory_order_relaxed);
+    g_instructionsBefore.store(0, std::memory_order_relaxed);
+    g_instructionsAfter.store(0, std::memory_order_relaxed);
+}
+
+} // namespace ObjectIR
@@ -0,0 +1,582 @@
+#include "bytecode.hpp"
+#include "objectir_type_names.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ObjectIR {
+
+namespace {
+
+using Type = VerifiedType;
+
+bool IsNumeric(Type type) {
+    return type == Type::Int32 || type == Type::Int64 || type == Type::Float32 || type == Type::Float64;
+}
+
+Type TypeOfValue(const Value& value) {
+    if (value.IsInt32()) return Type::Int32;
+    if (value.IsInt64()) return Type::Int64;
+    if (value.IsFloat32()) return Type::Float32;
+    if (value.IsFloat64()) return Type::Float64;
+    if (value.IsBool()) return Type::Bool;
+    if (value.IsString()) return Type::String;
+    if (value.IsObject()) return Type::Object;
+    return Type::Null;
+}
+
+// Type a value declared as `type` is guaranteed to have. Only primitives the
+// interpreter keeps in a dedicated tag qualify; references may be null.
+Type TypeOfDeclaration(const TypeReference& type) {
+    if (type.IsArray() || !type.IsPrimitive()) {
+        return Type::Unknown;
+    }
+    switch (type.GetPrimitiveType()) {
+        case PrimitiveType::Int32: return Type::Int32;
+        case PrimitiveType::Int64: return Type::Int64;
+        case PrimitiveType::Float32: return Type::Float32;
+        case PrimitiveType::Float64: return Type::Float64;
+        case PrimitiveType::Bool: return Type::Bool;
+        case PrimitiveType::String: return Type::String;
+        default: return Type::Unknown;
+    }
+}
+
+// Type of a call result declared as `name` (a CallTarget return type), for
+// analyses that trust declarations; see InferFrameStates.
+Type TypeOfTypeName(const std::string& name) {
+    const std::string normalized = TypeNames::NormalizeTypeName(name);
+    if (normalized == "int32") return Type::Int32;
+    if (normalized == "int64") return Type::Int64;
+    if (normalized == "float32") return Type::Float32;
+    if (normalized == "float64") return Type::Float64;
+    if (normalized == "bool") return Type::Bool;
+    return Type::Unknown;
+}
+
+// True when a value proven to be `actual` can never be a valid `declared`
+// value. Numeric types convert into each other and null fits anything.
+bool Conflicts(Type declared, Type actual) {
+    if (declared == Type::Unknown || actual == Type::Unknown || actual == Type::Null) {
+        return false;
+    }
+    if (IsNumeric(declared)) {
+        return !IsNumeric(actual);
+    }
+    return declared != actual;
+}
+
+const char* TypeName(Type type) {
+    switch (type) {
+        case Type::Null: return "null";
+        case Type::Int32: return "int32";
+        case Type::Int64: return "int64";
+        case Type::Float32: return "float32";
+        case Type::Float64: return "float64";
+        case Type::Bool: return "bool";
+        case Type::String: return "string";
+        case Type::Object: return "object";
+        default: return "unknown";
+    }
+}
+
+Type Join(Type a, Type b) {
+    return a == b ? a : Type::Unknown;
+}
+
+// Result type of the generic arithmetic handlers (see ExecuteAdd and friends).
+Type ArithmeticResult(BytecodeOp op, Type a, Type b) {
+    if (op == BytecodeOp::Add && (a == Type::String || b == Type::String)) {
+        return Type::String;
+    }
+    if (!IsNumeric(a) || !IsNumeric(b)) {
+        return Type::Unknown;
+    }
+    if (a == Type::Int32 && b == Type::Int32) {
+        return Type::Int32;
+    }
+    if (a == Type::Int64 || b == Type::Int64) {
+        return Type::Int64;
+    }
+    return op == BytecodeOp::Rem ? Type::Unknown : Type::Float64;
+}
+
+using FrameState = VerifiedFrameState;
+
+class VerificationError : public std::exception {
+public:
+    explicit VerificationError(std::string message) : _message(std::move(message)) {}
+    const char* what() const noexcept override { return _message.c_str(); }
+
+private:
+    std::string _message;
+};
+
+class Analysis {
+public:
+    Analysis(const Method& method, const PreparedMethod& prepared, const std::vector<BytecodeInstruction>& code,
+             bool trustCallResults)
+        : _method(method), _prepared(prepared), _code(code), _trustCallResults(trustCallResults),
+          _states(code.size()), _queued(code.size(), false) {
+        for (const auto& parameter : method.GetParameters()) {
+            _declaredArguments.push_back(TypeOfDeclaration(parameter.second));
+        }
+        for (const auto& local : method.GetLocals()) {
+            _declaredLocals.push_back(TypeOfDeclaration(local.second));
+        }
+        _declaredReturn = TypeOfDeclaration(method.GetReturnType());
+        _returnsVoid = method.GetReturnType().IsPrimitive() && !method.GetReturnType().IsArray() &&
+                       method.GetReturnType().GetPrimitiveType() == PrimitiveType::Void;
+    }
+
+    void Run() {
+        if (_code.empty()) {
+            throw VerificationError("empty body");
+        }
+
+        FrameState entry;
+        entry.reached = true;
+        entry.locals.assign(_prepared.localCount, Type::Null);
+        entry.arguments = _declaredArguments;
+        Merge(0, entry, 0);
+
+        while (!_worklist.empty()) {
+            const size_t pc = _worklist.front();
+            _worklist.pop_front();
+            _queued[pc] = false;
+            Step(pc);
+        }
+    }
+
+    [[nodiscard]] std::vector<FrameState> TakeStates() { return std::move(_states); }
+
+    void Rewrite(PreparedMethod& prepared) const {
+        std::vector<BytecodeInstruction> verified = _code;
+        for (size_t pc = 0; pc < _code.size(); ++pc) {
+            const FrameState& state = _states[pc];
+            if (!state.reached || state.stack.size() < 2) {
+                continue;
+            }
+            const size_t depth = state.stack.size();
+            if (state.stack[depth - 1] != Type::Int32 || state.stack[depth - 2] != Type::Int32) {
+                continue;
+            }
+            verified[pc].op = TypedForm(_code[pc].op);
+        }
+        prepared.verifiedCode = std::move(verified);
+        prepared.maxStackDepth = _maxDepth;
+        prepared.argumentTypes = _declaredArguments;
+    }
+
+private:
+    static BytecodeOp TypedForm(BytecodeOp op) {
+        switch (op) {
+            case BytecodeOp::Add: return BytecodeOp::AddI32Unchecked;
+            case BytecodeOp::Sub: return BytecodeOp::SubI32Unchecked;
+            case BytecodeOp::Mul: return BytecodeOp::MulI32Unchecked;
+            case BytecodeOp::Ceq: return BytecodeOp::CeqI32Unchecked;
+            case BytecodeOp::Cne: return BytecodeOp::CneI32Unchecked;
+            case BytecodeOp::Clt: return BytecodeOp::CltI32Unchecked;
+            case BytecodeOp::Cle: return BytecodeOp::CleI32Unchecked;
+            case BytecodeOp::Cgt: return BytecodeOp::CgtI32Unchecked;
+            case BytecodeOp::Cge: return BytecodeOp::CgeI32Unchecked;
+            case BytecodeOp::Beq: return BytecodeOp::BeqI32Unchecked;
+            case BytecodeOp::Bne: return BytecodeOp::BneI32Unchecked;
+            case BytecodeOp::Bgt: return BytecodeOp::BgtI32Unchecked;
+            case BytecodeOp::Blt: return BytecodeOp::BltI32Unchecked;
+            case BytecodeOp::Bge: return BytecodeOp::BgeI32Unchecked;
+            case BytecodeOp::Ble: return BytecodeOp::BleI32Unchecked;
+            default: return op;
+        }
+    }
+
+    [[noreturn]] void Fail(size_t pc, const std::string& message) const {
+        throw VerificationError(message + " (ip=" + std::to_string(_prepared.sourceIps[pc]) + ")");
+    }
+
+    void Merge(size_t target, const FrameState& incoming, size_t from) {
+        if (target >= _code.size()) {
+            Fail(from, "branch target " + std::to_string(target) + " is outside the method body");
+        }
+
+        FrameState& state = _states[target];
+        if (!state.reached) {
+            state = incoming;
+            Enqueue(target);
+            return;
+        }
+
+        if (state.stack.size() != incoming.stack.size()) {
+            Fail(from, "stack depth mismatch at merge point (" + std::to_string(state.stack.size()) +
+                 " vs " + std::to_string(incoming.stack.size()) + ")");
+        }
+
+        bool changed = false;
+        auto joinInto = [&changed](std::vector<Type>& into, const std::vector<Type>& other) {
+            for (size_t i = 0; i < into.size(); ++i) {
+                const Type joined = Join(into[i], other[i]);
+                if (joined != into[i]) {
+                    into[i] = joined;
+                    changed = true;
+                }
+            }
+        };
+        joinInto(state.stack, incoming.stack);
+        joinInto(state.locals, incoming.locals);
+        joinInto(state.arguments, incoming.arguments);
+        if (changed) {
+            Enqueue(target);
+        }
+    }
+
+    void Enqueue(size_t pc) {
+        if (!_queued[pc]) {
+            _queued[pc] = true;
+            _worklist.push_back(pc);
+        }
+    }
+
+    Type Pop(FrameState& state, size_t pc) const {
+        if (state.stack.empty()) {
+            Fail(pc, "stack underflow");
+        }
+        const Type type = state.stack.back();
+        state.stack.pop_back();
+        return type;
+    }
+
+    void Push(FrameState& state, Type type) {
+        state.stack.push_back(type);
+        _maxDepth = std::max(_maxDepth, state.stack.size());
+    }
+
+    void CheckSlot(size_t pc, int32_t slot, size_t count, const char* kind) const {
+        if (slot < 0 || static_cast<size_t>(slot) >= count) {
+            Fail(pc, std::string(kind) + " slot " + std::to_string(slot) + " is out of range");
+        }
+    }
+
+    void CheckStore(size_t pc, Type declared, Type actual, const std::string& what) const {
+        if (Conflicts(declared, actual)) {
+            Fail(pc, std::string("cannot store ") + TypeName(actual) + " into " + what +
+                 " declared " + TypeName(declared));
+        }
+    }
+
+    // An exception raised at `pc` enters the handlers whose protected range
+    // holds it with the locals and arguments of the instruction, and only
+    // the thrown value (catch) or nothing (finally) on the stack.
+    void MergeHandlers(size_t pc, const FrameState& state) {
+        for (const auto& handler : _prepared.handlers) {
+            if (pc < handler.tryStart || pc >= handler.tryEnd) {
+                continue;
+            }
+            FrameState entry = state;
+            entry.stack.clear();
+            if (handler.kind == ExceptionHandlerKind::Catch) {
+                Push(entry, Type::Unknown);
+            }
+            Merge(handler.handlerStart, entry, pc);
+        }
+    }
+
+    // Where control goes from an EndFinally at `pc`: on to the next finally
+    // handler or the target of each Leave whose way out runs the innermost
+    // finally handler holding `pc`. Exceptions are rethrown from there, which
+    // MergeHandlers already accounts for.
+    void MergeEndFinally(size_t pc, const FrameState& state) {
+        const auto& handlers = _prepared.handlers;
+        size_t owner = handlers.size();
+        for (size_t i = 0; i < handlers.size(); ++i) {
+            if (handlers[i].kind == ExceptionHandlerKind::Finally && handlers[i].handlerStart <= pc &&
+                pc < handlers[i].handlerEnd) {
+                owner = i;
+                break;
+            }
+        }
+        FrameState exit = state;
+        exit.stack.clear();
+        for (const auto& site : _prepared.leaveSites) {
+            const auto& chain = site.finallyHandlers;
+            for (size_t i = 0; i < chain.size(); ++i) {
+                if (chain[i] != owner) {
+                    continue;
+                }
+                if (i + 1 < chain.size()) {
+                    Merge(handlers[chain[i + 1]].handlerStart, exit, pc);
+                } else {
+                    Merge(site.target, ExitState(site, exit), pc);
+                }
+            }
+        }
+    }
+
+    // State at the target of `site` once its finally handlers ran: a ret
+    // lowered to the Leave gets its value back, of a type not tracked here.
+    static FrameState ExitState(const LeaveSite& site, FrameState state) {
+        state.stack.clear();
+        if (site.returns) {
+            state.stack.push_back(Type::Unknown);
+        }
+        return state;
+    }
+
+    void CheckReturn(size_t pc, const FrameState& state) {
+        if (!state.stack.empty() && !_returnsVoid && Conflicts(_declaredReturn, state.stack.back())) {
+            Fail(pc, std::string("cannot return ") + TypeName(state.stack.back()) +
+                 " from a method declared " + TypeName(_declaredReturn));
+        }
+    }
+
+    void Step(size_t pc) {
+        const BytecodeInstruction& instr = _code[pc];
+        FrameState state = _states[pc];
+        if (!_prepared.handlers.empty()) {
+            MergeHandlers(pc, state);
+        }
+
+        switch (instr.op) {
+            case BytecodeOp::Nop:
+                break;
+            case BytecodeOp::Dup: {
+                const Type top = Pop(state, pc);
+                Push(state, top);
+                Push(state, top);
+                break;
+            }
+            case BytecodeOp::Pop:
+                Pop(state, pc);
+                break;
+            case BytecodeOp::LdArg:
+                CheckSlot(pc, instr.a, state.arguments.size(), "argument");
+                Push(state, state.arguments[instr.a]);
+                break;
+            case BytecodeOp::StArg: {
+                CheckSlot(pc, instr.a, state.arguments.size(), "argument");
+                const Type value = Pop(state, pc);
+                CheckStore(pc, _declaredArguments[instr.a], value,
+                           "parameter '" + _method.GetParameters()[instr.a].first + "'");
+                state.arguments[instr.a] = value;
+                break;
+            }
+            case BytecodeOp::LdThis:
+                Push(state, Type::Unknown);
+                break;
+            case BytecodeOp::LdLoc:
+                CheckSlot(pc, instr.a, state.locals.size(), "local");
+                Push(state, state.locals[instr.a]);
+                break;
+            case BytecodeOp::StLoc: {
+                CheckSlot(pc, instr.a, state.locals.size(), "local");
+                const Type value = Pop(state, pc);
+                // Slots past the declared locals are BytecodeInliner scratch.
+                if (static_cast<size_t>(instr.a) < _declaredLocals.size()) {
+                    CheckStore(pc, _declaredLocals[instr.a], value,
+                               "local '" + _method.GetLocals()[instr.a].first + "'");
+                }
+                state.locals[instr.a] = value;
+                break;
+            }
+            case BytecodeOp::LdFld:
+                // The instance operand is optional: with an empty stack the
+                // field is read from 'this'.
+                if (!state.stack.empty()) {
+                    Pop(state, pc);
+                }
+                Push(state, Type::Unknown);
+                break;
+            case BytecodeOp::StFld:
+                Pop(state, pc);
+                if (!state.stack.empty()) {
+                    Pop(state, pc);
+                }
+                break;
+            case BytecodeOp::LdConst:
+                Push(state, TypeOfValue(_prepared.constants[instr.a]));
+                break;
+            case BytecodeOp::LdNull:
+                Push(state, Type::Null);
+                break;
+            case BytecodeOp::Add:
+            case BytecodeOp::Sub:
+            case BytecodeOp::Mul:
+            case BytecodeOp::Div:
+            case BytecodeOp::Rem: {
+                const Type right = Pop(state, pc);
+                const Type left = Pop(state, pc);
+                Push(state, ArithmeticResult(instr.op, left, right));
+                break;
+            }
+            case BytecodeOp::Neg: {
+                // Neg pushes nothing for non-numeric operands, so the stack
+                // depth after it is only known for numeric ones.
+                const Type operand = Pop(state, pc);
+                if (!IsNumeric(operand)) {
+                    Fail(pc, "neg operand is not known to be numeric");
+                }
+                Push(state, operand);
+                break;
+            }
+            case BytecodeOp::Ceq:
+            case BytecodeOp::Cne:
+            case BytecodeOp::Clt:
+            case BytecodeOp::Cle:
+            case BytecodeOp::Cgt:
+            case BytecodeOp::Cge:
+                Pop(state, pc);
+                Pop(state, pc);
+                Push(state, Type::Bool);
+                break;
+            case BytecodeOp::Ret:
+                CheckReturn(pc, state);
+                return;
+            case BytecodeOp::Br:
+                Merge(static_cast<size_t>(instr.a), state, pc);
+                return;
+            case BytecodeOp::BrTrue:
+            case BytecodeOp::BrFalse:
+                Pop(state, pc);
+                Merge(static_cast<size_t>(instr.a), state, pc);
+                break;
+            case BytecodeOp::Beq:
+            case BytecodeOp::Bne:
+            case BytecodeOp::Bgt:
+            case BytecodeOp::Blt:
+            case BytecodeOp::Bge:
+            case BytecodeOp::Ble:
+                Pop(state, pc);
+                Pop(state, pc);
+                Merge(static_cast<size_t>(instr.a), state, pc);
+                break;
+            case BytecodeOp::NewObj:
+                Push(state, Type::Object);
+                break;
+            case BytecodeOp::NewArr:
+                Pop(state, pc);
+                Push(state, Type::Object);
+                break;
+            case BytecodeOp::LdLen:
+                Pop(state, pc);
+                Push(state, Type::Int32);
+                break;
+            case BytecodeOp::LdElem:
+                Pop(state, pc);
+                Pop(state, pc);
+                Push(state, Type::Unknown);
+                break;
+            case BytecodeOp::StElem:
+                Pop(state, pc);
+                Pop(state, pc);
+                Pop(state, pc);
+                break;
+            case BytecodeOp::CastClass: {
+                const Type value = Pop(state, pc);
+                Push(state, value);
+                break;
+            }
+            case BytecodeOp::IsInst:
+                Pop(state, pc);
+                Push(state, Type::Unknown);
+                break;
+            case BytecodeOp::Call:
+            case BytecodeOp::CallVirt: {
+                const CallSite& site = _prepared.callSites[instr.a];
+                for (size_t i = 0; i < site.argumentCount; ++i) {
+                    Pop(state, pc);
+                }
+                if (site.isConsoleWriteLine) {
+                    break;
+                }
+                if (instr.op == BytecodeOp::CallVirt) {
+                    Pop(state, pc);
+                }
+                if (!site.isVoidReturn) {
+                    Push(state, _trustCallResults ? TypeOfTypeName(site.target.returnType) : Type::Unknown);
+                }
+                break;
+            }
+            case BytecodeOp::InlineGuard:
+                // Enters the inlined body, or jumps to the original call.
+                Merge(static_cast<size_t>(instr.a), state, pc);
+                break;
+            case BytecodeOp::Throw:
+                Pop(state, pc);
+                return;
+            case BytecodeOp::Leave: {
+                const LeaveSite& site = _prepared.leaveSites[instr.a];
+                if (site.returns) {
+                    CheckReturn(pc, state);
+                }
+                state.stack.clear();
+                if (site.finallyHandlers.empty()) {
+                    Merge(site.target, ExitState(site, state), pc);
+                } else {
+                    Merge(_prepared.handlers[site.finallyHandlers[0]].handlerStart, state, pc);
+                }
+                return;
+            }
+            case BytecodeOp::EndFinally:
+                MergeEndFinally(pc, state);
+                return;
+            case BytecodeOp::Fail:
+                Fail(pc, _prepared.messages[instr.a]);
+            default:
+                Fail(pc, "unexpected opcode " + std::to_string(static_cast<int>(instr.op)));
+        }
+
+        Merge(pc + 1, state, pc);
+    }
+
+    const Method& _method;
+    const PreparedMethod& _prepared;
+    const std::vector<BytecodeInstruction>& _code;
+    bool _trustCallResults;
+    std::vector<FrameState> _states;
+    std::vector<bool> _queued;
+    std::deque<size_t> _worklist;
+    std::vector<Type> _declaredArguments;
+    std::vector<Type> _declaredLocals;
+    Type _declaredReturn = Type::Unknown;
+    bool _returnsVoid = false;
+    size_t _maxDepth = 0;
+};
+
+} // namespace
+
+void BytecodeVerifier::Verify(const Method& method, PreparedMethod& prepared) {
+    prepared.verified = false;
+    prepared.verificationError.clear();
+    prepared.verifiedCode.clear();
+
+    try {
+        Analysis analysis(method, prepared, prepared.code, false);
+        analysis.Run();
+        analysis.Rewrite(prepared);
+        prepared.verified = true;
+    } catch (const VerificationError& error) {
+        prepared.verificationError = error.what();
+    }
+}
+
+bool BytecodeVerifier::InferFrameStates(
+    const Method& method,
+    const PreparedMethod& prepared,
+    const std::vector<BytecodeInstruction>& code,
+    bool trustCallResults,
+    std::vector<VerifiedFrameState>& states,
+    std::string& error
+) {
+    try {
+        Analysis analysis(method, prepared, code, trustCallResults);
+        analysis.Run();
+        states = analysis.TakeStates();
+        return true;
+    } catch (const VerificationError& ex) {
+        error = ex.what();
+        return false;
+    }
+}
+
+} // namespace ObjectIR
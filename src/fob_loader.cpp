@@ -45,6 +45,7 @@ FOBLoader::FOBLoadResult FOBLoader::LoadFromData(const std::vector<uint8_t>& dat
     std::vector<FOBTypeDefinition> types;
     std::vector<FOBInstruction> instructions;
     std::vector<FOBConstant> constants;
+    const SectionHeader* exceptions = nullptr;
 
     for (const auto& section : sections) {
         // Clear any error bits before seeking
@@ -59,10 +60,18 @@ FOBLoader::FOBLoadResult FOBLoader::LoadFromData(const std::vector<uint8_t>& dat
             instructions = ParseCodeSection(stream, section);
         } else if (section.name == ".constants") {
             constants = ParseConstantsSection(stream, section);
+        } else if (section.name == ".exceptions") {
+            exceptions = &section; // refers to methods of .types
         }
         // Skip unknown sections
     }
 
+    if (exceptions) {
+        stream.clear();
+        stream.seekg(exceptions->startAddr, std::ios::beg);
+        ParseExceptionsSection(stream, *exceptions, types);
+    }
+
     // Build virtual machine from parsed data
     return BuildVirtualMachine(header, strings, types, instructions, constants);
 }
@@ -314,6 +323,33 @@ std::vector<FOBLoader::FOBConstant> FOBLoader::ParseConstantsSection(std::istrea
     return constants;
 }
 
+void FOBLoader::ParseExceptionsSection(std::istream &stream, const SectionHeader &section, std::vector<FOBTypeDefinition> &types) {
+    // Read entry count
+    uint32_t entryCount = ReadU32(stream);
+
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        uint32_t typeIndex = ReadU32(stream);
+        uint32_t methodIndex = ReadU32(stream);
+        if (typeIndex >= types.size() || methodIndex >= types[typeIndex].methods.size()) {
+            throw std::runtime_error("Exception handler table for unknown method " +
+                                     std::to_string(typeIndex) + "." + std::to_string(methodIndex));
+        }
+        auto& method = types[typeIndex].methods[methodIndex];
+
+        uint32_t handlerCount = ReadU32(stream);
+        method.exceptionHandlers.resize(handlerCount);
+        for (uint32_t j = 0; j < handlerCount; ++j) {
+            auto& handler = method.exceptionHandlers[j];
+            handler.kind = ReadU8(stream);
+            handler.tryStart = ReadU32(stream);
+            handler.tryEnd = ReadU32(stream);
+            handler.handlerStart = ReadU32(stream);
+            handler.handlerEnd = ReadU32(stream);
+            handler.catchTypeIndex = ReadU32(stream);
+        }
+    }
+}
+
 // ============================================================================
 // Helper Methods
 // ============================================================================
@@ -374,6 +410,30 @@ FOBLoader::FOBLoadResult FOBLoader::BuildVirtualMachine(
         methodNames.push_back(result.methodNames);
     }
 
+    // Base types and interfaces are .types indices and may point forward,
+    // so they are linked once every type is built.
+    std::vector<ClassRef> classes;
+    classes.reserve(classNames.size());
+    for (const auto& className : classNames) {
+        classes.push_back(vm->GetClass(className));
+    }
+    for (size_t i = 0; i < types.size(); ++i) {
+        const auto& typeDef = types[i];
+        if (typeDef.baseTypeIndex < classes.size()) {
+            const ClassRef& base = classes[typeDef.baseTypeIndex];
+            if (base->IsInterface()) {
+                classes[i]->AddInterface(base);
+            } else {
+                classes[i]->SetBaseClass(base);
+            }
+        }
+        for (uint32_t interfaceIndex : typeDef.interfaceIndices) {
+            if (interfaceIndex < classes.size()) {
+                classes[i]->AddInterface(classes[interfaceIndex]);
+            }
+        }
+    }
+
     // Extract entry point indices from header
     // Entry point is encoded as (type_index << 16) | method_index
     uint32_t entryPoint = header.entryPoint;
@@ -421,6 +481,9 @@ FOBLoader::BuildTypeResult FOBLoader::BuildType(
     // Create class
     auto classRef = std::make_shared<Class>(typeName);
     classRef->SetNamespace(namespaceName);
+    classRef->SetInterface(typeDef.kind == 0x02);
+    classRef->SetAbstract(typeDef.kind == 0x02 || (typeDef.flags & 0x01) != 0);
+    classRef->SetSealed((typeDef.flags & 0x02) != 0);
     
     // Register with VM
     vm->RegisterClass(classRef);
@@ -455,7 +518,9 @@ MethodRef FOBLoader::BuildMethod(
     auto returnType = ParseTypeReference(nullptr, methodDef.returnTypeIndex, strings); // TODO: Pass VM
     
     // Create method
-    MethodRef methodRef = std::make_shared<Method>(methodName, returnType);
+    // Method flags: 0x01 = Static, 0x02 = Virtual
+    MethodRef methodRef = std::make_shared<Method>(
+        methodName, returnType, (methodDef.flags & 0x01) != 0, (methodDef.flags & 0x02) != 0);
     
     // Add to class
     classRef->AddMethod(methodRef);
@@ -475,6 +540,39 @@ MethodRef FOBLoader::BuildMethod(
     }
     
     // TODO: Add instructions
+
+    // Exception handlers
+    if (!methodDef.exceptionHandlers.empty()) {
+        std::vector<ExceptionHandler> handlers;
+        handlers.reserve(methodDef.exceptionHandlers.size());
+        for (const auto& handlerDef : methodDef.exceptionHandlers) {
+            ExceptionHandler handler;
+            if (handlerDef.kind == 0x01) {
+                handler.kind = ExceptionHandlerKind::Catch;
+                if (handlerDef.catchTypeIndex != 0xFFFFFFFFu) {
+                    if (handlerDef.catchTypeIndex >= strings.size()) {
+                        throw std::runtime_error("Invalid catch type index in method " + methodName);
+                    }
+                    handler.catchType = strings[handlerDef.catchTypeIndex];
+                }
+            } else if (handlerDef.kind == 0x02) {
+                handler.kind = ExceptionHandlerKind::Finally;
+            } else {
+                throw std::runtime_error("Unknown exception handler kind in method " + methodName);
+            }
+            handler.tryStart = handlerDef.tryStart;
+            handler.tryEnd = handlerDef.tryEnd;
+            handler.handlerStart = handlerDef.handlerStart;
+            handler.handlerEnd = handlerDef.handlerEnd;
+            if (handler.tryStart >= handler.tryEnd || handler.handlerStart >= handler.handlerEnd ||
+                handler.tryEnd > methodDef.instructionOffsets.size() ||
+                handler.handlerEnd > methodDef.instructionOffsets.size()) {
+                throw std::runtime_error("Invalid exception handler range in method " + methodName);
+            }
+            handlers.push_back(std::move(handler));
+        }
+        methodRef->SetExceptionHandlers(std::move(handlers));
+    }
     
     return methodRef;
 }
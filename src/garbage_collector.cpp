@@ -0,0 +1,549 @@
+#include "objectir_runtime.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ObjectIR {
+
+namespace {
+
+// Smallest heap size a collection is triggered at.
+constexpr size_t kMinimumTrigger = 4u << 20;
+// Young generation size that triggers a minor collection by default.
+constexpr size_t kDefaultYoungTrigger = 1u << 20;
+
+struct TrackedObject {
+    std::weak_ptr<Object> object;
+    size_t bytes;
+};
+
+using ScannerList = std::vector<std::pair<size_t, GarbageCollector::RootScanner>>;
+
+struct CollectorState {
+    std::mutex mutex;
+    // The old generation, then the objects tracked since the last collection.
+    std::vector<TrackedObject> objects;
+    size_t oldObjects = 0;
+    size_t trackedBytes = 0;
+    size_t youngBytes = 0;
+    size_t nextCollection = kMinimumTrigger;
+    ScannerList scanners;
+    size_t nextScannerId = 1;
+    GarbageCollector::Statistics statistics;
+};
+
+// Entries a region holds before it first drops the dead ones; after that it
+// compacts whenever its entries double.
+constexpr size_t kRegionCompaction = 64;
+
+std::atomic<bool> g_collectorEnabled{false};
+std::atomic<size_t> g_heapLimit{0};
+std::atomic<size_t> g_youngTrigger{kDefaultYoungTrigger};
+// Set from the start of a collection until its garbage is released.
+std::atomic<bool> g_collecting{false};
+// Regions open on any thread; allocation skips the region lookup while 0.
+std::atomic<size_t> g_openRegions{0};
+// Threads inside a MutatorScope. It only changes under the state's lock,
+// except when a thread leaves its outermost scope.
+std::atomic<size_t> g_mutators{0};
+thread_local size_t t_mutatorDepth = 0;
+
+CollectorState& State() {
+    // Never destroyed: VMs with static storage duration unregister their
+    // root scanners during exit.
+    static auto* state = new CollectorState();
+    return *state;
+}
+
+// True when no thread but the calling one may touch objects while a
+// collection traces them. Expects the lock held.
+bool OnlyMutator() {
+    return g_mutators.load(std::memory_order_acquire) <= (t_mutatorDepth != 0 ? 1u : 0u);
+}
+
+size_t NextTrigger(size_t liveBytes) {
+    size_t trigger = std::max(kMinimumTrigger, liveBytes * 2);
+    const size_t limit = g_heapLimit.load(std::memory_order_relaxed);
+    return limit != 0 ? std::min(trigger, limit) : trigger;
+}
+
+// Index of each tracked object that is still alive.
+using ObjectIndex = std::unordered_map<const Object*, size_t>;
+
+// Counts the references into the tracked heap, by kind, and optionally
+// records their targets.
+class ReferenceCounter : public ReferenceVisitor {
+public:
+    ReferenceCounter(const ObjectIndex& index, std::vector<uint32_t>& values,
+                     std::vector<uint32_t>& objects, std::vector<size_t>* targets)
+        : _index(index), _values(values), _objects(objects), _targets(targets) {}
+
+    void VisitValue(const Value& value) override {
+        if (value.IsObject()) {
+            Count(value.UncheckedObject(), _values);
+        }
+    }
+
+    void VisitObject(const Object* object) override { Count(object, _objects); }
+
+private:
+    void Count(const Object* object, std::vector<uint32_t>& counts) {
+        auto it = _index.find(object);
+        if (it == _index.end()) {
+            return;
+        }
+        ++counts[it->second];
+        if (_targets) {
+            _targets->push_back(it->second);
+        }
+    }
+
+    const ObjectIndex& _index;
+    std::vector<uint32_t>& _values;
+    std::vector<uint32_t>& _objects;
+    std::vector<size_t>* _targets;
+};
+
+// Marks the tracked objects a reference leads to, queueing the new ones.
+class Marker : public ReferenceVisitor {
+public:
+    Marker(const ObjectIndex& index, std::vector<char>& marked, std::vector<size_t>& worklist)
+        : _index(index), _marked(marked), _worklist(worklist) {}
+
+    void VisitValue(const Value& value) override {
+        if (value.IsObject()) {
+            Mark(value.UncheckedObject());
+        }
+    }
+
+    void VisitObject(const Object* object) override { Mark(object); }
+
+    void Mark(size_t index) {
+        if (!_marked[index]) {
+            _marked[index] = 1;
+            _worklist.push_back(index);
+        }
+    }
+
+private:
+    void Mark(const Object* object) {
+        auto it = _index.find(object);
+        if (it != _index.end()) {
+            Mark(it->second);
+        }
+    }
+
+    const ObjectIndex& _index;
+    std::vector<char>& _marked;
+    std::vector<size_t>& _worklist;
+};
+
+struct TraceResult {
+    std::vector<ObjectRef> garbage;
+    std::vector<TrackedObject> survivors;
+    size_t liveBytes = 0;
+    size_t garbageBytes = 0;
+    size_t pinned = 0;
+};
+
+// Mark the live objects among `objects[first..]` from the roots `scanners`
+// report and from every object referenced from somewhere the trace cannot
+// see; split them into survivors and garbage. Objects outside the range go
+// uncounted, so their references pin their targets too.
+TraceResult Trace(const std::vector<TrackedObject>& objects, size_t first, const ScannerList* scanners) {
+    const size_t candidates = objects.size() - first;
+    std::vector<ObjectRef> live;
+    std::vector<size_t> bytes;
+    live.reserve(candidates);
+    bytes.reserve(candidates);
+    ObjectIndex index;
+    index.reserve(candidates);
+    for (size_t i = first; i < objects.size(); ++i) {
+        const auto& tracked = objects[i];
+        if (ObjectRef object = tracked.object.lock()) {
+            index.emplace(object.get(), live.size());
+            live.push_back(std::move(object));
+            bytes.push_back(tracked.bytes);
+        }
+    }
+
+    // References from inside the traced heap and from the root scanners.
+    // Whatever a count leaves unexplained comes from places the collector
+    // cannot see, which pins the object.
+    const size_t count = live.size();
+    std::vector<uint32_t> valueReferences(count, 0);
+    std::vector<uint32_t> objectReferences(count, 0);
+    ReferenceCounter heapCounter(index, valueReferences, objectReferences, nullptr);
+    for (const auto& object : live) {
+        object->VisitReferences(heapCounter);
+    }
+    std::vector<size_t> roots;
+    if (scanners) {
+        ReferenceCounter rootCounter(index, valueReferences, objectReferences, &roots);
+        for (const auto& scanner : *scanners) {
+            scanner.second(rootCounter);
+        }
+    }
+
+    TraceResult result;
+    std::vector<char> marked(count, 0);
+    std::vector<size_t> worklist;
+    Marker marker(index, marked, worklist);
+    for (size_t root : roots) {
+        marker.Mark(root);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const Object& object = *live[i];
+        // Strong references, less the one held by `live` and the anchor
+        // standing for the object's Values.
+        const long objectCount = live[i].use_count() - 1 - (object.GetValueAnchor() ? 1 : 0);
+        if (object.GetValueReferenceCount() > valueReferences[i] ||
+            objectCount > static_cast<long>(objectReferences[i])) {
+            if (!marked[i]) {
+                ++result.pinned;
+            }
+            marker.Mark(i);
+        }
+    }
+    while (!worklist.empty()) {
+        const size_t next = worklist.back();
+        worklist.pop_back();
+        live[next]->VisitReferences(marker);
+    }
+
+    result.survivors.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (marked[i]) {
+            result.survivors.push_back({live[i], bytes[i]});
+            result.liveBytes += bytes[i];
+        } else {
+            result.garbage.push_back(live[i]);
+            result.garbageBytes += bytes[i];
+        }
+    }
+    return result;
+}
+
+// Trace the tracked heap and return the objects left unmarked, holding them
+// so they can be cleared outside the lock. A minor collection looks at the
+// young generation only: references from old objects go uncounted, so they
+// pin their targets like any other reference from outside, and old objects
+// need no write barrier. Survivors join the old generation. Expects the lock
+// held and g_collecting set.
+std::vector<ObjectRef> FindGarbage(CollectorState& state, bool minor) {
+    const size_t first = minor ? state.oldObjects : 0;
+    TraceResult result = Trace(state.objects, first, &state.scanners);
+    state.objects.resize(first);
+    state.objects.insert(state.objects.end(), std::make_move_iterator(result.survivors.begin()),
+                         std::make_move_iterator(result.survivors.end()));
+    state.oldObjects = state.objects.size();
+    if (minor) {
+        // The young objects that died since are gone from the count too.
+        state.trackedBytes -= std::min(state.trackedBytes, state.youngBytes);
+        state.trackedBytes += result.liveBytes;
+    } else {
+        state.trackedBytes = result.liveBytes;
+        state.nextCollection = NextTrigger(result.liveBytes);
+    }
+    state.youngBytes = 0;
+
+    auto& statistics = state.statistics;
+    ++statistics.collections;
+    if (minor) {
+        ++statistics.minorCollections;
+    }
+    statistics.objectsFreed += result.garbage.size();
+    statistics.bytesFreed += result.garbageBytes;
+    statistics.pinnedObjects = result.pinned;
+    return std::move(result.garbage);
+}
+
+// Break the references among `garbage`, which frees it once the last
+// reference held here is dropped, and end the collection.
+size_t ReleaseGarbage(std::vector<ObjectRef>& garbage) {
+    for (const auto& object : garbage) {
+        object->ClearReferences();
+    }
+    const size_t count = garbage.size();
+    garbage.clear();
+    g_collecting.store(false, std::memory_order_release);
+    return count;
+}
+
+size_t ParseByteCount(const std::string& entry, const std::string& value) {
+    size_t digits = 0;
+    while (digits < value.size() && std::isdigit(static_cast<unsigned char>(value[digits]))) {
+        ++digits;
+    }
+    const std::string suffix = value.substr(digits);
+    size_t scale = 1;
+    if (suffix == "k" || suffix == "K") {
+        scale = size_t(1) << 10;
+    } else if (suffix == "m" || suffix == "M") {
+        scale = size_t(1) << 20;
+    } else if (suffix == "g" || suffix == "G") {
+        scale = size_t(1) << 30;
+    } else if (!suffix.empty()) {
+        digits = 0;
+    }
+    if (digits == 0 || digits > 12) {
+        throw std::runtime_error("Invalid heap size: " + entry);
+    }
+    return static_cast<size_t>(std::stoull(value.substr(0, digits))) * scale;
+}
+
+} // namespace
+
+void GarbageCollector::SetEnabled(bool enabled) {
+    g_collectorEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool GarbageCollector::IsEnabled() {
+    return g_collectorEnabled.load(std::memory_order_relaxed);
+}
+
+void GarbageCollector::SetHeapLimit(size_t bytes) {
+    auto& state = State();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    g_heapLimit.store(bytes, std::memory_order_relaxed);
+    state.nextCollection = NextTrigger(state.trackedBytes);
+}
+
+size_t GarbageCollector::GetHeapLimit() {
+    return g_heapLimit.load(std::memory_order_relaxed);
+}
+
+void GarbageCollector::SetYoungGenerationSize(size_t bytes) {
+    g_youngTrigger.store(bytes, std::memory_order_relaxed);
+}
+
+size_t GarbageCollector::GetYoungGenerationSize() {
+    return g_youngTrigger.load(std::memory_order_relaxed);
+}
+
+void GarbageCollector::Track(const ObjectRef& object, size_t bytes) {
+    if (g_openRegions.load(std::memory_order_relaxed) != 0 && object) {
+        AllocationRegion::Record(object, bytes);
+    }
+    if (!g_collectorEnabled.load(std::memory_order_relaxed) || !object) {
+        return;
+    }
+    auto& state = State();
+    std::vector<ObjectRef> garbage;
+    size_t trackedBytes;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.objects.push_back({object, bytes});
+        state.trackedBytes += bytes;
+        state.youngBytes += bytes;
+        const size_t youngTrigger = g_youngTrigger.load(std::memory_order_relaxed);
+        const bool major = state.trackedBytes >= state.nextCollection;
+        if ((!major && (youngTrigger == 0 || state.youngBytes < youngTrigger)) || !OnlyMutator() ||
+            g_collecting.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        // `object` is held by its creator, so the collection keeps it.
+        garbage = FindGarbage(state, !major);
+        // The limit is only enforced once the whole heap has been looked at.
+        if (!major && state.trackedBytes >= state.nextCollection) {
+            std::vector<ObjectRef> older = FindGarbage(state, false);
+            garbage.insert(garbage.end(), std::make_move_iterator(older.begin()),
+                           std::make_move_iterator(older.end()));
+        }
+        trackedBytes = state.trackedBytes;
+    }
+    ReleaseGarbage(garbage);
+
+    const size_t limit = g_heapLimit.load(std::memory_order_relaxed);
+    if (limit != 0 && trackedBytes > limit) {
+        throw std::runtime_error("Heap limit of " + std::to_string(limit) + " bytes exceeded (" +
+                                 std::to_string(trackedBytes) + " bytes live)");
+    }
+}
+
+size_t GarbageCollector::Collect() {
+    auto& state = State();
+    std::vector<ObjectRef> garbage;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!OnlyMutator() || g_collecting.exchange(true, std::memory_order_acq_rel)) {
+            return 0;
+        }
+        garbage = FindGarbage(state, false);
+    }
+    return ReleaseGarbage(garbage);
+}
+
+size_t GarbageCollector::AddRootScanner(RootScanner scanner) {
+    auto& state = State();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    const size_t id = state.nextScannerId++;
+    state.scanners.emplace_back(id, std::move(scanner));
+    return id;
+}
+
+void GarbageCollector::RemoveRootScanner(size_t id) {
+    auto& state = State();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto& scanners = state.scanners;
+    scanners.erase(std::remove_if(scanners.begin(), scanners.end(),
+                                  [id](const auto& scanner) { return scanner.first == id; }),
+                   scanners.end());
+}
+
+GarbageCollector::MutatorScope::MutatorScope() {
+    if (t_mutatorDepth++ != 0) {
+        return;
+    }
+    // Under the lock, so a collection that found this thread outside its
+    // scope finishes tracing first.
+    auto& state = State();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    g_mutators.fetch_add(1, std::memory_order_acq_rel);
+}
+
+GarbageCollector::MutatorScope::~MutatorScope() {
+    if (--t_mutatorDepth == 0) {
+        g_mutators.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+GarbageCollector::Statistics GarbageCollector::GetStatistics() {
+    auto& state = State();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    Statistics statistics = state.statistics;
+    statistics.trackedObjects = state.objects.size();
+    statistics.trackedBytes = state.trackedBytes;
+    return statistics;
+}
+
+struct AllocationRegion::Impl {
+    std::vector<TrackedObject> objects;
+    size_t created = 0;
+    size_t compactAt = kRegionCompaction;
+    Impl* parent = nullptr;
+
+    void Add(TrackedObject tracked) {
+        objects.push_back(std::move(tracked));
+        if (objects.size() < compactAt) {
+            return;
+        }
+        // Dropping the dead entries lets their memory go back to the nursery.
+        objects.erase(std::remove_if(objects.begin(), objects.end(),
+                                     [](const TrackedObject& entry) { return entry.object.expired(); }),
+                      objects.end());
+        compactAt = std::max(kRegionCompaction, objects.size() * 2);
+    }
+};
+
+AllocationRegion::Impl*& AllocationRegion::Current() {
+    static thread_local Impl* current = nullptr;
+    return current;
+}
+
+AllocationRegion::AllocationRegion() : _impl(std::make_unique<Impl>()) {
+    Impl*& current = Current();
+    _impl->parent = current;
+    current = _impl.get();
+    g_openRegions.fetch_add(1, std::memory_order_relaxed);
+}
+
+AllocationRegion::~AllocationRegion() {
+    if (!_impl) {
+        return;
+    }
+    try {
+        Close();
+    } catch (...) {
+        // Still linked into another thread's regions: leave it to them.
+        if (_impl) {
+            _impl.release();
+        }
+    }
+}
+
+void AllocationRegion::Record(const ObjectRef& object, size_t bytes) {
+    if (Impl* region = Current()) {
+        ++region->created;
+        region->Add({object, bytes});
+    }
+}
+
+AllocationRegion::Statistics AllocationRegion::Close() {
+    if (!_impl) {
+        throw std::runtime_error("Allocation region is already closed");
+    }
+    Impl*& current = Current();
+    if (current != _impl.get()) {
+        throw std::runtime_error("Allocation region is not the innermost region open on this thread");
+    }
+    current = _impl->parent;
+    g_openRegions.fetch_sub(1, std::memory_order_relaxed);
+    std::unique_ptr<Impl> region = std::move(_impl);
+
+    // No roots: everything outside the region counts as outside the trace,
+    // so whatever it references is pinned.
+    TraceResult result;
+    {
+        auto& state = State();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        result = Trace(region->objects, 0, nullptr);
+    }
+    Statistics statistics;
+    statistics.objects = region->created;
+    statistics.promoted = result.survivors.size();
+    statistics.cleared = result.garbage.size();
+    if (Impl* parent = region->parent) {
+        parent->created += result.survivors.size();
+        for (auto& survivor : result.survivors) {
+            parent->Add(std::move(survivor));
+        }
+    }
+    for (const auto& object : result.garbage) {
+        object->ClearReferences();
+    }
+    return statistics;
+}
+
+void GarbageCollector::Configure(const std::string& spec) {
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        std::string entry = spec.substr(start, end - start);
+        start = end + 1;
+
+        const size_t first = entry.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            continue;
+        }
+        entry = entry.substr(first, entry.find_last_not_of(" \t") - first + 1);
+
+        if (entry == "on" || entry == "off") {
+            SetEnabled(entry == "on");
+            continue;
+        }
+        const size_t equals = entry.find('=');
+        const std::string key = entry.substr(0, equals);
+        const std::string value = equals == std::string::npos ? std::string() : entry.substr(equals + 1);
+        if (key == "limit") {
+            SetHeapLimit(ParseByteCount(entry, value));
+        } else if (key == "young") {
+            SetYoungGenerationSize(ParseByteCount(entry, value));
+        } else {
+            throw std::runtime_error("Unknown garbage collector setting: " + entry);
+        }
+    }
+}
+
+} // namespace ObjectIR
@@ -1,10 +1,23 @@
 #include "instruction_executor.hpp"
+#include "bytecode.hpp"
+#include "jit_compiler.hpp"
 #include "objectir_type_names.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cctype>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <stdexcept>
+#include <type_traits>
+
+// Threaded dispatch needs the labels-as-values extension (GCC/Clang).
+#if defined(OBJECTIR_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+    #define OBJECTIR_COMPUTED_GOTO 1
+#else
+    #define OBJECTIR_COMPUTED_GOTO 0
+#endif
 
 namespace ObjectIR {
 
@@ -36,14 +49,6 @@ TypeReference ParseTypeReference(VirtualMachine* vm, const std::string& typeStr)
     return TypeReference::Object();
 }
 
-struct BreakSignal : public std::exception {
-    const char* what() const noexcept override { return "break"; }
-};
-
-struct ContinueSignal : public std::exception {
-    const char* what() const noexcept override { return "continue"; }
-};
-
 std::string ToLowerInvariant(std::string value) {
     std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
         return static_cast<char>(std::tolower(c));
@@ -58,56 +63,6 @@ bool EqualsIgnoreCase(const std::string& lhs, const std::string& rhs) {
     return ToLowerInvariant(lhs) == ToLowerInvariant(rhs);
 }
 
-Value CreateConstantValue(const Instruction& instr) {
-    if (instr.constantIsNull) {
-        return Value();
-    }
-
-    if (!instr.constantType.empty()) {
-        auto typeLower = ToLowerInvariant(instr.constantType);
-
-        if (typeLower == "system.string" || typeLower == "string") {
-            return Value(instr.constantRawValue);
-        }
-
-        if (typeLower == "system.boolean" || typeLower == "bool" || typeLower == "boolean") {
-            bool boolValue = instr.constantBool;
-            if (instr.constantRawValue.empty()) {
-                return Value(boolValue);
-            }
-            auto valueLower = ToLowerInvariant(instr.constantRawValue);
-            if (valueLower == "true" || valueLower == "1") {
-                boolValue = true;
-            } else if (valueLower == "false" || valueLower == "0") {
-                boolValue = false;
-            }
-            return Value(boolValue);
-        }
-
-        if (typeLower == "system.int32" || typeLower == "int32" || typeLower == "int") {
-            return Value(static_cast<int32_t>(std::stoi(instr.constantRawValue)));
-        }
-
-        if (typeLower == "system.int64" || typeLower == "int64" || typeLower == "long") {
-            return Value(static_cast<int64_t>(std::stoll(instr.constantRawValue)));
-        }
-
-        if (typeLower == "system.single" || typeLower == "single" || typeLower == "float" || typeLower == "float32") {
-            return Value(static_cast<float>(std::stof(instr.constantRawValue)));
-        }
-
-        if (typeLower == "system.double" || typeLower == "double" || typeLower == "float64") {
-            return Value(static_cast<double>(std::stod(instr.constantRawValue)));
-        }
-    }
-
-    if (instr.constantBool) {
-        return Value(instr.constantBool);
-    }
-
-    return Value(instr.constantRawValue);
-}
-
 std::string ValueToString(const Value& value) {
     if (value.IsNull()) {
         return "null";
@@ -136,6 +91,28 @@ std::string ValueToString(const Value& value) {
     return "";
 }
 
+void WriteConsoleLine(VirtualMachine* vm, const std::vector<Value>& callArgs) {
+    if (callArgs.empty()) {
+        vm->WriteOutput("\n");
+        return;
+    }
+    for (size_t i = 0; i < callArgs.size(); ++i) {
+        if (i > 0) {
+            vm->WriteOutput(" ");
+        }
+        // If the runtime is asked to print a null value, do not show the
+        // literal "null" string; instead emit an empty string so that
+        // Console.WriteLine(null) will behave like WriteLine("") in
+        // typical .NET loggers (printing an empty line).
+        if (callArgs[i].IsNull()) {
+            vm->WriteOutput("");
+        } else {
+            vm->WriteOutput(ValueToString(callArgs[i]));
+        }
+    }
+    vm->WriteOutput("\n");
+}
+
 Instruction::ConditionData ParseConditionNode(const json& node) {
     Instruction::ConditionData data;
 
@@ -190,8 +167,145 @@ std::vector<Instruction> ParseInstructionArray(const json& node) {
     return result;
 }
 
+std::string FormatVmError(
+    const std::string& methodName,
+    size_t ip,
+    const std::vector<Instruction>& source,
+    const std::string& message
+) {
+    const Instruction empty;
+    const Instruction& instr = ip < source.size() ? source[ip] : empty;
+    return "VM error in method '" + methodName + "' at ip=" + std::to_string(ip) +
+           " op=" + std::to_string(static_cast<int>(instr.opCode)) +
+           " id='" + instr.identifier + "' operand='" + instr.operandString + "': " + message;
+}
+
+std::string DescribeThrownValue(const Value& value) {
+    if (value.IsString()) {
+        return value.AsString();
+    }
+    if (value.IsObject() && value.AsObject() && value.AsObject()->GetClass()) {
+        return "Unhandled exception of type '" + value.AsObject()->GetClass()->GetName() + "'";
+    }
+    return "Unhandled exception: " + ValueToString(value);
+}
+
 } // namespace
 
+// ============================================================================
+// IRException
+// ============================================================================
+
+struct IRException::State {
+    struct Frame {
+        MethodRef method;
+        size_t ip;
+        std::shared_ptr<const std::vector<Instruction>> source;
+    };
+
+    Value value;
+    std::string message;
+    std::vector<Frame> frames; // innermost first
+    std::string formatted;     // what(), for the first `formattedFrames` frames
+    size_t formattedFrames = 0;
+};
+
+IRException::IRException(const std::string& message)
+    : IRException(message, Value(message)) {}
+
+IRException::IRException(const std::string& message, Value value)
+    : std::runtime_error(message), _state(std::make_shared<State>()) {
+    _state->value = std::move(value);
+    _state->message = message;
+}
+
+IRException IRException::FromValue(Value value) {
+    const std::string message = DescribeThrownValue(value);
+    return IRException(message, std::move(value));
+}
+
+const Value& IRException::GetValue() const { return _state->value; }
+
+const std::string& IRException::GetMessage() const { return _state->message; }
+
+size_t IRException::GetFrameCount() const { return _state->frames.size(); }
+
+void IRException::AddFrame(const MethodRef& method, size_t ip, std::shared_ptr<const std::vector<Instruction>> source) {
+    _state->frames.push_back(State::Frame{method, ip, std::move(source)});
+}
+
+const char* IRException::what() const noexcept {
+    State& state = *_state;
+    if (state.frames.empty()) {
+        return state.message.c_str();
+    }
+    if (state.formattedFrames != state.frames.size()) {
+        try {
+            std::string text = state.message;
+            for (const auto& frame : state.frames) {
+                const std::string methodName = frame.method ? frame.method->GetName() : std::string("<unknown>");
+                static const std::vector<Instruction> kNoSource;
+                text = FormatVmError(methodName, frame.ip, frame.source ? *frame.source : kNoSource, text);
+            }
+            state.formatted = std::move(text);
+            state.formattedFrames = state.frames.size();
+        } catch (...) {
+            return state.message.c_str();
+        }
+    }
+    return state.formatted.c_str();
+}
+
+Value InstructionExecutor::CreateConstantValue(const Instruction& instr) {
+    if (instr.constantIsNull) {
+        return Value();
+    }
+
+    if (!instr.constantType.empty()) {
+        auto typeLower = ToLowerInvariant(instr.constantType);
+
+        if (typeLower == "system.string" || typeLower == "string") {
+            return Value(instr.constantRawValue);
+        }
+
+        if (typeLower == "system.boolean" || typeLower == "bool" || typeLower == "boolean") {
+            bool boolValue = instr.constantBool;
+            if (instr.constantRawValue.empty()) {
+                return Value(boolValue);
+            }
+            auto valueLower = ToLowerInvariant(instr.constantRawValue);
+            if (valueLower == "true" || valueLower == "1") {
+                boolValue = true;
+            } else if (valueLower == "false" || valueLower == "0") {
+                boolValue = false;
+            }
+            return Value(boolValue);
+        }
+
+        if (typeLower == "system.int32" || typeLower == "int32" || typeLower == "int") {
+            return Value(static_cast<int32_t>(std::stoi(instr.constantRawValue)));
+        }
+
+        if (typeLower == "system.int64" || typeLower == "int64" || typeLower == "long") {
+            return Value(static_cast<int64_t>(std::stoll(instr.constantRawValue)));
+        }
+
+        if (typeLower == "system.single" || typeLower == "single" || typeLower == "float" || typeLower == "float32") {
+            return Value(static_cast<float>(std::stof(instr.constantRawValue)));
+        }
+
+        if (typeLower == "system.double" || typeLower == "double" || typeLower == "float64") {
+            return Value(static_cast<double>(std::stod(instr.constantRawValue)));
+        }
+    }
+
+    if (instr.constantBool) {
+        return Value(instr.constantBool);
+    }
+
+    return Value(instr.constantRawValue);
+}
+
 OpCode InstructionExecutor::ParseOpCode(const std::string& opStr) {
     const auto op = ToLowerInvariant(opStr);
 
@@ -258,6 +372,8 @@ OpCode InstructionExecutor::ParseOpCode(const std::string& opStr) {
     if (op == "continue") return OpCode::Continue;
     if (op == "throw") return OpCode::Throw;
     if (op == "while") return OpCode::While;
+    if (op == "leave" || op == "leave.s") return OpCode::Leave;
+    if (op == "endfinally") return OpCode::EndFinally;
     
     throw std::runtime_error("Unknown opcode: " + opStr);
 }
@@ -387,6 +503,35 @@ Instruction InstructionExecutor::ParseJsonInstruction(const json& instrJson) {
             }
             break;
 
+        case OpCode::LdI4:
+        case OpCode::LdI8:
+        case OpCode::LdR4:
+        case OpCode::LdR8: {
+            // The text IR parser emits `ldc.i4 5` as {"value": "5", "type": "int32"}.
+            const json* valueNode = &operand;
+            if (operand.is_object()) {
+                if (!operand.contains("value")) {
+                    break;
+                }
+                valueNode = &operand["value"];
+            }
+            const bool isInteger = instr.opCode == OpCode::LdI4 || instr.opCode == OpCode::LdI8;
+            if (valueNode->is_number()) {
+                instr.operandInt = isInteger ? valueNode->get<int32_t>() : 0;
+                instr.operandDouble = valueNode->get<double>();
+            } else if (valueNode->is_string()) {
+                const auto text = valueNode->get<std::string>();
+                if (isInteger) {
+                    instr.operandInt = static_cast<int32_t>(std::stoll(text, nullptr, 0));
+                    instr.operandDouble = static_cast<double>(instr.operandInt);
+                } else {
+                    instr.operandDouble = std::stod(text);
+                }
+            }
+            instr.hasOperandInt = true;
+            break;
+        }
+
         case OpCode::Br:
         case OpCode::BrTrue:
         case OpCode::BrFalse:
@@ -395,7 +540,8 @@ Instruction InstructionExecutor::ParseJsonInstruction(const json& instrJson) {
         case OpCode::Bgt:
         case OpCode::Blt:
         case OpCode::Bge:
-        case OpCode::Ble: {
+        case OpCode::Ble:
+        case OpCode::Leave: {
             if (operand.is_object()) {
                 if (operand.contains("target")) {
                     const auto& targetNode = operand["target"];
@@ -801,25 +947,7 @@ void InstructionExecutor::Execute(
             auto isVoidReturn = target.returnType.empty() || target.returnType == "void" || target.returnType == "System.Void";
 
             if (target.declaringType == "System.Console" && target.name == "WriteLine") {
-                if (callArgs.empty()) {
-                    vm->WriteOutput("\n");
-                } else {
-                    for (size_t i = 0; i < callArgs.size(); ++i) {
-                        if (i > 0) {
-                            vm->WriteOutput(" ");
-                        }
-                        // If the runtime is asked to print a null value, do not show the
-                        // literal "null" string; instead emit an empty string so that
-                        // Console.WriteLine(null) will behave like WriteLine("") in
-                        // typical .NET loggers (printing an empty line).
-                        if (callArgs[i].IsNull()) {
-                            vm->WriteOutput("");
-                        } else {
-                            vm->WriteOutput(ValueToString(callArgs[i]));
-                        }
-                    }
-                    vm->WriteOutput("\n");
-                }
+                WriteConsoleLine(vm, callArgs);
                 break;
             }
 
@@ -843,60 +971,33 @@ void InstructionExecutor::Execute(
             break;
         }
         
+        // Outside of a While these escape the method as errors.
         case OpCode::Break:
-            throw BreakSignal();
+            throw std::runtime_error("break");
 
         case OpCode::Continue:
-            throw ContinueSignal();
+            throw std::runtime_error("continue");
 
-        case OpCode::While: {
-            if (!instr.whileData.has_value()) {
-                throw std::runtime_error("While instruction missing metadata");
+        case OpCode::While:
+        case OpCode::If: {
+            const BlockExit exit = ExecuteStructured(instr, context, vm);
+            if (exit == BlockExit::Break) {
+                throw std::runtime_error("break");
             }
-
-            const auto& whileData = instr.whileData.value();
-
-            while (EvaluateCondition(whileData.condition, context, vm)) {
-                try {
-                    for (const auto& bodyInstr : whileData.body) {
-                        Execute(bodyInstr, context, vm);
-                    }
-                } catch (const ContinueSignal&) {
-                    continue;
-                } catch (const BreakSignal&) {
-                    break;
-                }
+            if (exit == BlockExit::Continue) {
+                throw std::runtime_error("continue");
             }
             break;
         }
 
-        case OpCode::If: {
-            if (!instr.ifData.has_value()) {
-                throw std::runtime_error("If instruction missing metadata");
-            }
-
-            const auto& ifData = instr.ifData.value();
-
-            // Pop the condition value from the stack
-            Value conditionValue = context->PopStack();
-            bool condition = ValueToBool(conditionValue);
-
-            if (condition) {
-                // Execute then block
-                for (const auto& thenInstr : ifData.thenBlock) {
-                    Execute(thenInstr, context, vm);
-                }
-            } else if (!ifData.elseBlock.empty()) {
-                // Execute else block if present
-                for (const auto& elseInstr : ifData.elseBlock) {
-                    Execute(elseInstr, context, vm);
-                }
+        case OpCode::Throw: {
+            // The tree walker has no handler tables: the exception escapes.
+            Value value = context->PopStack();
+            if (value.IsNull()) {
+                throw std::runtime_error("Cannot throw a null value");
             }
-            break;
+            throw IRException::FromValue(std::move(value));
         }
-
-        case OpCode::Throw:
-            throw std::runtime_error("Instruction not yet implemented: throw");
         
         default:
             throw std::runtime_error("Unknown instruction opcode");
@@ -938,46 +1039,17 @@ Value InstructionExecutor::ExecuteInstructions(
         return static_cast<size_t>(target);
     };
 
-    auto compareBranch = [&](OpCode cmp, const Value& left, const Value& right) -> bool {
-        switch (cmp) {
-            case OpCode::Beq:
-                if (left.IsString() && right.IsString()) return left.AsString() == right.AsString();
-                if (left.IsBool() && right.IsBool()) return left.AsBool() == right.AsBool();
-                if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) == ValueToInt64(right);
-                return ValueToDouble(left) == ValueToDouble(right);
-            case OpCode::Bne:
-                if (left.IsString() && right.IsString()) return left.AsString() != right.AsString();
-                if (left.IsBool() && right.IsBool()) return left.AsBool() != right.AsBool();
-                if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) != ValueToInt64(right);
-                return ValueToDouble(left) != ValueToDouble(right);
-            case OpCode::Bgt:
-                if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) > ValueToInt64(right);
-                return ValueToDouble(left) > ValueToDouble(right);
-            case OpCode::Blt:
-                if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) < ValueToInt64(right);
-                return ValueToDouble(left) < ValueToDouble(right);
-            case OpCode::Bge:
-                if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) >= ValueToInt64(right);
-                return ValueToDouble(left) >= ValueToDouble(right);
-            case OpCode::Ble:
-                if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) <= ValueToInt64(right);
-                return ValueToDouble(left) <= ValueToDouble(right);
-            default:
-                return false;
-        }
-    };
-
     size_t ip = 0;
-    while (ip < instructions.size()) {
-        const auto& instr = instructions[ip];
-        if (context) {
-            context->SetLastInstruction(ip, instr.opCode);
-        }
-        // std::cerr << "[" << (context->GetMethod() ? context->GetMethod()->GetName() : std::string("<static>"))
-        //           << "] Executing instruction " << ip << ": op=" << static_cast<int>(instr.opCode)
-        //           << ", id='" << instr.identifier << "', operand='" << instr.operandString << "'" << std::endl;
+    try {
+        while (ip < instructions.size()) {
+            const auto& instr = instructions[ip];
+            if (context) {
+                context->SetLastInstruction(ip, instr.opCode);
+            }
+            // std::cerr << "[" << (context->GetMethod() ? context->GetMethod()->GetName() : std::string("<static>"))
+            //           << "] Executing instruction " << ip << ": op=" << static_cast<int>(instr.opCode)
+            //           << ", id='" << instr.identifier << "', operand='" << instr.operandString << "'" << std::endl;
 
-        try {
             if (instr.opCode == OpCode::Ret) {
                 try {
                     return context->PopStack();
@@ -1017,7 +1089,7 @@ Value InstructionExecutor::ExecuteInstructions(
                 case OpCode::Ble: {
                     auto right = context->PopStack();
                     auto left = context->PopStack();
-                    bool cond = compareBranch(instr.opCode, left, right);
+                    bool cond = CompareBranch(instr.opCode, left, right);
                     if (cond) {
                         ip = resolveTarget(instr);
                         continue;
@@ -1030,14 +1102,12 @@ Value InstructionExecutor::ExecuteInstructions(
             }
 
             // Special handling for while loops with binary conditions
-            if (instr.opCode == OpCode::While && instr.whileData.has_value()) {
-            const auto& whileData = instr.whileData.value();
-            if (whileData.condition.kind == ConditionKind::Binary) {
-                std::vector<Instruction> setupInstrs;
-                int setupIdx = static_cast<int>(ip) - 1;
-
-                while (setupIdx >= 0) {
-                    const auto& prevInstr = instructions[setupIdx];
+            if (instr.opCode == OpCode::While && instr.whileData.has_value() &&
+                instr.whileData->condition.kind == ConditionKind::Binary) {
+                size_t setupStart = ip;
+
+                while (setupStart > 0) {
+                    const auto& prevInstr = instructions[setupStart - 1];
                     if (prevInstr.opCode == OpCode::LdLoc ||
                         prevInstr.opCode == OpCode::LdCon ||
                         prevInstr.opCode == OpCode::LdI4 ||
@@ -1047,71 +1117,32 @@ Value InstructionExecutor::ExecuteInstructions(
                         prevInstr.opCode == OpCode::LdTrue ||
                         prevInstr.opCode == OpCode::LdFalse ||
                         prevInstr.opCode == OpCode::LdNull) {
-                        setupInstrs.insert(setupInstrs.begin(), prevInstr);
-                        setupIdx--;
+                        setupStart--;
                     } else {
                         break;
                     }
                 }
 
-                while (true) {
-                    for (const auto& setupInstr : setupInstrs) {
-                        Execute(setupInstr, context, vm);
-                    }
-
-                    bool cond_result;
-                    if (whileData.condition.comparisonOp == OpCode::Nop) {
-                        throw std::runtime_error("Binary condition missing comparison operation");
-                    }
-
-                    auto right = context->PopStack();
-                    auto left = context->PopStack();
-                    context->PushStack(left);
-                    context->PushStack(right);
-
-                    switch (whileData.condition.comparisonOp) {
-                        case OpCode::Ceq: ExecuteCeq(context); break;
-                        case OpCode::Cne: ExecuteCne(context); break;
-                        case OpCode::Clt: ExecuteClt(context); break;
-                        case OpCode::Cle: ExecuteCle(context); break;
-                        case OpCode::Cgt: ExecuteCgt(context); break;
-                        case OpCode::Cge: ExecuteCge(context); break;
-                        default:
-                            throw std::runtime_error("Unsupported comparison opcode in binary condition");
-                    }
-
-                    auto result = context->PopStack();
-                    cond_result = ValueToBool(result);
-
-                    if (!cond_result) {
-                        break;
-                    }
-
-                    try {
-                        for (const auto& bodyInstr : whileData.body) {
-                            Execute(bodyInstr, context, vm);
-                        }
-                    } catch (const ContinueSignal&) {
-                        continue;
-                    } catch (const BreakSignal&) {
-                        break;
-                    }
-                }
+                ExecuteBinaryWhile(instr.whileData.value(), instructions.data() + setupStart, ip - setupStart, context, vm);
                 ++ip;
                 continue;
             }
-        }
 
             Execute(instr, context, vm);
             ++ip;
-        } catch (const std::exception& ex) {
-            const std::string methodName = (context && context->GetMethod()) ? context->GetMethod()->GetName() : std::string("<unknown>");
-            throw std::runtime_error(
-                "VM error in method '" + methodName + "' at ip=" + std::to_string(ip) +
-                " op=" + std::to_string(static_cast<int>(instr.opCode)) +
-                " id='" + instr.identifier + "' operand='" + instr.operandString + "': " + ex.what()
-            );
         }
+    } catch (const std::exception& ex) {
+        // The frame is only described once the error is reported (see
+        // IRException::what).
+        const auto* raised = dynamic_cast<const IRException*>(&ex);
+        IRException exception = raised ? *raised : IRException(ex.what());
+        const MethodRef method = context ? context->GetMethod() : nullptr;
+        auto source = method ? method->GetSharedInstructions() : nullptr;
+        if (!source || source.get() != &instructions) {
+            source = std::make_shared<const std::vector<Instruction>>(instructions);
+        }
+        exception.AddFrame(method, ip, std::move(source));
+        throw exception;
     }
 
     try {
@@ -1121,55 +1152,1788 @@ Value InstructionExecutor::ExecuteInstructions(
     }
 }
 
-double InstructionExecutor::ValueToDouble(const Value& v) {
-    if (v.IsInt32()) return static_cast<double>(v.AsInt32());
-    if (v.IsInt64()) return static_cast<double>(v.AsInt64());
-    if (v.IsFloat32()) return static_cast<double>(v.AsFloat32());
-    if (v.IsFloat64()) return v.AsFloat64();
-    throw std::runtime_error("Cannot convert value to double");
+namespace {
+
+// Empties the inline cache of `site` if a method table or the class registry
+// changed since its entries were resolved.
+void ValidateCallSiteCache(const CallSite& site, VirtualMachine* vm) {
+    const uint64_t epoch = VirtualMachine::GetDispatchEpoch();
+    const uint64_t version = vm->GetClassRegistryVersion();
+    if (site.cacheEpoch == epoch && site.cachedRegistryVersion == version) {
+        return;
+    }
+    for (size_t i = 0; i < site.cacheCount; ++i) {
+        site.cache[i] = CallCacheEntry{};
+    }
+    site.cacheCount = 0;
+    site.megamorphic = false;
+    site.cacheEpoch = epoch;
+    site.cachedRegistryVersion = version;
+    site.slotClass = nullptr;
+    site.slot = Method::kNoVTableSlot;
+    site.slotResolved = false;
 }
 
-int64_t InstructionExecutor::ValueToInt64(const Value& v) {
-    if (v.IsInt32()) return static_cast<int64_t>(v.AsInt32());
-    if (v.IsInt64()) return v.AsInt64();
-    if (v.IsFloat32()) return static_cast<int64_t>(v.AsFloat32());
-    if (v.IsFloat64()) return static_cast<int64_t>(v.AsFloat64());
-    throw std::runtime_error("Cannot convert value to int64");
+MethodRef ResolveStaticCallSite(const CallSite& site, VirtualMachine* vm) {
+    ValidateCallSiteCache(site, vm);
+    if (site.cacheCount == 0) {
+        auto classRef = vm->GetClass(site.declaringType);
+        auto method = vm->ResolveMethod(classRef, site.name, site.target, /*requireStatic*/true);
+        site.cache[0] = CallCacheEntry{std::move(classRef), std::move(method)};
+        site.cacheCount = 1;
+    }
+    return site.cache[0].method;
 }
 
-void InstructionExecutor::ExecuteAdd(ExecutionContext* context) {
-    auto b = context->PopStack();
-    auto a = context->PopStack();
-    
-    if (a.IsString() || b.IsString()) {
-        // String concatenation
-        std::string result = a.AsString() + b.AsString();
-        context->PushStack(Value(result));
-    } else if (a.IsInt32() && b.IsInt32()) {
-        context->PushStack(Value(a.AsInt32() + b.AsInt32()));
-    } else if (a.IsInt64() || b.IsInt64()) {
-        context->PushStack(Value(ValueToInt64(a) + ValueToInt64(b)));
-    } else {
-        context->PushStack(Value(ValueToDouble(a) + ValueToDouble(b)));
+// The method a virtual call on `receiver` dispatches to through the vtable
+// (or interface table) slot of the site, or null when the receiver is not
+// covered by the slot's class.
+MethodRef DispatchThroughSlot(const CallSite& site, const Class& receiver, VirtualMachine* vm) {
+    if (!site.slotResolved) {
+        site.slotResolved = true;
+        try {
+            ClassRef declaring = vm->GetClass(site.declaringType);
+            MethodRef method = vm->ResolveMethod(declaring, site.name, site.target, /*requireStatic*/false);
+            if (method && !method->IsStatic()) {
+                declaring->FinalizeDispatch();
+                site.slot = method->GetVTableSlot();
+                site.slotClass = std::move(declaring);
+            }
+        } catch (const std::exception&) {
+            site.slot = Method::kNoVTableSlot;
+        }
+    }
+    if (site.slot == Method::kNoVTableSlot) {
+        return nullptr;
+    }
+    if (site.slotClass->IsInterface()) {
+        const auto* table = receiver.GetInterfaceTable(*site.slotClass);
+        return table && site.slot < table->size() ? (*table)[site.slot] : nullptr;
+    }
+    if (!receiver.IsSubclassOf(*site.slotClass)) {
+        return nullptr;
     }
+    return receiver.GetVTable()[site.slot];
 }
 
-void InstructionExecutor::ExecuteSub(ExecutionContext* context) {
-    auto b = context->PopStack();
-    auto a = context->PopStack();
-    
-    if (a.IsInt32() && b.IsInt32()) {
-        context->PushStack(Value(a.AsInt32() - b.AsInt32()));
-    } else if (a.IsInt64() || b.IsInt64()) {
-        context->PushStack(Value(ValueToInt64(a) - ValueToInt64(b)));
+MethodRef ResolveVirtualCallSite(const CallSite& site, const ClassRef& receiver, VirtualMachine* vm) {
+    ValidateCallSiteCache(site, vm);
+    for (size_t i = 0; i < site.cacheCount; ++i) {
+        if (site.cache[i].receiver == receiver) {
+            return site.cache[i].method;
+        }
+    }
+
+    MethodRef method = receiver ? DispatchThroughSlot(site, *receiver, vm) : nullptr;
+    if (!method) {
+        method = vm->ResolveMethod(receiver, site.name, site.target, /*requireStatic*/false);
+    }
+    if (site.cacheCount < kCallSiteCacheSize) {
+        site.cache[site.cacheCount++] = CallCacheEntry{receiver, method};
     } else {
-        context->PushStack(Value(ValueToDouble(a) - ValueToDouble(b)));
+        site.megamorphic = true;
     }
+    return method;
 }
 
-void InstructionExecutor::ExecuteMul(ExecutionContext* context) {
-    auto b = context->PopStack();
-    auto a = context->PopStack();
+bool ReturnsVoid(const Method& method) {
+    const TypeReference& type = method.GetReturnType();
+    return type.IsPrimitive() && type.GetPrimitiveType() == PrimitiveType::Void;
+}
+
+// The callee of `site` and, for a virtual call, the receiver below its
+// arguments. False for calls the usual call path has to make (console output)
+// or report (missing instance, stack underflow).
+bool ResolveCallee(const CallSite& site, bool isVirtual, ExecutionContext& context, VirtualMachine* vm,
+                   MethodRef& callee, ObjectRef& instance) {
+    if (!vm || site.isConsoleWriteLine || context.GetStackDepth() < site.argumentCount + (isVirtual ? 1 : 0)) {
+        return false;
+    }
+    if (isVirtual) {
+        const Value& receiver = context.UncheckedStackEnd()[-1 - static_cast<ptrdiff_t>(site.argumentCount)];
+        if (!receiver.IsObject() || !receiver.AsObject() || !receiver.AsObject()->GetClass()) {
+            return false;
+        }
+        instance = receiver.AsObject();
+        callee = ResolveVirtualCallSite(site, instance->GetClass(), vm);
+    } else {
+        callee = ResolveStaticCallSite(site, vm);
+    }
+    return true;
+}
+
+// Tail calls (see MarkTailCalls): move the frame of `context` over to the
+// callee of `site` and return the callee's body, or return null when the call
+// has to be made as usual. The frame then returns what the callee returns,
+// which must be what the call would have made it return: the call's result,
+// so the callee returns a value exactly when the call site expects one, or
+// nothing at all, when the frame's own method is void.
+std::shared_ptr<PreparedMethod> EnterTailCall(const CallSite& site, bool isVirtual, ExecutionContext& context,
+                                              VirtualMachine* vm) {
+    const MethodRef& caller = context.GetMethod();
+    MethodRef callee;
+    ObjectRef instance;
+    if (!caller || !ResolveCallee(site, isVirtual, context, vm, callee, instance)) {
+        return nullptr;
+    }
+    if (site.isVoidReturn != ReturnsVoid(*callee) || (site.isVoidReturn && !ReturnsVoid(*caller))) {
+        return nullptr;
+    }
+    return vm->ReuseFrame(callee, std::move(instance), &context, site.argumentCount);
+}
+
+// Stackless calls: a call from one IR method to another pushes the callee's
+// frame on the VM's frame stack and the dispatch loop continues in the
+// callee's body; the caller is parked as a SuspendedFrame until the callee
+// returns. Native methods, and calls from frames off the frame stack, still
+// get a native frame (see ExecuteCallSite).
+std::atomic<bool> g_stacklessCallsEnabled{true};
+
+struct SuspendedFrame {
+    std::shared_ptr<PreparedMethod> held; // keeps `body` alive, unless it is the initial one
+    const PreparedMethod* body;
+    ExecutionContext* context;
+    const CallSite* site;
+    size_t resume;     // pc after the call
+    size_t previousOp; // see RecordDispatch
+    bool verified;     // runs verifiedCode
+    bool isVirtual;
+    bool calleeReturnsVoid;
+    size_t pendingBase; // its entries of the pending finally handlers
+};
+
+// A finally handler a frame is running (see ExceptionHandler). It was entered
+// either on a Leave, and then goes on with the next finally handler of the
+// leave site or its target, or on an exception, which endfinally rethrows.
+struct PendingFinally {
+    size_t handler;
+    size_t leaveSite;
+    size_t step; // position of `handler` in the leave site's finallyHandlers
+    std::optional<IRException> exception;
+    size_t throwPc; // where `exception` was raised
+    Value result;   // what a returning leave site returns (LeaveSite::returns)
+};
+
+constexpr size_t kNoHandler = std::numeric_limits<size_t>::max();
+
+// Push the frame of the callee of `site` and return its body, or null when
+// the call has to be made as usual.
+std::shared_ptr<PreparedMethod> EnterCall(const CallSite& site, bool isVirtual, ExecutionContext& context,
+                                          VirtualMachine* vm, bool& calleeReturnsVoid) {
+    MethodRef callee;
+    ObjectRef instance;
+    if (!ResolveCallee(site, isVirtual, context, vm, callee, instance)) {
+        return nullptr;
+    }
+    calleeReturnsVoid = ReturnsVoid(*callee);
+    return vm->PushFrame(callee, std::move(instance), &context, site.argumentCount);
+}
+
+// A failed call leaves its frame on the call stack for diagnostics; leave
+// the frame an inlined call would have had, failing at `ip` of its body.
+// Skipped when a call made by the inlined body failed: its frame is already
+// above the caller's.
+void PushInlinedFrame(const InlinedCall& call, size_t ip, ExecutionContext& caller, VirtualMachine& vm) {
+    auto frame = std::make_unique<ExecutionContext>(call.method);
+    if (call.thisSlot >= 0) {
+        const Value self = caller.GetLocal(static_cast<size_t>(call.thisSlot));
+        if (self.IsObject()) {
+            frame->SetThis(self.AsObject());
+        }
+    }
+    const auto& source = *call.source;
+    frame->SetLastInstruction(ip, ip < source.size() ? source[ip].opCode : OpCode::Ret);
+    vm.PushContext(std::move(frame));
+}
+
+// Record `pc` of `prepared` as the instruction `context` is executing. Code
+// inlined from a callee is located at the call.
+void RecordLocation(const PreparedMethod& prepared, size_t pc, ExecutionContext& context) {
+    const size_t frame = prepared.inlineFrames.empty() ? 0 : prepared.inlineFrames[pc];
+    const size_t ip = frame == 0 ? prepared.sourceIps[pc] : prepared.inlinedCalls[frame - 1].sourceIp;
+    const auto& source = *prepared.source;
+    context.SetLastInstruction(ip, ip < source.size() ? source[ip].opCode : OpCode::Ret);
+}
+
+// Record that `exception`, raised at `pc` of `prepared`, leaves the frame
+// `context`. Code inlined from a callee reports it as the call would have:
+// raised by the callee at its own ip, then passed on by the caller at the call.
+void LeaveFrame(IRException& exception, const PreparedMethod& prepared, size_t pc, ExecutionContext& context,
+                VirtualMachine* vm) {
+    RecordLocation(prepared, pc, context);
+    const size_t frame = prepared.inlineFrames.empty() ? 0 : prepared.inlineFrames[pc];
+    if (frame != 0) {
+        const InlinedCall& call = prepared.inlinedCalls[frame - 1];
+        const size_t calleeIp = prepared.sourceIps[pc];
+        if (vm && vm->GetCurrentContext() == &context) {
+            PushInlinedFrame(call, calleeIp, context, *vm);
+        }
+        exception.AddFrame(call.method, calleeIp, call.source);
+        exception.AddFrame(context.GetMethod(), call.sourceIp, prepared.source);
+        return;
+    }
+    exception.AddFrame(context.GetMethod(), prepared.sourceIps[pc], prepared.source);
+}
+
+// Whether the body BytecodeInliner spliced in for `call` still stands for
+// the call: the receiver (on the stack below the arguments) has the class
+// the call was resolved for, and the call still resolves to the same body.
+bool InlinedCallHolds(const PreparedMethod& prepared, const InlinedCall& call, ExecutionContext& context,
+                      VirtualMachine* vm) {
+    if (call.receiver) {
+        if (context.GetStackDepth() <= call.argumentCount) {
+            return false;
+        }
+        const Value& instance = context.UncheckedStackEnd()[-1 - static_cast<ptrdiff_t>(call.argumentCount)];
+        if (!instance.IsObject() || !instance.UncheckedObject() ||
+            instance.UncheckedObject()->GetClass() != call.receiver) {
+            return false;
+        }
+    }
+
+    const uint64_t epoch = VirtualMachine::GetDispatchEpoch();
+    const uint64_t version = vm->GetClassRegistryVersion();
+    if (call.checkedEpoch != epoch || call.checkedRegistryVersion != version) {
+        const CallSite& site = prepared.callSites[call.callSite];
+        MethodRef method;
+        try {
+            method = call.receiver
+                         ? vm->ResolveMethod(call.receiver, site.name, site.target, /*requireStatic*/false)
+                         : vm->ResolveMethod(vm->GetClass(site.declaringType), site.name, site.target, /*requireStatic*/true);
+        } catch (const std::exception&) {
+            method = nullptr;
+        }
+        call.holds = method == call.method && !method->GetNativeImpl() &&
+                     method->GetSharedInstructions() == call.source &&
+                     method->GetParameters().size() == call.argumentCount;
+        call.checkedEpoch = epoch;
+        call.checkedRegistryVersion = version;
+    }
+    return call.holds;
+}
+
+void RefreshTypeSite(const TypeSite& site, VirtualMachine* vm) {
+    const uint64_t version = vm->GetClassRegistryVersion();
+    if (site.cachedRegistryVersion != version) {
+        site.cachedClass = nullptr;
+        site.hasCachedClass = false;
+        site.hasCachedType = false;
+        site.cachedRegistryVersion = version;
+    }
+}
+
+ClassRef ResolveTypeSiteClass(const TypeSite& site, VirtualMachine* vm) {
+    RefreshTypeSite(site, vm);
+    if (!site.hasCachedClass) {
+        site.cachedClass = vm->GetClass(site.symbol);
+        site.hasCachedClass = true;
+    }
+    return site.cachedClass;
+}
+
+// Class named by a CastClass/IsInst operand, or null when it is not registered.
+ClassRef TryResolveTypeSiteClass(const TypeSite& site, VirtualMachine* vm) {
+    RefreshTypeSite(site, vm);
+    if (!site.hasCachedClass) {
+        try {
+            site.cachedClass = vm->GetClass(site.normalizedSymbol);
+        } catch (...) {
+            site.cachedClass = nullptr;
+        }
+        site.hasCachedClass = true;
+    }
+    return site.cachedClass;
+}
+
+const TypeReference& ResolveTypeSiteType(const TypeSite& site, VirtualMachine* vm) {
+    RefreshTypeSite(site, vm);
+    if (!site.hasCachedType) {
+        site.cachedType = ParseTypeReference(vm, site.name);
+        site.hasCachedType = true;
+    }
+    return site.cachedType;
+}
+
+bool MatchesPrimitiveTypeName(const std::string& normalized, const Value& value) {
+    if (normalized == "object") return true;
+    if (normalized == "string") return value.IsString();
+    if (normalized == "bool") return value.IsBool();
+    if (normalized == "int32") return value.IsInt32();
+    if (normalized == "int64") return value.IsInt64();
+    if (normalized == "float32") return value.IsFloat32();
+    if (normalized == "float64") return value.IsFloat64();
+    if (normalized == "uint8") return value.IsInt32();
+    return false;
+}
+
+// First handler of `prepared`, from index `from` on, that takes `value`
+// raised at `pc`: a finally, or a catch whose type `value` has.
+size_t FindHandler(const PreparedMethod& prepared, size_t pc, size_t from, const Value& value, VirtualMachine* vm) {
+    for (size_t i = from; i < prepared.handlers.size(); ++i) {
+        const PreparedHandler& handler = prepared.handlers[i];
+        if (pc < handler.tryStart || pc >= handler.tryEnd) {
+            continue;
+        }
+        if (handler.kind == ExceptionHandlerKind::Finally || handler.catchType == kCatchAnyType) {
+            return i;
+        }
+        const TypeSite& site = prepared.typeSites[static_cast<size_t>(handler.catchType)];
+        if (MatchesPrimitiveTypeName(site.normalizedName, value)) {
+            return i;
+        }
+        if (vm && value.IsObject()) {
+            auto classRef = TryResolveTypeSiteClass(site, vm);
+            auto obj = value.AsObject();
+            if (classRef && obj && obj->IsInstanceOf(classRef)) {
+                return i;
+            }
+        }
+    }
+    return kNoHandler;
+}
+
+// Drop the pending finally handlers (the frame's from `base` on) control
+// leaves when it moves from `from` to `to`.
+void DropPendingFinally(std::vector<PendingFinally>& pending, size_t base, const PreparedMethod& prepared,
+                        size_t from, size_t to) {
+    while (pending.size() > base) {
+        const PreparedHandler& handler = prepared.handlers[pending.back().handler];
+        const bool holdsFrom = from >= handler.handlerStart && from < handler.handlerEnd;
+        const bool holdsTo = to >= handler.handlerStart && to < handler.handlerEnd;
+        if (!holdsFrom || holdsTo) {
+            break;
+        }
+        pending.pop_back();
+    }
+}
+
+// Pops the instance operand of LdFld/StFld, falling back to 'this' like the
+// tree walker does when the stack is empty or does not hold an object.
+ObjectRef PopFieldInstance(ExecutionContext* context) {
+    if (context->GetStackDepth() > 0) {
+        auto instanceValue = context->PopStack();
+        if (instanceValue.IsObject()) {
+            return instanceValue.AsObject();
+        }
+    }
+    return context->GetThis();
+}
+
+// Slot of the site's field in `instance`, or Class::kNoFieldSlot when the
+// field is not part of the instance's layout (the caller then falls back to
+// the string-keyed GetField/SetField).
+size_t ResolveFieldSite(const FieldSite& site, const Object& instance) {
+    const ClassRef& classRef = instance.GetClass();
+    if (site.cachedClass && site.cachedClass == classRef) {
+        return site.cachedSlot;
+    }
+    if (!classRef) {
+        return Class::kNoFieldSlot;
+    }
+    const size_t slot = classRef->GetFieldSlot(site.symbol);
+    if (slot >= instance.GetSlotCount()) {
+        return Class::kNoFieldSlot;
+    }
+    site.cachedClass = classRef;
+    site.cachedSlot = slot;
+    return slot;
+}
+
+bool MatchesVerifiedType(VerifiedType type, const Value& value) {
+    switch (type) {
+        case VerifiedType::Unknown: return true;
+        case VerifiedType::Null: return value.IsNull();
+        case VerifiedType::Int32: return value.IsInt32();
+        case VerifiedType::Int64: return value.IsInt64();
+        case VerifiedType::Float32: return value.IsFloat32();
+        case VerifiedType::Float64: return value.IsFloat64();
+        case VerifiedType::Bool: return value.IsBool();
+        case VerifiedType::String: return value.IsString();
+        case VerifiedType::Object: return value.IsObject();
+    }
+    return false;
+}
+
+// The verified stream of `prepared` assumes its declared argument types; a
+// frame called with anything else runs the checked stream.
+bool CanRunVerified(const PreparedMethod& prepared, const ExecutionContext& context) {
+    if (!prepared.verified || context.GetArgumentCount() != prepared.argumentTypes.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prepared.argumentTypes.size(); ++i) {
+        if (prepared.argumentTypes[i] != VerifiedType::Unknown &&
+            !MatchesVerifiedType(prepared.argumentTypes[i], context.GetArgument(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tiering (see JitCompiler): continue the frame at `pc` in native code,
+// compiling the method first if it has none yet. `pc` is left alone when the
+// frame cannot enter native code there. A method whose native code keeps
+// bailing out goes back to being interpreted; the code itself stays alive,
+// since frames further up the stack may still be running it.
+// Native code makes its calls on the native stack (see ExecuteCallSite), so
+// frames nested deeper than kMaxNativeNesting runs of it stay interpreted,
+// where calls are stackless.
+constexpr uint32_t kMaxNativeBailouts = 64;
+constexpr uint32_t kMaxNativeNesting = 256;
+thread_local uint32_t g_nativeNesting = 0;
+
+void RunNative(const PreparedMethod& prepared, ExecutionContext& context, VirtualMachine* vm, size_t& pc) {
+    if (prepared.nativeCodeRejected || g_nativeNesting >= kMaxNativeNesting) {
+        return;
+    }
+    if (!prepared.nativeCode) {
+        prepared.nativeCode = JitCompiler::Compile(*context.GetMethod(), prepared);
+        if (!prepared.nativeCode) {
+            prepared.nativeCodeRejected = true;
+            return;
+        }
+    }
+    const JitCode& native = *prepared.nativeCode;
+    if (!native.CanEnter(pc, context)) {
+        return;
+    }
+    ++g_nativeNesting;
+    try {
+        native.Run(pc, context, vm);
+    } catch (...) {
+        --g_nativeNesting;
+        throw;
+    }
+    --g_nativeNesting;
+    if (!native.IsReturn(pc) && ++prepared.nativeBailouts >= kMaxNativeBailouts) {
+        prepared.nativeCodeRejected = true;
+    }
+}
+
+// Tiering (see TieredExecution): the pc of `to`, an optimized body of the
+// same method, at which a frame of Interpreter-tier `from` standing at loop
+// header `pc` can continue, or kNoLoopEntry. The entry must start the same
+// source instruction and be a branch target of `to` outside inlined code, and
+// the operand stack must be empty: the optimizer keeps what locals hold at
+// such points.
+constexpr size_t kNoLoopEntry = ~size_t{0};
+
+bool IsBranchOp(BytecodeOp op) {
+    switch (op) {
+        case BytecodeOp::Br:
+        case BytecodeOp::BrTrue:
+        case BytecodeOp::BrFalse:
+        case BytecodeOp::Beq:
+        case BytecodeOp::Bne:
+        case BytecodeOp::Bgt:
+        case BytecodeOp::Blt:
+        case BytecodeOp::Bge:
+        case BytecodeOp::Ble:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool StartsSourceInstruction(const PreparedMethod& prepared, size_t pc) {
+    return pc < prepared.sourceIps.size() && (pc == 0 || prepared.sourceIps[pc - 1] != prepared.sourceIps[pc]) &&
+           (prepared.inlineFrames.empty() || prepared.inlineFrames[pc] == 0);
+}
+
+size_t FindLoopEntry(const PreparedMethod& from, const PreparedMethod& to, size_t pc, ExecutionContext& context) {
+    if (context.GetStackDepth() != 0 || !StartsSourceInstruction(from, pc)) {
+        return kNoLoopEntry;
+    }
+    const size_t ip = from.sourceIps[pc];
+    for (const auto& instr : to.code) {
+        // Fusion leaves the later components of a superinstruction alone, so
+        // every branch still has its own op.
+        const size_t target = static_cast<size_t>(instr.a);
+        if (IsBranchOp(GetGenericBytecodeOp(instr.op)) && StartsSourceInstruction(to, target) &&
+            to.sourceIps[target] == ip) {
+            return target;
+        }
+    }
+    return kNoLoopEntry;
+}
+
+// Dispatch profiling (see DispatchProfile). `previous` is the opcode last
+// dispatched in the same frame, or kNoPreviousOp at frame entry.
+constexpr size_t kNoPreviousOp = kBytecodeOpCount;
+
+bool g_dispatchProfiling = false;
+uint64_t g_dispatchCount = 0;
+uint64_t g_opcodePairCounts[kBytecodeOpCount][kBytecodeOpCount] = {};
+
+void RecordDispatch(size_t& previous, BytecodeOp op) {
+    const size_t current = static_cast<size_t>(op);
+    ++g_dispatchCount;
+    if (previous != kNoPreviousOp) {
+        ++g_opcodePairCounts[previous][current];
+    }
+    previous = current;
+}
+
+// Quickening. A generic instruction whose operands carry the tags of one of
+// its quickened forms is rewritten into that form (it still executes
+// generically this once); a quickened form whose tag guard fails rewrites
+// itself back and stays generic from then on. A form is Nop when the op has
+// no quickened variant for those tags.
+void QuickenBinary(BytecodeInstruction& instr, ExecutionContext& context, BytecodeOp int32Form, BytecodeOp float64Form) {
+    if (instr.b == kQuickeningDisabled || context.GetStackDepth() < 2) {
+        return;
+    }
+    const Value* end = context.UncheckedStackEnd();
+    if (int32Form != BytecodeOp::Nop && end[-2].IsInt32() && end[-1].IsInt32()) {
+        instr.op = int32Form;
+    } else if (float64Form != BytecodeOp::Nop && end[-2].IsFloat64() && end[-1].IsFloat64()) {
+        instr.op = float64Form;
+    }
+}
+
+void QuickenBool(BytecodeInstruction& instr, ExecutionContext& context, BytecodeOp boolForm) {
+    if (instr.b == kQuickeningDisabled || context.GetStackDepth() < 1) {
+        return;
+    }
+    if (context.UncheckedStackEnd()[-1].IsBool()) {
+        instr.op = boolForm;
+    }
+}
+
+void Deoptimize(BytecodeInstruction& instr, BytecodeOp genericForm) {
+    instr.op = genericForm;
+    instr.b = kQuickeningDisabled;
+}
+
+bool TopTwoAreInt32(ExecutionContext& context) {
+    const Value* end = context.UncheckedStackEnd();
+    return context.GetStackDepth() >= 2 && end[-2].IsInt32() && end[-1].IsInt32();
+}
+
+// Integer division by a nonzero divisor. x / -1 is -x, so the smallest
+// value divides to itself as neg wraps it, and x % -1 is 0; idiv traps on
+// both.
+template <typename T>
+T DivideWrapping(T left, T right) {
+    using Unsigned = std::make_unsigned_t<T>;
+    return right == -1 ? static_cast<T>(Unsigned(0) - static_cast<Unsigned>(left)) : left / right;
+}
+
+template <typename T>
+T RemainderWrapping(T left, T right) {
+    return right == -1 ? 0 : left % right;
+}
+
+// Fast paths of superinstructions. `op` is the generic op kept in `b` of the
+// fused instruction; false means the operands need the generic handler.
+bool TryArithmeticInt32(BytecodeOp op, int32_t left, int32_t right, int32_t& result) {
+    switch (op) {
+        case BytecodeOp::Add: result = left + right; return true;
+        case BytecodeOp::Sub: result = left - right; return true;
+        case BytecodeOp::Mul: result = left * right; return true;
+        case BytecodeOp::Rem:
+            if (right == 0) return false;
+            result = RemainderWrapping(left, right);
+            return true;
+        default: return false;
+    }
+}
+
+bool CompareInt32(BytecodeOp op, int32_t left, int32_t right) {
+    switch (op) {
+        case BytecodeOp::Beq: return left == right;
+        case BytecodeOp::Bne: return left != right;
+        case BytecodeOp::Bgt: return left > right;
+        case BytecodeOp::Blt: return left < right;
+        case BytecodeOp::Bge: return left >= right;
+        case BytecodeOp::Ble: return left <= right;
+        default: return false;
+    }
+}
+
+bool TopTwoAreFloat64(ExecutionContext& context) {
+    const Value* end = context.UncheckedStackEnd();
+    return context.GetStackDepth() >= 2 && end[-2].IsFloat64() && end[-1].IsFloat64();
+}
+
+} // namespace
+
+Value InstructionExecutor::ExecutePrepared(
+    const PreparedMethod& prepared,
+    ObjectRef thisPtr,
+    const std::vector<Value>& args,
+    ExecutionContext* context,
+    VirtualMachine* vm
+) {
+    context->SetArguments(args);
+    return ExecutePrepared(prepared, std::move(thisPtr), context, vm);
+}
+
+Value InstructionExecutor::ExecutePrepared(
+    const PreparedMethod& initial,
+    ObjectRef thisPtr,
+    ExecutionContext* context,
+    VirtualMachine* vm
+) {
+    context->SetThis(std::move(thisPtr));
+
+    // The frame may move on to another body: the optimized one of its method
+    // (see FindLoopEntry) or that of a tail callee (see EnterTailCall). It then
+    // starts over at `entry` of `next`, which `held` keeps alive from there on.
+    // A stackless call (see EnterCall) moves on to the callee's frame the same
+    // way, parking the caller in `suspended`; once the callee returns, the
+    // caller resumes after the call in the stream it was running.
+    // An exception a handler takes (see FindHandler) moves the frame on to the
+    // handler the same way, after the frames it left were unwound.
+    const PreparedMethod* body = &initial;
+    std::shared_ptr<PreparedMethod> held;
+    std::shared_ptr<PreparedMethod> next;
+    size_t entry = 0;
+    const bool stackless = vm && g_stacklessCallsEnabled.load(std::memory_order_relaxed);
+    std::vector<SuspendedFrame> suspended;
+    bool resuming = false;
+    bool resumeVerified = false;
+    size_t previousOp = kNoPreviousOp;
+    // Finally handlers being run, of all frames; the current frame's start
+    // at `pendingBase`. Endfinally rethrowing an exception has the search for
+    // its handler go on from `unwindFrom` at `unwindPc` instead.
+    std::vector<PendingFinally> pending;
+    size_t pendingBase = 0;
+    size_t unwindPc = kNoHandler;
+    size_t unwindFrom = 0;
+
+enterBody:
+    const PreparedMethod& prepared = *body;
+    context->EnsureLocals(prepared.localCount);
+
+    BytecodeInstruction* code = prepared.code.data();
+    const bool runVerified = resuming ? resumeVerified : CanRunVerified(prepared, *context);
+    resuming = false;
+    if (runVerified) {
+        code = prepared.verifiedCode.data();
+        context->ReserveStack(prepared.maxStackDepth);
+    }
+    // Tiering (see TieredExecution). The method's profile counts every frame,
+    // but native code is compiled for verified frames only, and only bodies
+    // past the Interpreter tier quicken.
+    MethodProfile unprofiled;
+    const MethodRef& frameMethod = context->GetMethod();
+    MethodProfile& profile = frameMethod ? frameMethod->GetProfile() : unprofiled;
+    const bool tiering = runVerified && !prepared.nativeCodeRejected && JitCompiler::IsEnabled();
+    const bool quickening = prepared.tier != ExecutionTier::Interpreter;
+    bool promoting = !quickening && frameMethod && TieredExecution::IsEnabled();
+    size_t pc = entry;
+    const bool profiling = g_dispatchProfiling;
+
+    // Diagnostics only need the location of the instruction that is executing
+    // when the frame is observed: on a call (callers show up in the call stack)
+    // or on an error. Recording it for every instruction is not worth the cost.
+    // Code inlined from a callee is located at the call.
+    auto recordLocation = [&](size_t at) { RecordLocation(prepared, at, *context); };
+
+    // OBJECTIR_OP(name) opens the handler of an opcode and OBJECTIR_NEXT()
+    // transfers control to the handler of code[pc]. Threaded builds jump
+    // straight from handler to handler; otherwise this is a switch in a loop.
+    // A computed goto does not run the destructors of the locals it leaves
+    // (GCC), so OBJECTIR_NEXT() must only appear where no Value, ObjectRef
+    // or other local with a destructor is in scope: handlers keep those in an
+    // inner block that closes before it.
+    // While profiling, every opcode goes through `profileDispatch` first.
+    // Keeping that check out of the handlers keeps each jump short enough for
+    // the compiler to leave one in every handler instead of merging them.
+#if OBJECTIR_COMPUTED_GOTO
+#define OBJECTIR_LABEL_ADDRESS(name) &&op_##name,
+#define OBJECTIR_PROFILE_ADDRESS(name) &&profileDispatch,
+    static void* const kDispatchTable[] = { OBJECTIR_BYTECODE_OPS(OBJECTIR_LABEL_ADDRESS) };
+    static void* const kProfilingTable[] = { OBJECTIR_BYTECODE_OPS(OBJECTIR_PROFILE_ADDRESS) };
+#undef OBJECTIR_PROFILE_ADDRESS
+#undef OBJECTIR_LABEL_ADDRESS
+    void* const* const dispatchTable = profiling ? kProfilingTable : kDispatchTable;
+#define OBJECTIR_OP(name) op_##name:
+#define OBJECTIR_NEXT() goto *dispatchTable[static_cast<size_t>(code[pc].op)]
+#else
+#define OBJECTIR_OP(name) case BytecodeOp::name:
+#define OBJECTIR_NEXT() continue
+#endif
+
+    try {
+        if (tiering && (prepared.nativeCode || profile.invocations >= JitCompiler::GetInvocationThreshold())) {
+            RunNative(prepared, *context, vm, pc);
+        }
+#if OBJECTIR_COMPUTED_GOTO
+        OBJECTIR_NEXT();
+    profileDispatch:
+        RecordDispatch(previousOp, code[pc].op);
+        goto *kDispatchTable[static_cast<size_t>(code[pc].op)];
+#else
+        for (;;) {
+        if (profiling) RecordDispatch(previousOp, code[pc].op);
+        switch (code[pc].op) {
+#endif
+
+        OBJECTIR_OP(Nop) {
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(Dup) {
+            context->PushStack(context->PeekStack());
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(Pop) {
+            (void)context->PopStack();
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdArg) {
+            context->PushStack(context->GetArgument(static_cast<size_t>(code[pc].a)));
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdThis) {
+            context->PushStack(Value(context->GetThis()));
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(StArg) {
+            context->SetArgument(static_cast<size_t>(code[pc].a), context->PopStack());
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdLoc) {
+            context->PushStack(context->GetLocal(static_cast<size_t>(code[pc].a)));
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(StLoc) {
+            context->SetLocal(static_cast<size_t>(code[pc].a), context->PopStack());
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdFld) {
+            {
+                ObjectRef instance = PopFieldInstance(context);
+                if (!instance) {
+                    throw std::runtime_error("LdFld requires an object instance on the stack or a valid 'this' in the context");
+                }
+                const FieldSite& site = prepared.fieldSites[code[pc].a];
+                const size_t slot = ResolveFieldSite(site, *instance);
+                if (slot != Class::kNoFieldSlot) {
+                    context->PushStack(instance->GetSlot(slot));
+                } else {
+                    context->PushStack(instance->GetField(site.symbol));
+                }
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(StFld) {
+            {
+                auto value = context->PopStack();
+                ObjectRef instance = PopFieldInstance(context);
+                if (!instance) {
+                    throw std::runtime_error("StFld requires an object instance on the stack or a valid 'this' in the context");
+                }
+                const FieldSite& site = prepared.fieldSites[code[pc].a];
+                const size_t slot = ResolveFieldSite(site, *instance);
+                if (slot != Class::kNoFieldSlot) {
+                    instance->SetSlot(slot, value);
+                } else {
+                    instance->SetField(site.symbol, value);
+                }
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdConst) {
+            context->PushStack(prepared.constants[code[pc].a]);
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdNull) {
+            context->PushStack(Value());
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        // Generic arithmetic and compares; see QuickenBinary.
+#define OBJECTIR_QUICKENING_OP(name, int32Form, float64Form)                                 \
+        OBJECTIR_OP(name) {                                                                  \
+            if (quickening) QuickenBinary(code[pc], *context, BytecodeOp::int32Form, BytecodeOp::float64Form); \
+            Execute##name(context);                                                          \
+            ++pc;                                                                            \
+            OBJECTIR_NEXT();                                                                 \
+        }
+        OBJECTIR_QUICKENING_OP(Add, AddI32, AddF64)
+        OBJECTIR_QUICKENING_OP(Sub, SubI32, SubF64)
+        OBJECTIR_QUICKENING_OP(Mul, MulI32, MulF64)
+        OBJECTIR_QUICKENING_OP(Div, Nop, DivF64)
+        OBJECTIR_QUICKENING_OP(Ceq, CeqI32, Nop)
+        OBJECTIR_QUICKENING_OP(Cne, CneI32, Nop)
+        OBJECTIR_QUICKENING_OP(Clt, CltI32, Nop)
+        OBJECTIR_QUICKENING_OP(Cle, CleI32, Nop)
+        OBJECTIR_QUICKENING_OP(Cgt, CgtI32, Nop)
+        OBJECTIR_QUICKENING_OP(Cge, CgeI32, Nop)
+#undef OBJECTIR_QUICKENING_OP
+        OBJECTIR_OP(Rem) { ExecuteRem(context); ++pc; OBJECTIR_NEXT(); }
+        OBJECTIR_OP(Neg) { ExecuteNeg(context); ++pc; OBJECTIR_NEXT(); }
+
+        // Quickened forms: tag guard, then the typed operation. A failed guard
+        // deoptimizes the instruction and runs the generic handler.
+#define OBJECTIR_QUICK_BINARY(name, generic, guard, Type, accessor, expr)                    \
+        OBJECTIR_OP(name) {                                                                  \
+            if (guard(*context)) {                                                           \
+                Value* end = context->UncheckedStackEnd();                                   \
+                const Type left = end[-2].accessor();                                        \
+                const Type right = end[-1].accessor();                                       \
+                end[-2] = Value(expr);                                                       \
+                context->UncheckedDrop(1);                                                   \
+            } else {                                                                         \
+                Deoptimize(code[pc], BytecodeOp::generic);                                   \
+                Execute##generic(context);                                                   \
+            }                                                                                \
+            ++pc;                                                                            \
+            OBJECTIR_NEXT();                                                                 \
+        }
+        OBJECTIR_QUICK_BINARY(AddI32, Add, TopTwoAreInt32, int32_t, UncheckedInt32, left + right)
+        OBJECTIR_QUICK_BINARY(SubI32, Sub, TopTwoAreInt32, int32_t, UncheckedInt32, left - right)
+        OBJECTIR_QUICK_BINARY(MulI32, Mul, TopTwoAreInt32, int32_t, UncheckedInt32, left * right)
+        OBJECTIR_QUICK_BINARY(AddF64, Add, TopTwoAreFloat64, double, UncheckedFloat64, left + right)
+        OBJECTIR_QUICK_BINARY(SubF64, Sub, TopTwoAreFloat64, double, UncheckedFloat64, left - right)
+        OBJECTIR_QUICK_BINARY(MulF64, Mul, TopTwoAreFloat64, double, UncheckedFloat64, left * right)
+        OBJECTIR_QUICK_BINARY(DivF64, Div, TopTwoAreFloat64, double, UncheckedFloat64, left / right)
+        OBJECTIR_QUICK_BINARY(CeqI32, Ceq, TopTwoAreInt32, int32_t, UncheckedInt32, left == right)
+        OBJECTIR_QUICK_BINARY(CneI32, Cne, TopTwoAreInt32, int32_t, UncheckedInt32, left != right)
+        OBJECTIR_QUICK_BINARY(CltI32, Clt, TopTwoAreInt32, int32_t, UncheckedInt32, left < right)
+        OBJECTIR_QUICK_BINARY(CleI32, Cle, TopTwoAreInt32, int32_t, UncheckedInt32, left <= right)
+        OBJECTIR_QUICK_BINARY(CgtI32, Cgt, TopTwoAreInt32, int32_t, UncheckedInt32, left > right)
+        OBJECTIR_QUICK_BINARY(CgeI32, Cge, TopTwoAreInt32, int32_t, UncheckedInt32, left >= right)
+#undef OBJECTIR_QUICK_BINARY
+
+
+        // Typed forms from the verified stream: both operands are int32.
+#define OBJECTIR_INT32_BINARY(name, expr)                                                    \
+        OBJECTIR_OP(name) {                                                                  \
+            Value* end = context->UncheckedStackEnd();                                       \
+            const int32_t left = end[-2].UncheckedInt32();                                   \
+            const int32_t right = end[-1].UncheckedInt32();                                  \
+            end[-2] = Value(expr);                                                           \
+            context->UncheckedDrop(1);                                                       \
+            ++pc;                                                                            \
+            OBJECTIR_NEXT();                                                                 \
+        }
+        OBJECTIR_INT32_BINARY(AddI32Unchecked, left + right)
+        OBJECTIR_INT32_BINARY(SubI32Unchecked, left - right)
+        OBJECTIR_INT32_BINARY(MulI32Unchecked, left * right)
+        OBJECTIR_INT32_BINARY(CeqI32Unchecked, left == right)
+        OBJECTIR_INT32_BINARY(CneI32Unchecked, left != right)
+        OBJECTIR_INT32_BINARY(CltI32Unchecked, left < right)
+        OBJECTIR_INT32_BINARY(CleI32Unchecked, left <= right)
+        OBJECTIR_INT32_BINARY(CgtI32Unchecked, left > right)
+        OBJECTIR_INT32_BINARY(CgeI32Unchecked, left >= right)
+#undef OBJECTIR_INT32_BINARY
+
+#define OBJECTIR_INT32_BRANCH(name, cond)                                                    \
+        OBJECTIR_OP(name) {                                                                  \
+            Value* end = context->UncheckedStackEnd();                                       \
+            const int32_t left = end[-2].UncheckedInt32();                                   \
+            const int32_t right = end[-1].UncheckedInt32();                                  \
+            context->UncheckedDrop(2);                                                       \
+            pc = (cond) ? static_cast<size_t>(code[pc].a) : pc + 1;                          \
+            OBJECTIR_NEXT();                                                                 \
+        }
+        OBJECTIR_INT32_BRANCH(BeqI32Unchecked, left == right)
+        OBJECTIR_INT32_BRANCH(BneI32Unchecked, left != right)
+        OBJECTIR_INT32_BRANCH(BgtI32Unchecked, left > right)
+        OBJECTIR_INT32_BRANCH(BltI32Unchecked, left < right)
+        OBJECTIR_INT32_BRANCH(BgeI32Unchecked, left >= right)
+        OBJECTIR_INT32_BRANCH(BleI32Unchecked, left <= right)
+#undef OBJECTIR_INT32_BRANCH
+
+        // Superinstructions (see FuseSuperinstructions). When the fast path
+        // does not apply, the first instruction of the sequence runs on its own
+        // and execution continues with the (intact) second one.
+        OBJECTIR_OP(LdLocLdConstArithStLoc)
+        OBJECTIR_OP(LdLocLdLocArithStLoc)
+        OBJECTIR_OP(LdLocLdConstArith)
+        OBJECTIR_OP(LdLocLdLocArith) {
+            const BytecodeInstruction& instr = code[pc];
+            const Value& left = context->UncheckedLocal(static_cast<size_t>(instr.a));
+            const bool constantOperand = instr.op == BytecodeOp::LdLocLdConstArithStLoc ||
+                                         instr.op == BytecodeOp::LdLocLdConstArith;
+            const Value& right = constantOperand ? prepared.constants[code[pc + 1].a]
+                                                 : context->UncheckedLocal(static_cast<size_t>(code[pc + 1].a));
+            int32_t result;
+            if (left.IsInt32() && right.IsInt32() &&
+                TryArithmeticInt32(static_cast<BytecodeOp>(instr.b), left.UncheckedInt32(), right.UncheckedInt32(), result)) {
+                if (instr.op == BytecodeOp::LdLocLdConstArithStLoc || instr.op == BytecodeOp::LdLocLdLocArithStLoc) {
+                    context->UncheckedLocal(static_cast<size_t>(code[pc + 3].a)) = Value(result);
+                    pc += 4;
+                } else {
+                    context->PushStack(Value(result));
+                    pc += 3;
+                }
+            } else {
+                context->PushStack(left);
+                ++pc;
+            }
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdLocLdArgBranch)
+        OBJECTIR_OP(LdLocLdConstBranch)
+        OBJECTIR_OP(LdLocLdLocBranch) {
+            const BytecodeInstruction& instr = code[pc];
+            const Value& left = context->UncheckedLocal(static_cast<size_t>(instr.a));
+            const size_t operand = static_cast<size_t>(code[pc + 1].a);
+            const Value* right;
+            if (instr.op == BytecodeOp::LdLocLdConstBranch) {
+                right = &prepared.constants[operand];
+            } else if (instr.op == BytecodeOp::LdLocLdLocBranch) {
+                right = &context->UncheckedLocal(operand);
+            } else {
+                right = operand < context->GetArgumentCount() ? &context->UncheckedArgument(operand) : nullptr;
+            }
+            if (right && left.IsInt32() && right->IsInt32()) {
+                pc = CompareInt32(static_cast<BytecodeOp>(instr.b), left.UncheckedInt32(), right->UncheckedInt32())
+                    ? static_cast<size_t>(code[pc + 2].a) : pc + 3;
+            } else {
+                context->PushStack(left);
+                ++pc;
+            }
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdThisLdFld) {
+            const ObjectRef& instance = context->GetThis();
+            if (!instance) {
+                context->PushStack(Value(instance));
+                ++pc;
+                OBJECTIR_NEXT();
+            }
+            ++pc; // errors belong to the LdFld
+            const FieldSite& site = prepared.fieldSites[code[pc].a];
+            const size_t slot = ResolveFieldSite(site, *instance);
+            if (slot != Class::kNoFieldSlot) {
+                context->PushStack(instance->GetSlot(slot));
+            } else {
+                context->PushStack(instance->GetField(site.symbol));
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdLocLdFld) {
+            {
+                const Value& local = context->UncheckedLocal(static_cast<size_t>(code[pc].a));
+                ObjectRef instance = local.IsObject() ? local.AsObject() : nullptr;
+                if (!instance) {
+                    context->PushStack(local);
+                } else {
+                    ++pc; // errors belong to the LdFld
+                    const FieldSite& site = prepared.fieldSites[code[pc].a];
+                    const size_t slot = ResolveFieldSite(site, *instance);
+                    if (slot != Class::kNoFieldSlot) {
+                        context->PushStack(instance->GetSlot(slot));
+                    } else {
+                        context->PushStack(instance->GetField(site.symbol));
+                    }
+                }
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdConstStLoc) {
+            context->UncheckedLocal(static_cast<size_t>(code[pc + 1].a)) = prepared.constants[code[pc].a];
+            pc += 2;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(Ret) {
+            Value result = context->GetStackDepth() > 0 ? context->PopStack() : Value();
+            if (suspended.empty()) {
+                return result;
+            }
+            // Back to the suspended caller, finishing the call as
+            // ExecuteCallSite does.
+            SuspendedFrame& caller = suspended.back();
+            vm->PopFrame();
+            pending.erase(pending.begin() + static_cast<ptrdiff_t>(pendingBase), pending.end());
+            pendingBase = caller.pendingBase;
+            context = caller.context;
+            if (caller.isVirtual) {
+                (void)context->PopStack(); // the instance
+            }
+            if (!caller.site->isVoidReturn) {
+                context->PushStack(caller.calleeReturnsVoid ? Value() : std::move(result));
+            }
+            held = std::move(caller.held);
+            body = caller.body;
+            entry = caller.resume;
+            previousOp = caller.previousOp;
+            resumeVerified = caller.verified;
+            resuming = true;
+            suspended.pop_back();
+            goto enterBody;
+        }
+
+        OBJECTIR_OP(Br) {
+            const size_t target = static_cast<size_t>(code[pc].a);
+            const bool backEdge = target <= pc;
+            pc = target;
+            if (backEdge) {
+                ++profile.backEdges;
+                if (tiering && (prepared.nativeCode || profile.backEdges >= JitCompiler::GetBackEdgeThreshold())) {
+                    RunNative(prepared, *context, vm, pc);
+                } else if (promoting && profile.backEdges >= TieredExecution::GetBackEdgeThreshold()) {
+                    promoting = false;
+                    next = TieredExecution::Optimize(*frameMethod, vm);
+                    entry = FindLoopEntry(prepared, *next, pc, *context);
+                    if (entry != kNoLoopEntry) {
+                        goto switchBody;
+                    }
+                }
+            }
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(BrTrue) {
+            if (quickening) QuickenBool(code[pc], *context, BytecodeOp::BrTrueBool);
+            pc = ValueToBool(context->PopStack()) ? static_cast<size_t>(code[pc].a) : pc + 1;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(BrFalse) {
+            if (quickening) QuickenBool(code[pc], *context, BytecodeOp::BrFalseBool);
+            pc = !ValueToBool(context->PopStack()) ? static_cast<size_t>(code[pc].a) : pc + 1;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(BrTrueBool)
+        OBJECTIR_OP(BrFalseBool) {
+            const bool branchIfTrue = code[pc].op == BytecodeOp::BrTrueBool;
+            bool value;
+            if (context->GetStackDepth() >= 1 && context->UncheckedStackEnd()[-1].IsBool()) {
+                value = context->UncheckedStackEnd()[-1].UncheckedBool();
+                context->UncheckedDrop(1);
+            } else {
+                Deoptimize(code[pc], branchIfTrue ? BytecodeOp::BrTrue : BytecodeOp::BrFalse);
+                value = ValueToBool(context->PopStack());
+            }
+            pc = value == branchIfTrue ? static_cast<size_t>(code[pc].a) : pc + 1;
+            OBJECTIR_NEXT();
+        }
+
+#define OBJECTIR_COMPARE_BRANCH(name, int32Form)                                             \
+        OBJECTIR_OP(name) {                                                                  \
+            if (quickening) QuickenBinary(code[pc], *context, BytecodeOp::int32Form, BytecodeOp::Nop); \
+            bool taken;                                                                      \
+            {                                                                                \
+                auto right = context->PopStack();                                            \
+                auto left = context->PopStack();                                             \
+                taken = CompareBranch(OpCode::name, left, right);                            \
+            }                                                                                \
+            pc = taken ? static_cast<size_t>(code[pc].a) : pc + 1;                           \
+            OBJECTIR_NEXT();                                                                 \
+        }
+        OBJECTIR_COMPARE_BRANCH(Beq, BeqI32)
+        OBJECTIR_COMPARE_BRANCH(Bne, BneI32)
+        OBJECTIR_COMPARE_BRANCH(Bgt, BgtI32)
+        OBJECTIR_COMPARE_BRANCH(Blt, BltI32)
+        OBJECTIR_COMPARE_BRANCH(Bge, BgeI32)
+        OBJECTIR_COMPARE_BRANCH(Ble, BleI32)
+#undef OBJECTIR_COMPARE_BRANCH
+
+#define OBJECTIR_QUICK_COMPARE_BRANCH(name, generic, cond)                                   \
+        OBJECTIR_OP(name) {                                                                  \
+            bool taken;                                                                      \
+            if (TopTwoAreInt32(*context)) {                                                  \
+                Value* end = context->UncheckedStackEnd();                                   \
+                const int32_t left = end[-2].UncheckedInt32();                               \
+                const int32_t right = end[-1].UncheckedInt32();                              \
+                context->UncheckedDrop(2);                                                   \
+                taken = (cond);                                                              \
+            } else {                                                                         \
+                Deoptimize(code[pc], BytecodeOp::generic);                                   \
+                auto right = context->PopStack();                                            \
+                auto left = context->PopStack();                                             \
+                taken = CompareBranch(OpCode::generic, left, right);                         \
+            }                                                                                \
+            pc = taken ? static_cast<size_t>(code[pc].a) : pc + 1;                           \
+            OBJECTIR_NEXT();                                                                 \
+        }
+        OBJECTIR_QUICK_COMPARE_BRANCH(BeqI32, Beq, left == right)
+        OBJECTIR_QUICK_COMPARE_BRANCH(BneI32, Bne, left != right)
+        OBJECTIR_QUICK_COMPARE_BRANCH(BgtI32, Bgt, left > right)
+        OBJECTIR_QUICK_COMPARE_BRANCH(BltI32, Blt, left < right)
+        OBJECTIR_QUICK_COMPARE_BRANCH(BgeI32, Bge, left >= right)
+        OBJECTIR_QUICK_COMPARE_BRANCH(BleI32, Ble, left <= right)
+#undef OBJECTIR_QUICK_COMPARE_BRANCH
+
+        OBJECTIR_OP(NewObj) {
+            {
+                auto classRef = ResolveTypeSiteClass(prepared.typeSites[code[pc].a], vm);
+                context->PushStack(Value(vm->CreateObject(classRef)));
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(NewArr) {
+            {
+                const auto lengthValue = context->PopStack();
+                const int32_t length = static_cast<int32_t>(ValueToInt64(lengthValue));
+                if (length < 0) {
+                    throw std::runtime_error("NewArr length must be non-negative");
+                }
+                const auto& elementType = ResolveTypeSiteType(prepared.typeSites[code[pc].a], vm);
+                ObjectRef arrayObject = vm->CreateArray(elementType, length);
+                context->PushStack(Value(arrayObject));
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdLen) {
+            {
+                const auto arrayValue = context->PopStack();
+                if (!arrayValue.IsObject()) {
+                    throw std::runtime_error("LdLen requires an array object on the stack");
+                }
+                auto arrayObj = std::dynamic_pointer_cast<Array>(arrayValue.AsObject());
+                if (!arrayObj) {
+                    throw std::runtime_error("LdLen requires an Array instance");
+                }
+                context->PushStack(Value(arrayObj->GetArrayLength()));
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(LdElem) {
+            {
+                const auto indexValue = context->PopStack();
+                const auto arrayValue = context->PopStack();
+                if (!arrayValue.IsObject()) {
+                    throw std::runtime_error("LdElem requires an array object on the stack");
+                }
+                auto arrayObj = std::dynamic_pointer_cast<Array>(arrayValue.AsObject());
+                if (!arrayObj) {
+                    throw std::runtime_error("LdElem requires an Array instance");
+                }
+                const int32_t index = static_cast<int32_t>(ValueToInt64(indexValue));
+                context->PushStack(arrayObj->GetElement(index));
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(StElem) {
+            {
+                const auto valueToStore = context->PopStack();
+                const auto indexValue = context->PopStack();
+                const auto arrayValue = context->PopStack();
+                if (!arrayValue.IsObject()) {
+                    throw std::runtime_error("StElem requires an array object on the stack");
+                }
+                auto arrayObj = std::dynamic_pointer_cast<Array>(arrayValue.AsObject());
+                if (!arrayObj) {
+                    throw std::runtime_error("StElem requires an Array instance");
+                }
+                const int32_t index = static_cast<int32_t>(ValueToInt64(indexValue));
+                arrayObj->SetElement(index, valueToStore);
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(CastClass)
+        OBJECTIR_OP(IsInst) {
+            {
+                const TypeSite& site = prepared.typeSites[code[pc].a];
+                const auto value = context->PopStack();
+
+                bool ok = value.IsNull() || MatchesPrimitiveTypeName(site.normalizedName, value);
+                if (!ok && value.IsObject()) {
+                    auto classRef = TryResolveTypeSiteClass(site, vm);
+                    auto obj = value.AsObject();
+                    ok = classRef && obj && obj->IsInstanceOf(classRef);
+                }
+
+                if (code[pc].op == BytecodeOp::IsInst) {
+                    context->PushStack(ok ? value : Value());
+                } else if (!ok) {
+                    throw std::runtime_error("Invalid cast to '" + site.name + "'");
+                } else {
+                    context->PushStack(value);
+                }
+            }
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(Call)
+        OBJECTIR_OP(CallVirt) {
+            recordLocation(pc);
+            const CallSite& site = prepared.callSites[code[pc].a];
+            const bool isVirtual = code[pc].op == BytecodeOp::CallVirt;
+            if (stackless) {
+                bool calleeReturnsVoid = false;
+                next = EnterCall(site, isVirtual, *context, vm, calleeReturnsVoid);
+                if (next) {
+                    suspended.push_back(SuspendedFrame{std::move(held), body, context, &site, pc + 1, previousOp,
+                                                       runVerified, isVirtual, calleeReturnsVoid, pendingBase});
+                    pendingBase = pending.size();
+                    context = vm->GetCurrentContext();
+                    entry = 0;
+                    goto switchBody;
+                }
+            }
+            ExecuteCallSite(site, isVirtual, context, vm);
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(TailCall)
+        OBJECTIR_OP(TailCallVirt) {
+            recordLocation(pc);
+            const CallSite& site = prepared.callSites[code[pc].a];
+            const bool isVirtual = code[pc].op == BytecodeOp::TailCallVirt;
+            next = EnterTailCall(site, isVirtual, *context, vm);
+            if (next) {
+                pending.erase(pending.begin() + static_cast<ptrdiff_t>(pendingBase), pending.end());
+                entry = 0;
+                goto switchBody;
+            }
+            ExecuteCallSite(site, isVirtual, context, vm);
+            ++pc;
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(Fail) {
+            throw std::runtime_error(prepared.messages[code[pc].a]);
+        }
+
+        OBJECTIR_OP(InlineGuard) {
+            const InlinedCall& call = prepared.inlinedCalls[static_cast<size_t>(code[pc].b)];
+            pc = InlinedCallHolds(prepared, call, *context, vm) ? pc + 1 : static_cast<size_t>(code[pc].a);
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(Throw) {
+            Value value = context->PopStack();
+            if (value.IsNull()) {
+                throw std::runtime_error("Cannot throw a null value");
+            }
+            throw IRException::FromValue(std::move(value));
+        }
+
+        OBJECTIR_OP(Leave) {
+            {
+                const size_t siteIndex = static_cast<size_t>(code[pc].a);
+                const LeaveSite& site = prepared.leaveSites[siteIndex];
+                Value result;
+                if (site.returns && context->GetStackDepth() > 0) {
+                    result = context->PopStack();
+                }
+                context->ResizeStack(0);
+                DropPendingFinally(pending, pendingBase, prepared, pc, site.target);
+                if (site.finallyHandlers.empty()) {
+                    pc = site.target;
+                    if (site.returns) {
+                        context->PushStack(std::move(result));
+                    }
+                } else {
+                    const size_t handler = site.finallyHandlers.front();
+                    pending.push_back(PendingFinally{handler, siteIndex, 0, std::nullopt, 0, std::move(result)});
+                    pc = prepared.handlers[handler].handlerStart;
+                }
+            }
+            OBJECTIR_NEXT();
+        }
+
+        OBJECTIR_OP(EndFinally) {
+            if (pending.size() == pendingBase) {
+                throw std::runtime_error("endfinally outside of a finally handler");
+            }
+            context->ResizeStack(0);
+            PendingFinally& top = pending.back();
+            if (top.exception) {
+                IRException exception = std::move(*top.exception);
+                unwindPc = top.throwPc;
+                unwindFrom = top.handler + 1;
+                pending.pop_back();
+                throw exception;
+            }
+            const LeaveSite& site = prepared.leaveSites[top.leaveSite];
+            if (++top.step < site.finallyHandlers.size()) {
+                top.handler = site.finallyHandlers[top.step];
+                pc = prepared.handlers[top.handler].handlerStart;
+            } else {
+                pc = site.target;
+                if (site.returns) {
+                    context->PushStack(std::move(top.result));
+                }
+                pending.pop_back();
+            }
+            OBJECTIR_NEXT();
+        }
+
+#if !OBJECTIR_COMPUTED_GOTO
+        }
+        }
+#endif
+    } catch (const std::exception& ex) {
+        // Look for a handler in the frames the error leaves, innermost first.
+        // Frames of stackless calls pass it on as their native frames would
+        // have: each failed frame stays on the call stack (see
+        // VirtualMachine::RunFrame) until a handler takes the error.
+        const auto* raised = dynamic_cast<const IRException*>(&ex);
+        IRException exception = raised ? *raised : IRException(ex.what());
+        const PreparedMethod* frameBody = &prepared;
+        size_t throwPc = pc;
+        size_t from = 0;
+        if (unwindPc != kNoHandler) {
+            throwPc = unwindPc;
+            from = unwindFrom;
+            unwindPc = kNoHandler;
+        }
+        bool frameVerified = runVerified;
+        for (;;) {
+            const size_t index = frameBody->handlers.empty()
+                ? kNoHandler
+                : FindHandler(*frameBody, throwPc, from, exception.GetValue(), vm);
+            if (index != kNoHandler) {
+                const PreparedHandler& handler = frameBody->handlers[index];
+                DropPendingFinally(pending, pendingBase, *frameBody, throwPc, handler.handlerStart);
+                if (vm) {
+                    vm->UnwindTo(context);
+                }
+                context->ResizeStack(0);
+                if (handler.kind == ExceptionHandlerKind::Catch) {
+                    context->PushStack(exception.GetValue());
+                } else {
+                    pending.push_back(PendingFinally{index, 0, 0, std::move(exception), throwPc});
+                }
+                body = frameBody;
+                entry = handler.handlerStart;
+                resumeVerified = frameVerified;
+                resuming = true;
+                previousOp = kNoPreviousOp;
+                goto enterBody;
+            }
+            pending.erase(pending.begin() + static_cast<ptrdiff_t>(pendingBase), pending.end());
+            LeaveFrame(exception, *frameBody, throwPc, *context, vm);
+            if (suspended.empty()) {
+                break;
+            }
+            context->Detach();
+            SuspendedFrame& caller = suspended.back();
+            context = caller.context;
+            held = std::move(caller.held);
+            frameBody = caller.body;
+            throwPc = caller.resume - 1;
+            from = 0;
+            frameVerified = caller.verified;
+            pendingBase = caller.pendingBase;
+            suspended.pop_back();
+        }
+        throw exception;
+    }
+
+switchBody:
+    held = std::move(next);
+    body = held.get();
+    previousOp = kNoPreviousOp;
+    goto enterBody;
+
+#undef OBJECTIR_OP
+#undef OBJECTIR_NEXT
+}
+
+void InstructionExecutor::ExecuteCallSite(
+    const CallSite& site,
+    bool isVirtual,
+    ExecutionContext* context,
+    VirtualMachine* vm
+) {
+    if (site.isConsoleWriteLine) {
+        std::vector<Value> callArgs(site.argumentCount);
+        for (size_t i = site.argumentCount; i-- > 0;) {
+            callArgs[i] = context->PopStack();
+        }
+        WriteConsoleLine(vm, callArgs);
+        return;
+    }
+
+    // Arguments stay on the operand stack; the callee frame takes them
+    // in place (see VirtualMachine::InvokeWithStackArguments).
+    Value result;
+    if (isVirtual) {
+        auto instanceValue = context->PeekStack(site.argumentCount);
+        if (!instanceValue.IsObject()) {
+            throw std::runtime_error("CallVirt requires object instance on stack");
+        }
+        auto instance = instanceValue.AsObject();
+        if (!instance || !instance->GetClass()) {
+            throw std::runtime_error("Cannot invoke method on null object");
+        }
+        auto method = ResolveVirtualCallSite(site, instance->GetClass(), vm);
+        result = vm->InvokeWithStackArguments(method, std::move(instance), context, site.argumentCount);
+        (void)context->PopStack(); // the instance
+    } else {
+        result = vm->InvokeWithStackArguments(ResolveStaticCallSite(site, vm), nullptr, context, site.argumentCount);
+    }
+
+    if (!site.isVoidReturn) {
+        context->PushStack(result);
+    }
+}
+
+Value InstructionExecutor::InvokeStaticCallSite(
+    const CallSite& site,
+    const std::vector<Value>& args,
+    VirtualMachine* vm
+) {
+    if (site.isConsoleWriteLine) {
+        WriteConsoleLine(vm, args);
+        return Value();
+    }
+    Value result = vm->InvokeResolved(ResolveStaticCallSite(site, vm), nullptr, args);
+    return site.isVoidReturn ? Value() : result;
+}
+
+const char* GetBytecodeOpName(BytecodeOp op) {
+#define OBJECTIR_BYTECODE_NAME_ENTRY(name) #name,
+    static const char* const kNames[] = { OBJECTIR_BYTECODE_OPS(OBJECTIR_BYTECODE_NAME_ENTRY) };
+#undef OBJECTIR_BYTECODE_NAME_ENTRY
+    const size_t index = static_cast<size_t>(op);
+    return index < kBytecodeOpCount ? kNames[index] : "<invalid>";
+}
+
+void DispatchProfile::SetEnabled(bool enabled) {
+    g_dispatchProfiling = enabled;
+}
+
+bool DispatchProfile::IsEnabled() {
+    return g_dispatchProfiling;
+}
+
+void DispatchProfile::Reset() {
+    g_dispatchCount = 0;
+    for (auto& row : g_opcodePairCounts) {
+        std::fill(std::begin(row), std::end(row), 0);
+    }
+}
+
+uint64_t DispatchProfile::GetDispatchCount() {
+    return g_dispatchCount;
+}
+
+std::vector<OpcodePairCount> DispatchProfile::GetPairCounts() {
+    std::vector<OpcodePairCount> pairs;
+    for (size_t first = 0; first < kBytecodeOpCount; ++first) {
+        for (size_t second = 0; second < kBytecodeOpCount; ++second) {
+            if (g_opcodePairCounts[first][second] != 0) {
+                pairs.push_back(OpcodePairCount{static_cast<BytecodeOp>(first), static_cast<BytecodeOp>(second),
+                                                g_opcodePairCounts[first][second]});
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const OpcodePairCount& a, const OpcodePairCount& b) {
+        return a.count > b.count;
+    });
+    return pairs;
+}
+
+void InstructionExecutor::SetStacklessCallsEnabled(bool enabled) {
+    g_stacklessCallsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool InstructionExecutor::AreStacklessCallsEnabled() {
+    return g_stacklessCallsEnabled.load(std::memory_order_relaxed);
+}
+
+const char* InstructionExecutor::GetDispatchMode() {
+#if OBJECTIR_COMPUTED_GOTO
+    return "threaded";
+#else
+    return "switch";
+#endif
+}
+
+bool InstructionExecutor::CompareBranch(OpCode cmp, const Value& left, const Value& right) {
+    switch (cmp) {
+        case OpCode::Beq:
+            if (left.IsString() && right.IsString()) return left.AsStringRef() == right.AsStringRef();
+            if (left.IsBool() && right.IsBool()) return left.AsBool() == right.AsBool();
+            if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) == ValueToInt64(right);
+            return ValueToDouble(left) == ValueToDouble(right);
+        case OpCode::Bne:
+            if (left.IsString() && right.IsString()) return left.AsStringRef() != right.AsStringRef();
+            if (left.IsBool() && right.IsBool()) return left.AsBool() != right.AsBool();
+            if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) != ValueToInt64(right);
+            return ValueToDouble(left) != ValueToDouble(right);
+        case OpCode::Bgt:
+            if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) > ValueToInt64(right);
+            return ValueToDouble(left) > ValueToDouble(right);
+        case OpCode::Blt:
+            if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) < ValueToInt64(right);
+            return ValueToDouble(left) < ValueToDouble(right);
+        case OpCode::Bge:
+            if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) >= ValueToInt64(right);
+            return ValueToDouble(left) >= ValueToDouble(right);
+        case OpCode::Ble:
+            if ((left.IsInt32() || left.IsInt64()) && (right.IsInt32() || right.IsInt64())) return ValueToInt64(left) <= ValueToInt64(right);
+            return ValueToDouble(left) <= ValueToDouble(right);
+        default:
+            return false;
+    }
+}
+
+void InstructionExecutor::ExecuteBinaryWhile(
+    const Instruction::WhileData& whileData,
+    const Instruction* setupInstructions,
+    size_t setupCount,
+    ExecutionContext* context,
+    VirtualMachine* vm
+) {
+    while (true) {
+        for (size_t i = 0; i < setupCount; ++i) {
+            Execute(setupInstructions[i], context, vm);
+        }
+
+        if (whileData.condition.comparisonOp == OpCode::Nop) {
+            throw std::runtime_error("Binary condition missing comparison operation");
+        }
+
+        switch (whileData.condition.comparisonOp) {
+            case OpCode::Ceq: ExecuteCeq(context); break;
+            case OpCode::Cne: ExecuteCne(context); break;
+            case OpCode::Clt: ExecuteClt(context); break;
+            case OpCode::Cle: ExecuteCle(context); break;
+            case OpCode::Cgt: ExecuteCgt(context); break;
+            case OpCode::Cge: ExecuteCge(context); break;
+            default:
+                throw std::runtime_error("Unsupported comparison opcode in binary condition");
+        }
+
+        if (!ValueToBool(context->PopStack())) {
+            break;
+        }
+
+        if (ExecuteBlock(whileData.body, context, vm) == BlockExit::Break) {
+            break;
+        }
+    }
+}
+
+InstructionExecutor::BlockExit InstructionExecutor::ExecuteBlock(
+    const std::vector<Instruction>& block,
+    ExecutionContext* context,
+    VirtualMachine* vm
+) {
+    for (const auto& instr : block) {
+        switch (instr.opCode) {
+            case OpCode::Break:
+                return BlockExit::Break;
+            case OpCode::Continue:
+                return BlockExit::Continue;
+            case OpCode::While:
+            case OpCode::If: {
+                const BlockExit exit = ExecuteStructured(instr, context, vm);
+                if (exit != BlockExit::Normal) {
+                    return exit;
+                }
+                break;
+            }
+            default:
+                Execute(instr, context, vm);
+                break;
+        }
+    }
+    return BlockExit::Normal;
+}
+
+InstructionExecutor::BlockExit InstructionExecutor::ExecuteStructured(
+    const Instruction& instr,
+    ExecutionContext* context,
+    VirtualMachine* vm
+) {
+    if (instr.opCode == OpCode::While) {
+        if (!instr.whileData.has_value()) {
+            throw std::runtime_error("While instruction missing metadata");
+        }
+
+        const auto& whileData = instr.whileData.value();
+        while (true) {
+            bool condition = false;
+            // A break/continue in the condition belongs to the enclosing loop.
+            const BlockExit conditionExit = EvaluateCondition(whileData.condition, context, vm, condition);
+            if (conditionExit != BlockExit::Normal) {
+                return conditionExit;
+            }
+            if (!condition || ExecuteBlock(whileData.body, context, vm) == BlockExit::Break) {
+                break;
+            }
+        }
+        return BlockExit::Normal;
+    }
+
+    if (!instr.ifData.has_value()) {
+        throw std::runtime_error("If instruction missing metadata");
+    }
+
+    const auto& ifData = instr.ifData.value();
+
+    // Pop the condition value from the stack
+    Value conditionValue = context->PopStack();
+    if (ValueToBool(conditionValue)) {
+        return ExecuteBlock(ifData.thenBlock, context, vm);
+    }
+    return ExecuteBlock(ifData.elseBlock, context, vm);
+}
+
+double InstructionExecutor::ValueToDouble(const Value& v) {
+    if (v.IsInt32()) return static_cast<double>(v.AsInt32());
+    if (v.IsInt64()) return static_cast<double>(v.AsInt64());
+    if (v.IsFloat32()) return static_cast<double>(v.AsFloat32());
+    if (v.IsFloat64()) return v.AsFloat64();
+    throw std::runtime_error("Cannot convert value to double");
+}
+
+int64_t InstructionExecutor::ValueToInt64(const Value& v) {
+    if (v.IsInt32()) return static_cast<int64_t>(v.AsInt32());
+    if (v.IsInt64()) return v.AsInt64();
+    if (v.IsFloat32()) return static_cast<int64_t>(v.AsFloat32());
+    if (v.IsFloat64()) return static_cast<int64_t>(v.AsFloat64());
+    throw std::runtime_error("Cannot convert value to int64");
+}
+
+bool InstructionExecutor::EvaluateConstantOp(OpCode op, const Value* operands, size_t count, Value& result) {
+    auto isInteger = [](const Value& v) { return v.IsInt32() || v.IsInt64(); };
+
+    switch (op) {
+        case OpCode::Neg:
+            if (count != 1) return false;
+            // Negating the smallest integer overflows.
+            if (operands[0].IsInt32() && operands[0].AsInt32() == std::numeric_limits<int32_t>::min()) return false;
+            if (operands[0].IsInt64() && operands[0].AsInt64() == std::numeric_limits<int64_t>::min()) return false;
+            break;
+        case OpCode::Div:
+        case OpCode::Rem: {
+            if (count != 2) return false;
+            const Value& left = operands[0];
+            const Value& right = operands[1];
+            if (isInteger(left) && isInteger(right)) {
+                const int64_t divisor = ValueToInt64(right);
+                if (divisor == 0 || divisor == -1) return false;
+            } else if (op == OpCode::Rem || left.IsInt64() || right.IsInt64()) {
+                // Integer arithmetic on a truncated floating point operand.
+                return false;
+            }
+            break;
+        }
+        case OpCode::BrTrue:
+        case OpCode::BrFalse:
+            if (count != 1) return false;
+            result = Value(ValueToBool(operands[0]) == (op == OpCode::BrTrue));
+            return true;
+        case OpCode::Beq:
+        case OpCode::Bne:
+        case OpCode::Bgt:
+        case OpCode::Blt:
+        case OpCode::Bge:
+        case OpCode::Ble:
+            if (count != 2) return false;
+            try {
+                result = Value(CompareBranch(op, operands[0], operands[1]));
+            } catch (const std::exception&) {
+                return false;
+            }
+            return true;
+        default:
+            break;
+    }
+
+    static const MethodRef kEvaluationMethod = std::make_shared<Method>("<constant>", TypeReference::Void(), true);
+    ExecutionContext context(kEvaluationMethod);
+    for (size_t i = 0; i < count; ++i) {
+        context.PushStack(operands[i]);
+    }
+
+    try {
+        switch (op) {
+            case OpCode::Add: if (count != 2) return false; ExecuteAdd(&context); break;
+            case OpCode::Sub: if (count != 2) return false; ExecuteSub(&context); break;
+            case OpCode::Mul: if (count != 2) return false; ExecuteMul(&context); break;
+            case OpCode::Div: ExecuteDiv(&context); break;
+            case OpCode::Rem: ExecuteRem(&context); break;
+            case OpCode::Neg: ExecuteNeg(&context); break;
+            case OpCode::Ceq: if (count != 2) return false; ExecuteCeq(&context); break;
+            case OpCode::Cne: if (count != 2) return false; ExecuteCne(&context); break;
+            case OpCode::Clt: if (count != 2) return false; ExecuteClt(&context); break;
+            case OpCode::Cle: if (count != 2) return false; ExecuteCle(&context); break;
+            case OpCode::Cgt: if (count != 2) return false; ExecuteCgt(&context); break;
+            case OpCode::Cge: if (count != 2) return false; ExecuteCge(&context); break;
+            default: return false;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    // Neg of a non-numeric value pushes nothing.
+    if (context.GetStackDepth() != 1) {
+        return false;
+    }
+    result = context.PopStack();
+    return true;
+}
+
+void InstructionExecutor::ExecuteAdd(ExecutionContext* context) {
+    auto b = context->PopStack();
+    auto a = context->PopStack();
+    
+    if (a.IsString() || b.IsString()) {
+        // String concatenation
+        std::string result = a.AsStringRef() + b.AsStringRef();
+        context->PushStack(Value(result));
+    } else if (a.IsInt32() && b.IsInt32()) {
+        context->PushStack(Value(a.AsInt32() + b.AsInt32()));
+    } else if (a.IsInt64() || b.IsInt64()) {
+        context->PushStack(Value(ValueToInt64(a) + ValueToInt64(b)));
+    } else {
+        context->PushStack(Value(ValueToDouble(a) + ValueToDouble(b)));
+    }
+}
+
+void InstructionExecutor::ExecuteSub(ExecutionContext* context) {
+    auto b = context->PopStack();
+    auto a = context->PopStack();
+    
+    if (a.IsInt32() && b.IsInt32()) {
+        context->PushStack(Value(a.AsInt32() - b.AsInt32()));
+    } else if (a.IsInt64() || b.IsInt64()) {
+        context->PushStack(Value(ValueToInt64(a) - ValueToInt64(b)));
+    } else {
+        context->PushStack(Value(ValueToDouble(a) - ValueToDouble(b)));
+    }
+}
+
+void InstructionExecutor::ExecuteMul(ExecutionContext* context) {
+    auto b = context->PopStack();
+    auto a = context->PopStack();
     
     if (a.IsInt32() && b.IsInt32()) {
         context->PushStack(Value(a.AsInt32() * b.AsInt32()));
@@ -1192,9 +2956,13 @@ void InstructionExecutor::ExecuteDiv(ExecutionContext* context) {
     }
     
     if (a.IsInt32() && b.IsInt32()) {
-        context->PushStack(Value(a.AsInt32() / b.AsInt32()));
+        context->PushStack(Value(DivideWrapping(a.AsInt32(), b.AsInt32())));
     } else if (a.IsInt64() || b.IsInt64()) {
-        context->PushStack(Value(ValueToInt64(a) / ValueToInt64(b)));
+        const int64_t divisor = ValueToInt64(b);
+        if (divisor == 0) {
+            throw std::runtime_error("Division by zero");
+        }
+        context->PushStack(Value(DivideWrapping(ValueToInt64(a), divisor)));
     } else {
         context->PushStack(Value(ValueToDouble(a) / ValueToDouble(b)));
     }
@@ -1205,9 +2973,16 @@ void InstructionExecutor::ExecuteRem(ExecutionContext* context) {
     auto a = context->PopStack();
     
     if (a.IsInt32() && b.IsInt32()) {
-        context->PushStack(Value(a.AsInt32() % b.AsInt32()));
+        if (b.AsInt32() == 0) {
+            throw std::runtime_error("Division by zero");
+        }
+        context->PushStack(Value(RemainderWrapping(a.AsInt32(), b.AsInt32())));
     } else if (a.IsInt64() || b.IsInt64()) {
-        context->PushStack(Value(ValueToInt64(a) % ValueToInt64(b)));
+        const int64_t divisor = ValueToInt64(b);
+        if (divisor == 0) {
+            throw std::runtime_error("Division by zero");
+        }
+        context->PushStack(Value(RemainderWrapping(ValueToInt64(a), divisor)));
     } else {
         throw std::runtime_error("Modulo operation not supported for floating point");
     }
@@ -1237,7 +3012,7 @@ void InstructionExecutor::ExecuteCeq(ExecutionContext* context) {
     } else if ((a.IsInt32() || a.IsInt64()) && (b.IsInt32() || b.IsInt64())) {
         result = ValueToInt64(a) == ValueToInt64(b);
     } else if (a.IsString() && b.IsString()) {
-        result = a.AsString() == b.AsString();
+        result = a.AsStringRef() == b.AsStringRef();
     } else if (a.IsBool() && b.IsBool()) {
         result = a.AsBool() == b.AsBool();
     } else {
@@ -1257,7 +3032,7 @@ void InstructionExecutor::ExecuteCne(ExecutionContext* context) {
     } else if ((a.IsInt32() || a.IsInt64()) && (b.IsInt32() || b.IsInt64())) {
         result = ValueToInt64(a) != ValueToInt64(b);
     } else if (a.IsString() && b.IsString()) {
-        result = a.AsString() != b.AsString();
+        result = a.AsStringRef() != b.AsStringRef();
     } else if (a.IsBool() && b.IsBool()) {
         result = a.AsBool() != b.AsBool();
     } else {
@@ -1331,32 +3106,26 @@ void InstructionExecutor::ExecuteCge(ExecutionContext* context) {
     context->PushStack(Value(result));
 }
 
-bool InstructionExecutor::EvaluateCondition(
+InstructionExecutor::BlockExit InstructionExecutor::EvaluateCondition(
     const Instruction::ConditionData& condition,
     ExecutionContext* context,
-    VirtualMachine* vm
+    VirtualMachine* vm,
+    bool& result
 ) {
-    for (const auto& setupInstr : condition.setupInstructions) {
-        Execute(setupInstr, context, vm);
+    BlockExit exit = ExecuteBlock(condition.setupInstructions, context, vm);
+    if (exit != BlockExit::Normal) {
+        return exit;
     }
 
     switch (condition.kind) {
-        case ConditionKind::Stack: {
-            auto value = context->PopStack();
-            return ValueToBool(value);
-        }
+        case ConditionKind::Stack:
+            break;
 
         case ConditionKind::Binary: {
             if (condition.comparisonOp == OpCode::Nop) {
                 throw std::runtime_error("Binary condition missing comparison operation");
             }
 
-            auto right = context->PopStack();
-            auto left = context->PopStack();
-
-            context->PushStack(left);
-            context->PushStack(right);
-
             switch (condition.comparisonOp) {
                 case OpCode::Ceq: ExecuteCeq(context); break;
                 case OpCode::Cne: ExecuteCne(context); break;
@@ -1367,23 +3136,23 @@ bool InstructionExecutor::EvaluateCondition(
                 default:
                     throw std::runtime_error("Unsupported comparison opcode in binary condition");
             }
-
-            auto result = context->PopStack();
-            return ValueToBool(result);
+            break;
         }
 
-        case ConditionKind::Expression: {
-            for (const auto& exprInstr : condition.expressionInstructions) {
-                Execute(exprInstr, context, vm);
+        case ConditionKind::Expression:
+            exit = ExecuteBlock(condition.expressionInstructions, context, vm);
+            if (exit != BlockExit::Normal) {
+                return exit;
             }
-            auto result = context->PopStack();
-            return ValueToBool(result);
-        }
+            break;
 
         case ConditionKind::None:
         default:
             throw std::runtime_error("Condition kind not supported");
     }
+
+    result = ValueToBool(context->PopStack());
+    return BlockExit::Normal;
 }
 
 bool InstructionExecutor::ValueToBool(const Value& value) {
@@ -1406,7 +3175,7 @@ bool InstructionExecutor::ValueToBool(const Value& value) {
         return value.AsFloat64() != 0.0;
     }
     if (value.IsString()) {
-        return !value.AsString().empty();
+        return !value.AsStringRef().empty();
     }
     if (value.IsObject()) {
         return true;
@@ -1,4 +1,5 @@
 #include "ir_loader.hpp"
+#include "bytecode.hpp"
 #include "fob_loader.hpp"
 #include "instruction_executor.hpp"
 #include "stdlib.hpp"
@@ -141,6 +142,9 @@ std::shared_ptr<VirtualMachine> IRLoader::ParseModule(const json& moduleJson) {
         LoadTypes(vm, moduleJson["types"]);
     }
 
+    // Every class is registered now; splice small callees into their callers.
+    BytecodeInliner::InlineCalls(*vm);
+
     return vm;
 }
 
@@ -148,6 +152,67 @@ void IRLoader::LoadTypes(std::shared_ptr<VirtualMachine> vm, const json& typesAr
     for (const auto& typeJson : typesArray) {
         LoadTypeDefinition(vm, typeJson);
     }
+
+    // Bases and interfaces may be declared after the types that name them,
+    // so they are linked once every type is registered.
+    for (const auto& typeJson : typesArray) {
+        LinkTypeDefinition(vm, typeJson);
+    }
+}
+
+void IRLoader::LinkTypeDefinition(std::shared_ptr<VirtualMachine> vm, const json& typeJson) {
+    std::string kind = typeJson["kind"];
+    std::transform(kind.begin(), kind.end(), kind.begin(), ::tolower);
+    if (kind != "class" && kind != "interface") {
+        return;
+    }
+
+    const std::string name = typeJson["name"];
+    ClassRef classRef = FindLoadedClass(vm, GetFQTypeName(name, typeJson.value("namespace", "")));
+    if (!classRef) {
+        return;
+    }
+
+    // Names outside the module (System.Object and friends) have no class
+    // to link against and are skipped.
+    auto link = [&](const std::string& targetName, bool mayBeBase) {
+        ClassRef target = FindLoadedClass(vm, targetName);
+        if (!target) {
+            return;
+        }
+        if (mayBeBase && !target->IsInterface()) {
+            classRef->SetBaseClass(target);
+        } else {
+            classRef->AddInterface(target);
+        }
+    };
+
+    for (const char* key : {"base", "baseType", "BaseType"}) {
+        auto it = typeJson.find(key);
+        if (it != typeJson.end() && it->is_string()) {
+            link(it->get<std::string>(), !classRef->IsInterface());
+            break;
+        }
+    }
+    for (const char* key : {"interfaces", "Interfaces", "baseInterfaces", "BaseInterfaces"}) {
+        auto it = typeJson.find(key);
+        if (it == typeJson.end() || !it->is_array()) {
+            continue;
+        }
+        for (const auto& interfaceName : *it) {
+            if (interfaceName.is_string()) {
+                link(interfaceName.get<std::string>(), false);
+            }
+        }
+    }
+}
+
+ClassRef IRLoader::FindLoadedClass(std::shared_ptr<VirtualMachine> vm, const std::string& name) {
+    try {
+        return vm->GetClass(name);
+    } catch (const std::runtime_error&) {
+        return nullptr;
+    }
 }
 
 void IRLoader::LoadTypeDefinition(std::shared_ptr<VirtualMachine> vm, const json& typeJson) {
@@ -171,17 +236,10 @@ ClassRef IRLoader::LoadClass(std::shared_ptr<VirtualMachine> vm, const json& cla
     std::string fullName = GetFQTypeName(name, ns);
     auto classRef = std::make_shared<Class>(name);  // Pass simple name to constructor
     classRef->SetNamespace(ns);  // Set namespace separately
+    classRef->SetSealed(classJson.value("isSealed", false));
 
-    // Load base class if present
-    if (classJson.contains("base")) {
-        std::string baseName = classJson["base"];
-        // TODO: Resolve base class
-    }
-
-    // Load interfaces if present
-    if (classJson.contains("interfaces")) {
-        // TODO: Load interfaces
-    }
+    // "base" and "interfaces" are linked by LinkTypeDefinition once every
+    // type of the module is registered.
 
     // Load fields
     if (classJson.contains("fields")) {
@@ -198,7 +256,17 @@ ClassRef IRLoader::LoadClass(std::shared_ptr<VirtualMachine> vm, const json& cla
 }
 
 void IRLoader::LoadInterface(std::shared_ptr<VirtualMachine> vm, const json& interfaceJson) {
-    // TODO: Implement interface loading
+    std::string name = interfaceJson["name"];
+    auto interfaceRef = std::make_shared<Class>(name);
+    interfaceRef->SetNamespace(interfaceJson.value("namespace", ""));
+    interfaceRef->SetInterface(true);
+    interfaceRef->SetAbstract(true);
+
+    if (interfaceJson.contains("methods")) {
+        LoadMethods(interfaceRef, interfaceJson["methods"], vm);
+    }
+
+    vm->RegisterClass(interfaceRef);
 }
 
 void IRLoader::LoadStruct(std::shared_ptr<VirtualMachine> vm, const json& structJson) {
@@ -223,7 +291,8 @@ void IRLoader::LoadMethods(ClassRef classRef, const json& methodsArray, std::sha
         TypeReference returnType = ParseTypeReference(vm, returnTypeStr);
 
         bool isStatic = methodJson.value("isStatic", false);
-        auto method = std::make_shared<Method>(name, returnType, isStatic);
+        bool isVirtual = methodJson.value("isVirtual", methodJson.value("IsVirtual", false));
+        auto method = std::make_shared<Method>(name, returnType, isStatic, isVirtual);
 
         if (methodJson.contains("parameters")) {
             for (const auto& paramJson : methodJson["parameters"]) {
@@ -302,10 +371,71 @@ void IRLoader::LoadMethods(ClassRef classRef, const json& methodsArray, std::sha
             }
         }
 
+        if (methodJson.contains("exceptionHandlers")) {
+            method->SetExceptionHandlers(LoadExceptionHandlers(
+                methodJson["exceptionHandlers"], method->GetLabelMap(), method->GetInstructions().size()));
+        }
+
         classRef->AddMethod(method);
     }
 }
 
+std::vector<ExceptionHandler> IRLoader::LoadExceptionHandlers(
+    const json& handlersArray,
+    const std::unordered_map<std::string, size_t>& labelMap,
+    size_t instructionCount) {
+    if (!handlersArray.is_array()) {
+        throw std::runtime_error("exceptionHandlers must be an array");
+    }
+
+    auto offset = [&](const json& handlerJson, const char* key) -> size_t {
+        if (!handlerJson.contains(key)) {
+            throw std::runtime_error(std::string("Exception handler missing '") + key + "'");
+        }
+        const auto& node = handlerJson[key];
+        size_t value = 0;
+        if (node.is_number_unsigned() || (node.is_number_integer() && node.get<int64_t>() >= 0)) {
+            value = node.get<size_t>();
+        } else if (node.is_string()) {
+            auto it = labelMap.find(node.get<std::string>());
+            if (it == labelMap.end()) {
+                throw std::runtime_error("Exception handler label not found: " + node.get<std::string>());
+            }
+            value = it->second;
+        } else {
+            throw std::runtime_error(std::string("Invalid exception handler offset '") + key + "'");
+        }
+        if (value > instructionCount) {
+            throw std::runtime_error(std::string("Exception handler offset '") + key + "' out of range");
+        }
+        return value;
+    };
+
+    std::vector<ExceptionHandler> handlers;
+    handlers.reserve(handlersArray.size());
+    for (const auto& handlerJson : handlersArray) {
+        ExceptionHandler handler;
+        const std::string kind = handlerJson.value("kind", std::string("catch"));
+        if (kind == "catch") {
+            handler.kind = ExceptionHandlerKind::Catch;
+            handler.catchType = handlerJson.value("catchType", std::string());
+        } else if (kind == "finally") {
+            handler.kind = ExceptionHandlerKind::Finally;
+        } else {
+            throw std::runtime_error("Unknown exception handler kind: " + kind);
+        }
+        handler.tryStart = offset(handlerJson, "tryStart");
+        handler.tryEnd = offset(handlerJson, "tryEnd");
+        handler.handlerStart = offset(handlerJson, "handlerStart");
+        handler.handlerEnd = offset(handlerJson, "handlerEnd");
+        if (handler.tryStart >= handler.tryEnd || handler.handlerStart >= handler.handlerEnd) {
+            throw std::runtime_error("Exception handler has an empty range");
+        }
+        handlers.push_back(std::move(handler));
+    }
+    return handlers;
+}
+
 TypeReference IRLoader::ParseTypeReference(std::shared_ptr<VirtualMachine> vm, const std::string& typeStr) {
     const auto normalized = TypeNames::NormalizeTypeName(typeStr);
 
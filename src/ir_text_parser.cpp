@@ -345,6 +345,16 @@ json IRTextParser::Parser::ParseModule()
         {
             module["types"].push_back(ParseClass());
         }
+        else if (Peek().value == "sealed")
+        {
+            Advance(); // 'sealed'
+            if (Peek().value == "class")
+            {
+                json classJson = ParseClass();
+                classJson["isSealed"] = true;
+                module["types"].push_back(std::move(classJson));
+            }
+        }
         else if (Peek().value == "interface")
         {
             module["types"].push_back(ParseInterface());
@@ -373,9 +383,15 @@ json IRTextParser::Parser::ParseClass()
     classJson["fields"] = json::array();
     classJson["methods"] = json::array();
 
+    // class Name : Base, IFirst, ISecond -- the loader tells the base class
+    // from interfaces once every type is known.
     if (Match(Token::Type::Colon))
     {
         classJson["base"] = Advance().value;
+        while (Match(Token::Type::Comma))
+        {
+            classJson["interfaces"].push_back(Advance().value);
+        }
     }
 
     Match(Token::Type::LBrace);
@@ -437,6 +453,14 @@ json IRTextParser::Parser::ParseInterface()
     ifaceJson["kind"] = "interface";
     ifaceJson["methods"] = json::array();
 
+    if (Match(Token::Type::Colon))
+    {
+        do
+        {
+            ifaceJson["interfaces"].push_back(Advance().value);
+        } while (Match(Token::Type::Comma));
+    }
+
     Match(Token::Type::LBrace);
 
     while (current < tokens.size() && !Check(Token::Type::RBrace))
@@ -576,6 +600,120 @@ json IRTextParser::Parser::ParseMethod()
         json localVariables = json::array();
         json labelMap = json::object(); // Map label names to instruction indices
         int braceCount = 1;
+
+        // try { ... } catch (Type [name]) { ... } ... finally { ... }
+        // lowers to the blocks in order, each try and catch block left with
+        // a leave to the end of the construct and the finally block ended by
+        // endfinally, plus one exception handler per catch/finally block.
+        struct OpenTry
+        {
+            enum class Block { Try, Catch, Finally };
+            int depth;               // braceCount inside the current block
+            Block block;
+            size_t tryStart;
+            size_t tryEnd = 0;
+            size_t blockStart = 0;   // of the current catch/finally block
+            size_t finallyStart = 0;
+            std::string catchType;
+            std::vector<size_t> leaves;
+            json catches = json::array();
+            bool hasFinally = false;
+        };
+        std::vector<OpenTry> openTries;
+        json exceptionHandlers = json::array();
+
+        auto atTry = [&]() {
+            return Peek().value == "try" && current + 1 < tokens.size() && tokens[current + 1].type == Token::Type::LBrace;
+        };
+        auto skipNewlines = [&]() {
+            while (Check(Token::Type::Newline))
+            {
+                Advance();
+            }
+        };
+        auto emitLeave = [&](OpenTry& open) {
+            open.leaves.push_back(bodyInstructions.size());
+            bodyInstructions.push_back(json{{"opCode", "leave"}});
+        };
+        // Open the catch or finally block following a closed block of `open`,
+        // or return false when the construct ends there.
+        auto openHandlerBlock = [&](OpenTry& open) -> bool {
+            skipNewlines();
+            if (Peek().value == "catch" && !open.hasFinally)
+            {
+                Advance();
+                std::vector<std::string> words;
+                if (Match(Token::Type::LParen))
+                {
+                    while (current < tokens.size() && !Check(Token::Type::RParen))
+                    {
+                        words.push_back(Advance().value);
+                    }
+                    Match(Token::Type::RParen);
+                }
+                // A trailing name after the type names the local the
+                // exception is stored to.
+                std::string localName;
+                if (words.size() >= 2 && words[words.size() - 2] != ".")
+                {
+                    localName = words.back();
+                    words.pop_back();
+                }
+                open.catchType.clear();
+                for (const auto& word : words)
+                {
+                    open.catchType += word;
+                }
+                open.block = OpenTry::Block::Catch;
+                open.blockStart = bodyInstructions.size();
+                if (localName.empty())
+                {
+                    bodyInstructions.push_back(json{{"opCode", "pop"}});
+                }
+                else
+                {
+                    bodyInstructions.push_back(json{{"opCode", "stloc"}, {"operand", {{"localName", localName}}}});
+                }
+            }
+            else if (Peek().value == "finally" && !open.hasFinally)
+            {
+                Advance();
+                open.block = OpenTry::Block::Finally;
+                open.blockStart = open.finallyStart = bodyInstructions.size();
+                open.hasFinally = true;
+            }
+            else
+            {
+                return false;
+            }
+            skipNewlines();
+            Consume(Token::Type::LBrace, "Expected '{' after catch/finally");
+            braceCount++;
+            return true;
+        };
+        auto closeTry = [&](OpenTry& open) {
+            if (open.catches.empty() && !open.hasFinally)
+            {
+                throw std::runtime_error("try block without catch or finally in method " + methodName);
+            }
+            const size_t end = bodyInstructions.size();
+            for (size_t leave : open.leaves)
+            {
+                bodyInstructions[leave]["operand"] = json{{"target", end}};
+            }
+            for (const auto& handler : open.catches)
+            {
+                exceptionHandlers.push_back(handler);
+            }
+            if (open.hasFinally)
+            {
+                exceptionHandlers.push_back(json{{"kind", "finally"},
+                                                 {"tryStart", open.tryStart},
+                                                 {"tryEnd", open.finallyStart},
+                                                 {"handlerStart", open.finallyStart},
+                                                 {"handlerEnd", end}});
+            }
+        };
         
         while (braceCount > 0 && current < tokens.size())
         {
@@ -584,6 +722,41 @@ json IRTextParser::Parser::ParseMethod()
                 braceCount++;
                 Advance();
             }
+            else if (Check(Token::Type::RBrace) && !openTries.empty() && openTries.back().depth == braceCount)
+            {
+                // End of a block of a try construct
+                Advance();
+                braceCount--;
+                OpenTry& open = openTries.back();
+                switch (open.block)
+                {
+                case OpenTry::Block::Try:
+                    emitLeave(open);
+                    open.tryEnd = bodyInstructions.size();
+                    break;
+                case OpenTry::Block::Catch:
+                    emitLeave(open);
+                    open.catches.push_back(json{{"kind", "catch"},
+                                                {"tryStart", open.tryStart},
+                                                {"tryEnd", open.tryEnd},
+                                                {"handlerStart", open.blockStart},
+                                                {"handlerEnd", bodyInstructions.size()},
+                                                {"catchType", open.catchType}});
+                    break;
+                case OpenTry::Block::Finally:
+                    bodyInstructions.push_back(json{{"opCode", "endfinally"}});
+                    break;
+                }
+                if (!openHandlerBlock(open))
+                {
+                    closeTry(open);
+                    openTries.pop_back();
+                }
+                else
+                {
+                    open.depth = braceCount;
+                }
+            }
             else if (Check(Token::Type::RBrace))
             {
                 braceCount--;
@@ -592,6 +765,17 @@ json IRTextParser::Parser::ParseMethod()
                     Advance();
                 }
             }
+            else if (atTry())
+            {
+                Advance(); // 'try'
+                Advance(); // '{'
+                braceCount++;
+                OpenTry open;
+                open.depth = braceCount;
+                open.block = OpenTry::Block::Try;
+                open.tryStart = bodyInstructions.size();
+                openTries.push_back(std::move(open));
+            }
             else if (Peek().value == "local")
             {
                 // Parse local variable declaration: local varName: type
@@ -635,7 +819,8 @@ json IRTextParser::Parser::ParseMethod()
                        !Check(Token::Type::LBrace) &&
                        !Check(Token::Type::RBrace) &&
                        !Check(Token::Type::Newline) &&
-                       !(Check(Token::Type::Identifier) && current + 1 < tokens.size() && tokens[current + 1].type == Token::Type::Colon))
+                       !(Check(Token::Type::Identifier) && current + 1 < tokens.size() && tokens[current + 1].type == Token::Type::Colon) &&
+                       !atTry())
                 {
                     args.push_back(Peek().value);
                     Advance();
@@ -721,7 +906,8 @@ json IRTextParser::Parser::ParseMethod()
                           instructionName == "beq" || instructionName == "beq.s" || instructionName == "bne" || 
                           instructionName == "bne.s" || instructionName == "bgt" || instructionName == "bgt.s" || 
                           instructionName == "blt" || instructionName == "blt.s" || instructionName == "bge" || 
-                          instructionName == "bge.s" || instructionName == "ble" || instructionName == "ble.s") && !args.empty())
+                          instructionName == "bge.s" || instructionName == "ble" || instructionName == "ble.s" ||
+                          instructionName == "leave" || instructionName == "leave.s") && !args.empty())
                 {
                     // This is a branch instruction with a label or numeric target
                     // Store as a string for now; will be resolved using labelMap during loading
@@ -759,6 +945,14 @@ json IRTextParser::Parser::ParseMethod()
         method["body"] = bodyInstructions; // legacy compatibility
         method["localVariables"] = localVariables; // Add locals to method
         method["labelMap"] = labelMap; // Add label map for branch resolution
+        if (!openTries.empty())
+        {
+            throw std::runtime_error("Unterminated try block in method " + methodName);
+        }
+        if (!exceptionHandlers.empty())
+        {
+            method["exceptionHandlers"] = exceptionHandlers;
+        }
         Match(Token::Type::RBrace);
     }
 
@@ -959,7 +1153,7 @@ bool IRTextParser::IsKeyword(const std::string& word)
     static const std::vector<std::string> keywords = {
         "module", "class", "interface", "struct", "enum",
         "method", "field", "property", "constructor",
-        "static", "virtual", "abstract", "private", "public", "protected",
+        "static", "virtual", "abstract", "sealed", "private", "public", "protected",
         "local", "if", "else", "while", "for", "switch", "case",
         "return", "implements", "version"
     };
@@ -977,6 +1171,7 @@ bool IRTextParser::IsInstruction(const std::string& word)
         "brtrue", "brtrue.s", "bgt", "bgt.s", "bgt.un", "blt", "blt.s", "blt.un", "bge", "bge.s", "bge.un",
         "ble", "ble.s", "ble.un",
         "newarr", "ldelem", "stelem", "ldlen",
+        "throw", "leave", "leave.s", "endfinally",
         "if", "while", "for", "switch", "case", "default", "break", "continue"
     };
 
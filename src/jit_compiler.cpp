@@ -0,0 +1,899 @@
+#include "jit_compiler.hpp"
+#include "instruction_executor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <stdexcept>
+
+#if defined(OBJECTIR_JIT) && defined(__x86_64__) && (defined(__linux__) || defined(__FreeBSD__))
+    #define OBJECTIR_JIT_X86_64 1
+    #include <sys/mman.h>
+    #include <unistd.h>
+#else
+    #define OBJECTIR_JIT_X86_64 0
+#endif
+
+namespace ObjectIR {
+
+// Native code is called as `int64_t code(Frame*, int64_t pc)` and returns the
+// instruction the interpreter continues with. Calls made from native code
+// refresh the slot pointers, since the frame storage may have grown.
+struct JitCode::Frame {
+    Value* arguments;
+    Value* locals;
+    Value* stack;
+    ExecutionContext* context;
+    VirtualMachine* vm;
+    const JitCode* code;
+    std::exception_ptr* error;
+};
+
+namespace {
+
+using Type = VerifiedType;
+
+std::atomic<bool> g_jitEnabled{true};
+std::atomic<uint32_t> g_invocationThreshold{500};
+std::atomic<uint32_t> g_backEdgeThreshold{2000};
+
+bool MatchesType(Type type, const Value& value) {
+    switch (type) {
+        case Type::Unknown: return true;
+        case Type::Null: return value.IsNull();
+        case Type::Int32: return value.IsInt32();
+        case Type::Int64: return value.IsInt64();
+        case Type::Float32: return value.IsFloat32();
+        case Type::Float64: return value.IsFloat64();
+        case Type::Bool: return value.IsBool();
+        case Type::String: return value.IsString();
+        case Type::Object: return value.IsObject();
+    }
+    return false;
+}
+
+// Values native code may copy bit for bit: nothing to retain or release.
+bool IsPlain(Type type) {
+    return type != Type::Unknown && type != Type::String && type != Type::Object;
+}
+
+bool MatchesSlots(const std::vector<Type>& types, const Value* values) {
+    for (size_t i = 0; i < types.size(); ++i) {
+        if (!MatchesType(types[i], values[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+#if OBJECTIR_JIT_X86_64
+
+namespace {
+
+// At least one call per this many instructions of the hot path and a body is
+// not worth compiling: every call leaves native code (see CallFromNative) and
+// enters the callee through the interpreter, which costs more than native
+// code saves on the instructions around it.
+constexpr size_t kCallDominatedRatio = 8;
+
+// True when calls dominate the hot path of `code`: its loops, or the whole
+// body of a method without loops (recursive methods, say).
+bool IsCallDominated(const std::vector<BytecodeInstruction>& code, const std::vector<VerifiedFrameState>& states) {
+    std::vector<bool> hot(code.size(), false);
+    bool hasLoop = false;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        const size_t target = static_cast<size_t>(code[pc].a);
+        if (code[pc].op == BytecodeOp::Br && target <= pc && states[pc].reached) {
+            std::fill(hot.begin() + static_cast<std::ptrdiff_t>(target), hot.begin() + static_cast<std::ptrdiff_t>(pc) + 1, true);
+            hasLoop = true;
+        }
+    }
+    size_t instructions = 0;
+    size_t calls = 0;
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (!states[pc].reached || (hasLoop && !hot[pc])) {
+            continue;
+        }
+        ++instructions;
+        switch (code[pc].op) {
+            case BytecodeOp::Call:
+            case BytecodeOp::CallVirt:
+            case BytecodeOp::TailCall:
+            case BytecodeOp::TailCallVirt:
+                ++calls;
+                break;
+            default:
+                break;
+        }
+    }
+    return calls > 0 && calls * kCallDominatedRatio >= instructions;
+}
+
+class Unsupported : public std::exception {
+public:
+    explicit Unsupported(std::string message) : _message(std::move(message)) {}
+    const char* what() const noexcept override { return _message.c_str(); }
+
+private:
+    std::string _message;
+};
+
+enum Reg : int { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R13 = 13, R14 = 14, R15 = 15 };
+enum XmmReg : int { XMM0 = 0 };
+
+// Condition codes of Jcc/SETcc.
+enum Cond : uint8_t { kAboveEqual = 0x3, kEqual = 0x4, kNotEqual = 0x5, kAbove = 0x7,
+                      kParity = 0xA, kNoParity = 0xB, kLess = 0xC, kGreaterEqual = 0xD, kLessEqual = 0xE,
+                      kGreater = 0xF };
+
+// Minimal x86-64 encoder. Memory operands are always [base + disp32] with a
+// base other than RSP/R12, which keeps ModRM encoding SIB-free.
+class Assembler {
+public:
+    size_t Position() const { return _bytes.size(); }
+    const std::vector<uint8_t>& Bytes() const { return _bytes; }
+
+    void Byte(uint8_t value) { _bytes.push_back(value); }
+    void Int32(int32_t value) { Raw(&value, sizeof(value)); }
+    void Int64(uint64_t value) { Raw(&value, sizeof(value)); }
+
+    void PatchRel32(size_t at, size_t target) {
+        const int32_t rel = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(at + 4));
+        std::memcpy(&_bytes[at], &rel, sizeof(rel));
+    }
+
+    // op reg, [base + disp]; `prefix` is a mandatory SSE prefix (0 for none).
+    void Mem(std::initializer_list<uint8_t> opcode, bool wide, int reg, int base, int32_t disp, uint8_t prefix = 0) {
+        if (prefix) Byte(prefix);
+        Rex(wide, reg, base);
+        for (uint8_t byte : opcode) Byte(byte);
+        Byte(static_cast<uint8_t>(0x80 | ((reg & 7) << 3) | (base & 7)));
+        Int32(disp);
+    }
+
+    // op rm, reg (register direct).
+    void RegReg(std::initializer_list<uint8_t> opcode, bool wide, int reg, int rm) {
+        Rex(wide, reg, rm);
+        for (uint8_t byte : opcode) Byte(byte);
+        Byte(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+    }
+
+    void Load32(int reg, int base, int32_t disp) { Mem({0x8B}, false, reg, base, disp); }
+    void Store32(int base, int32_t disp, int reg) { Mem({0x89}, false, reg, base, disp); }
+    void Load64(int reg, int base, int32_t disp) { Mem({0x8B}, true, reg, base, disp); }
+    void Store64(int base, int32_t disp, int reg) { Mem({0x89}, true, reg, base, disp); }
+
+    // mov qword [base + disp], imm32 (sign-extended)
+    void StoreImm64(int base, int32_t disp, int32_t imm) {
+        Mem({0xC7}, true, 0, base, disp);
+        Int32(imm);
+    }
+
+    void MovImm32(int reg, int32_t imm) {
+        if (reg & 8) Byte(0x41);
+        Byte(static_cast<uint8_t>(0xB8 | (reg & 7)));
+        Int32(imm);
+    }
+
+    void MovImm64(int reg, uint64_t imm) {
+        Byte(static_cast<uint8_t>(0x48 | ((reg & 8) ? 1 : 0)));
+        Byte(static_cast<uint8_t>(0xB8 | (reg & 7)));
+        Int64(imm);
+    }
+
+    void Push(int reg) {
+        if (reg & 8) Byte(0x41);
+        Byte(static_cast<uint8_t>(0x50 | (reg & 7)));
+    }
+
+    void Pop(int reg) {
+        if (reg & 8) Byte(0x41);
+        Byte(static_cast<uint8_t>(0x58 | (reg & 7)));
+    }
+
+    // cmp dword/byte [base + disp], imm8
+    void CmpMem32Imm8(int base, int32_t disp, int8_t imm) {
+        Mem({0x83}, false, 7, base, disp);
+        Byte(static_cast<uint8_t>(imm));
+    }
+    void CmpMem8Imm8(int base, int32_t disp, uint8_t imm) {
+        Mem({0x80}, false, 7, base, disp);
+        Byte(imm);
+    }
+
+    void SetCc(Cond cond, int reg8) { RegReg({0x0F, static_cast<uint8_t>(0x90 | cond)}, false, 0, reg8); }
+
+    size_t Jcc(Cond cond) {
+        Byte(0x0F);
+        Byte(static_cast<uint8_t>(0x80 | cond));
+        return Rel32();
+    }
+
+    size_t Jmp() {
+        Byte(0xE9);
+        return Rel32();
+    }
+
+private:
+    void Raw(const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        _bytes.insert(_bytes.end(), bytes, bytes + size);
+    }
+
+    void Rex(bool wide, int reg, int rm) {
+        const uint8_t rex = static_cast<uint8_t>(0x40 | (wide ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0));
+        if (rex != 0x40) Byte(rex);
+    }
+
+    size_t Rel32() {
+        const size_t at = Position();
+        Int32(0);
+        return at;
+    }
+
+    std::vector<uint8_t> _bytes;
+};
+
+// Slot registers while native code runs: the Frame, and the first argument,
+// local and operand stack slot of the frame.
+constexpr int kFrameReg = RBX;
+constexpr int kArgumentsReg = R13;
+constexpr int kLocalsReg = R14;
+constexpr int kStackReg = R15;
+
+constexpr int32_t kSlotSize = static_cast<int32_t>(sizeof(Value));
+constexpr int32_t kPayload = static_cast<int32_t>(Value::kPayloadOffset);
+
+// What generated code needs to know about JitCode::Frame and the call helper.
+struct FrameInterface {
+    int32_t argumentsOffset;
+    int32_t localsOffset;
+    int32_t stackOffset;
+    uint64_t callHelper;
+};
+
+struct Slot {
+    int base;
+    int32_t disp;
+
+    int32_t Payload() const { return disp + kPayload; }
+};
+
+class Emitter {
+public:
+    Emitter(const FrameInterface& frame, const PreparedMethod& prepared, const std::vector<BytecodeInstruction>& code,
+            const std::vector<VerifiedFrameState>& states)
+        : _frame(frame), _prepared(prepared), _code(code), _states(states), _labels(code.size(), kUnbound) {}
+
+    void Run(const std::vector<size_t>& entryPoints) {
+        EmitPrologue(entryPoints);
+        for (size_t pc = 0; pc < _code.size(); ++pc) {
+            _labels[pc] = _asm.Position();
+            if (_states[pc].reached) {
+                EmitInstruction(pc);
+            }
+        }
+        EmitExits();
+        EmitEpilogue();
+
+        for (const auto& ref : _labelRefs) {
+            _asm.PatchRel32(ref.first, _labels[ref.second]);
+        }
+    }
+
+    const std::vector<uint8_t>& Bytes() const { return _asm.Bytes(); }
+
+private:
+    static constexpr size_t kUnbound = static_cast<size_t>(-1);
+
+    // Frame layout: rbp, then rbx/r13/r14/r15 keep rsp 16-byte aligned at
+    // every call made from the body.
+    void EmitPrologue(const std::vector<size_t>& entryPoints) {
+        _asm.Push(RBP);
+        _asm.RegReg({0x89}, true, RSP, RBP); // mov rbp, rsp
+        _asm.Push(RBX);
+        _asm.Push(R13);
+        _asm.Push(R14);
+        _asm.Push(R15);
+        _asm.RegReg({0x89}, true, RDI, kFrameReg); // mov rbx, rdi
+        ReloadSlotRegisters();
+
+        // Dispatch on the entry pc; anything else leaves straight away.
+        for (size_t pc : entryPoints) {
+            _asm.RegReg({0x81}, false, 7, RSI); // cmp esi, imm32
+            _asm.Int32(static_cast<int32_t>(pc));
+            JumpTo(_asm.Jcc(kEqual), pc);
+        }
+        _asm.RegReg({0x89}, false, RSI, RAX); // mov eax, esi
+        _epilogueRefs.push_back(_asm.Jmp());
+    }
+
+    void EmitEpilogue() {
+        const size_t epilogue = _asm.Position();
+        for (size_t ref : _epilogueRefs) {
+            _asm.PatchRel32(ref, epilogue);
+        }
+        _asm.Pop(R15);
+        _asm.Pop(R14);
+        _asm.Pop(R13);
+        _asm.Pop(RBX);
+        _asm.Pop(RBP);
+        _asm.Byte(0xC3);
+    }
+
+    void ReloadSlotRegisters() {
+        _asm.Load64(kArgumentsReg, kFrameReg, _frame.argumentsOffset);
+        _asm.Load64(kLocalsReg, kFrameReg, _frame.localsOffset);
+        _asm.Load64(kStackReg, kFrameReg, _frame.stackOffset);
+    }
+
+    // Bail-outs jump to a stub per target instruction, placed after the body.
+    void ExitTo(size_t patch, size_t pc) { _exitRefs.emplace_back(patch, pc); }
+
+    void EmitExits() {
+        std::map<size_t, size_t> stubs;
+        for (const auto& ref : _exitRefs) {
+            auto it = stubs.find(ref.second);
+            if (it == stubs.end()) {
+                it = stubs.emplace(ref.second, _asm.Position()).first;
+                EmitLeave(ref.second);
+            }
+            _asm.PatchRel32(ref.first, it->second);
+        }
+    }
+
+    void EmitLeave(size_t pc) {
+        _asm.MovImm32(RAX, static_cast<int32_t>(pc));
+        _epilogueRefs.push_back(_asm.Jmp());
+    }
+
+    void JumpTo(size_t patch, size_t pc) { _labelRefs.emplace_back(patch, pc); }
+
+    Slot Stack(size_t index) const { return {kStackReg, static_cast<int32_t>(index) * kSlotSize}; }
+    Slot Local(size_t index) const { return {kLocalsReg, static_cast<int32_t>(index) * kSlotSize}; }
+    Slot Argument(size_t index) const { return {kArgumentsReg, static_cast<int32_t>(index) * kSlotSize}; }
+
+    void Copy(Slot from, Slot to) {
+        _asm.Load64(RAX, from.base, from.disp);
+        _asm.Store64(to.base, to.disp, RAX);
+        _asm.Load64(RAX, from.base, from.Payload());
+        _asm.Store64(to.base, to.Payload(), RAX);
+    }
+
+    void StoreConstant(Slot to, const Value& value) {
+        uint64_t payload = 0;
+        std::memcpy(&payload, reinterpret_cast<const unsigned char*>(&value) + Value::kPayloadOffset, sizeof(payload));
+        _asm.StoreImm64(to.base, to.disp, static_cast<int32_t>(value.GetTag()));
+        const auto low = static_cast<int64_t>(payload);
+        if (low >= INT32_MIN && low <= INT32_MAX) {
+            _asm.StoreImm64(to.base, to.Payload(), static_cast<int32_t>(low));
+        } else {
+            _asm.MovImm64(RAX, payload);
+            _asm.Store64(to.base, to.Payload(), RAX);
+        }
+    }
+
+    // A store into a slot the code knows nothing about may not overwrite a
+    // string or object, which would need a release: leave for those.
+    void GuardOverwrite(Type type, Slot to, size_t pc) {
+        if (type == Type::Unknown) {
+            _asm.CmpMem8Imm8(to.base, to.disp, static_cast<uint8_t>(Value::Tag::String));
+            ExitTo(_asm.Jcc(kAboveEqual), pc);
+        } else if (!IsPlain(type)) {
+            Reject(pc, "store over a reference");
+        }
+    }
+
+    void StoreBoolFromAl(Slot to) {
+        _asm.RegReg({0x0F, 0xB6}, false, RAX, RAX); // movzx eax, al
+        _asm.StoreImm64(to.base, to.disp, static_cast<int32_t>(Value::Tag::Bool));
+        _asm.Store64(to.base, to.Payload(), RAX);
+    }
+
+    // Sets al to the float64 comparison `op` (generic compare or compare-
+    // branch) of the two slots. Unordered operands compare false except for
+    // "not equal", like the C++ operators the interpreter uses.
+    void CompareFloat64ToAl(BytecodeOp op, Slot left, Slot right) {
+        const bool swapped = op == BytecodeOp::Clt || op == BytecodeOp::Cle;
+        const Slot first = swapped ? right : left;
+        const Slot second = swapped ? left : right;
+        _asm.Mem({0x0F, 0x10}, false, XMM0, first.base, first.Payload(), 0xF2);   // movsd xmm0, [first]
+        _asm.Mem({0x0F, 0x2E}, false, XMM0, second.base, second.Payload(), 0x66); // ucomisd xmm0, [second]
+        switch (op) {
+            case BytecodeOp::Cgt:
+            case BytecodeOp::Clt: _asm.SetCc(kAbove, RAX); break;
+            case BytecodeOp::Cge:
+            case BytecodeOp::Cle: _asm.SetCc(kAboveEqual, RAX); break;
+            case BytecodeOp::Ceq:
+                _asm.SetCc(kEqual, RAX);
+                _asm.SetCc(kNoParity, RCX);
+                _asm.RegReg({0x20}, false, RCX, RAX); // and al, cl
+                break;
+            default:
+                _asm.SetCc(kNotEqual, RAX);
+                _asm.SetCc(kParity, RCX);
+                _asm.RegReg({0x08}, false, RCX, RAX); // or al, cl
+                break;
+        }
+    }
+
+    static BytecodeOp CompareOfBranch(BytecodeOp op) {
+        switch (op) {
+            case BytecodeOp::Beq: return BytecodeOp::Ceq;
+            case BytecodeOp::Bne: return BytecodeOp::Cne;
+            case BytecodeOp::Bgt: return BytecodeOp::Cgt;
+            case BytecodeOp::Blt: return BytecodeOp::Clt;
+            case BytecodeOp::Bge: return BytecodeOp::Cge;
+            default: return BytecodeOp::Cle;
+        }
+    }
+
+    static Cond Int32Condition(BytecodeOp compare) {
+        switch (compare) {
+            case BytecodeOp::Ceq: return kEqual;
+            case BytecodeOp::Cne: return kNotEqual;
+            case BytecodeOp::Cgt: return kGreater;
+            case BytecodeOp::Clt: return kLess;
+            case BytecodeOp::Cge: return kGreaterEqual;
+            default: return kLessEqual;
+        }
+    }
+
+    [[noreturn]] void Reject(size_t pc, const std::string& what) const {
+        throw Unsupported(what + " at " + GetBytecodeOpName(_code[pc].op) + " (pc " + std::to_string(pc) + ")");
+    }
+
+    // Operand types of a binary op: both int32 or both float64. Bools compare
+    // for (in)equality like int32s, their payloads being 0 or 1.
+    Type BinaryType(size_t pc, bool allowFloat64, bool allowBool = false) const {
+        const auto& stack = _states[pc].stack;
+        const Type left = stack[stack.size() - 2];
+        const Type right = stack[stack.size() - 1];
+        if ((left == Type::Int32 && right == Type::Int32) ||
+            (allowBool && left == Type::Bool && right == Type::Bool)) {
+            return Type::Int32;
+        }
+        if (allowFloat64 && left == Type::Float64 && right == Type::Float64) {
+            return Type::Float64;
+        }
+        Reject(pc, "unsupported operand types");
+    }
+
+    Type TopType(size_t pc, size_t depth = 0) const {
+        const auto& stack = _states[pc].stack;
+        return stack[stack.size() - 1 - depth];
+    }
+
+    void RequirePlain(size_t pc, Type type) const {
+        if (!IsPlain(type)) {
+            Reject(pc, "non-primitive value");
+        }
+    }
+
+    void EmitInstruction(size_t pc) {
+        const BytecodeInstruction& instr = _code[pc];
+        const VerifiedFrameState& state = _states[pc];
+        const size_t depth = state.stack.size();
+
+        switch (instr.op) {
+            case BytecodeOp::Nop:
+                break;
+            case BytecodeOp::Dup:
+                RequirePlain(pc, TopType(pc));
+                Copy(Stack(depth - 1), Stack(depth));
+                break;
+            case BytecodeOp::Pop:
+                RequirePlain(pc, TopType(pc));
+                break;
+            case BytecodeOp::LdArg:
+                RequirePlain(pc, state.arguments[instr.a]);
+                Copy(Argument(instr.a), Stack(depth));
+                break;
+            case BytecodeOp::LdLoc:
+                RequirePlain(pc, state.locals[instr.a]);
+                Copy(Local(instr.a), Stack(depth));
+                break;
+            case BytecodeOp::StArg:
+                RequirePlain(pc, TopType(pc));
+                GuardOverwrite(state.arguments[instr.a], Argument(instr.a), pc);
+                Copy(Stack(depth - 1), Argument(instr.a));
+                break;
+            case BytecodeOp::StLoc:
+                RequirePlain(pc, TopType(pc));
+                GuardOverwrite(state.locals[instr.a], Local(instr.a), pc);
+                Copy(Stack(depth - 1), Local(instr.a));
+                break;
+            case BytecodeOp::LdConst: {
+                const Value& value = _prepared.constants[instr.a];
+                if (value.IsString() || value.IsObject()) {
+                    Reject(pc, "reference constant");
+                }
+                StoreConstant(Stack(depth), value);
+                break;
+            }
+            case BytecodeOp::LdNull:
+                StoreConstant(Stack(depth), Value());
+                break;
+            case BytecodeOp::Add:
+            case BytecodeOp::Sub:
+            case BytecodeOp::Mul:
+                EmitArithmetic(pc, instr.op, depth);
+                break;
+            case BytecodeOp::Div:
+            case BytecodeOp::Rem:
+                EmitDivision(pc, instr.op, depth);
+                break;
+            case BytecodeOp::Neg: {
+                const Slot operand = Stack(depth - 1);
+                if (TopType(pc) == Type::Int32) {
+                    _asm.Mem({0xF7}, false, 3, operand.base, operand.Payload()); // neg dword [operand]
+                } else if (TopType(pc) == Type::Float64) {
+                    _asm.Load64(RAX, operand.base, operand.Payload());
+                    _asm.RegReg({0x0F, 0xBA}, true, 7, RAX); // btc rax, 63
+                    _asm.Byte(63);
+                    _asm.Store64(operand.base, operand.Payload(), RAX);
+                } else {
+                    Reject(pc, "unsupported operand type");
+                }
+                break;
+            }
+            case BytecodeOp::Ceq:
+            case BytecodeOp::Cne:
+            case BytecodeOp::Clt:
+            case BytecodeOp::Cle:
+            case BytecodeOp::Cgt:
+            case BytecodeOp::Cge: {
+                const Slot left = Stack(depth - 2);
+                const Slot right = Stack(depth - 1);
+                const bool equality = instr.op == BytecodeOp::Ceq || instr.op == BytecodeOp::Cne;
+                if (BinaryType(pc, true, equality) == Type::Int32) {
+                    _asm.Load32(RAX, left.base, left.Payload());
+                    _asm.Mem({0x3B}, false, RAX, right.base, right.Payload()); // cmp eax, [right]
+                    _asm.SetCc(Int32Condition(instr.op), RAX);
+                } else {
+                    CompareFloat64ToAl(instr.op, left, right);
+                }
+                StoreBoolFromAl(left);
+                break;
+            }
+            case BytecodeOp::Ret:
+                EmitLeave(pc);
+                break;
+            case BytecodeOp::Br:
+                JumpTo(_asm.Jmp(), static_cast<size_t>(instr.a));
+                break;
+            case BytecodeOp::BrTrue:
+            case BytecodeOp::BrFalse: {
+                const Slot operand = Stack(depth - 1);
+                if (TopType(pc) == Type::Bool) {
+                    _asm.CmpMem8Imm8(operand.base, operand.Payload(), 0);
+                } else if (TopType(pc) == Type::Int32) {
+                    _asm.CmpMem32Imm8(operand.base, operand.Payload(), 0);
+                } else {
+                    Reject(pc, "unsupported condition type");
+                }
+                JumpTo(_asm.Jcc(instr.op == BytecodeOp::BrTrue ? kNotEqual : kEqual), static_cast<size_t>(instr.a));
+                break;
+            }
+            case BytecodeOp::Beq:
+            case BytecodeOp::Bne:
+            case BytecodeOp::Bgt:
+            case BytecodeOp::Blt:
+            case BytecodeOp::Bge:
+            case BytecodeOp::Ble: {
+                const Slot left = Stack(depth - 2);
+                const Slot right = Stack(depth - 1);
+                const BytecodeOp compare = CompareOfBranch(instr.op);
+                if (BinaryType(pc, true) == Type::Int32) {
+                    _asm.Load32(RAX, left.base, left.Payload());
+                    _asm.Mem({0x3B}, false, RAX, right.base, right.Payload()); // cmp eax, [right]
+                    JumpTo(_asm.Jcc(Int32Condition(compare)), static_cast<size_t>(instr.a));
+                } else {
+                    CompareFloat64ToAl(compare, left, right);
+                    _asm.RegReg({0x84}, false, RAX, RAX); // test al, al
+                    JumpTo(_asm.Jcc(kNotEqual), static_cast<size_t>(instr.a));
+                }
+                break;
+            }
+            case BytecodeOp::Call:
+                if (_prepared.code[pc].op == BytecodeOp::TailCall) {
+                    // The interpreter runs tail calls in the same frame.
+                    EmitLeave(pc);
+                } else {
+                    EmitCall(pc);
+                }
+                break;
+            default:
+                Reject(pc, "unsupported opcode");
+        }
+    }
+
+    void EmitArithmetic(size_t pc, BytecodeOp op, size_t depth) {
+        const Slot left = Stack(depth - 2);
+        const Slot right = Stack(depth - 1);
+        if (BinaryType(pc, true) == Type::Int32) {
+            _asm.Load32(RAX, left.base, left.Payload());
+            switch (op) {
+                case BytecodeOp::Add: _asm.Mem({0x03}, false, RAX, right.base, right.Payload()); break;
+                case BytecodeOp::Sub: _asm.Mem({0x2B}, false, RAX, right.base, right.Payload()); break;
+                default: _asm.Mem({0x0F, 0xAF}, false, RAX, right.base, right.Payload()); break;
+            }
+            _asm.Store32(left.base, left.Payload(), RAX);
+        } else {
+            _asm.Mem({0x0F, 0x10}, false, XMM0, left.base, left.Payload(), 0xF2);
+            const uint8_t opcode = op == BytecodeOp::Add ? 0x58 : op == BytecodeOp::Sub ? 0x5C : 0x59;
+            _asm.Mem({0x0F, opcode}, false, XMM0, right.base, right.Payload(), 0xF2);
+            _asm.Mem({0x0F, 0x11}, false, XMM0, left.base, left.Payload(), 0xF2);
+        }
+    }
+
+    // Int32 division by zero leaves for the interpreter, which reports it.
+    // A divisor of -1 skips idiv, which traps on INT32_MIN / -1: the
+    // quotient is the wrapped negation and the remainder 0, as in the
+    // interpreter.
+    void EmitDivision(size_t pc, BytecodeOp op, size_t depth) {
+        const Slot left = Stack(depth - 2);
+        const Slot right = Stack(depth - 1);
+        if (BinaryType(pc, op == BytecodeOp::Div) == Type::Float64) {
+            _asm.Mem({0x0F, 0x10}, false, XMM0, left.base, left.Payload(), 0xF2);
+            _asm.Mem({0x0F, 0x5E}, false, XMM0, right.base, right.Payload(), 0xF2);
+            _asm.Mem({0x0F, 0x11}, false, XMM0, left.base, left.Payload(), 0xF2);
+            return;
+        }
+        _asm.CmpMem32Imm8(right.base, right.Payload(), 0);
+        ExitTo(_asm.Jcc(kEqual), pc);
+        _asm.CmpMem32Imm8(right.base, right.Payload(), -1);
+        const size_t divide = _asm.Jcc(kNotEqual);
+        if (op == BytecodeOp::Div) {
+            _asm.Load32(RAX, left.base, left.Payload());
+            _asm.RegReg({0xF7}, false, 3, RAX); // neg eax
+        } else {
+            _asm.RegReg({0x31}, false, RAX, RAX); // xor eax, eax
+        }
+        _asm.Store32(left.base, left.Payload(), RAX);
+        const size_t done = _asm.Jmp();
+        _asm.PatchRel32(divide, _asm.Position());
+        _asm.Load32(RAX, left.base, left.Payload());
+        _asm.Byte(0x99);                                      // cdq
+        _asm.Mem({0xF7}, false, 7, right.base, right.Payload()); // idiv dword [right]
+        _asm.Store32(left.base, left.Payload(), op == BytecodeOp::Div ? RAX : RDX);
+        _asm.PatchRel32(done, _asm.Position());
+    }
+
+    // Calls go through JitCode::CallFromNative, which returns -1 to continue
+    // or the instruction to leave for.
+    void EmitCall(size_t pc) {
+        const CallSite& site = _prepared.callSites[_code[pc].a];
+        for (size_t i = 0; i < site.argumentCount; ++i) {
+            RequirePlain(pc, TopType(pc, i));
+        }
+        if (!site.isVoidReturn && !site.isConsoleWriteLine && !IsPlain(_states[pc + 1].stack.back())) {
+            Reject(pc, "call result is not a primitive");
+        }
+
+        _asm.RegReg({0x89}, true, kFrameReg, RDI); // mov rdi, rbx
+        _asm.MovImm32(RSI, static_cast<int32_t>(pc));
+        _asm.MovImm64(RAX, _frame.callHelper);
+        _asm.RegReg({0xFF}, false, 2, RAX); // call rax
+        ReloadSlotRegisters();
+        _asm.Byte(0x48);
+        _asm.Byte(0x83);
+        _asm.Byte(0xF8);
+        _asm.Byte(0xFF); // cmp rax, -1
+        _epilogueRefs.push_back(_asm.Jcc(kNotEqual));
+    }
+
+    Assembler _asm;
+    const FrameInterface& _frame;
+    const PreparedMethod& _prepared;
+    const std::vector<BytecodeInstruction>& _code;
+    const std::vector<VerifiedFrameState>& _states;
+    std::vector<size_t> _labels;
+    std::vector<std::pair<size_t, size_t>> _labelRefs;
+    std::vector<std::pair<size_t, size_t>> _exitRefs;
+    std::vector<size_t> _epilogueRefs;
+};
+
+} // namespace
+
+#endif // OBJECTIR_JIT_X86_64
+
+JitCode::~JitCode() {
+#if OBJECTIR_JIT_X86_64
+    if (_memory) {
+        munmap(_memory, _mappedSize);
+    }
+#endif
+}
+
+bool JitCode::CanEnter(size_t pc, ExecutionContext& context) const {
+    for (const auto& entry : _entryPoints) {
+        if (entry.pc != pc) {
+            continue;
+        }
+        const VerifiedFrameState& state = entry.state;
+        return context.GetArgumentCount() == state.arguments.size() &&
+               context.GetStackDepth() == state.stack.size() &&
+               MatchesSlots(state.arguments, context.FrameArguments()) &&
+               MatchesSlots(state.locals, context.FrameLocals()) &&
+               MatchesSlots(state.stack, context.FrameStack());
+    }
+    return false;
+}
+
+void JitCode::Run(size_t& pc, ExecutionContext& context, VirtualMachine* vm) const {
+    std::exception_ptr error;
+    context.ResizeStack(_maxStackDepth);
+    Frame frame{context.FrameArguments(), context.FrameLocals(), context.FrameStack(), &context, vm, this, &error};
+
+    using Entry = int64_t (*)(Frame*, int64_t);
+    const auto entry = reinterpret_cast<Entry>(_memory);
+    pc = static_cast<size_t>(entry(&frame, static_cast<int64_t>(pc)));
+
+    context.ResizeStack(_stackDepths[pc]);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+int64_t JitCode::CallFromNative(Frame* frame, int64_t pc) noexcept {
+    const JitCode& code = *frame->code;
+    ExecutionContext& context = *frame->context;
+    const PreparedMethod& prepared = code._prepared;
+    const CallSite& site = prepared.callSites[prepared.code[pc].a];
+
+    bool resultMatches = true;
+    try {
+        context.ResizeStack(code._stackDepths[pc]);
+        const size_t ip = prepared.sourceIps[pc];
+        context.SetLastInstruction(ip, ip < prepared.source->size() ? (*prepared.source)[ip].opCode : OpCode::Ret);
+
+        InstructionExecutor::ExecuteCallSite(site, false, &context, frame->vm);
+
+        if (!site.isVoidReturn && !site.isConsoleWriteLine) {
+            resultMatches = MatchesType(code._callResultTypes[pc], context.UncheckedStackEnd()[-1]);
+        }
+        context.ResizeStack(code._maxStackDepth);
+    } catch (...) {
+        // Unwinding must not cross native frames: report through Run.
+        *frame->error = std::current_exception();
+        return pc;
+    }
+
+    frame->arguments = context.FrameArguments();
+    frame->locals = context.FrameLocals();
+    frame->stack = context.FrameStack();
+    // A result of another type than the call site declares invalidates what
+    // the code after the call was compiled for.
+    return resultMatches ? -1 : pc + 1;
+}
+
+bool JitCompiler::IsSupported() {
+    return OBJECTIR_JIT_X86_64 != 0;
+}
+
+void JitCompiler::SetEnabled(bool enabled) {
+    g_jitEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool JitCompiler::IsEnabled() {
+    return IsSupported() && g_jitEnabled.load(std::memory_order_relaxed);
+}
+
+void JitCompiler::SetThresholds(uint32_t invocations, uint32_t backEdges) {
+    g_invocationThreshold.store(std::max<uint32_t>(invocations, 1), std::memory_order_relaxed);
+    g_backEdgeThreshold.store(std::max<uint32_t>(backEdges, 1), std::memory_order_relaxed);
+}
+
+uint32_t JitCompiler::GetInvocationThreshold() {
+    return g_invocationThreshold.load(std::memory_order_relaxed);
+}
+
+uint32_t JitCompiler::GetBackEdgeThreshold() {
+    return g_backEdgeThreshold.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<JitCode> JitCompiler::Compile(const Method& method, const PreparedMethod& prepared, std::string* error) {
+    auto fail = [error](const std::string& reason) -> std::shared_ptr<JitCode> {
+        if (error) {
+            *error = reason;
+        }
+        return nullptr;
+    };
+
+#if OBJECTIR_JIT_X86_64
+    if (!prepared.verified) {
+        return fail("method did not verify: " + prepared.verificationError);
+    }
+    if (prepared.HasExceptionHandling()) {
+        // Handlers are found by the pc the interpreter stands at.
+        return fail("method has exception handlers");
+    }
+
+    // Quickening and fusion rewrite `code` in place; compile the generic ops
+    // the instructions stand for.
+    std::vector<BytecodeInstruction> generic = prepared.code;
+    for (auto& instr : generic) {
+        instr.op = GetGenericBytecodeOp(instr.op);
+        if (instr.op == BytecodeOp::InlineGuard) {
+            // Native code always takes the original call.
+            instr.op = BytecodeOp::Br;
+        }
+    }
+
+    std::vector<VerifiedFrameState> states;
+    std::string reason;
+    if (!BytecodeVerifier::InferFrameStates(method, prepared, generic, true, states, reason)) {
+        return fail(reason);
+    }
+    if (IsCallDominated(generic, states)) {
+        return fail("calls dominate the method's hot path");
+    }
+
+    std::shared_ptr<JitCode> code(new JitCode(prepared));
+    code->_stackDepths.resize(generic.size(), 0);
+    code->_returns.resize(generic.size(), false);
+    code->_callResultTypes.resize(generic.size(), VerifiedType::Unknown);
+    std::vector<size_t> entryPoints = {0};
+    for (size_t pc = 0; pc < generic.size(); ++pc) {
+        code->_stackDepths[pc] = static_cast<uint32_t>(states[pc].stack.size());
+        code->_maxStackDepth = std::max(code->_maxStackDepth, states[pc].stack.size());
+        code->_returns[pc] = generic[pc].op == BytecodeOp::Ret || prepared.code[pc].op == BytecodeOp::TailCall;
+        if (generic[pc].op == BytecodeOp::Call && pc + 1 < generic.size() && states[pc + 1].reached &&
+            !prepared.callSites[generic[pc].a].isVoidReturn) {
+            code->_callResultTypes[pc] = states[pc + 1].stack.back();
+        }
+        // Loop headers, where the interpreter moves a running frame over.
+        const size_t target = static_cast<size_t>(generic[pc].a);
+        if (generic[pc].op == BytecodeOp::Br && target <= pc && states[pc].reached &&
+            std::find(entryPoints.begin(), entryPoints.end(), target) == entryPoints.end()) {
+            entryPoints.push_back(target);
+        }
+    }
+    for (size_t pc : entryPoints) {
+        code->_entryPoints.push_back({pc, states[pc]});
+    }
+
+    const FrameInterface frame = {
+        static_cast<int32_t>(offsetof(JitCode::Frame, arguments)),
+        static_cast<int32_t>(offsetof(JitCode::Frame, locals)),
+        static_cast<int32_t>(offsetof(JitCode::Frame, stack)),
+        reinterpret_cast<uint64_t>(&JitCode::CallFromNative),
+    };
+    Emitter emitter(frame, prepared, generic, states);
+    try {
+        emitter.Run(entryPoints);
+    } catch (const Unsupported& ex) {
+        return fail(ex.what());
+    }
+
+    // Written while mapped read/write, then flipped to read/execute.
+    const std::vector<uint8_t>& bytes = emitter.Bytes();
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t mappedSize = (bytes.size() + pageSize - 1) / pageSize * pageSize;
+    void* memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return fail("cannot map memory for native code");
+    }
+    std::memcpy(memory, bytes.data(), bytes.size());
+    if (mprotect(memory, mappedSize, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, mappedSize);
+        return fail("cannot make native code executable");
+    }
+    code->_memory = memory;
+    code->_mappedSize = mappedSize;
+    code->_codeSize = bytes.size();
+    return code;
+#else
+    (void)method;
+    (void)prepared;
+    return fail("this build has no JIT for the host architecture");
+#endif
+}
+
+} // namespace ObjectIR
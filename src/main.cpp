@@ -2,10 +2,15 @@
 #include "fob_loader.hpp"
 #include "ir_loader.hpp"
 #include "DiagnosticsProvider.hpp"
+#include "jit_compiler.hpp"
+#include "bytecode.hpp"
+#include "instruction_executor.hpp"
 #include <iostream>
 #include <fstream>
+#include <map>
 #include <vector>
 #include <string>
+#include <cctype>
 #include <cstdlib>
 
 using namespace ObjectIR;
@@ -20,17 +25,86 @@ bool IsFOBFile(const std::string& filePath) {
     return file && magic[0] == 'F' && magic[1] == 'O' && magic[2] == 'B';
 }
 
+// Report of OBJECTIR_OPT_STATS: what each optimizer pass changed.
+void PrintOptimizerStatistics() {
+    const OptimizerStatistics stats = BytecodeOptimizer::GetStatistics();
+    std::cerr << "Optimizer: " << stats.methods << " methods, " << stats.instructionsBefore << " -> "
+              << stats.instructionsAfter << " instructions" << std::endl;
+    for (const auto& pass : stats.passes) {
+        std::cerr << "  " << pass.name << ": ";
+        if (pass.enabled) {
+            std::cerr << pass.changes << std::endl;
+        } else {
+            std::cerr << "off" << std::endl;
+        }
+    }
+}
+
+// Run-time switches. Each is read from the environment variable
+// OBJECTIR_<NAME>, or given before the module file as --<name>=<value>
+// (--<name> alone means "on"), which wins over the environment.
+const char* const kSwitches[] = {"opt", "inline", "tailcalls", "stackless", "tiers",
+                                 "gc", "opt-stats", "verify", "jit", "plugin"};
+
+std::string EnvironmentName(const std::string& name) {
+    std::string variable = "OBJECTIR_";
+    for (char c : name) {
+        variable += c == '-' ? '_' : static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return variable;
+}
+
+// Parses the options in front of the module file into `switches`; returns the
+// index of the module file, or 0 after an unknown option.
+int ParseSwitches(int argc, char* argv[], std::map<std::string, std::string>& switches) {
+    int i = 1;
+    for (; i < argc && std::string(argv[i]).rfind("--", 0) == 0; ++i) {
+        const std::string option = argv[i] + 2;
+        const size_t equals = option.find('=');
+        const std::string name = option.substr(0, equals);
+        bool known = false;
+        for (const char* candidate : kSwitches) {
+            known |= name == candidate;
+        }
+        if (!known) {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return 0;
+        }
+        switches[name] = equals == std::string::npos ? "on" : option.substr(equals + 1);
+    }
+    return i;
+}
+
+// The value of a switch, or nullptr when it is set neither way.
+const char* GetSwitch(const std::map<std::string, std::string>& switches, const std::string& name) {
+    auto it = switches.find(name);
+    return it != switches.end() ? it->second.c_str() : std::getenv(EnvironmentName(name).c_str());
+}
+
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <module_file> [entry_point] [args...]" << std::endl;
+    std::map<std::string, std::string> switches;
+    const int first = ParseSwitches(argc, argv, switches);
+    if (first == 0 || first >= argc) {
+        std::cerr << "Usage: " << argv[0] << " [options] <module_file> [entry_point] [args...]" << std::endl;
         std::cerr << "  module_file: Path to .ir (text), .json, or .fob ObjectIR module" << std::endl;
         std::cerr << "  entry_point: Optional class.method entry point (default: Main.Main)" << std::endl;
         std::cerr << "  args: Optional arguments to pass to the entry point" << std::endl;
+        std::cerr << "  options: --<name>=<value> for the switch otherwise read from OBJECTIR_<NAME>:" << std::endl;
+        std::cerr << "    --opt=off|-<pass>,...     optimizer passes" << std::endl;
+        std::cerr << "    --opt-stats               print what each optimizer pass changed" << std::endl;
+        std::cerr << "    --inline=off|<size>       largest callee inlined" << std::endl;
+        std::cerr << "    --tailcalls=off           give every call its own frame" << std::endl;
+        std::cerr << "    --stackless=off           run IR calls on the native stack" << std::endl;
+        std::cerr << "    --tiers=off|<thresholds>  tiered execution" << std::endl;
+        std::cerr << "    --gc=on[,limit=<size>]    collect object cycles" << std::endl;
+        std::cerr << "    --verify=strict           reject unverifiable modules" << std::endl;
+        std::cerr << "    --jit=off                 interpret every method" << std::endl;
+        std::cerr << "    --plugin=<path>           load a native plugin" << std::endl;
         return 1;
     }
 
-    std::string modulePath = argv[1];
-    std::string entryPoint = (argc >= 3) ? argv[2] : "Main.Main";
+    std::string modulePath = argv[first];
+    std::string entryPoint = (argc > first + 1) ? argv[first + 1] : "Main.Main";
 
     // Parse entry point
     size_t dotPos = entryPoint.rfind('.');
@@ -45,6 +119,40 @@ int main(int argc, char* argv[]) {
     std::shared_ptr<VirtualMachine> vm;
 
     try {
+        // OBJECTIR_OPT selects the optimizer passes methods are prepared with,
+        // e.g. OBJECTIR_OPT=off or OBJECTIR_OPT=-dead-store,-unreachable (see
+        // BytecodeOptimizer::Configure). Loading prepares them, so it comes first.
+        if (const char* optMode = GetSwitch(switches, "opt")) {
+            BytecodeOptimizer::Configure(optMode);
+        }
+        // OBJECTIR_INLINE=off keeps every call; a number sets the largest
+        // callee inlined, in prepared instructions (see BytecodeInliner).
+        if (const char* inlineMode = GetSwitch(switches, "inline")) {
+            BytecodeInliner::Configure(inlineMode);
+        }
+        // OBJECTIR_TAILCALLS=off gives every call a frame of its own, which
+        // keeps tail callers in call stacks.
+        if (const char* tailCalls = GetSwitch(switches, "tailcalls")) {
+            BytecodeCompiler::SetTailCallsEnabled(std::string(tailCalls) != "off");
+        }
+        // OBJECTIR_STACKLESS=off runs every IR call on the native stack.
+        if (const char* stackless = GetSwitch(switches, "stackless")) {
+            InstructionExecutor::SetStacklessCallsEnabled(std::string(stackless) != "off");
+        }
+        // OBJECTIR_TIERS=off prepares every method fully at load; otherwise
+        // e.g. OBJECTIR_TIERS=optimize=100,native=1000 moves the thresholds
+        // methods are promoted at (see TieredExecution::Configure).
+        if (const char* tiers = GetSwitch(switches, "tiers")) {
+            TieredExecution::Configure(tiers);
+        }
+        // OBJECTIR_GC=on collects unreachable object cycles; e.g.
+        // OBJECTIR_GC=on,limit=512m also caps the heap (see
+        // GarbageCollector::Configure).
+        if (const char* gcMode = GetSwitch(switches, "gc")) {
+            GarbageCollector::Configure(gcMode);
+        }
+        const char* optStats = GetSwitch(switches, "opt-stats");
+        const bool printOptimizerStatistics = optStats && std::string(optStats) != "0";
 
         if (IsFOBFile(modulePath)) {
             // Load FOB file
@@ -62,7 +170,22 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
-        if (const char* pluginPath = std::getenv("OBJECTIR_PLUGIN")) {
+        // OBJECTIR_VERIFY=strict rejects modules with unverifiable method
+        // bodies instead of running them on the checked interpreter path.
+        if (const char* verifyMode = GetSwitch(switches, "verify")) {
+            if (std::string(verifyMode) == "strict") {
+                vm->VerifyAllClasses();
+            }
+        }
+
+        // OBJECTIR_JIT=off keeps every method in the interpreter.
+        if (const char* jitMode = GetSwitch(switches, "jit")) {
+            if (std::string(jitMode) == "off") {
+                JitCompiler::SetEnabled(false);
+            }
+        }
+
+        if (const char* pluginPath = GetSwitch(switches, "plugin")) {
             if (std::string(pluginPath).size() > 0) {
                 std::cout << "Loading plugin: " << pluginPath << std::endl;
                 vm->LoadPlugin(pluginPath);
@@ -127,7 +250,7 @@ int main(int argc, char* argv[]) {
 
         // Prepare method arguments from command line
         std::vector<Value> methodArgs;
-        for (int i = 3; i < argc; ++i) {
+        for (int i = first + 2; i < argc; ++i) {
             methodArgs.push_back(Value(std::string(argv[i])));
         }
 
@@ -162,6 +285,9 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        if (printOptimizerStatistics) {
+            PrintOptimizerStatistics();
+        }
         return 0;
 
     } catch (const std::exception& e) {
@@ -0,0 +1,248 @@
+#include "objectir_runtime.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+
+// The nursery is reached through one thread-local pointer on every
+// allocation; the initial-exec model keeps that a single load instead of a
+// call into the dynamic linker.
+#if defined(__GNUC__) && !defined(_WIN32)
+    #define OBJECTIR_FAST_TLS __attribute__((tls_model("initial-exec")))
+#else
+    #define OBJECTIR_FAST_TLS
+#endif
+
+namespace ObjectIR {
+
+namespace {
+
+constexpr size_t kChunkSize = 64u << 10;
+constexpr size_t kBlockAlignment = alignof(std::max_align_t);
+constexpr size_t kLargeAllocation = 1u << 10;
+constexpr size_t kSizeClasses = kLargeAllocation / kBlockAlignment;
+// Free blocks a thread keeps per size class before it hands them to the
+// shared lists, so memory freed by one thread and allocated by another
+// keeps circulating. Threads take from the shared lists before they carve
+// out new blocks.
+constexpr uint32_t kMaxLocalBlocks = 4096;
+
+static_assert(kBlockAlignment >= sizeof(void*), "free blocks hold a link");
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct FreeList {
+    FreeBlock* head = nullptr;
+    FreeBlock* tail = nullptr;
+    uint32_t length = 0;
+
+    void Push(FreeBlock* block) {
+        block->next = head;
+        if (!head) {
+            tail = block;
+        }
+        head = block;
+        ++length;
+    }
+
+    FreeBlock* Pop() {
+        FreeBlock* block = head;
+        head = block->next;
+        if (!head) {
+            tail = nullptr;
+        }
+        --length;
+        return block;
+    }
+};
+
+struct SharedLists {
+    std::mutex mutex;
+    FreeList lists[kSizeClasses];
+    std::atomic<bool> nonEmpty[kSizeClasses] = {};
+    Nursery::Statistics statistics;
+};
+
+SharedLists& Shared() {
+    // Never destroyed: objects with static storage duration are released
+    // during exit.
+    static auto* shared = new SharedLists();
+    return *shared;
+}
+
+struct ThreadNursery {
+    char* top = nullptr;
+    char* end = nullptr;
+    FreeList lists[kSizeClasses];
+};
+
+thread_local ThreadNursery* t_nursery OBJECTIR_FAST_TLS = nullptr;
+// Set once the thread's nursery is gone; blocks allocated and released
+// during the rest of its exit go straight through the shared lists.
+thread_local bool t_nurseryClosed OBJECTIR_FAST_TLS = false;
+
+size_t SizeClass(size_t bytes) {
+    return (bytes - 1) / kBlockAlignment;
+}
+
+size_t RoundUp(size_t bytes) {
+    return (bytes + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+}
+
+// Move `list` onto the shared list of its class.
+void Donate(size_t sizeClass, FreeList& list) {
+    if (!list.head) {
+        return;
+    }
+    auto& shared = Shared();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    FreeList& target = shared.lists[sizeClass];
+    list.tail->next = target.head;
+    target.head = list.head;
+    if (!target.tail) {
+        target.tail = list.tail;
+    }
+    target.length += list.length;
+    shared.nonEmpty[sizeClass].store(true, std::memory_order_relaxed);
+    list = FreeList();
+}
+
+// Hands the thread's free blocks to the shared lists when it exits.
+struct NurseryCloser {
+    ~NurseryCloser() {
+        ThreadNursery* nursery = t_nursery;
+        t_nursery = nullptr;
+        t_nurseryClosed = true;
+        if (nursery) {
+            for (size_t i = 0; i < kSizeClasses; ++i) {
+                Donate(i, nursery->lists[i]);
+            }
+            delete nursery;
+        }
+    }
+};
+
+thread_local NurseryCloser t_closer;
+
+ThreadNursery* OpenNursery() {
+    if (t_nurseryClosed) {
+        return nullptr;
+    }
+    // Registers the closer for this thread.
+    (void)&t_closer;
+    t_nursery = new ThreadNursery();
+    return t_nursery;
+}
+
+// Allocate when the thread has no free block of the size: reuse blocks freed
+// on other threads before carving out new ones.
+void* Refill(ThreadNursery* nursery, size_t bytes) {
+    auto& shared = Shared();
+    const size_t sizeClass = SizeClass(bytes);
+    if (shared.nonEmpty[sizeClass].load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        FreeList& source = shared.lists[sizeClass];
+        if (source.head) {
+            FreeBlock* block = source.Pop();
+            if (nursery) {
+                // Adopt the rest of the list.
+                nursery->lists[sizeClass] = source;
+                source = FreeList();
+            }
+            if (!source.head) {
+                shared.nonEmpty[sizeClass].store(false, std::memory_order_relaxed);
+            }
+            return block;
+        }
+    }
+    if (!nursery) {
+        // Any block of the size can join the free lists later.
+        return ::operator new(bytes);
+    }
+
+    if (static_cast<size_t>(nursery->end - nursery->top) < bytes) {
+        // What is left of the old chunk is too small for the block and stays
+        // unused.
+        auto* chunk = static_cast<char*>(::operator new(kChunkSize));
+        nursery->top = chunk;
+        nursery->end = chunk + kChunkSize;
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        ++shared.statistics.chunksCreated;
+        shared.statistics.reservedBytes += kChunkSize;
+    }
+    void* block = nursery->top;
+    nursery->top += bytes;
+    return block;
+}
+
+} // namespace
+
+void* Nursery::Allocate(size_t bytes) {
+#if defined(OBJECTIR_NURSERY)
+    bytes = RoundUp(bytes);
+    if (bytes > kLargeAllocation || bytes == 0) {
+        return ::operator new(bytes == 0 ? 1 : bytes);
+    }
+    ThreadNursery* nursery = t_nursery;
+    if (nursery) {
+        FreeList& list = nursery->lists[SizeClass(bytes)];
+        if (list.head) {
+            return list.Pop();
+        }
+    } else {
+        nursery = OpenNursery();
+    }
+    return Refill(nursery, bytes);
+#else
+    return ::operator new(bytes);
+#endif
+}
+
+void Nursery::Release(void* block, size_t bytes) noexcept {
+    if (!block) {
+        return;
+    }
+#if defined(OBJECTIR_NURSERY)
+    bytes = RoundUp(bytes);
+    if (bytes > kLargeAllocation || bytes == 0) {
+        ::operator delete(block);
+        return;
+    }
+    const size_t sizeClass = SizeClass(bytes);
+    ThreadNursery* nursery = t_nursery;
+    if (!nursery) {
+        nursery = OpenNursery();
+    }
+    FreeList single;
+    FreeList& list = nursery ? nursery->lists[sizeClass] : single;
+    list.Push(static_cast<FreeBlock*>(block));
+    if (list.length > kMaxLocalBlocks || !nursery) {
+        Donate(sizeClass, list);
+    }
+#else
+    (void)bytes;
+    ::operator delete(block);
+#endif
+}
+
+size_t Nursery::GetChunkSize() {
+    return kChunkSize;
+}
+
+size_t Nursery::GetLargeAllocationSize() {
+    return kLargeAllocation;
+}
+
+Nursery::Statistics Nursery::GetStatistics() {
+    auto& shared = Shared();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    Statistics statistics = shared.statistics;
+    for (const auto& list : shared.lists) {
+        statistics.sharedFreeBlocks += list.length;
+    }
+    return statistics;
+}
+
+} // namespace ObjectIR
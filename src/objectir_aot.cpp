@@ -0,0 +1,114 @@
+#include "aot_compiler.hpp"
+#include "bytecode.hpp"
+#include "ir_loader.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ObjectIR;
+
+// objectir_aot: translate the methods of an ObjectIR module into the C++
+// source of a plugin library (see AotCompiler). Compile the output against the
+// runtime headers as a shared library and load it with OBJECTIR_PLUGIN or
+// VirtualMachine::LoadPlugin next to the same module.
+
+namespace {
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <module_file> -o <output.cpp> [--name <plugin_name>] [--verbose]" << std::endl;
+    std::cerr << "  module_file: Path to .ir (text), .json, or .fob ObjectIR module" << std::endl;
+    std::cerr << "  --name:      Name the plugin reports (default: the output file name)" << std::endl;
+    std::cerr << "  --verbose:   List every method and why it stays interpreted" << std::endl;
+}
+
+std::string StemOf(const std::string& path) {
+    const size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    const size_t dot = name.find_last_of('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string modulePath;
+    std::string outputPath;
+    std::string pluginName;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (arg == "--name" && i + 1 < argc) {
+            pluginName = argv[++i];
+        } else if (arg == "--verbose" || arg == "-v") {
+            verbose = true;
+        } else if (modulePath.empty() && !arg.empty() && arg[0] != '-') {
+            modulePath = arg;
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (modulePath.empty() || outputPath.empty()) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    if (pluginName.empty()) {
+        pluginName = StemOf(outputPath);
+    }
+
+    try {
+        // Plugins only match methods prepared with the same optimizer passes
+        // and inlining (see AotCompiler::Fingerprint), so honour the
+        // runtime's switches.
+        if (const char* optMode = std::getenv("OBJECTIR_OPT")) {
+            BytecodeOptimizer::Configure(optMode);
+        }
+        if (const char* inlineMode = std::getenv("OBJECTIR_INLINE")) {
+            BytecodeInliner::Configure(inlineMode);
+        }
+
+        // Detects FOB, text and JSON modules.
+        auto vm = IRLoader::LoadFromFile(modulePath);
+        if (!vm) {
+            std::cerr << "Failed to load module from: " << modulePath << std::endl;
+            return 1;
+        }
+
+        std::vector<AotMethodReport> report;
+        const std::string source = AotCompiler::GenerateSource(*vm, pluginName, &report);
+
+        std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            std::cerr << "Cannot write " << outputPath << std::endl;
+            return 1;
+        }
+        output << source;
+        if (!output.flush()) {
+            std::cerr << "Cannot write " << outputPath << std::endl;
+            return 1;
+        }
+
+        size_t compiled = 0;
+        for (const auto& entry : report) {
+            if (entry.compiled) {
+                ++compiled;
+            }
+            if (verbose) {
+                std::cout << (entry.compiled ? "  compiled     " : "  interpreted  ") << entry.className << "."
+                          << entry.signature << (entry.compiled ? "" : "  (" + entry.reason + ")") << std::endl;
+            }
+        }
+        std::cout << "Precompiled " << compiled << " of " << report.size() << " methods into " << outputPath
+                  << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -49,16 +49,8 @@ ObjectIR::ClassRef FindClass(ObjectIR::VirtualMachine* vm, const std::string& cl
     throw std::runtime_error("Class not found: " + className);
 }
 
-std::vector<ObjectIR::MethodRef> CollectMethodsByName(ObjectIR::ClassRef cls, const std::string& name) {
-    std::vector<ObjectIR::MethodRef> matches;
-    for (auto current = cls; current; current = current->GetBaseClass()) {
-        for (const auto& method : current->GetAllMethods()) {
-            if (method && method->GetName() == name) {
-                matches.push_back(method);
-            }
-        }
-    }
-    return matches;
+const std::vector<ObjectIR::MethodRef>& CollectMethodsByName(ObjectIR::ClassRef cls, const std::string& name) {
+    return cls->GetMethodsByName(ObjectIR::SymbolTable::Find(name));
 }
 
 bool ParameterTypeMatches(const std::string& requestedType, const ObjectIR::TypeReference& parameterType) {
@@ -77,7 +69,7 @@ bool ParameterTypeMatches(const std::string& requestedType, const ObjectIR::Type
 ObjectIR::MethodRef FindMethodBySignatureOrThrow(ObjectIR::ClassRef cls,
                                                 const std::string& name,
                                                 const std::vector<std::string>& parameterTypes) {
-    auto candidates = CollectMethodsByName(cls, name);
+    const auto& candidates = CollectMethodsByName(cls, name);
     if (candidates.empty()) {
         throw std::runtime_error("Method not found: " + name);
     }
@@ -108,7 +100,7 @@ ObjectIR::MethodRef FindMethodBySignatureOrThrow(ObjectIR::ClassRef cls,
 }
 
 ObjectIR::MethodRef FindMethodUniqueNameOrThrow(ObjectIR::ClassRef cls, const std::string& name) {
-    auto candidates = CollectMethodsByName(cls, name);
+    const auto& candidates = CollectMethodsByName(cls, name);
     if (candidates.empty()) {
         throw std::runtime_error("Method not found: " + name);
     }
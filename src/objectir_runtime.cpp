@@ -1,10 +1,20 @@
 #include "objectir_runtime.hpp"
+#include "bytecode.hpp"
 #include "instruction_executor.hpp"
 #include "objectir_plugin.hpp"
 #include "objectir_plugin_api.h"
 #include "objectir_type_names.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
@@ -113,6 +123,8 @@ std::string OpCodeToString(OpCode op) {
         case OpCode::Continue: return "continue";
         case OpCode::Throw: return "throw";
         case OpCode::While: return "while";
+        case OpCode::Leave: return "leave";
+        case OpCode::EndFinally: return "endfinally";
         default: return "nop";
     }
 }
@@ -262,6 +274,71 @@ struct VirtualMachine::LoadedPlugin {
     std::string path;
 };
 
+// ============================================================================
+// SymbolTable Implementation
+// ============================================================================
+
+namespace {
+
+struct SymbolStore {
+    std::shared_mutex mutex;
+    // A deque keeps each name in place as the table grows, so the keys of
+    // `ids` and the references GetName returns stay valid.
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, SymbolId> ids;
+};
+
+SymbolStore& Symbols() {
+    // Never destroyed: names may still be interned or looked up while other
+    // statics are torn down.
+    static SymbolStore* store = new SymbolStore();
+    return *store;
+}
+
+} // namespace
+
+SymbolId SymbolTable::Intern(std::string_view name) {
+    SymbolStore& store = Symbols();
+    {
+        std::shared_lock<std::shared_mutex> lock(store.mutex);
+        auto it = store.ids.find(name);
+        if (it != store.ids.end()) {
+            return it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(store.mutex);
+    auto it = store.ids.find(name);
+    if (it != store.ids.end()) {
+        return it->second;
+    }
+    const auto symbol = static_cast<SymbolId>(store.names.size());
+    store.names.emplace_back(name);
+    store.ids.emplace(store.names.back(), symbol);
+    return symbol;
+}
+
+SymbolId SymbolTable::Find(std::string_view name) {
+    SymbolStore& store = Symbols();
+    std::shared_lock<std::shared_mutex> lock(store.mutex);
+    auto it = store.ids.find(name);
+    return it != store.ids.end() ? it->second : kNoSymbol;
+}
+
+const std::string& SymbolTable::GetName(SymbolId symbol) {
+    SymbolStore& store = Symbols();
+    std::shared_lock<std::shared_mutex> lock(store.mutex);
+    if (symbol >= store.names.size()) {
+        throw std::out_of_range("Unknown symbol id: " + std::to_string(symbol));
+    }
+    return store.names[symbol];
+}
+
+size_t SymbolTable::GetCount() {
+    SymbolStore& store = Symbols();
+    std::shared_lock<std::shared_mutex> lock(store.mutex);
+    return store.names.size();
+}
+
 // ============================================================================
 // TypeReference Implementation
 // ============================================================================
@@ -343,70 +420,72 @@ std::string TypeReference::ToString() const {
 // Value Implementation
 // ============================================================================
 
-Value::Value() : _value(nullptr) {}
-Value::Value(int32_t i32) : _value(i32) {}
-Value::Value(int64_t i64) : _value(i64) {}
-Value::Value(float f) : _value(f) {}
-Value::Value(double d) : _value(d) {}
-Value::Value(bool b) : _value(b) {}
-Value::Value(const std::string& str) : _value(str) {}
-Value::Value(ObjectRef obj) : _value(obj) {}
+/// Immutable, reference-counted string payload of a Value.
+struct Value::StringData {
+    explicit StringData(const std::string& str) : value(str) {}
 
-bool Value::IsInt32() const { return _value.index() == 1; }
-bool Value::IsInt64() const { return _value.index() == 2; }
-bool Value::IsFloat32() const { return _value.index() == 3; }
-bool Value::IsFloat64() const { return _value.index() == 4; }
-bool Value::IsBool() const { return _value.index() == 5; }
-bool Value::IsString() const { return _value.index() == 6; }
-bool Value::IsObject() const { return _value.index() == 7; }
+    mutable std::atomic<uint32_t> refCount{1};
+    const std::string value;
+};
 
-int32_t Value::AsInt32() const {
-    if (!IsInt32()) throw std::runtime_error("Value is not int32");
-    return std::get<int32_t>(_value);
+Value::Value(const std::string& str) : _tag(Tag::String) {
+    _payload.str = new StringData(str);
 }
 
-int64_t Value::AsInt64() const {
-    if (!IsInt64()) throw std::runtime_error("Value is not int64");
-    return std::get<int64_t>(_value);
+Value::Value(ObjectRef obj) : _tag(Tag::Object) {
+    _payload.obj = obj.get();
+    if (obj) {
+        obj->RetainValueReference(obj);
+    }
 }
 
-float Value::AsFloat32() const {
-    if (!IsFloat32()) throw std::runtime_error("Value is not float32");
-    return std::get<float>(_value);
+void Value::ThrowTypeMismatch(const char* typeName) {
+    // Checked in member scope, where the layout is accessible.
+    static_assert(offsetof(Value, _tag) == 0 && offsetof(Value, _payload) == kPayloadOffset,
+                  "native code relies on the Value layout");
+    throw std::runtime_error(std::string("Value is not ") + typeName);
 }
 
-double Value::AsFloat64() const {
-    if (!IsFloat64()) throw std::runtime_error("Value is not float64");
-    return std::get<double>(_value);
+void Value::Retain() const noexcept {
+    if (_tag == Tag::String) {
+        _payload.str->refCount.fetch_add(1, std::memory_order_relaxed);
+    } else if (_payload.obj) {
+        _payload.obj->RetainValueReference();
+    }
 }
 
-bool Value::AsBool() const {
-    if (!IsBool()) throw std::runtime_error("Value is not bool");
-    return std::get<bool>(_value);
+void Value::Release() noexcept {
+    if (_tag == Tag::String) {
+        if (_payload.str->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete _payload.str;
+        }
+    } else if (_payload.obj) {
+        _payload.obj->ReleaseValueReference();
+    }
 }
 
-std::string Value::AsString() const {
-    if (!IsString()) throw std::runtime_error("Value is not string");
-    return std::get<std::string>(_value);
+const std::string& Value::AsStringRef() const {
+    if (!IsString()) ThrowTypeMismatch("string");
+    return _payload.str->value;
 }
 
 ObjectRef Value::AsObject() const {
-    if (!IsObject()) throw std::runtime_error("Value is not object");
-    return std::get<ObjectRef>(_value);
+    if (!IsObject()) ThrowTypeMismatch("object");
+    return _payload.obj ? _payload.obj->GetValueAnchor() : ObjectRef();
 }
 
 bool Value::operator==(const Value& other) const {
-    if (_value.index() != other._value.index()) return false;
+    if (_tag != other._tag) return false;
     
-    switch (_value.index()) {
-        case 0: return true; // both null
-        case 1: return std::get<int32_t>(_value) == std::get<int32_t>(other._value);
-        case 2: return std::get<int64_t>(_value) == std::get<int64_t>(other._value);
-        case 3: return std::get<float>(_value) == std::get<float>(other._value);
-        case 4: return std::get<double>(_value) == std::get<double>(other._value);
-        case 5: return std::get<bool>(_value) == std::get<bool>(other._value);
-        case 6: return std::get<std::string>(_value) == std::get<std::string>(other._value);
-        case 7: return std::get<ObjectRef>(_value) == std::get<ObjectRef>(other._value);
+    switch (_tag) {
+        case Tag::Null: return true; // both null
+        case Tag::Int32: return _payload.i32 == other._payload.i32;
+        case Tag::Int64: return _payload.i64 == other._payload.i64;
+        case Tag::Float32: return _payload.f32 == other._payload.f32;
+        case Tag::Float64: return _payload.f64 == other._payload.f64;
+        case Tag::Bool: return _payload.b == other._payload.b;
+        case Tag::String: return _payload.str == other._payload.str || _payload.str->value == other._payload.str->value;
+        case Tag::Object: return _payload.obj == other._payload.obj;
         default: return false;
     }
 }
@@ -416,10 +495,36 @@ bool Value::operator==(const Value& other) const {
 // ============================================================================
 
 void Object::SetField(const std::string& fieldName, const Value& value) {
-    _fieldValues[fieldName] = value;
+    SetField(SymbolTable::Intern(fieldName), value);
 }
 
 Value Object::GetField(const std::string& fieldName) const {
+    const SymbolId symbol = SymbolTable::Find(fieldName);
+    if (symbol == kNoSymbol) {
+        throw std::runtime_error("Field not found: " + fieldName);
+    }
+    return GetField(symbol);
+}
+
+void Object::SetField(SymbolId fieldName, const Value& value) {
+    if (_class) {
+        const size_t slot = _class->GetFieldSlot(fieldName);
+        if (slot < _slots.size()) {
+            _slots[slot] = value;
+            return;
+        }
+    }
+    _fieldValues[fieldName] = value;
+}
+
+Value Object::GetField(SymbolId fieldName) const {
+    if (_class) {
+        const size_t slot = _class->GetFieldSlot(fieldName);
+        if (slot < _slots.size()) {
+            return _slots[slot];
+        }
+    }
+
     auto it = _fieldValues.find(fieldName);
     if (it != _fieldValues.end()) {
         return it->second;
@@ -430,19 +535,224 @@ Value Object::GetField(const std::string& fieldName) const {
         return _baseInstance->GetField(fieldName);
     }
     
-    throw std::runtime_error("Field not found: " + fieldName);
+    throw std::runtime_error("Field not found: " + SymbolTable::GetName(fieldName));
 }
 
-bool Object::IsInstanceOf(ClassRef classType) const {
-    if (!_class) return false;
-    
-    auto current = _class;
-    while (current) {
-        if (current == classType) return true;
-        current = current->GetBaseClass();
+void Object::InitializeFieldSlot(const std::string& fieldName) {
+    const SymbolId symbol = SymbolTable::Intern(fieldName);
+    if (_class && _class->GetFieldSlot(symbol) < _slots.size()) {
+        return; // Laid out by the class; slots start out null
     }
-    
-    return _class->ImplementsInterface(classType);
+    if (_fieldValues.find(symbol) == _fieldValues.end()) {
+        _fieldValues[symbol] = Value(); // Initialize to null/default
+    }
+}
+
+void Object::RetainValueReference(const ObjectRef& self) const {
+    if (_valueRefCount.fetch_add(1, std::memory_order_acq_rel) != 0) {
+        return;
+    }
+    // First Value referring to this object: anchor it. The lock orders this
+    // against a concurrent release of the previous last reference.
+    while (_valueAnchorLock.test_and_set(std::memory_order_acquire)) {
+    }
+    _valueAnchor = self;
+    _valueAnchorLock.clear(std::memory_order_release);
+}
+
+void Object::ReleaseValueReference() const noexcept {
+    if (_valueRefCount.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    ObjectRef anchor;
+    while (_valueAnchorLock.test_and_set(std::memory_order_acquire)) {
+    }
+    if (_valueRefCount.load(std::memory_order_acquire) == 0) {
+        anchor = std::move(_valueAnchor);
+    }
+    _valueAnchorLock.clear(std::memory_order_release);
+    // `anchor` may hold the last strong reference; it is released here, after
+    // the lock, since destroying it can destroy this object.
+}
+
+void Object::VisitReferences(ReferenceVisitor& visitor) const {
+    for (const auto& value : _slots) {
+        visitor.VisitValue(value);
+    }
+    for (const auto& entry : _fieldValues) {
+        visitor.VisitValue(entry.second);
+    }
+    if (_baseInstance) {
+        visitor.VisitObject(_baseInstance.get());
+    }
+    if (_dataTracer && _data) {
+        _dataTracer(_data.get(), visitor);
+    }
+}
+
+void Object::ClearReferences() {
+    for (auto& value : _slots) {
+        value = Value();
+    }
+    _fieldValues.clear();
+    _baseInstance.reset();
+    _data.reset();
+    _dataTracer = nullptr;
+}
+
+namespace {
+
+// The storage kind of an array of `elementType` (see Array::_elementKind).
+PrimitiveType ArrayElementKind(const TypeReference& elementType) {
+    if (!elementType.IsPrimitive() || elementType.IsArray()) {
+        return PrimitiveType::Object;
+    }
+    switch (elementType.GetPrimitiveType()) {
+        case PrimitiveType::Int32:
+        case PrimitiveType::Int64:
+        case PrimitiveType::Float32:
+        case PrimitiveType::Float64:
+        case PrimitiveType::Bool:
+        case PrimitiveType::UInt8:
+            return elementType.GetPrimitiveType();
+        default:
+            return PrimitiveType::Object;
+    }
+}
+
+size_t UnboxedElementSize(PrimitiveType kind) {
+    switch (kind) {
+        case PrimitiveType::Int32: return sizeof(int32_t);
+        case PrimitiveType::Int64: return sizeof(int64_t);
+        case PrimitiveType::Float32: return sizeof(float);
+        case PrimitiveType::Float64: return sizeof(double);
+        case PrimitiveType::Bool: return sizeof(bool);
+        case PrimitiveType::UInt8: return sizeof(uint8_t);
+        default: return 0;
+    }
+}
+
+// Converts a floating-point value to an integer element type, truncating
+// toward zero. Values that do not fit after truncation, NaN among them,
+// throw instead of storing an arbitrary element.
+template<typename T>
+T FloatingToElement(double value, const TypeReference& elementType) {
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+        // Both bounds are powers of two (or zero), so exact as doubles.
+        const double upper = std::ldexp(1.0, std::numeric_limits<T>::digits);
+        const double lower = std::is_signed_v<T> ? -upper : 0.0;
+        const double truncated = std::trunc(value);
+        if (!(truncated >= lower && truncated < upper)) {
+            throw std::runtime_error("Cannot store " + std::to_string(value) + " in an array of " +
+                                     elementType.ToString() + ": out of range");
+        }
+        return static_cast<T>(truncated);
+    } else {
+        return static_cast<T>(value);
+    }
+}
+
+// Converts a numeric value to the element type of an unboxed array. Integers
+// wrap to the element's width, floating-point values go through
+// FloatingToElement, and any nonzero value stores as true in a bool array.
+template<typename T>
+T ToElement(const Value& value, const TypeReference& elementType) {
+    if (value.IsInt32()) return static_cast<T>(value.AsInt32());
+    if (value.IsInt64()) return static_cast<T>(value.AsInt64());
+    if (value.IsFloat32()) return FloatingToElement<T>(value.AsFloat32(), elementType);
+    if (value.IsFloat64()) return FloatingToElement<T>(value.AsFloat64(), elementType);
+    if (value.IsBool()) return static_cast<T>(value.AsBool());
+    const char* kind = value.IsNull() ? "null" : value.IsString() ? "a string" : "an object";
+    throw std::runtime_error(std::string("Cannot store ") + kind + " in an array of " +
+                             elementType.ToString());
+}
+
+template<typename T>
+void StoreElement(unsigned char* buffer, int32_t index, const Value& value, const TypeReference& elementType) {
+    const T element = ToElement<T>(value, elementType);
+    std::memcpy(buffer + static_cast<size_t>(index) * sizeof(T), &element, sizeof(T));
+}
+
+template<typename T>
+T LoadElement(const unsigned char* buffer, int32_t index) {
+    T element;
+    std::memcpy(&element, buffer + static_cast<size_t>(index) * sizeof(T), sizeof(T));
+    return element;
+}
+
+} // namespace
+
+Array::Array(TypeReference elementType, int32_t length)
+    : _elementType(std::move(elementType)),
+      _length(length),
+      _elementKind(ArrayElementKind(_elementType)) {
+    const size_t count = static_cast<size_t>(std::max(length, 0));
+    if (IsUnboxed()) {
+        _buffer.resize(count * UnboxedElementSize(_elementKind));
+    } else {
+        _elements.resize(count);
+    }
+}
+
+void Array::SetElement(int32_t index, const Value& value) {
+    if (index < 0 || index >= _length) {
+        return;
+    }
+    unsigned char* buffer = _buffer.data();
+    switch (_elementKind) {
+        case PrimitiveType::Int32: StoreElement<int32_t>(buffer, index, value, _elementType); break;
+        case PrimitiveType::Int64: StoreElement<int64_t>(buffer, index, value, _elementType); break;
+        case PrimitiveType::Float32: StoreElement<float>(buffer, index, value, _elementType); break;
+        case PrimitiveType::Float64: StoreElement<double>(buffer, index, value, _elementType); break;
+        case PrimitiveType::Bool: StoreElement<bool>(buffer, index, value, _elementType); break;
+        case PrimitiveType::UInt8: StoreElement<uint8_t>(buffer, index, value, _elementType); break;
+        default: _elements[index] = value; break;
+    }
+}
+
+Value Array::GetElement(int32_t index) const {
+    if (index < 0 || index >= _length) {
+        return Value(); // null
+    }
+    const unsigned char* buffer = _buffer.data();
+    switch (_elementKind) {
+        case PrimitiveType::Int32: return Value(LoadElement<int32_t>(buffer, index));
+        case PrimitiveType::Int64: return Value(LoadElement<int64_t>(buffer, index));
+        case PrimitiveType::Float32: return Value(LoadElement<float>(buffer, index));
+        case PrimitiveType::Float64: return Value(LoadElement<double>(buffer, index));
+        case PrimitiveType::Bool: return Value(LoadElement<bool>(buffer, index));
+        // Bytes are loaded as int32, like every small integer on the stack.
+        case PrimitiveType::UInt8: return Value(static_cast<int32_t>(LoadElement<uint8_t>(buffer, index)));
+        default: return _elements[index];
+    }
+}
+
+size_t Array::GetElementSize() const {
+    return IsUnboxed() ? UnboxedElementSize(_elementKind) : sizeof(Value);
+}
+
+void Array::ThrowElementTypeMismatch() const {
+    throw std::runtime_error("Array elements are not of the requested type (array of " +
+                             _elementType.ToString() + ")");
+}
+
+void Array::VisitReferences(ReferenceVisitor& visitor) const {
+    Object::VisitReferences(visitor);
+    for (const auto& element : _elements) {
+        visitor.VisitValue(element);
+    }
+}
+
+void Array::ClearReferences() {
+    Object::ClearReferences();
+    for (auto& element : _elements) {
+        element = Value();
+    }
+}
+
+bool Object::IsInstanceOf(ClassRef classType) const {
+    if (!_class || !classType) return false;
+    return _class->IsSubclassOf(*classType) || _class->ImplementsInterface(classType);
 }
 
 // ============================================================================
@@ -456,30 +766,95 @@ bool Object::IsInstanceOf(ClassRef classType) const {
 // ============================================================================
 
 void Method::AddParameter(const std::string& name, const TypeReference& type) {
+    _parameterIndices[SymbolTable::Intern(name)] = _parameters.size();
     _parameters.emplace_back(name, type);
+    _prepared.reset();
+    // The parameter list takes part in overload resolution.
+    VirtualMachine::InvalidateDispatchCaches();
 }
 
 void Method::AddLocal(const std::string& name, const TypeReference& type) {
+    _localIndices[SymbolTable::Intern(name)] = _locals.size();
     _locals.emplace_back(name, type);
+    _prepared.reset();
 }
 
 void Method::SetInstructions(std::vector<Instruction> instructions) {
-    _instructions = std::move(instructions);
+    _instructions = std::make_shared<const std::vector<Instruction>>(std::move(instructions));
+    Prepare();
+    VirtualMachine::InvalidateDispatchCaches();
+}
+
+void Method::SetNativeImpl(NativeMethodImpl impl) {
+    _nativeImpl = std::move(impl);
+    VirtualMachine::InvalidateDispatchCaches();
+}
+
+bool Method::HasSameSignature(const Method& other) const {
+    if (_parameters.size() != other._parameters.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < _parameters.size(); ++i) {
+        if (TypeNames::CanonicalTypeName(_parameters[i].second) !=
+            TypeNames::CanonicalTypeName(other._parameters[i].second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Method::Prepare() {
+    _prepared = BytecodeCompiler::Compile(*this, nullptr, TieredExecution::GetInitialTier());
+}
+
+std::shared_ptr<PreparedMethod> Method::GetPrepared() const {
+    if (!_prepared) {
+        _prepared = BytecodeCompiler::Compile(*this, nullptr, TieredExecution::GetInitialTier());
+    }
+    return _prepared;
+}
+
+ExecutionTier Method::GetTier() const {
+    if (_nativeImpl || (_prepared && _prepared->nativeCode && !_prepared->nativeCodeRejected)) {
+        return ExecutionTier::Native;
+    }
+    return _prepared ? _prepared->tier : ExecutionTier::Interpreter;
+}
+
+const char* GetExecutionTierName(ExecutionTier tier) {
+    switch (tier) {
+        case ExecutionTier::Interpreter:
+            return "interpreter";
+        case ExecutionTier::Optimized:
+            return "optimized";
+        case ExecutionTier::Native:
+            return "native";
+    }
+    return "unknown";
 }
 
 // ============================================================================
 // Class Implementation
 // ============================================================================
 
-Class::Class(std::string name) : _name(std::move(name)) {}
+Class::Class(std::string name) : _name(std::move(name)), _nameSymbol(SymbolTable::Intern(_name)) {}
 
 void Class::AddField(FieldRef field) {
+    if (_layoutFinalized) {
+        throw std::runtime_error("Cannot add field '" + field->GetName() + "' to class '" + _name +
+                                 "' after its layout has been finalized");
+    }
     _fields.push_back(field);
 }
 
 FieldRef Class::GetField(const std::string& name) const {
+    const SymbolId symbol = SymbolTable::Find(name);
+    return symbol != kNoSymbol ? GetField(symbol) : nullptr;
+}
+
+FieldRef Class::GetField(SymbolId name) const {
     for (const auto& field : _fields) {
-        if (field->GetName() == name) {
+        if (field->GetNameSymbol() == name) {
             return field;
         }
     }
@@ -491,13 +866,33 @@ FieldRef Class::GetField(const std::string& name) const {
     return nullptr;
 }
 
+void Class::SetBaseClass(ClassRef base) {
+    if (_layoutFinalized) {
+        throw std::runtime_error("Cannot change the base class of '" + _name +
+                                 "' after its layout has been finalized");
+    }
+    for (const Class* current = base.get(); current; current = current->_baseClass.get()) {
+        if (current == this) {
+            throw std::runtime_error("Class '" + _name + "' cannot derive from itself");
+        }
+    }
+    _baseClass = std::move(base);
+    VirtualMachine::InvalidateDispatchCaches();
+}
+
 void Class::AddMethod(MethodRef method) {
     _methods.push_back(method);
+    VirtualMachine::InvalidateDispatchCaches();
 }
 
 MethodRef Class::GetMethod(const std::string& name) const {
+    const SymbolId symbol = SymbolTable::Find(name);
+    return symbol != kNoSymbol ? GetMethod(symbol) : nullptr;
+}
+
+MethodRef Class::GetMethod(SymbolId name) const {
     for (const auto& method : _methods) {
-        if (method->GetName() == name) {
+        if (method->GetNameSymbol() == name) {
             return method;
         }
     }
@@ -509,42 +904,199 @@ std::vector<MethodRef> Class::GetMethods() const {
 }
 
 MethodRef Class::LookupMethod(const std::string& name) const {
-    auto method = GetMethod(name);
-    if (method) return method;
-    
+    const SymbolId symbol = SymbolTable::Find(name);
+    return symbol != kNoSymbol ? LookupMethod(symbol) : nullptr;
+}
+
+MethodRef Class::LookupMethod(SymbolId name) const {
+    const auto& methods = GetMethodsByName(name);
+    return methods.empty() ? nullptr : methods.front();
+}
+
+void Class::FinalizeDispatch() const {
+    const uint64_t epoch = VirtualMachine::GetDispatchEpoch();
+    if (_dispatchEpoch == epoch) {
+        return;
+    }
+    _dispatchEpoch = epoch;
+
+    _vtable.clear();
+    _interfaceTables.clear();
+    _methodsByName.clear();
+    _ancestors.clear();
     if (_baseClass) {
-        return _baseClass->LookupMethod(name);
+        _baseClass->FinalizeDispatch();
+        _vtable = _baseClass->_vtable;
+        _ancestors = _baseClass->_ancestors;
+    }
+    _ancestors.push_back(this);
+
+    for (const auto& method : _methods) {
+        if (!method) {
+            continue;
+        }
+        _methodsByName[method->GetNameSymbol()].push_back(method);
+        if (method->IsStatic()) {
+            continue;
+        }
+        size_t slot = _vtable.size();
+        if (_baseClass) {
+            for (const auto& inherited : _baseClass->GetMethodsByName(method->GetNameSymbol())) {
+                if (!inherited->IsStatic() && inherited->GetVTableSlot() < _vtable.size() &&
+                    method->HasSameSignature(*inherited)) {
+                    slot = inherited->GetVTableSlot();
+                    break;
+                }
+            }
+        }
+        if (slot == _vtable.size()) {
+            _vtable.push_back(method);
+        } else {
+            _vtable[slot] = method;
+        }
+        method->SetVTableSlot(slot);
+    }
+
+    if (_baseClass) {
+        for (const auto& [name, methods] : _baseClass->_methodsByName) {
+            auto& visible = _methodsByName[name];
+            for (const auto& inherited : methods) {
+                const size_t slot = inherited->GetVTableSlot();
+                if (!inherited->IsStatic() && slot < _vtable.size() && _vtable[slot] != inherited) {
+                    continue; // overridden here
+                }
+                visible.push_back(inherited);
+            }
+        }
+    }
+
+    // Interfaces of the base class, then the class's own and their bases.
+    std::vector<const Class*> interfaces;
+    auto addInterface = [&interfaces](const Class* iface) {
+        if (std::find(interfaces.begin(), interfaces.end(), iface) == interfaces.end()) {
+            interfaces.push_back(iface);
+        }
+    };
+    if (_baseClass) {
+        for (const auto& entry : _baseClass->_interfaceTables) {
+            addInterface(entry.first);
+        }
+    }
+    for (const auto& iface : _interfaces) {
+        if (!iface || iface.get() == this) {
+            continue;
+        }
+        iface->FinalizeDispatch();
+        addInterface(iface.get());
+        for (const auto& entry : iface->_interfaceTables) {
+            addInterface(entry.first);
+        }
+    }
+    for (const Class* iface : interfaces) {
+        iface->FinalizeDispatch();
+        std::vector<MethodRef> table(iface->_vtable.size());
+        for (size_t slot = 0; slot < table.size(); ++slot) {
+            const MethodRef& required = iface->_vtable[slot];
+            auto it = _methodsByName.find(required->GetNameSymbol());
+            if (it == _methodsByName.end()) {
+                continue;
+            }
+            for (const auto& candidate : it->second) {
+                if (!candidate->IsStatic() && candidate->HasSameSignature(*required)) {
+                    table[slot] = candidate;
+                    break;
+                }
+            }
+        }
+        _interfaceTables.emplace_back(iface, std::move(table));
+    }
+}
+
+const std::vector<MethodRef>& Class::GetVTable() const {
+    FinalizeDispatch();
+    return _vtable;
+}
+
+const std::vector<MethodRef>* Class::GetInterfaceTable(const Class& interfaceType) const {
+    FinalizeDispatch();
+    for (const auto& entry : _interfaceTables) {
+        if (entry.first == &interfaceType) {
+            return &entry.second;
+        }
     }
-    
     return nullptr;
 }
 
-ObjectRef Class::CreateInstance() const {
-    auto obj = std::make_shared<Object>();
-    obj->SetClass(std::const_pointer_cast<Class>(shared_from_this()));
-    
-    // Initialize all field value slots for this class and base classes
-    auto current = std::const_pointer_cast<Class>(shared_from_this());
-    while (current) {
-        // Initialize field values from most derived to most base
-        for (const auto& field : current->GetAllFields()) {
-            obj->InitializeFieldSlot(field->GetName());
+const std::vector<MethodRef>& Class::GetMethodsByName(SymbolId name) const {
+    static const std::vector<MethodRef> kNone;
+    FinalizeDispatch();
+    auto it = _methodsByName.find(name);
+    return it != _methodsByName.end() ? it->second : kNone;
+}
+
+bool Class::IsSubclassOf(const Class& classType) const {
+    FinalizeDispatch();
+    classType.FinalizeDispatch();
+    const size_t depth = classType._ancestors.size() - 1;
+    return depth < _ancestors.size() && _ancestors[depth] == &classType;
+}
+
+void Class::FinalizeLayout() const {
+    if (_layoutFinalized) {
+        return;
+    }
+
+    _fieldSlots.clear();
+    _fieldSlotCount = 0;
+    if (_baseClass) {
+        _baseClass->FinalizeLayout();
+        _fieldSlots = _baseClass->_fieldSlots;
+        _fieldSlotCount = _baseClass->_fieldSlotCount;
+    }
+
+    for (const auto& field : _fields) {
+        auto [it, inserted] = _fieldSlots.emplace(field->GetNameSymbol(), _fieldSlotCount);
+        if (inserted) {
+            ++_fieldSlotCount;
         }
-        current = current->GetBaseClass();
+        field->SetSlot(it->second);
     }
-    
+
+    _layoutFinalized = true;
+}
+
+size_t Class::GetFieldSlotCount() const {
+    FinalizeLayout();
+    return _fieldSlotCount;
+}
+
+size_t Class::GetFieldSlot(const std::string& name) const {
+    const SymbolId symbol = SymbolTable::Find(name);
+    return symbol != kNoSymbol ? GetFieldSlot(symbol) : kNoFieldSlot;
+}
+
+size_t Class::GetFieldSlot(SymbolId name) const {
+    FinalizeLayout();
+    auto it = _fieldSlots.find(name);
+    return it != _fieldSlots.end() ? it->second : kNoFieldSlot;
+}
+
+ObjectRef Class::CreateInstance() const {
+    // All fields of this class and its base classes live in the object's
+    // slot array and start out null.
+    auto obj = std::allocate_shared<Object>(NurseryAllocator<Object>(), GetFieldSlotCount());
+    obj->SetClass(std::const_pointer_cast<Class>(shared_from_this()));
+    GarbageCollector::Track(obj, sizeof(Object) + obj->GetSlotCount() * sizeof(Value));
     return obj;
 }
 
 void Class::AddInterface(ClassRef interfaceType) {
     _interfaces.push_back(interfaceType);
+    VirtualMachine::InvalidateDispatchCaches();
 }
 
 bool Class::ImplementsInterface(ClassRef interfaceType) const {
-    for (const auto& iface : _interfaces) {
-        if (iface == interfaceType) return true;
-    }
-    return false;
+    return interfaceType && GetInterfaceTable(*interfaceType) != nullptr;
 }
 
 // ============================================================================
@@ -552,115 +1104,189 @@ bool Class::ImplementsInterface(ClassRef interfaceType) const {
 // ============================================================================
 
 ExecutionContext::ExecutionContext(MethodRef method)
-    : _method(std::move(method)) {
+    : _method(std::move(method)), _values(&_ownValues) {
     if (!_method) {
         throw std::runtime_error("ExecutionContext requires a valid method reference");
     }
 
-    const auto& locals = _method->GetLocals();
-    _locals.resize(locals.size());
-    for (size_t i = 0; i < locals.size(); ++i) {
-        _localIndices[locals[i].first] = i;
-    }
+    _argumentCount = _method->GetParameters().size();
+    _localBase = _argumentCount;
+    _localCount = _method->GetLocals().size();
+    _stackBase = _localBase + _localCount;
+    _ownValues.resize(_stackBase);
+}
 
-    // Debug: Print locals mapping for this execution context
-    // std::cerr << "[" << _method->GetName() << "] ExecutionContext locals: count=" << locals.size() << std::endl;
-    for (size_t i = 0; i < locals.size(); ++i) {
-        // std::cerr << "  [" << _method->GetName() << "] local index " << i << " -> '" << locals[i].first << "' (" << locals[i].second.ToString() << ")" << std::endl;
+ExecutionContext::ExecutionContext(MethodRef method, std::vector<Value>& frameValues, size_t argumentCount)
+    : _values(&frameValues) {
+    Bind(std::move(method), frameValues, argumentCount);
+}
+
+void ExecutionContext::Bind(MethodRef method, std::vector<Value>& frameValues, size_t argumentCount) {
+    if (!method) {
+        throw std::runtime_error("ExecutionContext requires a valid method reference");
     }
+    if (argumentCount > frameValues.size()) {
+        throw std::runtime_error("Stack underflow");
+    }
+
+    _method = std::move(method);
+    _values = &frameValues;
+    _ownValues.clear();
+    _this.reset();
+    _hasLastInstruction = false;
+    _lastIp = 0;
+    _lastOpCode = OpCode::Nop;
 
-    const auto& parameters = _method->GetParameters();
-    _arguments.resize(parameters.size());
-    for (size_t i = 0; i < parameters.size(); ++i) {
-        _parameterIndices[parameters[i].first] = i;
+    _argumentBase = frameValues.size() - argumentCount;
+    _argumentCount = argumentCount;
+    _localBase = frameValues.size();
+    _localCount = _method->GetLocals().size();
+    _stackBase = _localBase + _localCount;
+    frameValues.resize(_stackBase);
+}
+
+void ExecutionContext::Rebind(MethodRef method, size_t argumentCount) {
+    if (argumentCount > GetStackDepth()) {
+        throw std::runtime_error("Stack underflow");
     }
+    auto first = _values->end() - static_cast<ptrdiff_t>(argumentCount);
+    std::move(first, _values->end(), _values->begin() + static_cast<ptrdiff_t>(_argumentBase));
+    _values->resize(_argumentBase + argumentCount);
+    Bind(std::move(method), *_values, argumentCount);
+}
+
+void ExecutionContext::Unbind() {
+    _method.reset();
+    _this.reset();
+    _ownValues.clear();
+    _values = &_ownValues;
+    _argumentBase = _argumentCount = _localBase = _localCount = _stackBase = 0;
+}
 
-    // Debug: Print parameters mapping for this execution context
-    // std::cerr << "[" << _method->GetName() << "] ExecutionContext parameters: count=" << parameters.size() << std::endl;
-    for (size_t i = 0; i < parameters.size(); ++i) {
-        // std::cerr << "  [" << _method->GetName() << "] param index " << i << " -> '" << parameters[i].first << "' (" << parameters[i].second.ToString() << ")" << std::endl;
+void ExecutionContext::Detach() {
+    if (_values == &_ownValues) {
+        return;
     }
+    std::vector<Value>& shared = *_values;
+    const size_t base = std::min(_argumentBase, shared.size());
+    _ownValues.assign(std::make_move_iterator(shared.begin() + static_cast<std::ptrdiff_t>(base)),
+                      std::make_move_iterator(shared.end()));
+    shared.resize(base);
+
+    _localBase -= _argumentBase;
+    _stackBase -= _argumentBase;
+    _argumentBase = 0;
+    _values = &_ownValues;
 }
 
-void ExecutionContext::PushStack(const Value& value) {
-    _stack.push_back(value);
+void ExecutionContext::GrowRegion(size_t position, size_t count) {
+    _values->insert(_values->begin() + static_cast<std::ptrdiff_t>(position), count, Value());
 }
 
 Value ExecutionContext::PopStack() {
-    if (_stack.empty()) {
+    if (_values->size() <= _stackBase) {
         throw std::runtime_error("Stack underflow");
     }
-    Value value = _stack.back();
-    _stack.pop_back();
+    Value value = std::move(_values->back());
+    _values->pop_back();
     return value;
 }
 
 Value ExecutionContext::PeekStack() const {
-    if (_stack.empty()) {
+    return PeekStack(0);
+}
+
+Value ExecutionContext::PeekStack(size_t depth) const {
+    if (GetStackDepth() <= depth) {
         throw std::runtime_error("Stack underflow");
     }
-    return _stack.back();
+    return (*_values)[_values->size() - 1 - depth];
 }
 
 std::vector<Value> ExecutionContext::GetStackSnapshot(size_t maxDepth) const {
     std::vector<Value> out;
-    if (_stack.empty() || maxDepth == 0) return out;
-    const size_t n = _stack.size();
+    const size_t n = GetStackDepth();
+    if (n == 0 || maxDepth == 0) return out;
     const size_t take = std::min(maxDepth, n);
     out.reserve(take);
     // Return top-of-stack first (like a typical stack trace view)
     for (size_t i = 0; i < take; ++i) {
-        out.push_back(_stack[n - 1 - i]);
+        out.push_back((*_values)[_values->size() - 1 - i]);
     }
     return out;
 }
 
+void ExecutionContext::VisitReferences(ReferenceVisitor& visitor) const {
+    if (_this) {
+        visitor.VisitObject(_this.get());
+    }
+    for (const auto& value : _ownValues) {
+        visitor.VisitValue(value);
+    }
+}
+
+void ExecutionContext::GrowLocals(size_t count) {
+    GrowRegion(_localBase + _localCount, count - _localCount);
+    _stackBase += count - _localCount;
+    _localCount = count;
+}
+
 void ExecutionContext::SetLocal(size_t index, const Value& value) {
-    if (index >= _locals.size()) {
-        _locals.resize(index + 1);
+    if (index >= _localCount) {
+        GrowLocals(index + 1);
     }
-    _locals[index] = value;
+    (*_values)[_localBase + index] = value;
 }
 
 Value ExecutionContext::GetLocal(size_t index) const {
-    if (index >= _locals.size()) {
+    if (index >= _localCount) {
         throw std::out_of_range("Local variable index out of range");
     }
-    return _locals[index];
+    return (*_values)[_localBase + index];
 }
 
 void ExecutionContext::SetLocal(const std::string& name, const Value& value) {
-    auto it = _localIndices.find(name);
-    if (it == _localIndices.end()) {
+    const auto& indices = _method->GetLocalIndices();
+    auto it = indices.find(SymbolTable::Find(name));
+    if (it == indices.end()) {
         std::cerr << "[" << _method->GetName() << "] SetLocal failed - Local variable not found: '" << name << "'" << std::endl;
         throw std::runtime_error("Local variable not found: " + name);
     }
-    // std::cerr << "[" << _method->GetName() << "] SetLocal: '" << name << "' -> index " << it->second << std::endl;
     SetLocal(it->second, value);
 }
 
 Value ExecutionContext::GetLocal(const std::string& name) const {
-    auto it = _localIndices.find(name);
-    if (it == _localIndices.end()) {
+    const auto& indices = _method->GetLocalIndices();
+    auto it = indices.find(SymbolTable::Find(name));
+    if (it == indices.end()) {
         std::cerr << "[" << _method->GetName() << "] GetLocal failed - Local variable not found: '" << name << "'" << std::endl;
         throw std::runtime_error("Local variable not found: " + name);
     }
-    // std::cerr << "[" << _method->GetName() << "] GetLocal: '" << name << "' -> index " << it->second << std::endl;
     return GetLocal(it->second);
 }
 
 void ExecutionContext::SetArguments(const std::vector<Value>& args) {
-    if (args.size() != _arguments.size()) {
-        _arguments.resize(args.size());
-    }
-    std::copy(args.begin(), args.end(), _arguments.begin());
+    if (args.size() > _argumentCount) {
+        const size_t extra = args.size() - _argumentCount;
+        GrowRegion(_argumentBase + _argumentCount, extra);
+        _localBase += extra;
+        _stackBase += extra;
+    } else if (args.size() < _argumentCount) {
+        const auto first = _values->begin() + static_cast<std::ptrdiff_t>(_argumentBase + args.size());
+        const size_t missing = _argumentCount - args.size();
+        _values->erase(first, first + static_cast<std::ptrdiff_t>(missing));
+        _localBase -= missing;
+        _stackBase -= missing;
+    }
+    _argumentCount = args.size();
+    std::copy(args.begin(), args.end(), _values->begin() + static_cast<std::ptrdiff_t>(_argumentBase));
 }
 
 Value ExecutionContext::GetArgument(size_t index) const {
-    if (index >= _arguments.size()) {
+    if (index >= _argumentCount) {
         throw std::out_of_range("Argument index out of range");
     }
-    return _arguments[index];
+    return (*_values)[_argumentBase + index];
 }
 
 Value ExecutionContext::GetArgument(const std::string& name) const {
@@ -669,34 +1295,93 @@ Value ExecutionContext::GetArgument(const std::string& name) const {
         return Value(_this);
     }
     
-    auto it = _parameterIndices.find(name);
-    if (it == _parameterIndices.end()) {
+    const auto& indices = _method->GetParameterIndices();
+    auto it = indices.find(SymbolTable::Find(name));
+    if (it == indices.end()) {
         throw std::runtime_error("Argument not found: " + name);
     }
     return GetArgument(it->second);
 }
 
+void ExecutionContext::SetArgument(size_t index, const Value& value) {
+    if (index >= _argumentCount) {
+        const size_t extra = index + 1 - _argumentCount;
+        GrowRegion(_argumentBase + _argumentCount, extra);
+        _argumentCount = index + 1;
+        _localBase += extra;
+        _stackBase += extra;
+    }
+    (*_values)[_argumentBase + index] = value;
+}
+
 void ExecutionContext::SetArgument(const std::string& name, const Value& value) {
-    auto it = _parameterIndices.find(name);
-    if (it == _parameterIndices.end()) {
+    const auto& indices = _method->GetParameterIndices();
+    auto it = indices.find(SymbolTable::Find(name));
+    if (it == indices.end()) {
         throw std::runtime_error("Argument not found: " + name);
     }
-    if (it->second >= _arguments.size()) {
-        _arguments.resize(it->second + 1);
-    }
-    _arguments[it->second] = value;
+    SetArgument(it->second, value);
 }
 
 // ============================================================================
 // VirtualMachine Implementation
 // ============================================================================
 
-VirtualMachine::VirtualMachine() = default;
+namespace {
+
+std::atomic<uint64_t> g_dispatchEpoch{1};
+
+uint64_t NextClassRegistryVersion() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+}
+
+} // namespace
+
+VirtualMachine::VirtualMachine() : _classRegistryVersion(NextClassRegistryVersion()) {
+    _frameValues.reserve(1024);
+    _rootScanner = GarbageCollector::AddRootScanner([this](ReferenceVisitor& visitor) { VisitRoots(visitor); });
+}
+
+uint64_t VirtualMachine::GetDispatchEpoch() {
+    return g_dispatchEpoch.load(std::memory_order_relaxed);
+}
+
+void VirtualMachine::InvalidateDispatchCaches() {
+    g_dispatchEpoch.fetch_add(1, std::memory_order_relaxed);
+}
 
 VirtualMachine::~VirtualMachine() {
+    GarbageCollector::RemoveRootScanner(_rootScanner);
+    // Prepared bodies cache the classes and methods their sites resolved to,
+    // which own those bodies in turn. Dropping them lets the classes go with
+    // the VM.
+    for (const auto& pair : _classes) {
+        for (const auto& method : pair.second->GetAllMethods()) {
+            method->SetPrepared(nullptr);
+        }
+    }
     UnloadAllPlugins();
 }
 
+void VirtualMachine::VisitRoots(ReferenceVisitor& visitor) const {
+    for (const auto& value : _frameValues) {
+        visitor.VisitValue(value);
+    }
+    // The bottom entry of the context stack is null (see PushContext).
+    for (const auto& context : _contextStack) {
+        if (context) {
+            context->VisitReferences(visitor);
+        }
+    }
+    if (_currentContext) {
+        _currentContext->VisitReferences(visitor);
+    }
+    for (const auto& context : _contextPool) {
+        context->VisitReferences(visitor);
+    }
+}
+
 bool VirtualMachine::LoadPlugin(const std::string& path) {
     if (path.empty()) {
         throw std::runtime_error("Plugin path is empty");
@@ -856,42 +1541,57 @@ void VirtualMachine::RegisterClass(ClassRef classType) {
     // - rawName: for code that stored fully-qualified names in Class::name
     // - qualifiedFromFields: canonical (namespace + simpleName)
     if (!simpleName.empty()) {
-        _classes[simpleName] = classType;
+        _classes[SymbolTable::Intern(simpleName)] = classType;
     }
     if (!rawName.empty()) {
-        _classes[rawName] = classType;
+        _classes[classType->GetNameSymbol()] = classType;
     }
     if (!qualifiedFromFields.empty()) {
-        _classes[qualifiedFromFields] = classType;
+        _classes[SymbolTable::Intern(qualifiedFromFields)] = classType;
     }
+    _classRegistryVersion = NextClassRegistryVersion();
+    InvalidateDispatchCaches();
 }
 /// @brief Retrieves a class reference by its name, supporting both simple and qualified names.
 /// @param name The name of the class to retrieve.
 /// @return A reference to the class.
 /// @throws std::runtime_error if the class is not found.
 ClassRef VirtualMachine::GetClass(const std::string& name) const {
+    if (auto classRef = FindClass(SymbolTable::Find(name), name)) {
+        return classRef;
+    }
+    throw std::runtime_error("Class not found: " + name);
+}
+
+ClassRef VirtualMachine::GetClass(SymbolId name) const {
+    const std::string& text = SymbolTable::GetName(name);
+    if (auto classRef = FindClass(name, text)) {
+        return classRef;
+    }
+    throw std::runtime_error("Class not found: " + text);
+}
+
+ClassRef VirtualMachine::FindClass(SymbolId name, std::string_view text) const {
     auto it = _classes.find(name);
     if (it != _classes.end()) {
         return it->second;
     }
     
     // If not found and name contains a dot, try just the simple name
-    size_t lastDot = name.find_last_of('.');
-    if (lastDot != std::string::npos) {
-        std::string simpleName = name.substr(lastDot + 1);
-        auto simpleIt = _classes.find(simpleName);
+    size_t lastDot = text.find_last_of('.');
+    if (lastDot != std::string_view::npos) {
+        auto simpleIt = _classes.find(SymbolTable::Find(text.substr(lastDot + 1)));
         if (simpleIt != _classes.end()) {
             return simpleIt->second;
         }
     }
-    
-    throw std::runtime_error("Class not found: " + name);
+    return nullptr;
 }
 
 std::vector<std::string> VirtualMachine::GetAllClassNames() const {
     std::vector<std::string> classNames;
     for (const auto& pair : _classes) {
-        classNames.push_back(pair.first);
+        classNames.push_back(SymbolTable::GetName(pair.first));
     }
     // Remove duplicates if any (due to qualified and simple names)
     std::sort(classNames.begin(), classNames.end());
@@ -899,7 +1599,36 @@ std::vector<std::string> VirtualMachine::GetAllClassNames() const {
     return classNames;
 }
 
+void VirtualMachine::VerifyClass(const ClassRef& classType) const {
+    if (!classType) return;
+
+    for (const auto& method : classType->GetAllMethods()) {
+        if (!method || method->GetNativeImpl() || !method->HasInstructions()) {
+            continue;
+        }
+        auto prepared = method->GetPrepared();
+        if (!prepared->verified) {
+            throw std::runtime_error("Verification failed for method '" + classType->GetName() + "." +
+                                     method->GetName() + "': " + prepared->verificationError);
+        }
+    }
+}
+
+void VirtualMachine::VerifyAllClasses() const {
+    // Classes are registered under several names; verify each one once.
+    std::unordered_set<const Class*> seen;
+    for (const auto& pair : _classes) {
+        if (seen.insert(pair.second.get()).second) {
+            VerifyClass(pair.second);
+        }
+    }
+}
+
 bool VirtualMachine::HasClass(const std::string& name) const {
+    return HasClass(SymbolTable::Find(name));
+}
+
+bool VirtualMachine::HasClass(SymbolId name) const {
     return _classes.find(name) != _classes.end();
 }
 
@@ -912,7 +1641,9 @@ ObjectRef VirtualMachine::CreateObject(const std::string& className) {
 }
 
 std::shared_ptr<Array> VirtualMachine::CreateArray(const TypeReference& elementType, int32_t length) {
-    return std::make_shared<Array>(elementType, length);
+    auto array = std::allocate_shared<Array>(NurseryAllocator<Array>(), elementType, length);
+    GarbageCollector::Track(array, sizeof(Array) + static_cast<size_t>(std::max(length, 0)) * array->GetElementSize());
+    return array;
 }
 
 Value VirtualMachine::InvokeMethod(ObjectRef object, const std::string& methodName, const std::vector<Value>& args) {
@@ -924,28 +1655,125 @@ Value VirtualMachine::InvokeMethod(ObjectRef object, const std::string& methodNa
     if (!method) {
         throw std::runtime_error("Method not found: " + methodName);
     }
-    
-    auto impl = method->GetNativeImpl();
+
+    return InvokeResolved(method, object, args);
+}
+
+Value VirtualMachine::InvokeMethod(ObjectRef object, SymbolId methodName, const std::vector<Value>& args) {
+    if (!object || !object->GetClass()) {
+        throw std::runtime_error("Cannot invoke method on null object");
+    }
+
+    auto method = object->GetClass()->LookupMethod(methodName);
+    if (!method) {
+        throw std::runtime_error("Method not found: " + SymbolTable::GetName(methodName));
+    }
+
+    return InvokeResolved(method, object, args);
+}
+
+Value VirtualMachine::InvokeResolved(const MethodRef& method, ObjectRef object, const std::vector<Value>& args) {
+    GarbageCollector::MutatorScope mutator;
+    const auto& impl = method->GetNativeImpl();
     if (impl) {
         return impl(object, args, this);
     }
 
     if (method->HasInstructions()) {
-        auto context = std::make_unique<ExecutionContext>(method);
-        context->SetThis(object);
-        context->SetArguments(args);
-        auto* rawContext = context.get();
-        PushContext(std::move(context));
-        auto result = InstructionExecutor::ExecuteInstructions(method->GetInstructions(), object, args, rawContext, this, method->GetLabelMap());
-        PopContext();
-        // If method is declared void, ignore residual stack value and return null
-        if (method->GetReturnType().IsPrimitive() && method->GetReturnType().GetPrimitiveType() == PrimitiveType::Void) {
-            return Value();
+        _frameValues.insert(_frameValues.end(), args.begin(), args.end());
+        return RunFrame(method, std::move(object), args.size());
+    }
+
+    throw std::runtime_error("Method has no implementation: " + method->GetName());
+}
+
+Value VirtualMachine::InvokeBytecode(const MethodRef& method, ObjectRef object, const std::vector<Value>& args) {
+    if (!method->HasInstructions()) {
+        throw std::runtime_error("Method has no implementation: " + method->GetName());
+    }
+    _frameValues.insert(_frameValues.end(), args.begin(), args.end());
+    return RunFrame(method, std::move(object), args.size());
+}
+
+Value VirtualMachine::InvokeWithStackArguments(const MethodRef& method, ObjectRef object, ExecutionContext* caller, size_t argumentCount) {
+    if (method->GetNativeImpl() || !method->HasInstructions() || !caller->UsesStorage(_frameValues)) {
+        std::vector<Value> args(argumentCount);
+        for (size_t i = argumentCount; i-- > 0;) {
+            args[i] = caller->PopStack();
         }
-        return result;
+        return InvokeResolved(method, std::move(object), args);
+    }
+
+    if (caller->GetStackDepth() < argumentCount) {
+        throw std::runtime_error("Stack underflow");
     }
+    return RunFrame(method, std::move(object), argumentCount);
+}
+
+std::shared_ptr<PreparedMethod> VirtualMachine::ReuseFrame(const MethodRef& method, ObjectRef object, ExecutionContext* frame, size_t argumentCount) {
+    if (method->GetNativeImpl() || !method->HasInstructions() || !frame->UsesStorage(_frameValues)) {
+        return nullptr;
+    }
+    auto prepared = TieredExecution::Enter(*method, this);
+    frame->Rebind(method, argumentCount);
+    frame->SetThis(std::move(object));
+    return prepared;
+}
 
-    throw std::runtime_error("Method has no implementation: " + methodName);
+std::shared_ptr<PreparedMethod> VirtualMachine::PushFrame(const MethodRef& method, ObjectRef object, ExecutionContext* caller, size_t argumentCount) {
+    if (method->GetNativeImpl() || !method->HasInstructions() || !caller->UsesStorage(_frameValues) ||
+        caller->GetStackDepth() < argumentCount) {
+        return nullptr;
+    }
+    auto prepared = TieredExecution::Enter(*method, this);
+    BindFrame(method, argumentCount)->SetThis(std::move(object));
+    return prepared;
+}
+
+void VirtualMachine::PopFrame() {
+    const size_t frameBase = _currentContext->GetFrameBase();
+    PopContext();
+    _frameValues.resize(frameBase);
+}
+
+ExecutionContext* VirtualMachine::BindFrame(const MethodRef& method, size_t argumentCount) {
+    std::unique_ptr<ExecutionContext> context;
+    if (_contextPool.empty()) {
+        context = std::make_unique<ExecutionContext>(method, _frameValues, argumentCount);
+    } else {
+        context = std::move(_contextPool.back());
+        _contextPool.pop_back();
+        context->Bind(method, _frameValues, argumentCount);
+    }
+    auto* rawContext = context.get();
+    PushContext(std::move(context));
+    return rawContext;
+}
+
+Value VirtualMachine::RunFrame(const MethodRef& method, ObjectRef object, size_t argumentCount) {
+    GarbageCollector::MutatorScope mutator;
+    // Hold on to the prepared body: a plugin may replace it mid-call.
+    auto prepared = TieredExecution::Enter(*method, this);
+    const size_t frameBase = _frameValues.size() - argumentCount;
+    auto* rawContext = BindFrame(method, argumentCount);
+
+    Value result;
+    try {
+        result = InstructionExecutor::ExecutePrepared(*prepared, std::move(object), rawContext, this);
+    } catch (...) {
+        // The failed frame stays on the call stack for diagnostics; move its
+        // values off the frame stack so callers that recover keep a valid one.
+        rawContext->Detach();
+        throw;
+    }
+    PopContext();
+    _frameValues.resize(frameBase);
+
+    // If method is declared void, ignore residual stack value and return null
+    if (method->GetReturnType().IsPrimitive() && method->GetReturnType().GetPrimitiveType() == PrimitiveType::Void) {
+        return Value();
+    }
+    return result;
 }
 
 namespace {
@@ -965,18 +1793,6 @@ std::string FormatMethodSignature(const ObjectIR::MethodRef& method) {
     return sig;
 }
 
-std::vector<ObjectIR::MethodRef> CollectMethodsByName(ObjectIR::ClassRef cls, const std::string& name) {
-    std::vector<ObjectIR::MethodRef> matches;
-    for (auto current = cls; current; current = current->GetBaseClass()) {
-        for (const auto& method : current->GetAllMethods()) {
-            if (method && method->GetName() == name) {
-                matches.push_back(method);
-            }
-        }
-    }
-    return matches;
-}
-
 bool TypeNameMatchesParameter(const std::string& requestedType,
                              const ObjectIR::TypeReference& parameterType) {
     const auto requestedNorm = ObjectIR::TypeNames::NormalizeTypeName(requestedType);
@@ -994,13 +1810,16 @@ bool TypeNameMatchesParameter(const std::string& requestedType,
 }
 
 ObjectIR::MethodRef ResolveOverloadOrThrow(ObjectIR::ClassRef cls,
+                                          ObjectIR::SymbolId name,
                                           const ObjectIR::CallTarget& target,
                                           bool requireStatic) {
     if (!cls) {
         throw std::runtime_error("Null class when resolving method: " + target.name);
     }
 
-    const auto methods = CollectMethodsByName(cls, target.name);
+    // Overridden methods are not candidates: the index only has the most
+    // derived one of each signature.
+    const auto& methods = cls->GetMethodsByName(name);
     if (methods.empty()) {
         throw std::runtime_error("Method not found: " + target.name);
     }
@@ -1089,52 +1908,21 @@ Value VirtualMachine::InvokeMethod(ObjectRef object, const CallTarget& target, c
         throw std::runtime_error("Cannot invoke method on null object");
     }
 
-    auto method = ResolveOverloadOrThrow(object->GetClass(), target, /*requireStatic*/false);
-
-    auto impl = method->GetNativeImpl();
-    if (impl) {
-        return impl(object, args, this);
-    }
-
-    if (method->HasInstructions()) {
-        auto context = std::make_unique<ExecutionContext>(method);
-        context->SetThis(object);
-        context->SetArguments(args);
-        auto* rawContext = context.get();
-        PushContext(std::move(context));
-        auto result = InstructionExecutor::ExecuteInstructions(method->GetInstructions(), object, args, rawContext, this, method->GetLabelMap());
-        PopContext();
-        if (method->GetReturnType().IsPrimitive() && method->GetReturnType().GetPrimitiveType() == PrimitiveType::Void) {
-            return Value();
-        }
-        return result;
-    }
-
-    throw std::runtime_error("Method has no implementation: " + target.name);
+    auto method = ResolveOverloadOrThrow(object->GetClass(), SymbolTable::Find(target.name), target, /*requireStatic*/false);
+    return InvokeResolved(method, object, args);
 }
 
 Value VirtualMachine::InvokeStaticMethod(ClassRef classType, const CallTarget& target, const std::vector<Value>& args) {
-    auto method = ResolveOverloadOrThrow(classType, target, /*requireStatic*/true);
-
-    auto impl = method->GetNativeImpl();
-    if (impl) {
-        return impl(nullptr, args, this);
-    }
+    auto method = ResolveOverloadOrThrow(classType, SymbolTable::Find(target.name), target, /*requireStatic*/true);
+    return InvokeResolved(method, nullptr, args);
+}
 
-    if (method->HasInstructions()) {
-        auto context = std::make_unique<ExecutionContext>(method);
-        context->SetArguments(args);
-        auto* rawContext = context.get();
-        PushContext(std::move(context));
-        auto result = InstructionExecutor::ExecuteInstructions(method->GetInstructions(), nullptr, args, rawContext, this, method->GetLabelMap());
-        PopContext();
-        if (method->GetReturnType().IsPrimitive() && method->GetReturnType().GetPrimitiveType() == PrimitiveType::Void) {
-            return Value();
-        }
-        return result;
-    }
+MethodRef VirtualMachine::ResolveMethod(ClassRef classType, const CallTarget& target, bool requireStatic) const {
+    return ResolveOverloadOrThrow(classType, SymbolTable::Find(target.name), target, requireStatic);
+}
 
-    throw std::runtime_error("Method has no implementation: " + target.name);
+MethodRef VirtualMachine::ResolveMethod(ClassRef classType, SymbolId name, const CallTarget& target, bool requireStatic) const {
+    return ResolveOverloadOrThrow(classType, name, target, requireStatic);
 }
 
 Value VirtualMachine::InvokeStaticMethod(ClassRef classType, const std::string& methodName, const std::vector<Value>& args) {
@@ -1142,27 +1930,17 @@ Value VirtualMachine::InvokeStaticMethod(ClassRef classType, const std::string&
     if (!method) {
         throw std::runtime_error("Static method not found: " + methodName);
     }
-    
-    auto impl = method->GetNativeImpl();
-    if (impl) {
-        return impl(nullptr, args, this);
-    }
 
-    if (method->HasInstructions()) {
-        auto context = std::make_unique<ExecutionContext>(method);
-        context->SetArguments(args);
-        auto* rawContext = context.get();
-        PushContext(std::move(context));
-        auto result = InstructionExecutor::ExecuteInstructions(method->GetInstructions(), nullptr, args, rawContext, this, method->GetLabelMap());
-        PopContext();
-        // If method is declared void, ignore residual stack value and return null
-        if (method->GetReturnType().IsPrimitive() && method->GetReturnType().GetPrimitiveType() == PrimitiveType::Void) {
-            return Value();
-        }
-        return result;
+    return InvokeResolved(method, nullptr, args);
+}
+
+Value VirtualMachine::InvokeStaticMethod(ClassRef classType, SymbolId methodName, const std::vector<Value>& args) {
+    auto method = classType->LookupMethod(methodName);
+    if (!method) {
+        throw std::runtime_error("Static method not found: " + SymbolTable::GetName(methodName));
     }
 
-    throw std::runtime_error("Method has no implementation: " + methodName);
+    return InvokeResolved(method, nullptr, args);
 }
 
 void VirtualMachine::PushContext(std::unique_ptr<ExecutionContext> context) {
@@ -1186,6 +1964,10 @@ std::vector<const ExecutionContext*> VirtualMachine::GetCallStackSnapshot() cons
 }
 
 void VirtualMachine::PopContext() {
+    if (_currentContext) {
+        _currentContext->Unbind();
+        _contextPool.push_back(std::move(_currentContext));
+    }
     if (!_contextStack.empty()) {
         _currentContext = std::move(_contextStack.back());
         _contextStack.pop_back();
@@ -1194,6 +1976,20 @@ void VirtualMachine::PopContext() {
     }
 }
 
+void VirtualMachine::UnwindTo(const ExecutionContext* frame) {
+    if (_currentContext.get() == frame) {
+        return;
+    }
+    const bool onStack = std::any_of(_contextStack.begin(), _contextStack.end(),
+                                     [frame](const auto& context) { return context.get() == frame; });
+    if (!onStack) {
+        return;
+    }
+    while (_currentContext.get() != frame) {
+        PopContext();
+    }
+}
+
 json VirtualMachine::ExportClassMetadata(const std::string& name, bool includeInstructions) const {
     auto classRef = GetClass(name);
     json type;
@@ -1245,6 +2041,15 @@ json VirtualMachine::ExportClassMetadata(const std::string& name, bool includeIn
             m["instructions"] = SerializeInstructionBlock(method->GetInstructions(), true);
         }
 
+        if (method->HasInstructions()) {
+            const MethodProfile& profile = method->GetProfile();
+            json execution;
+            execution["tier"] = GetExecutionTierName(method->GetTier());
+            execution["invocations"] = profile.invocations;
+            execution["backEdges"] = profile.backEdges;
+            m["execution"] = execution;
+        }
+
         methods.push_back(m);
     }
     type["methods"] = methods;
@@ -6,9 +6,11 @@
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 namespace
@@ -18,16 +20,83 @@ namespace
         std::shared_ptr<ObjectIR::VirtualMachine> vm;
     };
 
+    // Object and value handles are garbage collection roots while they live.
+    struct ObjectHandle;
+    struct ValueHandle;
+
+    struct HandleRegistry
+    {
+        std::mutex mutex;
+        std::unordered_set<const ObjectHandle *> objects;
+        std::unordered_set<const ValueHandle *> values;
+    };
+
+    HandleRegistry &Handles();
+
     struct ObjectHandle
     {
+        ObjectHandle()
+        {
+            auto &handles = Handles();
+            std::lock_guard<std::mutex> lock(handles.mutex);
+            handles.objects.insert(this);
+        }
+
+        ~ObjectHandle()
+        {
+            auto &handles = Handles();
+            std::lock_guard<std::mutex> lock(handles.mutex);
+            handles.objects.erase(this);
+        }
+
         ObjectIR::ObjectRef object;
     };
 
     struct ValueHandle
     {
+        ValueHandle()
+        {
+            auto &handles = Handles();
+            std::lock_guard<std::mutex> lock(handles.mutex);
+            handles.values.insert(this);
+        }
+
+        ~ValueHandle()
+        {
+            auto &handles = Handles();
+            std::lock_guard<std::mutex> lock(handles.mutex);
+            handles.values.erase(this);
+        }
+
         std::shared_ptr<ObjectIR::Value> value;
     };
 
+    HandleRegistry &Handles()
+    {
+        // Never destroyed, like the collector it registers with.
+        static auto *handles = []
+        {
+            auto *registry = new HandleRegistry();
+            ObjectIR::GarbageCollector::AddRootScanner([registry](ObjectIR::ReferenceVisitor &visitor)
+            {
+                std::lock_guard<std::mutex> lock(registry->mutex);
+                for (const auto *handle : registry->objects)
+                {
+                    visitor.VisitObject(handle->object.get());
+                }
+                for (const auto *handle : registry->values)
+                {
+                    if (handle->value)
+                    {
+                        visitor.VisitValue(*handle->value);
+                    }
+                }
+            });
+            return registry;
+        }();
+        return *handles;
+    }
+
     thread_local std::string g_lastError;
 
     void ClearLastError()
@@ -436,6 +505,132 @@ RUNTIME_API void *InvokeMethod(void *vmPtr, const char *className, const char *m
     return nullptr;
 }
 
+// Symbol entry points. Embedders that call into the VM repeatedly intern
+// their class and method names once and pass the ids, so the calls skip
+// hashing names.
+
+RUNTIME_API uint32_t InternSymbol(const char *name)
+{
+    if (!name)
+    {
+        SetLastError("Invalid arguments to InternSymbol");
+        return ObjectIR::kNoSymbol;
+    }
+
+    try
+    {
+        auto symbol = ObjectIR::SymbolTable::Intern(name);
+        ClearLastError();
+        return symbol;
+    }
+    catch (const std::exception &ex)
+    {
+        SetLastError(ex.what());
+    }
+    catch (...)
+    {
+        SetLastError("Unknown error in InternSymbol");
+    }
+    return ObjectIR::kNoSymbol;
+}
+
+RUNTIME_API char *GetSymbolName(uint32_t symbol)
+{
+    try
+    {
+        auto *name = CopyToCString(ObjectIR::SymbolTable::GetName(symbol));
+        ClearLastError();
+        return name;
+    }
+    catch (const std::exception &ex)
+    {
+        SetLastError(ex.what());
+    }
+    catch (...)
+    {
+        SetLastError("Unknown error in GetSymbolName");
+    }
+    return nullptr;
+}
+
+RUNTIME_API void *CreateInstanceBySymbol(void *vmPtr, uint32_t classSymbol)
+{
+    if (!vmPtr)
+    {
+        SetLastError("Invalid arguments to CreateInstanceBySymbol");
+        return nullptr;
+    }
+
+    try
+    {
+        auto *handle = AsRuntimeHandle(vmPtr);
+        auto *vm = GetVm(handle);
+        auto objRef = vm->CreateObject(vm->GetClass(classSymbol));
+        auto *objectHandle = new ObjectHandle();
+        objectHandle->object = objRef;
+        ClearLastError();
+        return objectHandle;
+    }
+    catch (const std::exception &ex)
+    {
+        SetLastError(ex.what());
+    }
+    catch (...)
+    {
+        SetLastError("Unknown error in CreateInstanceBySymbol");
+    }
+    return nullptr;
+}
+
+RUNTIME_API void *InvokeMethodBySymbol(void *vmPtr, uint32_t classSymbol, uint32_t methodSymbol, void *instancePtr, void **args, int32_t argCount)
+{
+    if (!vmPtr)
+    {
+        SetLastError("Invalid arguments to InvokeMethodBySymbol");
+        return nullptr;
+    }
+
+    try
+    {
+        auto *handle = AsRuntimeHandle(vmPtr);
+        auto *vm = GetVm(handle);
+        auto arguments = BuildArguments(args, argCount);
+        ObjectIR::Value result;
+
+        if (instancePtr)
+        {
+            auto *objectHandle = AsObjectHandle(instancePtr);
+            if (!objectHandle || !objectHandle->object)
+            {
+                throw std::runtime_error("Invalid object handle");
+            }
+            result = vm->InvokeMethod(objectHandle->object, methodSymbol, arguments);
+        }
+        else
+        {
+            if (classSymbol == ObjectIR::kNoSymbol)
+            {
+                throw std::runtime_error("Class symbol is required for static method invocation");
+            }
+            auto classRef = vm->GetClass(classSymbol);
+            result = vm->InvokeStaticMethod(classRef, methodSymbol, arguments);
+        }
+
+        auto *valueHandle = CreateValueHandle(std::move(result));
+        ClearLastError();
+        return valueHandle;
+    }
+    catch (const std::exception &ex)
+    {
+        SetLastError(ex.what());
+    }
+    catch (...)
+    {
+        SetLastError("Unknown error in InvokeMethodBySymbol");
+    }
+    return nullptr;
+}
+
 RUNTIME_API char *ValueToString(void *valuePtr)
 {
     if (!valuePtr)
@@ -663,3 +858,102 @@ RUNTIME_API void *CreateObjectValue(void *objectPtr)
     }
     return nullptr;
 }
+
+// Garbage collector entry points. The collector is process-wide; live object
+// and value handles are roots.
+
+RUNTIME_API int32_t ConfigureGarbageCollector(const char *spec)
+{
+    if (!spec)
+    {
+        SetLastError("Invalid arguments to ConfigureGarbageCollector");
+        return 0;
+    }
+
+    try
+    {
+        ObjectIR::GarbageCollector::Configure(spec);
+        ClearLastError();
+        return 1;
+    }
+    catch (const std::exception &ex)
+    {
+        SetLastError(ex.what());
+    }
+    catch (...)
+    {
+        SetLastError("Unknown error in ConfigureGarbageCollector");
+    }
+    return 0;
+}
+
+RUNTIME_API int64_t CollectGarbage()
+{
+    try
+    {
+        auto freed = ObjectIR::GarbageCollector::Collect();
+        ClearLastError();
+        return static_cast<int64_t>(freed);
+    }
+    catch (const std::exception &ex)
+    {
+        SetLastError(ex.what());
+    }
+    catch (...)
+    {
+        SetLastError("Unknown error in CollectGarbage");
+    }
+    return -1;
+}
+
+// Allocation regions. An embedder opens one before the calls that serve a
+// request and ends it after them, on the same thread; objects the request
+// left behind are freed, the ones that escaped are kept.
+
+RUNTIME_API void *BeginAllocationRegion()
+{
+    try
+    {
+        auto *region = new ObjectIR::AllocationRegion();
+        ClearLastError();
+        return region;
+    }
+    catch (const std::exception &ex)
+    {
+        SetLastError(ex.what());
+    }
+    catch (...)
+    {
+        SetLastError("Unknown error in BeginAllocationRegion");
+    }
+    return nullptr;
+}
+
+// Returns the number of the region's objects that did not escape, or -1 (the
+// region stays open, e.g. while a region opened after it is still open).
+RUNTIME_API int64_t EndAllocationRegion(void *regionPtr)
+{
+    if (!regionPtr)
+    {
+        SetLastError("Invalid arguments to EndAllocationRegion");
+        return -1;
+    }
+
+    try
+    {
+        auto *region = static_cast<ObjectIR::AllocationRegion *>(regionPtr);
+        auto statistics = region->Close();
+        delete region;
+        ClearLastError();
+        return static_cast<int64_t>(statistics.objects - statistics.promoted);
+    }
+    catch (const std::exception &ex)
+    {
+        SetLastError(ex.what());
+    }
+    catch (...)
+    {
+        SetLastError("Unknown error in EndAllocationRegion");
+    }
+    return -1;
+}
@@ -2,10 +2,21 @@
 #include "math_stubs.hpp"
 #include "io_stubs.hpp"
 #include "collections_stubs.hpp"
-
+#include "array_stubs.hpp"
+#include "array_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <limits>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 
 
@@ -42,6 +53,25 @@ std::string ValueToDisplayString(const Value& value) {
     return "";
 }
 
+// DataTracers for the native data of the collection and stream classes.
+template <typename Container>
+void TraceValues(const void* data, ReferenceVisitor& visitor) {
+    for (const auto& value : *static_cast<const Container*>(data)) {
+        visitor.VisitValue(value);
+    }
+}
+
+void TraceDictionary(const void* data, ReferenceVisitor& visitor) {
+    for (const auto& entry : *static_cast<const std::unordered_map<Value, Value>*>(data)) {
+        visitor.VisitValue(entry.first);
+        visitor.VisitValue(entry.second);
+    }
+}
+
+void TraceObject(const void* data, ReferenceVisitor& visitor) {
+    visitor.VisitObject(static_cast<const Object*>(data));
+}
+
 } // namespace
 
 // ============================================================================
@@ -815,10 +845,8 @@ Value FileStream_Read(ObjectRef thisPtr, const std::vector<Value>& args, Virtual
             auto bytesRead = fileStream->gcount();
 
             // Create a byte array object to return
-            auto byteArray = vm->CreateArray(TypeReference::UInt8(), bytesRead);
-            for (int32_t i = 0; i < bytesRead; ++i) {
-                byteArray->SetElement(i, Value(static_cast<int32_t>(buffer[i])));
-            }
+            auto byteArray = vm->CreateArray(TypeReference::UInt8(), static_cast<int32_t>(bytesRead));
+            std::copy_n(buffer.data(), bytesRead, byteArray->GetElements<uint8_t>());
             return Value(byteArray);
         }
     }
@@ -834,6 +862,14 @@ Value FileStream_Write(ObjectRef thisPtr, const std::vector<Value>& args, Virtua
             int32_t offset = args[1].AsInt32();
             int32_t count = args[2].AsInt32();
 
+            if (buffer->GetElementType().GetPrimitiveType() == PrimitiveType::UInt8 && buffer->IsUnboxed()) {
+                const int32_t begin = std::max(offset, 0);
+                const int32_t end = std::min(offset + std::max(count, 0), buffer->GetArrayLength());
+                if (begin < end) {
+                    fileStream->write(reinterpret_cast<const char*>(buffer->GetElements<uint8_t>() + begin), end - begin);
+                }
+                return Value();
+            }
             for (int32_t i = 0; i < count; ++i) {
                 auto byteVal = buffer->GetElement(offset + i);
                 if (byteVal.IsInt32()) {
@@ -865,7 +901,7 @@ Value FileStream_Close(ObjectRef thisPtr, const std::vector<Value>& args, Virtua
 Value StreamReader_ctor(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
     if (args.size() >= 1 && args[0].IsObject()) {
         // args[0] is the stream to read from
-        thisPtr->SetData(args[0].AsObject());
+        thisPtr->SetData(args[0].AsObject(), TraceObject);
     }
     return Value();
 }
@@ -903,7 +939,7 @@ Value StreamReader_Close(ObjectRef thisPtr, const std::vector<Value>& args, Virt
 Value StreamWriter_ctor(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
     if (args.size() >= 1 && args[0].IsObject()) {
         // args[0] is the stream to write to
-        thisPtr->SetData(args[0].AsObject());
+        thisPtr->SetData(args[0].AsObject(), TraceObject);
     }
     return Value();
 }
@@ -1024,6 +1060,48 @@ Value File_WriteAllLines(ObjectRef thisPtr, const std::vector<Value>& args, Virt
     return Value();
 }
 
+Value File_ReadAllBytes(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    if (args.size() >= 1 && args[0].IsString()) {
+        std::string path = args[0].AsString();
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (file.good()) {
+            const std::streamoff size = file.tellg();
+            if (size < 0 || size > std::numeric_limits<int32_t>::max()) {
+                return Value();
+            }
+            file.seekg(0);
+            auto byteArray = vm->CreateArray(TypeReference::UInt8(), static_cast<int32_t>(size));
+            file.read(reinterpret_cast<char*>(byteArray->GetElements<uint8_t>()), size);
+            return Value(byteArray);
+        }
+    }
+    return Value(); // null
+}
+
+Value File_WriteAllBytes(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    if (args.size() >= 2 && args[0].IsString() && args[1].IsObject()) {
+        std::string path = args[0].AsString();
+        auto bytesArray = std::dynamic_pointer_cast<Array>(args[1].AsObject());
+        if (bytesArray) {
+            std::ofstream file(path, std::ios::binary);
+            if (file.good()) {
+                const int32_t length = bytesArray->GetArrayLength();
+                if (bytesArray->GetElementType().GetPrimitiveType() == PrimitiveType::UInt8 && bytesArray->IsUnboxed()) {
+                    file.write(reinterpret_cast<const char*>(bytesArray->GetElements<uint8_t>()), length);
+                } else {
+                    for (int32_t i = 0; i < length; ++i) {
+                        auto byteVal = bytesArray->GetElement(i);
+                        if (byteVal.IsInt32()) {
+                            file.put(static_cast<char>(byteVal.AsInt32()));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return Value();
+}
+
 Value File_Delete(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
     if (args.size() >= 1 && args[0].IsString()) {
         std::string path = args[0].AsString();
@@ -1238,6 +1316,17 @@ void RegisterIOLibrary(std::shared_ptr<VirtualMachine> vm) {
     writeAllLines->SetNativeImpl(File_WriteAllLines);
     fileClass->AddMethod(writeAllLines);
 
+    auto readAllBytes = std::make_shared<Method>("ReadAllBytes", TypeReference::Object(), true, false);
+    readAllBytes->AddParameter("path", TypeReference::String());
+    readAllBytes->SetNativeImpl(File_ReadAllBytes);
+    fileClass->AddMethod(readAllBytes);
+
+    auto writeAllBytes = std::make_shared<Method>("WriteAllBytes", TypeReference::Void(), true, false);
+    writeAllBytes->AddParameter("path", TypeReference::String());
+    writeAllBytes->AddParameter("bytes", TypeReference::Object());
+    writeAllBytes->SetNativeImpl(File_WriteAllBytes);
+    fileClass->AddMethod(writeAllBytes);
+
     auto deleteFile = std::make_shared<Method>("Delete", TypeReference::Bool(), true, false);
     deleteFile->AddParameter("path", TypeReference::String());
     deleteFile->SetNativeImpl(File_Delete);
@@ -1246,6 +1335,339 @@ void RegisterIOLibrary(std::shared_ptr<VirtualMachine> vm) {
     vm->RegisterClass(fileClass);
 }
 
+// ============================================================================
+// System.Array Implementation
+// ============================================================================
+
+namespace {
+
+// The element type of an unboxed array, or Object for arrays of Values.
+PrimitiveType UnboxedKind(const Array& array) {
+    return array.IsUnboxed() ? array.GetElementType().GetPrimitiveType() : PrimitiveType::Object;
+}
+
+std::shared_ptr<Array> ArrayArgument(const std::vector<Value>& args, size_t index, const char* method) {
+    if (index < args.size() && args[index].IsObject()) {
+        if (auto array = std::dynamic_pointer_cast<Array>(args[index].AsObject())) {
+            return array;
+        }
+    }
+    throw std::runtime_error(std::string("System.Array.") + method + ": argument " + std::to_string(index + 1) +
+                             " is not an array");
+}
+
+// The storage of an unboxed array as T; bool arrays are handed to the uint8
+// kernels.
+template<typename T>
+T* StorageOf(Array& array) {
+    if constexpr (std::is_same_v<T, uint8_t>) {
+        if (UnboxedKind(array) == PrimitiveType::Bool) {
+            return reinterpret_cast<uint8_t*>(array.GetElements<bool>());
+        }
+    }
+    return array.GetElements<T>();
+}
+
+// Calls `function(elements, kernels)` with the storage of an array of int32,
+// int64, float32, float64 or uint8 and the kernels for it, and with bool
+// arrays as uint8 when `withBool` is set.
+template<typename Function>
+Value VisitUnboxed(Array& array, const char* method, bool withBool, Function&& function) {
+    const ArrayKernelTable& kernels = GetArrayKernels();
+    switch (UnboxedKind(array)) {
+        case PrimitiveType::Int32: return function(array.GetElements<int32_t>(), kernels.int32);
+        case PrimitiveType::Int64: return function(array.GetElements<int64_t>(), kernels.int64);
+        case PrimitiveType::Float32: return function(array.GetElements<float>(), kernels.float32);
+        case PrimitiveType::Float64: return function(array.GetElements<double>(), kernels.float64);
+        case PrimitiveType::UInt8: return function(array.GetElements<uint8_t>(), kernels.uint8);
+        case PrimitiveType::Bool:
+            if (withBool) {
+                return function(StorageOf<uint8_t>(array), kernels.uint8);
+            }
+            break;
+        default:
+            break;
+    }
+    throw std::runtime_error(std::string("System.Array.") + method +
+                             " needs an array of int32, int64, float32, float64 or uint8, not " +
+                             array.GetElementType().ToString());
+}
+
+void RequireSameElements(const Array& left, const Array& right, const char* method) {
+    if (UnboxedKind(left) != UnboxedKind(right) || left.GetArrayLength() != right.GetArrayLength()) {
+        throw std::runtime_error(std::string("System.Array.") + method +
+                                 " needs arrays of the same element type and length");
+    }
+}
+
+Value AccumulatorValue(int64_t total) { return Value(total); }
+Value AccumulatorValue(double total) { return Value(total); }
+
+// An element of the same type as the array's, boxed the way GetElement
+// boxes it.
+template<typename T>
+Value ElementValue(T element) {
+    if constexpr (std::is_same_v<T, uint8_t>) {
+        return Value(static_cast<int32_t>(element));
+    } else {
+        return Value(element);
+    }
+}
+
+// Sets `element` to `source` and reports whether it holds the same number.
+template<typename T, typename Source>
+bool ExactElement(Source source, T& element) {
+    if constexpr (std::is_floating_point_v<Source> && std::is_integral_v<T>) {
+        if (source != std::trunc(source) || source < static_cast<Source>(std::numeric_limits<T>::lowest()) ||
+            source >= static_cast<Source>(std::numeric_limits<T>::max()) + 1) {
+            return false;
+        }
+    }
+    element = static_cast<T>(source);
+    return static_cast<long double>(element) == static_cast<long double>(source);
+}
+
+// `value` as an element of type T, false when no element of type T equals it.
+template<typename T>
+bool ToExactElement(const Value& value, T& element) {
+    if (value.IsInt32()) return ExactElement(value.AsInt32(), element);
+    if (value.IsInt64()) return ExactElement(value.AsInt64(), element);
+    if (value.IsFloat32()) return ExactElement(value.AsFloat32(), element);
+    if (value.IsFloat64()) return ExactElement(value.AsFloat64(), element);
+    if (value.IsBool()) return ExactElement(static_cast<int32_t>(value.AsBool()), element);
+    return false;
+}
+
+Value ArrayExtreme(const std::vector<Value>& args, const char* method, bool max) {
+    auto array = ArrayArgument(args, 0, method);
+    if (array->GetArrayLength() == 0) {
+        throw std::runtime_error(std::string("System.Array.") + method + " of an empty array");
+    }
+    const size_t count = static_cast<size_t>(array->GetArrayLength());
+    return VisitUnboxed(*array, method, false, [&](auto* elements, const auto& kernels) {
+        return ElementValue(max ? kernels.max(elements, count) : kernels.min(elements, count));
+    });
+}
+
+Value ArrayCombine(const std::vector<Value>& args, const char* method, bool multiply) {
+    auto left = ArrayArgument(args, 0, method);
+    auto right = ArrayArgument(args, 1, method);
+    auto destination = ArrayArgument(args, 2, method);
+    RequireSameElements(*left, *right, method);
+    RequireSameElements(*left, *destination, method);
+    const size_t count = static_cast<size_t>(left->GetArrayLength());
+    return VisitUnboxed(*left, method, false, [&](auto* elements, const auto& kernels) {
+        using T = std::remove_pointer_t<decltype(elements)>;
+        auto combine = multiply ? kernels.multiply : kernels.add;
+        combine(elements, StorageOf<T>(*right), StorageOf<T>(*destination), count);
+        return Value();
+    });
+}
+
+} // namespace
+
+Value Array_Fill(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    auto array = ArrayArgument(args, 0, "Fill");
+    const Value value = args.size() >= 2 ? args[1] : Value();
+    const size_t count = static_cast<size_t>(array->GetArrayLength());
+    if (count == 0) {
+        return Value();
+    }
+    if (!array->IsUnboxed()) {
+        std::fill_n(array->GetElements<Value>(), count, value);
+        return Value();
+    }
+    // SetElement converts the value to the element type.
+    array->SetElement(0, value);
+    return VisitUnboxed(*array, "Fill", true, [&](auto* elements, const auto& kernels) {
+        kernels.fill(elements, count, elements[0]);
+        return Value();
+    });
+}
+
+Value Array_Copy(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    auto source = ArrayArgument(args, 0, "Copy");
+    auto destination = ArrayArgument(args, 1, "Copy");
+    if (args.size() < 3 || !args[2].IsInt32()) {
+        throw std::runtime_error("System.Array.Copy: argument 3 is not an int32 length");
+    }
+    const int32_t length = args[2].AsInt32();
+    if (length < 0 || length > source->GetArrayLength() || length > destination->GetArrayLength()) {
+        throw std::runtime_error("System.Array.Copy: length " + std::to_string(length) + " is out of range");
+    }
+    if (UnboxedKind(*source) != UnboxedKind(*destination)) {
+        // Convert every element before writing any, so an element the
+        // destination cannot hold leaves it untouched.
+        auto converted = std::make_shared<Array>(destination->GetElementType(), length);
+        for (int32_t i = 0; i < length; ++i) {
+            converted->SetElement(i, source->GetElement(i));
+        }
+        source = converted;
+    }
+    if (!source->IsUnboxed()) {
+        std::copy_n(source->GetElements<Value>(), length, destination->GetElements<Value>());
+        return Value();
+    }
+    return VisitUnboxed(*source, "Copy", true, [&](auto* elements, const auto&) {
+        using T = std::remove_pointer_t<decltype(elements)>;
+        std::memmove(StorageOf<T>(*destination), elements, static_cast<size_t>(length) * sizeof(T));
+        return Value();
+    });
+}
+
+Value Array_IndexOf(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    auto array = ArrayArgument(args, 0, "IndexOf");
+    const Value value = args.size() >= 2 ? args[1] : Value();
+    const size_t count = static_cast<size_t>(array->GetArrayLength());
+    if (!array->IsUnboxed()) {
+        const Value* elements = array->GetElements<Value>();
+        const Value* found = std::find(elements, elements + count, value);
+        return Value(found == elements + count ? -1 : static_cast<int32_t>(found - elements));
+    }
+    return VisitUnboxed(*array, "IndexOf", true, [&](auto* elements, const auto& kernels) {
+        using T = std::remove_pointer_t<decltype(elements)>;
+        T element{};
+        bool matches;
+        if (value.IsBool()) {
+            matches = UnboxedKind(*array) == PrimitiveType::Bool;
+            element = static_cast<T>(value.AsBool());
+        } else {
+            // Bool arrays match the integers 0 and 1.
+            matches = ToExactElement(value, element) &&
+                      (UnboxedKind(*array) != PrimitiveType::Bool || element <= 1);
+        }
+        return Value(matches ? static_cast<int32_t>(kernels.indexOf(elements, count, element)) : -1);
+    });
+}
+
+Value Array_SequenceEqual(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    auto left = ArrayArgument(args, 0, "SequenceEqual");
+    auto right = ArrayArgument(args, 1, "SequenceEqual");
+    const int32_t length = left->GetArrayLength();
+    if (length != right->GetArrayLength()) {
+        return Value(false);
+    }
+    if (UnboxedKind(*left) != UnboxedKind(*right) || !left->IsUnboxed()) {
+        for (int32_t i = 0; i < length; ++i) {
+            if (!(left->GetElement(i) == right->GetElement(i))) {
+                return Value(false);
+            }
+        }
+        return Value(true);
+    }
+    return VisitUnboxed(*left, "SequenceEqual", true, [&](auto* elements, const auto& kernels) {
+        using T = std::remove_pointer_t<decltype(elements)>;
+        return Value(kernels.equal(elements, StorageOf<T>(*right), static_cast<size_t>(length)));
+    });
+}
+
+Value Array_Sum(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    auto array = ArrayArgument(args, 0, "Sum");
+    const size_t count = static_cast<size_t>(array->GetArrayLength());
+    return VisitUnboxed(*array, "Sum", false, [&](auto* elements, const auto& kernels) {
+        return AccumulatorValue(kernels.sum(elements, count));
+    });
+}
+
+Value Array_Min(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    return ArrayExtreme(args, "Min", false);
+}
+
+Value Array_Max(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    return ArrayExtreme(args, "Max", true);
+}
+
+Value Array_Add(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    return ArrayCombine(args, "Add", false);
+}
+
+Value Array_Multiply(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    return ArrayCombine(args, "Multiply", true);
+}
+
+Value Array_Dot(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
+    auto left = ArrayArgument(args, 0, "Dot");
+    auto right = ArrayArgument(args, 1, "Dot");
+    RequireSameElements(*left, *right, "Dot");
+    const size_t count = static_cast<size_t>(left->GetArrayLength());
+    return VisitUnboxed(*left, "Dot", false, [&](auto* elements, const auto& kernels) {
+        using T = std::remove_pointer_t<decltype(elements)>;
+        return AccumulatorValue(kernels.dot(elements, StorageOf<T>(*right), count));
+    });
+}
+
+void RegisterArrayLibrary(std::shared_ptr<VirtualMachine> vm) {
+    // Create System.Array class
+    auto arrayClass = std::make_shared<Class>("System.Array");
+    arrayClass->SetNamespace("System");
+    arrayClass->SetAbstract(true);
+
+    auto fill = std::make_shared<Method>("Fill", TypeReference::Void(), true, false);
+    fill->AddParameter("array", TypeReference::Object());
+    fill->AddParameter("value", TypeReference::Object());
+    fill->SetNativeImpl(Array_Fill);
+    arrayClass->AddMethod(fill);
+
+    auto copy = std::make_shared<Method>("Copy", TypeReference::Void(), true, false);
+    copy->AddParameter("source", TypeReference::Object());
+    copy->AddParameter("destination", TypeReference::Object());
+    copy->AddParameter("length", TypeReference::Int32());
+    copy->SetNativeImpl(Array_Copy);
+    arrayClass->AddMethod(copy);
+
+    auto indexOf = std::make_shared<Method>("IndexOf", TypeReference::Int32(), true, false);
+    indexOf->AddParameter("array", TypeReference::Object());
+    indexOf->AddParameter("value", TypeReference::Object());
+    indexOf->SetNativeImpl(Array_IndexOf);
+    arrayClass->AddMethod(indexOf);
+
+    auto sequenceEqual = std::make_shared<Method>("SequenceEqual", TypeReference::Bool(), true, false);
+    sequenceEqual->AddParameter("left", TypeReference::Object());
+    sequenceEqual->AddParameter("right", TypeReference::Object());
+    sequenceEqual->SetNativeImpl(Array_SequenceEqual);
+    arrayClass->AddMethod(sequenceEqual);
+
+    // int64 for integer arrays, float64 otherwise
+    auto sum = std::make_shared<Method>("Sum", TypeReference::Object(), true, false);
+    sum->AddParameter("array", TypeReference::Object());
+    sum->SetNativeImpl(Array_Sum);
+    arrayClass->AddMethod(sum);
+
+    // The element type of the array
+    auto min = std::make_shared<Method>("Min", TypeReference::Object(), true, false);
+    min->AddParameter("array", TypeReference::Object());
+    min->SetNativeImpl(Array_Min);
+    arrayClass->AddMethod(min);
+
+    auto max = std::make_shared<Method>("Max", TypeReference::Object(), true, false);
+    max->AddParameter("array", TypeReference::Object());
+    max->SetNativeImpl(Array_Max);
+    arrayClass->AddMethod(max);
+
+    auto add = std::make_shared<Method>("Add", TypeReference::Void(), true, false);
+    add->AddParameter("left", TypeReference::Object());
+    add->AddParameter("right", TypeReference::Object());
+    add->AddParameter("destination", TypeReference::Object());
+    add->SetNativeImpl(Array_Add);
+    arrayClass->AddMethod(add);
+
+    auto multiply = std::make_shared<Method>("Multiply", TypeReference::Void(), true, false);
+    multiply->AddParameter("left", TypeReference::Object());
+    multiply->AddParameter("right", TypeReference::Object());
+    multiply->AddParameter("destination", TypeReference::Object());
+    multiply->SetNativeImpl(Array_Multiply);
+    arrayClass->AddMethod(multiply);
+
+    // int64 for integer arrays, float64 otherwise
+    auto dot = std::make_shared<Method>("Dot", TypeReference::Object(), true, false);
+    dot->AddParameter("left", TypeReference::Object());
+    dot->AddParameter("right", TypeReference::Object());
+    dot->SetNativeImpl(Array_Dot);
+    arrayClass->AddMethod(dot);
+
+    vm->RegisterClass(arrayClass);
+}
+
 // ============================================================================
 // System.Collections.Generic Implementation
 // ============================================================================
@@ -1253,7 +1675,7 @@ void RegisterIOLibrary(std::shared_ptr<VirtualMachine> vm) {
 Value List_ctor(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
     // Initialize empty list
     auto list = std::make_shared<std::vector<Value>>();
-    thisPtr->SetData(list);
+    thisPtr->SetData(list, TraceValues<std::vector<Value>>);
     return Value();
 }
 
@@ -1262,7 +1684,7 @@ Value List_ctor_Capacity(ObjectRef thisPtr, const std::vector<Value>& args, Virt
         int32_t capacity = args[0].AsInt32();
         auto list = std::make_shared<std::vector<Value>>();
         list->reserve(capacity);
-        thisPtr->SetData(list);
+        thisPtr->SetData(list, TraceValues<std::vector<Value>>);
     }
     return Value();
 }
@@ -1432,7 +1854,7 @@ Value List_ToArray(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMac
 Value Dictionary_ctor(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
     // Initialize empty dictionary
     auto dict = std::make_shared<std::unordered_map<Value, Value>>();
-    thisPtr->SetData(dict);
+    thisPtr->SetData(dict, TraceDictionary);
     return Value();
 }
 
@@ -1548,7 +1970,7 @@ Value Dictionary_get_Values(ObjectRef thisPtr, const std::vector<Value>& args, V
 Value Queue_ctor(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
     // Initialize empty queue
     auto queue = std::make_shared<std::deque<Value>>();
-    thisPtr->SetData(queue);
+    thisPtr->SetData(queue, TraceValues<std::deque<Value>>);
     return Value();
 }
 
@@ -1609,7 +2031,7 @@ Value Queue_Contains(ObjectRef thisPtr, const std::vector<Value>& args, VirtualM
 Value Stack_ctor(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
     // Initialize empty stack
     auto stack = std::make_shared<std::vector<Value>>();
-    thisPtr->SetData(stack);
+    thisPtr->SetData(stack, TraceValues<std::vector<Value>>);
     return Value();
 }
 
@@ -1670,7 +2092,7 @@ Value Stack_Contains(ObjectRef thisPtr, const std::vector<Value>& args, VirtualM
 Value HashSet_ctor(ObjectRef thisPtr, const std::vector<Value>& args, VirtualMachine* vm) {
     // Initialize empty hash set
     auto hashSet = std::make_shared<std::unordered_set<Value>>();
-    thisPtr->SetData(hashSet);
+    thisPtr->SetData(hashSet, TraceValues<std::unordered_set<Value>>);
     return Value();
 }
 
@@ -2191,6 +2613,9 @@ void RegisterStandardLibrary(std::shared_ptr<VirtualMachine> vm) {
     
     // Register System.IO library
     RegisterIOLibrary(vm);
+
+    // Register System.Array bulk operations
+    RegisterArrayLibrary(vm);
     
     // Register System.Collections.Generic library
     RegisterCollectionsLibrary(vm);
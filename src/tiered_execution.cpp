@@ -0,0 +1,124 @@
+#include "bytecode.hpp"
+#include "jit_compiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+namespace ObjectIR {
+
+namespace {
+
+std::atomic<bool> g_tieringEnabled{true};
+std::atomic<uint32_t> g_invocationThreshold{16};
+std::atomic<uint32_t> g_backEdgeThreshold{1000};
+
+uint32_t ParseThreshold(const std::string& entry, const std::string& value) {
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.size() > 9) {
+        throw std::runtime_error("Invalid tiering threshold: " + entry);
+    }
+    return static_cast<uint32_t>(std::stoul(value));
+}
+
+} // namespace
+
+void TieredExecution::SetEnabled(bool enabled) {
+    g_tieringEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool TieredExecution::IsEnabled() {
+    return g_tieringEnabled.load(std::memory_order_relaxed);
+}
+
+void TieredExecution::SetThresholds(uint32_t invocations, uint32_t backEdges) {
+    g_invocationThreshold.store(std::max<uint32_t>(invocations, 1), std::memory_order_relaxed);
+    g_backEdgeThreshold.store(std::max<uint32_t>(backEdges, 1), std::memory_order_relaxed);
+}
+
+uint32_t TieredExecution::GetInvocationThreshold() {
+    return g_invocationThreshold.load(std::memory_order_relaxed);
+}
+
+uint32_t TieredExecution::GetBackEdgeThreshold() {
+    return g_backEdgeThreshold.load(std::memory_order_relaxed);
+}
+
+ExecutionTier TieredExecution::GetInitialTier() {
+    return IsEnabled() ? ExecutionTier::Interpreter : ExecutionTier::Optimized;
+}
+
+std::shared_ptr<PreparedMethod> TieredExecution::Enter(Method& method, VirtualMachine* vm) {
+    auto prepared = method.GetPrepared();
+    if (++method.GetProfile().invocations >= GetInvocationThreshold() &&
+        prepared->tier == ExecutionTier::Interpreter && IsEnabled()) {
+        prepared = Optimize(method, vm);
+    }
+    return prepared;
+}
+
+std::shared_ptr<PreparedMethod> TieredExecution::Optimize(Method& method, VirtualMachine* vm) {
+    auto prepared = method.GetPrepared();
+    if (prepared->tier != ExecutionTier::Interpreter || method.GetNativeImpl()) {
+        return prepared;
+    }
+    prepared = BytecodeCompiler::Compile(method, vm, ExecutionTier::Optimized);
+    method.SetPrepared(prepared);
+    return prepared;
+}
+
+void TieredExecution::OptimizeAll(VirtualMachine& vm) {
+    // Classes are registered under several names; visit each one once.
+    std::unordered_set<const Class*> seen;
+    for (const auto& name : vm.GetAllClassNames()) {
+        ClassRef classRef = vm.GetClass(name);
+        if (!classRef || !seen.insert(classRef.get()).second) {
+            continue;
+        }
+        for (const auto& method : classRef->GetAllMethods()) {
+            if (method && method->HasInstructions()) {
+                Optimize(*method, &vm);
+            }
+        }
+    }
+}
+
+void TieredExecution::Configure(const std::string& spec) {
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        std::string entry = spec.substr(start, end - start);
+        start = end + 1;
+
+        const size_t first = entry.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            continue;
+        }
+        entry = entry.substr(first, entry.find_last_not_of(" \t") - first + 1);
+
+        if (entry == "on" || entry == "off") {
+            SetEnabled(entry == "on");
+            continue;
+        }
+        const size_t equals = entry.find('=');
+        const std::string key = entry.substr(0, equals);
+        const std::string value = equals == std::string::npos ? std::string() : entry.substr(equals + 1);
+        if (key == "optimize") {
+            SetThresholds(ParseThreshold(entry, value), GetBackEdgeThreshold());
+        } else if (key == "optimize-loops") {
+            SetThresholds(GetInvocationThreshold(), ParseThreshold(entry, value));
+        } else if (key == "native") {
+            JitCompiler::SetThresholds(ParseThreshold(entry, value), JitCompiler::GetBackEdgeThreshold());
+        } else if (key == "native-loops") {
+            JitCompiler::SetThresholds(JitCompiler::GetInvocationThreshold(), ParseThreshold(entry, value));
+        } else {
+            throw std::runtime_error("Unknown tiering setting: " + entry);
+        }
+    }
+}
+
+} // namespace ObjectIR